@@ -0,0 +1,511 @@
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <variant>
+#include <vector>
+
+#include "bench_stats.hpp"
+#include "can/core/arbitration_id.hpp"
+#include "can/core/can_frame_pool.hpp"
+#include "can/core/can_message_buffer.hpp"
+#include "can/core/dispatch.hpp"
+#include "can/core/ids.hpp"
+#include "can/core/message_core.hpp"
+#include "can/core/message_id_table.hpp"
+#include "can/core/messages.hpp"
+#include "can/core/parse.hpp"
+
+/*
+ * Host benchmarks for the work that every received CAN frame goes
+ * through: getting it from the receive interrupt to the dispatching task,
+ * finding the parser for a message id, deciding whether a dispatch target
+ * wants the frame at all, and handing it to the targets of a node.
+ *
+ * The parser and the message id table are compared against the lookups
+ * they replaced, which are kept here as references: a fold that compares
+ * the id against each type in turn, and a binary search of an id array
+ * sorted at startup. The frame pool is compared against a model of the
+ * FreeRTOS message buffer it replaced.
+ *
+ * Usage: can-benchmarks [--frames N]
+ */
+
+using namespace can::ids;
+using namespace can::messages;
+
+// The reference lookups get the same linkage as the code under test, so the
+// compiler makes the same inlining decisions for both.
+namespace reference {
+
+template <typename... T>
+class LinearParser {
+  public:
+    using Result = std::variant<std::monostate, T...>;
+
+    template <bit_utils::ByteIterator Iterator>
+    auto parse(MessageId message_id, const Iterator& payload,
+               const Iterator& limit) -> Result {
+        auto result = Result{std::monostate{}};
+        ((([&result, message_id, &payload, &limit]() -> void {
+             if (message_id == T::id) {
+                 result = T::parse(payload, limit);
+             }
+         })()),
+         ...);
+        return result;
+    }
+};
+
+template <typename... T>
+class SortedIdCollection {
+  public:
+    SortedIdCollection() { std::sort(arr.begin(), arr.end()); }
+
+    [[nodiscard]] auto in(MessageId id) const -> bool {
+        return std::binary_search(arr.cbegin(), arr.cend(), id);
+    }
+
+  private:
+    std::array<MessageId, sizeof...(T)> arr{T::id...};
+};
+
+/*
+ * The copies a FreeRTOS message buffer makes: each message is stored as a
+ * length followed by its bytes in a byte ring, wrapping at the end.
+ */
+template <std::size_t BufferSize>
+class MessageBuffer {
+  public:
+    static auto constexpr max_delay = 0;
+
+    template <typename Iterator, typename Limit>
+    auto send(Iterator iter, Limit limit, uint32_t) -> std::size_t {
+        return send_from_isr(iter, limit);
+    }
+
+    template <typename Iterator, typename Limit>
+    auto send_from_isr(Iterator iter, Limit limit) -> std::size_t {
+        auto length = static_cast<uint32_t>(limit - iter);
+        if (BufferSize - (head - tail) < length + sizeof(length)) {
+            return 0;
+        }
+        copy_in(reinterpret_cast<const uint8_t*>(&length), sizeof(length));
+        copy_in(&*iter, length);
+        return length;
+    }
+
+    template <typename Iterator, typename Limit>
+    auto receive(Iterator iter, Limit limit, uint32_t) -> std::size_t {
+        if (head == tail) {
+            return 0;
+        }
+        auto length = uint32_t{0};
+        copy_out(reinterpret_cast<uint8_t*>(&length), sizeof(length));
+        if (length > static_cast<uint32_t>(limit - iter)) {
+            tail += length;
+            return 0;
+        }
+        copy_out(&*iter, length);
+        return length;
+    }
+
+  private:
+    void copy_in(const uint8_t* source, std::size_t length) {
+        auto offset = head % BufferSize;
+        auto first = std::min(length, BufferSize - offset);
+        memcpy(&ring[offset], source, first);
+        if (length > first) {
+            memcpy(&ring[0], source + first, length - first);
+        }
+        head += length;
+    }
+
+    void copy_out(uint8_t* destination, std::size_t length) {
+        auto offset = tail % BufferSize;
+        auto first = std::min(length, BufferSize - offset);
+        memcpy(destination, &ring[offset], first);
+        if (length > first) {
+            memcpy(destination + first, &ring[0], length - first);
+        }
+        tail += length;
+    }
+
+    std::array<uint8_t, BufferSize> ring{};
+    std::size_t head = 0;
+    std::size_t tail = 0;
+};
+
+}  // namespace reference
+
+namespace {
+
+template <typename... T>
+struct TypeList {
+    template <template <typename...> class Into>
+    using apply = Into<T...>;
+    template <template <typename, typename...> class Into, typename First>
+    using apply_after = Into<First, T...>;
+    static constexpr std::array<MessageId, sizeof...(T)> ids{T::id...};
+};
+
+// Every message in messages.hpp that can be parsed, which is what a node
+// receives
+using AllMessages = TypeList<
+    Acknowledgment, ErrorMessage, HeartbeatRequest, HeartbeatResponse,
+    MotorStatusRequest, DeviceInfoRequest, TaskInfoRequest, StopRequest,
+    EnableMotorRequest, GearEnableMotorRequest, DisableMotorRequest,
+    GearDisableMotorRequest, ReadLimitSwitchRequest, MotorPositionRequest,
+    IncreaseEvoDispenseRequest, UpdateMotorPositionEstimationRequest,
+    WriteToEEPromRequest, ReadFromEEPromRequest, AddLinearMoveRequest,
+    AddJerkMoveRequest, HomeRequest, GetMoveGroupRequest,
+    ExecuteMoveGroupRequest, ClearAllMoveGroupsRequest,
+    ExecuteMoveStreamRequest, EndMoveStreamRequest, SetMotionConstraints,
+    GetMotionConstraintsRequest, WriteMotorDriverRegister,
+    ReadMotorDriverRegister, ReadMotorDriverErrorStatusRequest,
+    WriteMotorCurrentRequest, ReadPresenceSensingVoltageRequest,
+    AttachedToolsRequest, InitiateFirmwareUpdate, FirmwareUpdateStatusRequest,
+    SendAccumulatedSensorDataRequest, MaxSensorValueRequest,
+    ReadFromSensorRequest, WriteToSensorRequest, BaselineSensorRequest,
+    SetSensorThresholdRequest, SetBrushedMotorVrefRequest,
+    BrushedMotorConfRequest, SetBrushedMotorPwmRequest,
+    AddBrushedLinearMoveRequest, GripperGripRequest, GripperHomeRequest,
+    SetSerialNumber, SensorDiagnosticRequest, BindSensorOutputRequest,
+    TipStatusQueryRequest, TipActionRequest, GearWriteMotorCurrentRequest,
+    GearWriteMotorDriverRegister, GearReadMotorDriverRegister,
+    PeripheralStatusRequest, InstrumentInfoRequest,
+    SetGripperErrorToleranceRequest, GetMotorUsageRequest,
+    GripperJawStateRequest, SetGripperJawHoldoffRequest,
+    GripperJawHoldoffRequest, SetHepaFanStateRequest, GetHepaFanStateRequest,
+    SetHepaUVStateRequest, GetHepaUVStateRequest, AddSensorMoveRequest,
+    TransmitLaneStatusRequest, SensorStreamRequest>;
+
+// The messages the move group target of a motor node accepts
+using MoveGroupMessages =
+    TypeList<AddLinearMoveRequest, AddJerkMoveRequest, GetMoveGroupRequest,
+             ExecuteMoveGroupRequest, ClearAllMoveGroupsRequest,
+             ExecuteMoveStreamRequest, EndMoveStreamRequest, HomeRequest,
+             StopRequest>;
+
+// The messages the motion controller target of a motor node accepts
+using MotionMessages =
+    TypeList<DisableMotorRequest, EnableMotorRequest,
+             GetMotionConstraintsRequest, SetMotionConstraints,
+             ReadLimitSwitchRequest, MotorPositionRequest,
+             UpdateMotorPositionEstimationRequest, GetMotorUsageRequest,
+             MotorStatusRequest, IncreaseEvoDispenseRequest>;
+
+// The messages the system, eeprom and driver targets of a motor node accept
+using NodeMessages =
+    TypeList<DeviceInfoRequest, InitiateFirmwareUpdate,
+             FirmwareUpdateStatusRequest, TaskInfoRequest,
+             WriteToEEPromRequest, ReadFromEEPromRequest,
+             WriteMotorDriverRegister, ReadMotorDriverRegister,
+             WriteMotorCurrentRequest, ReadMotorDriverErrorStatusRequest>;
+
+// The messages all the targets of a motor node accept between them
+using MotorNodeMessages = TypeList<
+    AddLinearMoveRequest, AddJerkMoveRequest, GetMoveGroupRequest,
+    ExecuteMoveGroupRequest, ClearAllMoveGroupsRequest,
+    ExecuteMoveStreamRequest, EndMoveStreamRequest, HomeRequest, StopRequest,
+    DisableMotorRequest, EnableMotorRequest, GetMotionConstraintsRequest,
+    SetMotionConstraints, ReadLimitSwitchRequest, MotorPositionRequest,
+    UpdateMotorPositionEstimationRequest, GetMotorUsageRequest,
+    MotorStatusRequest, IncreaseEvoDispenseRequest, DeviceInfoRequest,
+    InitiateFirmwareUpdate, FirmwareUpdateStatusRequest, TaskInfoRequest,
+    WriteToEEPromRequest, ReadFromEEPromRequest, WriteMotorDriverRegister,
+    ReadMotorDriverRegister, WriteMotorCurrentRequest,
+    ReadMotorDriverErrorStatusRequest>;
+
+template <typename... T>
+struct TableCollection {
+    [[nodiscard]] auto in(MessageId id) const -> bool {
+        return can::message_id_table::MessageIdTable<T...>::contains(id);
+    }
+};
+
+template <typename... T>
+struct CountingHandler {
+    CountingHandler() = default;
+    CountingHandler(const CountingHandler&) = delete;
+    CountingHandler(const CountingHandler&&) = delete;
+    auto operator=(const CountingHandler&) -> CountingHandler& = delete;
+    auto operator=(const CountingHandler&&) -> CountingHandler&& = delete;
+    ~CountingHandler() = default;
+
+    void handle(std::variant<std::monostate, T...>& message) {
+        count += message.index();
+    }
+    std::size_t count = 0;
+};
+
+template <typename Messages>
+struct CountingTarget {
+    using Handler = typename Messages::template apply<CountingHandler>;
+    using Target = typename Messages::template apply_after<
+        can::dispatch::DispatchParseTarget, Handler>;
+    Handler handler{};
+    Target target{handler};
+};
+
+/*
+ * The targets of a motor node behind one dispatcher, as the boards set
+ * them up.
+ */
+struct MotorNode {
+    CountingTarget<MoveGroupMessages> move_group{};
+    CountingTarget<MotionMessages> motion{};
+    CountingTarget<NodeMessages> node{};
+
+    template <template <typename, typename...> class DispatcherType,
+              typename Test>
+    auto dispatcher(Test test) {
+        return DispatcherType(test, move_group.target, motion.target,
+                              node.target);
+    }
+
+    [[nodiscard]] auto count() const -> std::size_t {
+        return move_group.handler.count + motion.handler.count +
+               node.handler.count;
+    }
+};
+
+/*
+ * A node with a main motor and two gear motors, each with their own move
+ * group and motion targets, like the 96 channel pipette.
+ */
+struct GearMotorNode {
+    CountingTarget<MoveGroupMessages> move_group{};
+    CountingTarget<MotionMessages> motion{};
+    CountingTarget<MoveGroupMessages> left_move_group{};
+    CountingTarget<MotionMessages> left_motion{};
+    CountingTarget<MoveGroupMessages> right_move_group{};
+    CountingTarget<MotionMessages> right_motion{};
+    CountingTarget<NodeMessages> node{};
+
+    template <template <typename, typename...> class DispatcherType,
+              typename Test>
+    auto dispatcher(Test test) {
+        return DispatcherType(test, move_group.target, motion.target,
+                              left_move_group.target, left_motion.target,
+                              right_move_group.target, right_motion.target,
+                              node.target);
+    }
+
+    [[nodiscard]] auto count() const -> std::size_t {
+        return move_group.handler.count + motion.handler.count +
+               left_move_group.handler.count + left_motion.handler.count +
+               right_move_group.handler.count + right_motion.handler.count +
+               node.handler.count;
+    }
+};
+
+/*
+ * The ids of a stream of received frames: the ids of the full message list
+ * in a fixed pseudo-random order, with one frame in eight carrying an id
+ * that no message uses.
+ */
+auto frame_ids(std::size_t count) -> std::vector<MessageId> {
+    auto ids = std::vector<MessageId>{};
+    ids.reserve(count);
+    uint32_t state = 0x2545f491;
+    for (std::size_t i = 0; i < count; ++i) {
+        state = state * 1664525U + 1013904223U;
+        auto pick = state >> 16;
+        if (pick % 8 == 0) {
+            // 0x7ff is not a message id
+            ids.push_back(static_cast<MessageId>(0x7ff));
+        } else {
+            ids.push_back(AllMessages::ids[pick % AllMessages::ids.size()]);
+        }
+    }
+    return ids;
+}
+
+// Keeps the results of the code under test alive
+volatile std::size_t sink = 0;
+
+// A frame takes less time than reading the clock, so they are timed in
+// batches
+constexpr std::size_t frames_per_sample = 64;
+
+template <typename Callable>
+auto time_frames(const std::vector<MessageId>& ids, Callable&& callable)
+    -> benchmarks::Summary {
+    std::size_t total = 0;
+    // One untimed pass so both sides start with warm caches
+    for (auto id : ids) {
+        total += callable(id);
+    }
+    auto sampler = benchmarks::Sampler{ids.size() / frames_per_sample};
+    for (std::size_t first = 0; first + frames_per_sample <= ids.size();
+         first += frames_per_sample) {
+        sampler.time([&]() {
+            for (std::size_t i = first; i < first + frames_per_sample; ++i) {
+                total += callable(ids[i]);
+            }
+        });
+    }
+    sink = total;
+    return benchmarks::per_call(sampler.summarize(""), frames_per_sample);
+}
+
+template <template <typename...> class ParserType, typename Messages>
+auto time_parse(const std::vector<MessageId>& ids) -> benchmarks::Summary {
+    auto parser = typename Messages::template apply<ParserType>{};
+    auto payload = std::array<uint8_t, can::message_core::MaxMessageSize>{};
+    return time_frames(ids, [&parser, &payload](MessageId id) {
+        return parser.parse(id, payload.cbegin(), payload.cend()).index();
+    });
+}
+
+template <template <typename...> class CollectionType, typename Messages>
+auto time_lookup(const std::vector<MessageId>& ids) -> benchmarks::Summary {
+    const auto collection = typename Messages::template apply<CollectionType>{};
+    return time_frames(ids, [&collection](MessageId id) {
+        return static_cast<std::size_t>(collection.in(id));
+    });
+}
+
+template <typename Node,
+          template <typename, typename...> class DispatcherType>
+auto time_dispatch(const std::vector<MessageId>& ids)
+    -> benchmarks::Summary {
+    auto node = Node{};
+    auto dispatcher = node.template dispatcher<DispatcherType>(
+        can::dispatch::StandardArbIdTest{.node_id = NodeId::gantry_x});
+    auto payload = std::array<uint8_t, can::message_core::MaxMessageSize>{};
+    auto arb = can::arbitration_id::ArbitrationId{};
+    arb.node_id(NodeId::gantry_x);
+    auto result = time_frames(ids, [&](MessageId id) {
+        arb.message_id(id);
+        dispatcher.handle(arb.get_id(), payload.cbegin(), payload.cend());
+        return std::size_t{0};
+    });
+    sink = node.count();
+    return result;
+}
+
+/*
+ * Looks at the start of each frame, as a parser would.
+ */
+struct PeekingListener {
+    template <typename Iterator>
+    void handle(uint32_t arbitration_id, Iterator start, Iterator limit) {
+        total += arbitration_id + static_cast<std::size_t>(limit - start);
+        if (start != limit) {
+            total += *start;
+        }
+    }
+    std::size_t total = 0;
+};
+
+/*
+ * Each frame is written by the "interrupt" and read by the "task" straight
+ * away, so this is the cost of getting one frame across.
+ */
+auto time_message_buffer_receive(const std::vector<MessageId>& ids,
+                                 std::size_t payload_size)
+    -> benchmarks::Summary {
+    using BufferType = reference::MessageBuffer<1024>;
+    auto buffer = BufferType{};
+    auto listener = PeekingListener{};
+    auto writer = can::message_buffer::CanMessageBufferWriter(buffer);
+    auto reader = can::message_buffer::CanMessageBufferReader<
+        BufferType, PeekingListener>(buffer, listener);
+    auto payload = std::array<uint8_t, can::message_core::MaxMessageSize>{};
+    auto result = time_frames(ids, [&](MessageId id) {
+        writer.send_from_isr(static_cast<uint32_t>(id), payload.begin(),
+                             payload.begin() + payload_size);
+        reader.read(0);
+        return std::size_t{0};
+    });
+    sink = listener.total;
+    return result;
+}
+
+auto time_frame_pool_receive(const std::vector<MessageId>& ids,
+                             std::size_t payload_size)
+    -> benchmarks::Summary {
+    auto pool = can::frame_pool::CanFramePool<16>{};
+    auto listener = PeekingListener{};
+    auto payload = std::array<uint8_t, can::message_core::MaxMessageSize>{};
+    auto result = time_frames(ids, [&](MessageId id) {
+        pool.write(static_cast<uint32_t>(id), payload.begin(),
+                   payload.begin() + payload_size);
+        pool.dispatch_one(listener);
+        return std::size_t{0};
+    });
+    sink = listener.total;
+    return result;
+}
+
+void report(const char* name, const benchmarks::Summary& reference,
+            const benchmarks::Summary& current) {
+    printf("%-28s %10.2f %10.2f %10.2f %10.2f %9.2fx\n", name,
+           reference.p50_ns, current.p50_ns, reference.p99_ns,
+           current.p99_ns,
+           current.p50_ns > 0 ? reference.p50_ns / current.p50_ns : 0.0);
+}
+
+}  // namespace
+
+auto main(int argc, char** argv) -> int {
+    std::size_t frames = 1000000;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = strtoul(argv[++i], nullptr, 0);
+        } else {
+            fprintf(stderr, "usage: %s [--frames N]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (frames < frames_per_sample) {
+        fprintf(stderr, "--frames must be at least %zu\n",
+                frames_per_sample);
+        return 1;
+    }
+
+    auto ids = frame_ids(frames);
+    printf("%zu frames, %zu message types, table of %zu slots\n", frames,
+           AllMessages::ids.size(),
+           AllMessages::apply<
+               can::message_id_table::MessageIdTable>::table_size());
+    printf("%-28s %10s %10s %10s %10s %10s\n", "ns per frame", "ref p50",
+           "p50", "ref p99", "p99", "speedup");
+    report("receive, 8 byte frames", time_message_buffer_receive(ids, 8),
+           time_frame_pool_receive(ids, 8));
+    report("receive, 64 byte frames", time_message_buffer_receive(ids, 64),
+           time_frame_pool_receive(ids, 64));
+    report("parse, all messages",
+           time_parse<reference::LinearParser, AllMessages>(ids),
+           time_parse<can::parse::Parser, AllMessages>(ids));
+    report("parse, motor node",
+           time_parse<reference::LinearParser, MotorNodeMessages>(ids),
+           time_parse<can::parse::Parser, MotorNodeMessages>(ids));
+    report("parse, motion controller",
+           time_parse<reference::LinearParser, MotionMessages>(ids),
+           time_parse<can::parse::Parser, MotionMessages>(ids));
+    report("parse, move group",
+           time_parse<reference::LinearParser, MoveGroupMessages>(ids),
+           time_parse<can::parse::Parser, MoveGroupMessages>(ids));
+    report("filter, all messages",
+           time_lookup<reference::SortedIdCollection, AllMessages>(ids),
+           time_lookup<TableCollection, AllMessages>(ids));
+    report("filter, motor node",
+           time_lookup<reference::SortedIdCollection, MotorNodeMessages>(ids),
+           time_lookup<TableCollection, MotorNodeMessages>(ids));
+    report("filter, move group",
+           time_lookup<reference::SortedIdCollection, MoveGroupMessages>(ids),
+           time_lookup<TableCollection, MoveGroupMessages>(ids));
+    report("dispatch, motor node",
+           time_dispatch<MotorNode, can::dispatch::Dispatcher>(ids),
+           time_dispatch<MotorNode, can::dispatch::ParsingDispatcher>(ids));
+    report("dispatch, gear motor node",
+           time_dispatch<GearMotorNode, can::dispatch::Dispatcher>(ids),
+           time_dispatch<GearMotorNode, can::dispatch::ParsingDispatcher>(
+               ids));
+    return 0;
+}
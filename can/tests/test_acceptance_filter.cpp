@@ -0,0 +1,157 @@
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "can/core/acceptance_filter.hpp"
+#include "can/core/arbitration_id.hpp"
+#include "can/core/dispatch.hpp"
+#include "can/core/messages.hpp"
+#include "can/simlib/filter.hpp"
+#include "catch2/catch.hpp"
+
+using namespace can::acceptance_filter;
+using namespace can::messages;
+
+namespace {
+
+using Messages = can::dispatch::MessageList<
+    StopRequest, MotorStatusRequest, EnableMotorRequest, DisableMotorRequest,
+    AddLinearMoveRequest, ExecuteMoveGroupRequest, ClearAllMoveGroupsRequest,
+    DeviceInfoRequest, HeartbeatRequest, ReadFromEEPromRequest>;
+
+auto arbitration_id(MessageId message_id, NodeId node_id) -> uint32_t {
+    auto arb = can::arbitration_id::ArbitrationId();
+    arb.message_id(message_id);
+    arb.node_id(node_id);
+    arb.originating_node_id(NodeId::host);
+    arb.function_code(FunctionCode::network_management);
+    return arb.get_id();
+}
+
+auto sim_filters(const FilterTable& table)
+    -> std::vector<can::sim::filter::Filter> {
+    auto filters = std::vector<can::sim::filter::Filter>{};
+    for (const auto& filter : table) {
+        filters.emplace_back(filter.type, filter.config, filter.val1,
+                             filter.val2);
+    }
+    return filters;
+}
+
+template <typename... T>
+auto ids_of(can::dispatch::MessageList<T...>) -> std::vector<MessageId> {
+    return {T::id...};
+}
+
+}  // namespace
+
+SCENARIO("covering field values with blocks") {
+    GIVEN("values that make up whole blocks") {
+        auto values = std::array<uint32_t, 6>{4, 5, 6, 7, 8, 9};
+        WHEN("they are covered") {
+            auto result = cover(values, values.size(), 8);
+            THEN("each block is merged into one filter") {
+                REQUIRE(result.count == 2);
+                REQUIRE(result.blocks[0].value == 4);
+                REQUIRE(result.blocks[0].size == 4);
+                REQUIRE(result.blocks[1].value == 8);
+                REQUIRE(result.blocks[1].size == 2);
+            }
+        }
+    }
+
+    GIVEN("more values than the budget allows") {
+        auto values = std::array<uint32_t, 4>{0x10, 0x12, 0x200, 0x3ff};
+        WHEN("they are covered with two blocks") {
+            auto result = cover(values, values.size(), 2);
+            THEN("the merges that let in the least are made") {
+                REQUIRE(result.count == 2);
+                REQUIRE(result.blocks[0].value == 0x10);
+                REQUIRE(result.blocks[0].size == 4);
+                REQUIRE(result.blocks[1].value == 0x200);
+                REQUIRE(result.blocks[1].size == 0x200);
+            }
+        }
+        WHEN("they are covered with one block") {
+            auto result = cover(values, values.size(), 1);
+            THEN("the block holds every value") {
+                REQUIRE(result.count == 1);
+                REQUIRE(result.blocks[0].value == 0);
+                REQUIRE(result.blocks[0].size == 0x400);
+            }
+        }
+    }
+}
+
+SCENARIO("receive filters compiled from a message list") {
+    static constexpr auto table =
+        compile<Messages>(std::array{NodeId::head, NodeId::head_l,
+                                     NodeId::head_r});
+    auto filters = sim_filters(table);
+
+    THEN("the table fits in the FDCAN and ends by rejecting the rest") {
+        STATIC_REQUIRE(table.count <= max_filters);
+        REQUIRE(table.filters[table.count - 1].config ==
+                CanFilterConfig::reject);
+    }
+
+    THEN("broadcast frames go to fifo 0 and addressed frames to fifo 1") {
+        REQUIRE(table.filters[0].config == CanFilterConfig::to_fifo0);
+        REQUIRE(table.filters[table.count - 2].config ==
+                CanFilterConfig::to_fifo1);
+    }
+
+    GIVEN("every message in the list") {
+        auto ids = ids_of(Messages{});
+        ids.push_back(MessageId::multi_message_frame);
+        THEN("each is accepted for broadcast and for each node") {
+            for (auto id : ids) {
+                for (auto node : {NodeId::broadcast, NodeId::head,
+                                  NodeId::head_l, NodeId::head_r}) {
+                    INFO("message " << static_cast<uint32_t>(id) << " node "
+                                    << static_cast<uint32_t>(node));
+                    REQUIRE(can::sim::filter::accepts(
+                        filters, arbitration_id(id, node)));
+                }
+            }
+        }
+        THEN("each is rejected for other nodes") {
+            for (auto id : ids) {
+                for (auto node : {NodeId::gantry_x, NodeId::pipette_left,
+                                  NodeId::gripper, NodeId::host}) {
+                    REQUIRE(!can::sim::filter::accepts(
+                        filters, arbitration_id(id, node)));
+                }
+            }
+        }
+    }
+
+    GIVEN("a broadcast message the list does not take") {
+        auto id = arbitration_id(MessageId::read_sensor_request,
+                                 NodeId::broadcast);
+        THEN("it is rejected") {
+            REQUIRE(!can::sim::filter::accepts(filters, id));
+        }
+    }
+}
+
+SCENARIO("simulated filters apply in order") {
+    auto filters = std::vector<can::sim::filter::Filter>{};
+
+    GIVEN("no filters") {
+        THEN("every message is accepted") {
+            REQUIRE(can::sim::filter::accepts(filters, 1234));
+        }
+    }
+
+    GIVEN("a reject filter ahead of an accept filter") {
+        filters.emplace_back(CanFilterType::exact, CanFilterConfig::reject, 1,
+                             2);
+        filters.emplace_back(CanFilterType::mask, CanFilterConfig::to_fifo0, 0,
+                             0);
+        THEN("the first filter that matches decides") {
+            REQUIRE(!can::sim::filter::accepts(filters, 1));
+            REQUIRE(can::sim::filter::accepts(filters, 3));
+        }
+    }
+}
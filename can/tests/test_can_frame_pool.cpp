@@ -0,0 +1,187 @@
+#include <array>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "can/core/can_frame_pool.hpp"
+#include "catch2/catch.hpp"
+
+using namespace can::frame_pool;
+
+namespace {
+
+struct RecordingListener {
+    void handle(uint32_t arbitration_id, uint8_t* start, uint8_t* limit) {
+        arbitration_ids.push_back(arbitration_id);
+        payloads.emplace_back(start, limit);
+    }
+
+    std::vector<uint32_t> arbitration_ids{};
+    std::vector<std::vector<uint8_t>> payloads{};
+};
+
+/**
+ * Checks that every frame carries the payload written for its arbitration
+ * id, and that the frames arrive in order.
+ */
+struct CheckingListener {
+    void handle(uint32_t arbitration_id, uint8_t* start, uint8_t* limit) {
+        if (arbitration_id != expected || limit - start != 64) {
+            ++mismatched;
+        }
+        for (; start != limit; ++start) {
+            if (*start != static_cast<uint8_t>(arbitration_id)) {
+                ++mismatched;
+                break;
+            }
+        }
+        ++expected;
+    }
+
+    uint32_t expected = 0;
+    uint32_t mismatched = 0;
+};
+
+auto fd_frame(uint32_t arbitration_id) -> std::array<uint8_t, 64> {
+    auto frame = std::array<uint8_t, 64>{};
+    frame.fill(static_cast<uint8_t>(arbitration_id));
+    return frame;
+}
+
+}  // namespace
+
+SCENARIO("can frame pool hands frames to the listener") {
+    auto subject = CanFramePool<4>{};
+    auto listener = RecordingListener{};
+
+    GIVEN("an empty pool") {
+        THEN("there is nothing to dispatch") {
+            REQUIRE(!subject.has_frame());
+            REQUIRE(!subject.dispatch_one(listener));
+            REQUIRE(listener.arbitration_ids.empty());
+        }
+    }
+
+    GIVEN("frames written to the pool") {
+        auto first = std::array<uint8_t, 3>{1, 2, 3};
+        REQUIRE(subject.write(0x1234, first.begin(), first.end()));
+        REQUIRE(subject.write(0x5678, first.begin(), first.begin()));
+        WHEN("they are dispatched") {
+            auto count = subject.dispatch_all(listener);
+            THEN("the listener gets each frame in order") {
+                REQUIRE(count == 2);
+                REQUIRE(listener.arbitration_ids ==
+                        std::vector<uint32_t>{0x1234, 0x5678});
+                REQUIRE(listener.payloads[0] ==
+                        std::vector<uint8_t>{1, 2, 3});
+                REQUIRE(listener.payloads[1].empty());
+                REQUIRE(!subject.has_frame());
+            }
+        }
+    }
+
+    GIVEN("a payload longer than a CAN FD frame") {
+        auto payload = std::array<uint8_t, 70>{};
+        payload.fill(7);
+        REQUIRE(subject.write(1, payload.begin(), payload.end()));
+        WHEN("it is dispatched") {
+            subject.dispatch_one(listener);
+            THEN("it is cut to the largest frame") {
+                REQUIRE(listener.payloads[0].size() == 64);
+            }
+        }
+    }
+
+    GIVEN("a full pool") {
+        auto payload = std::array<uint8_t, 8>{};
+        for (uint32_t i = 0; i < 4; ++i) {
+            REQUIRE(subject.write(i, payload.begin(), payload.end()));
+        }
+        WHEN("another frame arrives") {
+            auto written = subject.write(4, payload.begin(), payload.end());
+            THEN("it is dropped and counted") {
+                REQUIRE(!written);
+                REQUIRE(subject.get_dropped_count() == 1);
+            }
+            THEN("the drop is taken as new once") {
+                REQUIRE(subject.take_new_drops() == 1);
+                REQUIRE(subject.take_new_drops() == 0);
+                static_cast<void>(
+                    subject.write(5, payload.begin(), payload.end()));
+                REQUIRE(subject.take_new_drops() == 1);
+                REQUIRE(subject.get_dropped_count() == 2);
+            }
+            AND_WHEN("the pool is drained") {
+                subject.dispatch_all(listener);
+                THEN("every slot can be used again") {
+                    for (uint32_t i = 5; i < 9; ++i) {
+                        REQUIRE(
+                            subject.write(i, payload.begin(), payload.end()));
+                    }
+                    REQUIRE(subject.dispatch_all(listener) == 4);
+                    REQUIRE(listener.arbitration_ids.back() == 8);
+                    REQUIRE(subject.get_dropped_count() == 1);
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("can frame pool under back to back CAN FD frames") {
+    static constexpr uint32_t frames = 200000;
+    auto subject = CanFramePool<16>{};
+    auto listener = CheckingListener{};
+
+    GIVEN("a task that runs once every pool's worth of frames") {
+        WHEN("the bus is saturated with 64 byte frames") {
+            for (uint32_t i = 0; i < frames; ++i) {
+                auto frame = fd_frame(i);
+                static_cast<void>(subject.write(i, frame.begin(), frame.end()));
+                if ((i + 1) % 16 == 0) {
+                    subject.dispatch_all(listener);
+                }
+            }
+            subject.dispatch_all(listener);
+            THEN("no frame is dropped or damaged") {
+                REQUIRE(subject.get_dropped_count() == 0);
+                REQUIRE(listener.expected == frames);
+                REQUIRE(listener.mismatched == 0);
+            }
+        }
+    }
+
+    GIVEN("a writer and a reader running at the same time") {
+        WHEN("the writer sends frames as fast as slots free up") {
+            auto writer = std::thread([&subject]() {
+                for (uint32_t i = 0; i < frames; ++i) {
+                    auto frame = fd_frame(i);
+                    while (!subject.write(i, frame.begin(), frame.end())) {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+            while (listener.expected < frames) {
+                if (subject.dispatch_all(listener) == 0) {
+                    std::this_thread::yield();
+                }
+            }
+            writer.join();
+            THEN("every frame arrives intact and in order") {
+                REQUIRE(listener.expected == frames);
+                REQUIRE(listener.mismatched == 0);
+                REQUIRE(!subject.has_frame());
+            }
+        }
+    }
+}
+
+SCENARIO("can frame pool sizing") {
+    GIVEN("a burst of move group frames") {
+        THEN("the pool holds the burst and the requests around it") {
+            STATIC_REQUIRE(pool_size_for_burst(0) == burst_headroom);
+            STATIC_REQUIRE(pool_size_for_burst(12) == 32);
+            STATIC_REQUIRE(pool_size_for_burst(24) == 32);
+            STATIC_REQUIRE(pool_size_for_burst(25) == 64);
+        }
+    }
+}
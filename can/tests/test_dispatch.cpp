@@ -1,3 +1,6 @@
+#include <variant>
+#include <vector>
+
 #include "can/core/arbitration_id.hpp"
 #include "can/core/dispatch.hpp"
 #include "can/core/ids.hpp"
@@ -225,3 +228,135 @@ SCENARIO("DispatchParseTarget") {
         }
     }
 }
+
+template <typename... T>
+struct RecordingHandler {
+    using MessageTypes = std::variant<std::monostate, T...>;
+
+    RecordingHandler() = default;
+    RecordingHandler(const RecordingHandler&) = delete;
+    RecordingHandler(const RecordingHandler&&) = delete;
+    auto operator=(const RecordingHandler&) -> RecordingHandler& = delete;
+    auto operator=(const RecordingHandler&&) -> RecordingHandler&& = delete;
+    ~RecordingHandler() = default;
+
+    void handle(MessageTypes& m) { messages.push_back(m); }
+    std::vector<MessageTypes> messages{};
+};
+
+SCENARIO("ParsingDispatcher") {
+    using HandlerA = RecordingHandler<HeartbeatRequest, DeviceInfoRequest>;
+    using HandlerB = RecordingHandler<DeviceInfoRequest, StopRequest>;
+    using TargetA =
+        DispatchParseTarget<HandlerA, HeartbeatRequest, DeviceInfoRequest>;
+    using TargetB =
+        DispatchParseTarget<HandlerB, DeviceInfoRequest, StopRequest>;
+    auto body = std::array<uint8_t, 4>{0x1, 0x2, 0x3, 0x4};
+
+    auto handler_a = HandlerA{};
+    auto handler_b = HandlerB{};
+    auto target_a = TargetA{handler_a};
+    auto target_b = TargetB{handler_b};
+
+    auto arbitration_id = [](MessageId message_id, NodeId node_id) {
+        auto arb = ArbitrationId();
+        arb.message_id(message_id);
+        arb.node_id(node_id);
+        return arb.get_id();
+    };
+
+    GIVEN("a dispatcher with two parse targets") {
+        auto subject = ParsingDispatcher(
+            [](uint32_t) -> bool { return true; }, target_a, target_b);
+        static_assert(decltype(subject)::accepts<HeartbeatRequest>);
+        static_assert(decltype(subject)::accepts<StopRequest>);
+        static_assert(!decltype(subject)::accepts<HeartbeatResponse>);
+
+        WHEN("a message only one target takes arrives") {
+            subject.handle(
+                arbitration_id(MessageId::stop_request, NodeId::broadcast),
+                body.begin(), body.end());
+            THEN("only that target is handed it") {
+                REQUIRE(handler_a.messages.empty());
+                REQUIRE(handler_b.messages.size() == 1);
+                REQUIRE(std::holds_alternative<StopRequest>(
+                    handler_b.messages[0]));
+                REQUIRE(std::get<StopRequest>(handler_b.messages[0])
+                            .message_index == 0x01020304);
+            }
+        }
+        WHEN("a message both targets take arrives") {
+            subject.handle(arbitration_id(MessageId::device_info_request,
+                                          NodeId::broadcast),
+                           body.begin(), body.end());
+            THEN("both targets are handed it") {
+                REQUIRE(handler_a.messages.size() == 1);
+                REQUIRE(std::holds_alternative<DeviceInfoRequest>(
+                    handler_a.messages[0]));
+                REQUIRE(handler_b.messages.size() == 1);
+                REQUIRE(std::get<DeviceInfoRequest>(handler_b.messages[0])
+                            .message_index == 0x01020304);
+            }
+        }
+        WHEN("a message neither target takes arrives") {
+            subject.handle(arbitration_id(MessageId::heartbeat_response,
+                                          NodeId::broadcast),
+                           body.begin(), body.end());
+            THEN("no target is called") {
+                REQUIRE(handler_a.messages.empty());
+                REQUIRE(handler_b.messages.empty());
+            }
+        }
+    }
+
+    GIVEN("a dispatcher whose arbitration id test fails") {
+        auto subject = ParsingDispatcher(
+            StandardArbIdTest{.node_id = NodeId::gantry_x}, target_a,
+            target_b);
+        WHEN("a message for another node arrives") {
+            subject.handle(
+                arbitration_id(MessageId::device_info_request, NodeId::head),
+                body.begin(), body.end());
+            THEN("no target is called") {
+                REQUIRE(handler_a.messages.empty());
+                REQUIRE(handler_b.messages.empty());
+            }
+        }
+    }
+
+    GIVEN("nested dispatchers for two nodes") {
+        auto left = ParsingDispatcher(
+            StandardArbIdTest{.node_id = NodeId::head_l}, target_a);
+        auto right = ParsingDispatcher(
+            StandardArbIdTest{.node_id = NodeId::head_r}, target_b);
+        auto subject = ParsingDispatcher(
+            [](uint32_t) -> bool { return true; }, left, right);
+        WHEN("a message for one node arrives") {
+            subject.handle(arbitration_id(MessageId::device_info_request,
+                                          NodeId::head_l),
+                           body.begin(), body.end());
+            THEN("only that node's targets are handed it") {
+                REQUIRE(handler_a.messages.size() == 1);
+                REQUIRE(handler_b.messages.empty());
+            }
+        }
+        WHEN("a broadcast message arrives") {
+            subject.handle(arbitration_id(MessageId::device_info_request,
+                                          NodeId::broadcast),
+                           body.begin(), body.end());
+            THEN("both nodes' targets are handed it") {
+                REQUIRE(handler_a.messages.size() == 1);
+                REQUIRE(handler_b.messages.size() == 1);
+            }
+        }
+        WHEN("a message only the other node takes arrives for one node") {
+            subject.handle(
+                arbitration_id(MessageId::stop_request, NodeId::head_l),
+                body.begin(), body.end());
+            THEN("no target is called") {
+                REQUIRE(handler_a.messages.empty());
+                REQUIRE(handler_b.messages.empty());
+            }
+        }
+    }
+}
@@ -31,6 +31,26 @@ SCENARIO("message deserializing works") {
         }
     }
 
+    GIVEN("an add jerk move request body") {
+        auto arr = std::array<uint8_t, 23>{
+            0xde, 0xad, 0xbe, 0xef, 1,    2,    0,    0,
+            0x10, 0,    0,    0,    0,    0x20, 0,    0,
+            0,    0x30, 0xff, 0xff, 0xff, 0xfe, 1};
+        WHEN("constructed") {
+            auto r = AddJerkMoveRequest::parse(arr.begin(), arr.end());
+            THEN("it is converted to a the correct structure") {
+                REQUIRE(r.message_index == 0xdeadbeef);
+                REQUIRE(r.group_id == 1);
+                REQUIRE(r.seq_id == 2);
+                REQUIRE(r.duration == 0x1000);
+                REQUIRE(r.acceleration == 0x20);
+                REQUIRE(r.velocity == 0x30);
+                REQUIRE(r.jerk == -2);
+                REQUIRE(r.request_stop_condition == 1);
+            }
+        }
+    }
+
     GIVEN("a read motor driver register message") {
         auto arr = std::array<uint8_t, 5>{0xde, 0xad, 0xbe, 0xef, 0x12};
         WHEN("constructed") {
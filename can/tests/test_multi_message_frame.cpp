@@ -0,0 +1,247 @@
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <variant>
+#include <vector>
+
+#include "can/core/arbitration_id.hpp"
+#include "can/core/dispatch.hpp"
+#include "can/core/messages.hpp"
+#include "can/core/multi_message_frame.hpp"
+#include "can/core/transmit_scheduler.hpp"
+#include "catch2/catch.hpp"
+
+using namespace can::arbitration_id;
+using namespace can::dispatch;
+using namespace can::messages;
+using namespace can::multi_message_frame;
+using namespace can::transmit_scheduler;
+
+namespace {
+
+auto arbitration_id(MessageId message_id, NodeId node_id) -> uint32_t {
+    auto arb = ArbitrationId();
+    arb.message_id(message_id);
+    arb.node_id(node_id);
+    arb.originating_node_id(NodeId::gantry_x);
+    return arb.get_id();
+}
+
+auto frame_of(uint32_t arbitration_id, std::vector<uint8_t> payload)
+    -> can::frame_pool::CanFrame {
+    auto frame = can::frame_pool::CanFrame{};
+    frame.arbitration_id = arbitration_id;
+    frame.length = static_cast<uint8_t>(payload.size());
+    std::copy(payload.begin(), payload.end(), frame.data.begin());
+    return frame;
+}
+
+struct Entry {
+    uint32_t arbitration_id;
+    std::vector<uint8_t> payload;
+};
+
+auto unpack(const can::frame_pool::CanFrame& frame) -> std::vector<Entry> {
+    auto entries = std::vector<Entry>{};
+    for_each_entry(frame.arbitration_id, frame.data.cbegin(),
+                   frame.data.cbegin() + frame.length,
+                   [&entries](uint32_t id, auto start, auto end) {
+                       entries.push_back(Entry{id, {start, end}});
+                   });
+    return entries;
+}
+
+template <typename... T>
+struct RecordingHandler {
+    using MessageTypes = std::variant<std::monostate, T...>;
+
+    RecordingHandler() = default;
+    RecordingHandler(const RecordingHandler&) = delete;
+    RecordingHandler(const RecordingHandler&&) = delete;
+    auto operator=(const RecordingHandler&) -> RecordingHandler& = delete;
+    auto operator=(const RecordingHandler&&) -> RecordingHandler&& = delete;
+    ~RecordingHandler() = default;
+
+    void handle(MessageTypes& m) { messages.push_back(m); }
+    std::vector<MessageTypes> messages{};
+};
+
+auto ack(uint32_t index) -> MoveCompleted {
+    return MoveCompleted{.message_index = index};
+}
+
+}  // namespace
+
+SCENARIO("multi message frames") {
+    auto stop = arbitration_id(MessageId::stop_request, NodeId::head);
+    auto info = arbitration_id(MessageId::device_info_request, NodeId::head);
+
+    GIVEN("two frames for the same node packed together") {
+        auto packer = Packer{frame_of(stop, {1, 2, 3, 4})};
+        REQUIRE(packer.add(frame_of(info, {5, 6})));
+        auto& frame = packer.get();
+        THEN("the frame is a multi message frame for that node") {
+            REQUIRE(packer.count() == 2);
+            REQUIRE(is_multi_message_frame(frame.arbitration_id));
+            REQUIRE(same_route(frame.arbitration_id, stop));
+            REQUIRE(frame.length == 1 + 3 + 4 + 3 + 2);
+        }
+        THEN("unpacking it gives back each frame") {
+            auto entries = unpack(frame);
+            REQUIRE(entries.size() == 2);
+            REQUIRE(entries[0].arbitration_id == stop);
+            REQUIRE(entries[0].payload == std::vector<uint8_t>{1, 2, 3, 4});
+            REQUIRE(entries[1].arbitration_id == info);
+            REQUIRE(entries[1].payload == std::vector<uint8_t>{5, 6});
+        }
+        THEN("padding after the last entry is ignored") {
+            auto padded = frame;
+            padded.length = 16;
+            REQUIRE(unpack(padded).size() == 2);
+        }
+        THEN("an entry cut off by the end of the frame is dropped") {
+            auto cut = frame;
+            cut.length--;
+            REQUIRE(unpack(cut).size() == 1);
+        }
+    }
+
+    GIVEN("a frame for another node") {
+        auto packer = Packer{frame_of(stop, {1})};
+        auto other =
+            arbitration_id(MessageId::device_info_request, NodeId::gripper);
+        THEN("it is not packed") {
+            REQUIRE(!packer.add(frame_of(other, {1})));
+            REQUIRE(packer.count() == 1);
+        }
+    }
+
+    GIVEN("frames that do not all fit") {
+        auto payload = std::vector<uint8_t>(28, 0);
+        auto packer = Packer{frame_of(stop, payload)};
+        THEN("packing stops at the largest frame") {
+            REQUIRE(packer.add(frame_of(info, payload)));
+            REQUIRE(!packer.add(frame_of(info, {1})));
+            REQUIRE(packer.get().length == 63);
+        }
+    }
+}
+
+SCENARIO("ParsingDispatcher unpacks multi message frames") {
+    using Handler = RecordingHandler<StopRequest, DeviceInfoRequest>;
+    using Target = DispatchParseTarget<Handler, StopRequest, DeviceInfoRequest>;
+    auto handler = Handler{};
+    auto target = Target{handler};
+    auto subject = ParsingDispatcher(
+        StandardArbIdTest{.node_id = NodeId::head}, target);
+
+    GIVEN("a multi message frame for this node") {
+        auto packer = Packer{frame_of(
+            arbitration_id(MessageId::stop_request, NodeId::head),
+            {0, 0, 0, 1})};
+        packer.add(frame_of(
+            arbitration_id(MessageId::device_info_request, NodeId::head),
+            {0, 0, 0, 2}));
+        auto frame = packer.get();
+        WHEN("it is handled") {
+            subject.handle(frame.arbitration_id, frame.data.begin(),
+                           frame.data.begin() + frame.length);
+            THEN("each message in it is parsed and routed") {
+                REQUIRE(handler.messages.size() == 2);
+                REQUIRE(std::get<StopRequest>(handler.messages[0])
+                            .message_index == 1);
+                REQUIRE(std::get<DeviceInfoRequest>(handler.messages[1])
+                            .message_index == 2);
+            }
+        }
+    }
+
+    GIVEN("a multi message frame for another node") {
+        auto packer = Packer{frame_of(
+            arbitration_id(MessageId::stop_request, NodeId::gripper),
+            {0, 0, 0, 1})};
+        auto frame = packer.get();
+        WHEN("it is handled") {
+            subject.handle(frame.arbitration_id, frame.data.begin(),
+                           frame.data.begin() + frame.length);
+            THEN("nothing is routed") { REQUIRE(handler.messages.empty()); }
+        }
+    }
+}
+
+SCENARIO("transmit scheduler coalescing") {
+    auto subject = TransmitScheduler{};
+    auto to_host = arbitration_id(MessageId::move_completed, NodeId::host);
+    auto frame = can::frame_pool::CanFrame{};
+
+    GIVEN("coalescing is off") {
+        subject.push(to_host, ack(1));
+        subject.push(to_host, ack(2));
+        THEN("each ack is sent in its own frame") {
+            REQUIRE(!subject.next_is_alone());
+            REQUIRE(subject.pop(frame));
+            REQUIRE(frame.arbitration_id == to_host);
+            REQUIRE(subject.depth(TransmitLane::motion_ack) == 1);
+        }
+    }
+
+    GIVEN("coalescing is on") {
+        subject.set_coalescing(true);
+        WHEN("acks for the host are queued together") {
+            for (uint32_t i = 1; i <= 4; ++i) {
+                subject.push(to_host, ack(i));
+            }
+            THEN("as many as fit are sent in one frame") {
+                REQUIRE(subject.pop(frame));
+                REQUIRE(is_multi_message_frame(frame.arbitration_id));
+                auto entries = unpack(frame);
+                REQUIRE(entries.size() == 3);
+                REQUIRE(entries[2].arbitration_id == to_host);
+                REQUIRE(entries[2].payload[3] == 3);
+                REQUIRE(subject.depth(TransmitLane::motion_ack) == 1);
+            }
+            THEN("a frame left on its own is sent as it is") {
+                subject.pop(frame);
+                REQUIRE(subject.next_is_alone());
+                REQUIRE(subject.pop(frame));
+                REQUIRE(frame.arbitration_id == to_host);
+                REQUIRE(frame.data[3] == 4);
+            }
+        }
+        WHEN("acks for different nodes are queued") {
+            subject.push(to_host, ack(1));
+            subject.push(
+                arbitration_id(MessageId::move_completed, NodeId::gantry_y),
+                ack(2));
+            THEN("they are not packed together") {
+                REQUIRE(subject.pop(frame));
+                REQUIRE(frame.arbitration_id == to_host);
+            }
+        }
+        WHEN("small bulk frames for the host are queued together") {
+            auto data_to_host =
+                arbitration_id(MessageId::read_sensor_response, NodeId::host);
+            for (uint32_t i = 1; i <= 3; ++i) {
+                subject.push(data_to_host,
+                             ReadFromSensorResponse{.message_index = i});
+            }
+            THEN("each is sent in its own frame") {
+                REQUIRE(!subject.next_is_alone());
+                REQUIRE(subject.pop(frame));
+                REQUIRE(frame.arbitration_id == data_to_host);
+                REQUIRE(subject.depth(TransmitLane::bulk) == 2);
+            }
+        }
+        WHEN("errors for the host are queued together") {
+            auto error_to_host =
+                arbitration_id(MessageId::error_message, NodeId::host);
+            subject.push(error_to_host, ErrorMessage{.message_index = 1});
+            subject.push(error_to_host, ErrorMessage{.message_index = 2});
+            THEN("each is sent in its own frame") {
+                REQUIRE(subject.pop(frame));
+                REQUIRE(frame.arbitration_id == error_to_host);
+                REQUIRE(subject.depth(TransmitLane::error) == 1);
+            }
+        }
+    }
+}
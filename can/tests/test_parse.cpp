@@ -1,12 +1,14 @@
 #include <array>
 
 #include "can/core/ids.hpp"
+#include "can/core/message_id_table.hpp"
 #include "can/core/messages.hpp"
 #include "can/core/parse.hpp"
 #include "catch2/catch.hpp"
 
 using namespace can::ids;
 using namespace can::messages;
+using namespace can::message_id_table;
 using namespace can::parse;
 
 SCENARIO("can parse works") {
@@ -32,3 +34,103 @@ SCENARIO("can parse works") {
         }
     }
 }
+
+SCENARIO("can parse chooses the message type by id") {
+    auto parser = Parser<HeartbeatRequest, DeviceInfoRequest, StopRequest,
+                         AddLinearMoveRequest, GetMotionConstraintsRequest,
+                         ExecuteMoveGroupRequest>{};
+    GIVEN("a move request id and body") {
+        auto arr = std::array<uint8_t, 22>{
+            // message index
+            0x1, 0x2, 0x3, 0x4,
+            // group id
+            0x5,
+            // seq_id
+            0x6,
+            // duration
+            0x7, 0x8, 0x9, 0xa,
+            // acceleration
+            0xb, 0xc, 0xd, 0xe,
+            // velocity
+            0xf, 0x10, 0x11, 0x12,
+            // stop condition
+            0x13,
+            // padding
+            0, 0, 0};
+        WHEN("parsed") {
+            auto r = parser.parse(MessageId::add_move_request, arr.begin(),
+                                  arr.end());
+            THEN("it is converted to the correct structure") {
+                REQUIRE(std::holds_alternative<AddLinearMoveRequest>(r));
+                auto m = std::get<AddLinearMoveRequest>(r);
+                REQUIRE(m.message_index == 0x01020304);
+                REQUIRE(m.group_id == 5);
+                REQUIRE(m.seq_id == 6);
+            }
+        }
+    }
+    GIVEN("every supported id") {
+        auto arr = std::array<uint8_t, 4>{0, 0, 0, 1};
+        THEN("each is parsed to its own type") {
+            REQUIRE(std::holds_alternative<HeartbeatRequest>(parser.parse(
+                MessageId::heartbeat_request, arr.begin(), arr.end())));
+            REQUIRE(std::holds_alternative<DeviceInfoRequest>(parser.parse(
+                MessageId::device_info_request, arr.begin(), arr.end())));
+            REQUIRE(std::holds_alternative<StopRequest>(
+                parser.parse(MessageId::stop_request, arr.begin(), arr.end())));
+            REQUIRE(std::holds_alternative<GetMotionConstraintsRequest>(
+                parser.parse(MessageId::get_motion_constraints_request,
+                             arr.begin(), arr.end())));
+            REQUIRE(std::holds_alternative<ExecuteMoveGroupRequest>(
+                parser.parse(MessageId::execute_move_group_request,
+                             arr.begin(), arr.end())));
+        }
+    }
+    GIVEN("ids that are not supported") {
+        auto arr = std::array<uint8_t, 4>{};
+        THEN("none of them parse") {
+            for (uint16_t id = 0; id < 0x800; ++id) {
+                auto message_id = static_cast<MessageId>(id);
+                auto r = parser.parse(message_id, arr.begin(), arr.end());
+                if (message_id != MessageId::heartbeat_request &&
+                    message_id != MessageId::device_info_request &&
+                    message_id != MessageId::stop_request &&
+                    message_id != MessageId::add_move_request &&
+                    message_id != MessageId::get_motion_constraints_request &&
+                    message_id != MessageId::execute_move_group_request) {
+                    REQUIRE(std::holds_alternative<std::monostate>(r));
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("message id table") {
+    using Table =
+        MessageIdTable<HeartbeatRequest, HeartbeatResponse, StopRequest,
+                       DeviceInfoRequest, AddLinearMoveRequest>;
+    static_assert(Table::index_of(MessageId::heartbeat_request) == 0);
+    static_assert(Table::index_of(MessageId::add_move_request) == 4);
+    static_assert(Table::index_of(MessageId::heartbeat_response) == 1);
+    static_assert(!Table::contains(MessageId::acknowledgement));
+    GIVEN("a table of five ids") {
+        THEN("it needs no more than four slots per id") {
+            REQUIRE(Table::table_size() <= 32);
+        }
+    }
+    GIVEN("a type that is listed twice") {
+        using Repeated =
+            MessageIdTable<StopRequest, HeartbeatRequest, StopRequest>;
+        THEN("the last position is found") {
+            REQUIRE(Repeated::index_of(MessageId::stop_request) == 2);
+            REQUIRE(Repeated::index_of(MessageId::heartbeat_request) == 1);
+        }
+    }
+    GIVEN("an empty table") {
+        using NoIds = MessageIdTable<>;
+        THEN("nothing is found") {
+            REQUIRE(!NoIds::contains(MessageId::stop_request));
+            REQUIRE(NoIds::index_of(MessageId::stop_request) == NoIds::npos);
+        }
+    }
+}
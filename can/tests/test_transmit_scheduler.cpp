@@ -0,0 +1,312 @@
+#include <cstdint>
+#include <vector>
+
+#include "can/core/can_bus.hpp"
+#include "can/core/can_writer_task.hpp"
+#include "can/core/messages.hpp"
+#include "can/core/transmit_scheduler.hpp"
+#include "catch2/catch.hpp"
+#include "common/tests/mock_message_queue.hpp"
+
+using namespace can::messages;
+using namespace can::transmit_scheduler;
+
+namespace {
+
+class RecordingCanBus : public can::bus::CanBus {
+  public:
+    void set_incoming_message_callback(void*,
+                                       IncomingMessageCallback) final {}
+    void add_filter(CanFilterType, CanFilterConfig, uint32_t,
+                    uint32_t) final {}
+    void send(uint32_t arbitration_id, uint8_t*, CanFDMessageLength) final {
+        sent.push_back(arbitration_id);
+    }
+
+    std::vector<uint32_t> sent{};
+};
+
+auto ack(uint32_t index) -> MoveCompleted {
+    return MoveCompleted{.message_index = index};
+}
+
+auto sensor_data(uint32_t index) -> BatchReadFromSensorResponse {
+    return BatchReadFromSensorResponse{.message_index = index};
+}
+
+auto error(uint32_t index) -> ErrorMessage {
+    return ErrorMessage{.message_index = index,
+                        .severity = can::ids::ErrorSeverity::warning,
+                        .error_code = can::ids::ErrorCode::hardware};
+}
+
+auto pop_all(TransmitScheduler& subject) -> std::vector<uint32_t> {
+    auto ids = std::vector<uint32_t>{};
+    auto frame = can::frame_pool::CanFrame{};
+    while (subject.pop(frame)) {
+        ids.push_back(frame.arbitration_id);
+    }
+    return ids;
+}
+
+}  // namespace
+
+SCENARIO("message classes map to transmit lanes") {
+    STATIC_REQUIRE(lane_of<ErrorMessage>() == TransmitLane::error);
+    STATIC_REQUIRE(lane_of<StopRequest>() == TransmitLane::error);
+    STATIC_REQUIRE(lane_of<MoveCompleted>() == TransmitLane::motion_ack);
+    STATIC_REQUIRE(lane_of<MoveStreamCreditResponse>() ==
+                   TransmitLane::motion_ack);
+    STATIC_REQUIRE(lane_of<DeviceInfoResponse>() == TransmitLane::response);
+    STATIC_REQUIRE(lane_of<BatchReadFromSensorResponse>() ==
+                   TransmitLane::bulk);
+    STATIC_REQUIRE(lane_of<TaskInfoResponse>() == TransmitLane::bulk);
+}
+
+SCENARIO("transmit scheduler orders frames by lane") {
+    auto subject = TransmitScheduler{};
+
+    GIVEN("bulk data queued ahead of an ack and an error") {
+        subject.push(1, sensor_data(1));
+        subject.push(2, sensor_data(2));
+        subject.push(3, ack(3));
+        subject.push(4, error(4));
+        THEN("the error goes first, then the ack, then the bulk data") {
+            REQUIRE(pop_all(subject) == std::vector<uint32_t>{4, 3, 1, 2});
+        }
+    }
+
+    GIVEN("frames pushed into a lane") {
+        subject.push(1, ack(1));
+        subject.push(2, ack(2));
+        subject.push(3, ack(3));
+        THEN("the depth counters follow the lane") {
+            REQUIRE(subject.depth(TransmitLane::motion_ack) == 3);
+            auto frame = can::frame_pool::CanFrame{};
+            subject.pop(frame);
+            REQUIRE(frame.arbitration_id == 1);
+            REQUIRE(subject.depth(TransmitLane::motion_ack) == 2);
+            REQUIRE(subject.max_depth(TransmitLane::motion_ack) == 3);
+            REQUIRE(subject.depth(TransmitLane::bulk) == 0);
+        }
+        THEN("the frames are serialized") {
+            auto frame = can::frame_pool::CanFrame{};
+            subject.pop(frame);
+            REQUIRE(frame.length == 16);
+            REQUIRE(frame.data[3] == 1);
+        }
+    }
+
+    GIVEN("a full lane") {
+        auto depth = TransmitScheduler::lane_depths[static_cast<std::size_t>(
+            TransmitLane::error)];
+        for (std::size_t i = 0; i < depth; ++i) {
+            REQUIRE(subject.push(i, error(i)));
+        }
+        THEN("no more frames fit in it") {
+            REQUIRE(subject.is_full(TransmitLane::error));
+            REQUIRE(!subject.push(99, error(99)));
+            REQUIRE(subject.push(100, ack(100)));
+        }
+        THEN("sending a frame makes room in it") {
+            auto frame = can::frame_pool::CanFrame{};
+            REQUIRE(subject.pop(frame));
+            REQUIRE(frame.arbitration_id == 0);
+            REQUIRE(subject.push(99, error(99)));
+        }
+    }
+
+    GIVEN("a burst of bulk frames") {
+        for (uint32_t i = 0; i < TransmitScheduler::bulk_burst; ++i) {
+            subject.push(i, sensor_data(i));
+        }
+        WHEN("the burst has been sent") {
+            auto sent = pop_all(subject);
+            subject.push(TransmitScheduler::bulk_burst,
+                         sensor_data(TransmitScheduler::bulk_burst));
+            THEN("the next bulk frame is held back") {
+                REQUIRE(sent.size() == TransmitScheduler::bulk_burst);
+                REQUIRE(subject.bulk_paused());
+                REQUIRE(!subject.has_ready());
+            }
+            AND_WHEN("it is resumed") {
+                subject.resume_bulk();
+                THEN("the rest is sent") {
+                    REQUIRE(pop_all(subject).size() == 1);
+                }
+            }
+            AND_WHEN("another lane sends") {
+                subject.push(50, ack(50));
+                THEN("the bulk lane may send again after it") {
+                    REQUIRE(pop_all(subject) ==
+                            std::vector<uint32_t>{50, TransmitScheduler::
+                                                          bulk_burst});
+                }
+            }
+        }
+    }
+
+    GIVEN("a transmit lane status response") {
+        subject.push(1, ack(1));
+        subject.push(2, sensor_data(2));
+        subject.push(3, TransmitLaneStatusResponse{.message_index = 7});
+        WHEN("it is sent") {
+            auto frame = can::frame_pool::CanFrame{};
+            subject.pop(frame);
+            subject.pop(frame);
+            THEN("it carries the lane counts from when it was queued") {
+                REQUIRE(frame.arbitration_id == 3);
+                REQUIRE(frame.length == 12);
+                REQUIRE(frame.data[3] == 7);
+                // depth: error, motion ack, response, bulk
+                REQUIRE(frame.data[4] == 0);
+                REQUIRE(frame.data[5] == 1);
+                REQUIRE(frame.data[6] == 0);
+                REQUIRE(frame.data[7] == 1);
+                // max depth
+                REQUIRE(frame.data[9] == 1);
+                REQUIRE(frame.data[11] == 1);
+            }
+        }
+    }
+}
+
+SCENARIO("message writer task sends by priority") {
+    using WriterTask = can::message_writer_task::MessageWriterTask<
+        test_mocks::MockMessageQueue>;
+    auto queue = WriterTask::QueueType{};
+    auto can_bus = RecordingCanBus{};
+    auto subject = WriterTask{queue};
+
+    GIVEN("bulk data queued ahead of a move ack") {
+        for (uint32_t i = 1; i <= 3; ++i) {
+            queue.try_write(can::message_writer_task::TaskMessage{
+                .arbitration_id = i, .message = sensor_data(i)});
+        }
+        queue.try_write(can::message_writer_task::TaskMessage{
+            .arbitration_id = 10, .message = ack(10)});
+        WHEN("the task runs") {
+            subject.run_once(&can_bus);
+            THEN("the ack is sent first") {
+                REQUIRE(can_bus.sent == std::vector<uint32_t>{10});
+                REQUIRE(!queue.has_message());
+                REQUIRE(subject.get_scheduler().depth(TransmitLane::bulk) ==
+                        3);
+            }
+            AND_WHEN("it keeps running") {
+                for (int i = 0; i < 3; ++i) {
+                    subject.run_once(&can_bus);
+                }
+                THEN("the bulk data follows in order") {
+                    REQUIRE(can_bus.sent ==
+                            std::vector<uint32_t>{10, 1, 2, 3});
+                }
+            }
+        }
+    }
+
+    GIVEN("an ack queued behind more bulk data than the bulk lane holds") {
+        auto depth = TransmitScheduler::lane_depths[static_cast<std::size_t>(
+            TransmitLane::bulk)];
+        auto& credits = subject.get_bulk_credits();
+        uint32_t turned_away = 0;
+        for (uint32_t i = 0; i < depth + 2; ++i) {
+            if (credits.take()) {
+                queue.try_write(can::message_writer_task::TaskMessage{
+                    .arbitration_id = i, .message = sensor_data(i)});
+            } else {
+                turned_away++;
+            }
+        }
+        queue.try_write(can::message_writer_task::TaskMessage{
+            .arbitration_id = 10, .message = ack(10)});
+        THEN("the bulk senders past the lane depth are turned away") {
+            REQUIRE(turned_away == 2);
+        }
+        WHEN("the task runs") {
+            subject.run_once(&can_bus);
+            THEN("the ack goes out before the bulk data") {
+                REQUIRE(can_bus.sent == std::vector<uint32_t>{10});
+                REQUIRE(!queue.has_message());
+                REQUIRE(subject.get_scheduler().depth(TransmitLane::bulk) ==
+                        depth);
+            }
+            AND_WHEN("the bulk data is sent") {
+                for (uint32_t i = 0; i < depth; ++i) {
+                    subject.run_once(&can_bus);
+                }
+                THEN("the credits are given back") {
+                    REQUIRE(can_bus.sent.size() == depth + 1);
+                    REQUIRE(credits.get_available() == depth);
+                }
+            }
+        }
+    }
+
+    GIVEN("more bulk data than fits in the bulk lane, queued without credits") {
+        auto depth = TransmitScheduler::lane_depths[static_cast<std::size_t>(
+            TransmitLane::bulk)];
+        for (uint32_t i = 0; i < depth + 2; ++i) {
+            queue.try_write(can::message_writer_task::TaskMessage{
+                .arbitration_id = i, .message = sensor_data(i)});
+        }
+        queue.try_write(can::message_writer_task::TaskMessage{
+            .arbitration_id = 10, .message = ack(10)});
+        WHEN("the task runs") {
+            subject.run_once(&can_bus);
+            THEN("frames are sent to make room and the queue is drained") {
+                REQUIRE(can_bus.sent == std::vector<uint32_t>{0, 1, 10});
+                REQUIRE(!queue.has_message());
+                REQUIRE(subject.get_scheduler().depth(TransmitLane::bulk) ==
+                        depth);
+            }
+        }
+    }
+
+    GIVEN("a full bulk lane with an error queued behind it") {
+        auto depth = TransmitScheduler::lane_depths[static_cast<std::size_t>(
+            TransmitLane::bulk)];
+        for (uint32_t i = 0; i < depth; ++i) {
+            queue.try_write(can::message_writer_task::TaskMessage{
+                .arbitration_id = i, .message = sensor_data(i)});
+        }
+        queue.try_write(can::message_writer_task::TaskMessage{
+            .arbitration_id = 50, .message = error(50)});
+        queue.try_write(can::message_writer_task::TaskMessage{
+            .arbitration_id = 60, .message = sensor_data(60)});
+        WHEN("the task runs") {
+            subject.run_once(&can_bus);
+            THEN("the error goes out before any bulk data") {
+                REQUIRE(can_bus.sent == std::vector<uint32_t>{50, 0, 1});
+                REQUIRE(subject.get_scheduler().depth(TransmitLane::bulk) ==
+                        depth - 1);
+                REQUIRE(!queue.has_message());
+            }
+        }
+    }
+
+    GIVEN("a burst of bulk data that has been sent") {
+        for (uint32_t i = 0; i < TransmitScheduler::bulk_burst; ++i) {
+            queue.try_write(can::message_writer_task::TaskMessage{
+                .arbitration_id = i, .message = sensor_data(i)});
+        }
+        for (uint32_t i = 0; i < TransmitScheduler::bulk_burst; ++i) {
+            subject.run_once(&can_bus);
+        }
+        REQUIRE(subject.get_scheduler().bulk_paused());
+        WHEN("more bulk data arrives during the hold off") {
+            queue.try_write(can::message_writer_task::TaskMessage{
+                .arbitration_id = 99, .message = sensor_data(99)});
+            subject.run_once(&can_bus);
+            THEN("it is held back") {
+                REQUIRE(can_bus.sent.size() == TransmitScheduler::bulk_burst);
+            }
+            AND_WHEN("the hold off passes with nothing else to send") {
+                subject.run_once(&can_bus);
+                THEN("it is sent") {
+                    REQUIRE(can_bus.sent.back() == 99);
+                }
+            }
+        }
+    }
+}
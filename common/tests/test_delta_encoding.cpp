@@ -0,0 +1,125 @@
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "catch2/catch.hpp"
+#include "common/core/delta_encoding.hpp"
+
+using namespace delta_encoding;
+
+SCENARIO("zigzag mapping") {
+    GIVEN("small signed values") {
+        THEN("they map to small unsigned values") {
+            REQUIRE(zigzag(0) == 0);
+            REQUIRE(zigzag(-1) == 1);
+            REQUIRE(zigzag(1) == 2);
+            REQUIRE(zigzag(-2) == 3);
+        }
+    }
+    GIVEN("the extremes of int32_t") {
+        auto low = std::numeric_limits<int32_t>::min();
+        auto high = std::numeric_limits<int32_t>::max();
+        THEN("they map back to themselves") {
+            REQUIRE(unzigzag(zigzag(low)) == low);
+            REQUIRE(unzigzag(zigzag(high)) == high);
+        }
+    }
+}
+
+SCENARIO("varints") {
+    auto buffer = std::array<uint8_t, max_varint_size>{};
+
+    GIVEN("a value under 128") {
+        WHEN("it is written") {
+            auto end = write_varint(0x45, buffer.begin(), buffer.end());
+            THEN("it takes one byte") {
+                REQUIRE(end == buffer.begin() + 1);
+                REQUIRE(buffer[0] == 0x45);
+            }
+        }
+    }
+    GIVEN("a value that takes two bytes") {
+        WHEN("it is written and read back") {
+            auto end = write_varint(300, buffer.begin(), buffer.end());
+            uint32_t value = 0;
+            auto next = read_varint(buffer.cbegin(), buffer.cend(), value);
+            THEN("the low seven bits come first") {
+                REQUIRE(end == buffer.begin() + 2);
+                REQUIRE(buffer[0] == 0xac);
+                REQUIRE(buffer[1] == 0x02);
+            }
+            THEN("the value is the same") {
+                REQUIRE(value == 300);
+                REQUIRE(next == buffer.cbegin() + 2);
+            }
+        }
+        WHEN("there is only room for one byte") {
+            auto end = write_varint(300, buffer.begin(), buffer.begin() + 1);
+            THEN("nothing is written") { REQUIRE(end == buffer.begin()); }
+        }
+    }
+    GIVEN("a varint cut off by the limit") {
+        buffer[0] = 0x80;
+        WHEN("it is read") {
+            uint32_t value = 7;
+            auto next =
+                read_varint(buffer.cbegin(), buffer.cbegin() + 1, value);
+            THEN("nothing is read") {
+                REQUIRE(next == buffer.cbegin());
+                REQUIRE(value == 7);
+            }
+        }
+    }
+}
+
+SCENARIO("delta encoding samples") {
+    auto buffer = std::array<uint8_t, 8>{};
+    auto encoder = DeltaEncoder(buffer.begin(), buffer.end());
+
+    GIVEN("samples that change slowly") {
+        auto samples = std::vector<int32_t>{1000, 1001, 999, 999, 1003};
+        for (auto sample : samples) {
+            REQUIRE(encoder.add(sample));
+        }
+        THEN("each sample after the first takes one byte") {
+            REQUIRE(encoder.count() == 5);
+            REQUIRE(encoder.size() == 2 + 4);
+        }
+        THEN("decoding gives the samples back") {
+            auto decoded = std::vector<int32_t>{};
+            auto count =
+                decode(buffer.cbegin(), buffer.cend(), 5,
+                       [&decoded](int32_t s) { decoded.push_back(s); });
+            REQUIRE(count == 5);
+            REQUIRE(decoded == samples);
+        }
+    }
+
+    GIVEN("a sample that does not fit") {
+        REQUIRE(encoder.add(std::numeric_limits<int32_t>::min()));
+        REQUIRE(encoder.add(std::numeric_limits<int32_t>::max()));
+        THEN("it is not written") {
+            REQUIRE(!encoder.add(0));
+            REQUIRE(encoder.count() == 2);
+            REQUIRE(encoder.size() == 6);
+        }
+        THEN("decoding gives back the large steps") {
+            auto decoded = std::vector<int32_t>{};
+            decode(buffer.cbegin(), buffer.cbegin() + encoder.size(), 2,
+                   [&decoded](int32_t s) { decoded.push_back(s); });
+            REQUIRE(decoded ==
+                    std::vector<int32_t>{std::numeric_limits<int32_t>::min(),
+                                         std::numeric_limits<int32_t>::max()});
+        }
+    }
+
+    GIVEN("fewer bytes than the count asks for") {
+        REQUIRE(encoder.add(5));
+        THEN("decoding stops where the bytes do") {
+            auto count = decode(buffer.cbegin(), buffer.cbegin() + 1, 3,
+                                [](int32_t) {});
+            REQUIRE(count == 1);
+        }
+    }
+}
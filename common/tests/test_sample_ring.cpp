@@ -0,0 +1,90 @@
+#include <array>
+#include <cstdint>
+
+#include "catch2/catch.hpp"
+#include "common/core/sample_ring.hpp"
+
+using namespace sample_ring;
+
+SCENARIO("sample ring basic operation") {
+    GIVEN("an empty ring") {
+        auto subject = SampleRing<int32_t, 4>{};
+        auto out = std::array<int32_t, 4>{};
+        THEN("it has nothing to copy") {
+            REQUIRE(subject.empty());
+            REQUIRE(subject.copy(out) == 0);
+        }
+        WHEN("samples are pushed") {
+            REQUIRE(subject.push(1));
+            REQUIRE(subject.push(2));
+            THEN("they can be looked at oldest first") {
+                REQUIRE(subject.size() == 2);
+                REQUIRE(subject[0] == 1);
+                REQUIRE(subject[1] == 2);
+            }
+            THEN("copying them out leaves them in the ring") {
+                REQUIRE(subject.copy(out) == 2);
+                REQUIRE(out[0] == 1);
+                REQUIRE(out[1] == 2);
+                REQUIRE(subject.size() == 2);
+            }
+            THEN("consuming drops the oldest") {
+                subject.consume(1);
+                REQUIRE(subject.size() == 1);
+                REQUIRE(subject[0] == 2);
+            }
+            THEN("consuming more than are waiting empties the ring") {
+                subject.consume(5);
+                REQUIRE(subject.empty());
+            }
+            THEN("clearing drops everything") {
+                subject.clear();
+                REQUIRE(subject.empty());
+                REQUIRE(subject.push(3));
+                REQUIRE(subject[0] == 3);
+            }
+        }
+        WHEN("the ring is filled") {
+            for (int32_t i = 0; i < 4; ++i) {
+                REQUIRE(subject.push(i));
+            }
+            THEN("every slot is used and further pushes fail") {
+                REQUIRE(subject.full());
+                REQUIRE(!subject.push(4));
+                REQUIRE(subject[3] == 3);
+            }
+        }
+    }
+}
+
+SCENARIO("sample ring wraps around") {
+    GIVEN("a ring whose samples run past the end of its storage") {
+        auto subject = SampleRing<int32_t, 4>{};
+        for (int32_t i = 0; i < 3; ++i) {
+            subject.push(i);
+        }
+        subject.consume(3);
+        for (int32_t i = 10; i < 14; ++i) {
+            REQUIRE(subject.push(i));
+        }
+        THEN("they are looked at in order") {
+            for (int32_t i = 0; i < 4; ++i) {
+                REQUIRE(subject[i] == 10 + i);
+            }
+        }
+        THEN("a bulk copy joins the two runs") {
+            auto out = std::array<int32_t, 8>{};
+            REQUIRE(subject.copy(out) == 4);
+            REQUIRE(out[0] == 10);
+            REQUIRE(out[1] == 11);
+            REQUIRE(out[2] == 12);
+            REQUIRE(out[3] == 13);
+        }
+        THEN("a short copy takes only the oldest") {
+            auto out = std::array<int32_t, 2>{};
+            REQUIRE(subject.copy(out) == 2);
+            REQUIRE(out[0] == 10);
+            REQUIRE(out[1] == 11);
+        }
+    }
+}
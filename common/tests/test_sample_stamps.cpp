@@ -0,0 +1,78 @@
+#include <cstdint>
+
+#include "catch2/catch.hpp"
+#include "common/core/sample_stamps.hpp"
+
+using namespace sample_stamps;
+
+SCENARIO("sample stamps basic operation") {
+    GIVEN("stamps of a few samples") {
+        auto subject = SampleStamps<4>{};
+        REQUIRE(subject.push(SampleStamp{.tick = 100, .step_position = 50}));
+        REQUIRE(subject.push(SampleStamp{.tick = 104, .step_position = 40}));
+        REQUIRE(subject.push(SampleStamp{.tick = 110, .step_position = 45}));
+        THEN("the oldest is kept whole and the rest as changes") {
+            REQUIRE(subject.size() == 3);
+            REQUIRE(subject.oldest() ==
+                    SampleStamp{.tick = 100, .step_position = 50});
+            REQUIRE(subject[1].ticks == 4);
+            REQUIRE(subject[1].steps == -10);
+            REQUIRE(subject[2].ticks == 6);
+            REQUIRE(subject[2].steps == 5);
+        }
+        WHEN("the oldest are consumed") {
+            subject.consume(2);
+            THEN("the oldest stamp moves up") {
+                REQUIRE(subject.size() == 1);
+                REQUIRE(subject.oldest() ==
+                        SampleStamp{.tick = 110, .step_position = 45});
+            }
+        }
+        WHEN("they are all consumed and another is pushed") {
+            subject.consume(3);
+            REQUIRE(subject.push(SampleStamp{.tick = 7, .step_position = 9}));
+            THEN("it becomes the oldest") {
+                REQUIRE(subject.size() == 1);
+                REQUIRE(subject.oldest() ==
+                        SampleStamp{.tick = 7, .step_position = 9});
+            }
+        }
+        WHEN("the ring fills") {
+            REQUIRE(subject.push(SampleStamp{.tick = 111}));
+            THEN("no more stamps are taken") {
+                REQUIRE(!subject.push(SampleStamp{.tick = 112}));
+                REQUIRE(subject.size() == 4);
+            }
+        }
+    }
+
+    GIVEN("samples further apart than a change holds") {
+        auto subject = SampleStamps<8>{};
+        REQUIRE(subject.push(SampleStamp{.tick = 0, .step_position = 0}));
+        REQUIRE(
+            subject.push(SampleStamp{.tick = 70000, .step_position = 40000}));
+        REQUIRE(
+            subject.push(SampleStamp{.tick = 70001, .step_position = 40001}));
+        THEN("the change is clamped and the next one makes up for it") {
+            REQUIRE(subject[1].ticks == UINT16_MAX);
+            REQUIRE(subject[1].steps == INT16_MAX);
+            subject.consume(2);
+            REQUIRE(subject.oldest() ==
+                    SampleStamp{.tick = 70001, .step_position = 40001});
+        }
+        THEN("runs end at a gap longer than asked for") {
+            REQUIRE(subject.run(3, UINT8_MAX) == 1);
+            REQUIRE(subject.run(3, UINT16_MAX) == 3);
+        }
+    }
+
+    GIVEN("a step position that wraps") {
+        auto subject = SampleStamps<4>{};
+        REQUIRE(subject.push(SampleStamp{.tick = 0, .step_position = 2}));
+        REQUIRE(subject.push(
+            SampleStamp{.tick = 1, .step_position = UINT32_MAX - 1}));
+        THEN("the change is the short way round") {
+            REQUIRE(subject[1].steps == -4);
+        }
+    }
+}
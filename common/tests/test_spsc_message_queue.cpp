@@ -0,0 +1,111 @@
+#include <cstdint>
+
+#include "catch2/catch.hpp"
+#include "common/core/message_queue.hpp"
+#include "common/core/spsc_message_queue.hpp"
+
+using namespace spsc_message_queue;
+
+struct TestMessage {
+    uint32_t index;
+    int64_t payload;
+};
+
+static_assert(MessageQueue<SPSCMessageQueue<TestMessage>, TestMessage>);
+static_assert(MessageQueue<SPSCMessageQueue<uint8_t, 4>, uint8_t>);
+
+SCENARIO("spsc message queue basic operation") {
+    GIVEN("an empty queue") {
+        auto subject = SPSCMessageQueue<TestMessage, 4>{};
+        auto out = TestMessage{};
+        THEN("it has no messages") {
+            REQUIRE(!subject.has_message());
+            REQUIRE(!subject.has_message_isr());
+            REQUIRE(!subject.try_read(&out));
+            REQUIRE(!subject.try_read_isr(&out));
+            REQUIRE(!subject.peek_isr(&out));
+        }
+        WHEN("a message is written") {
+            REQUIRE(subject.try_write(TestMessage{.index = 1, .payload = -2}));
+            THEN("it can be peeked without removing it") {
+                REQUIRE(subject.peek_isr(&out));
+                REQUIRE(out.index == 1);
+                REQUIRE(subject.has_message_isr());
+                REQUIRE(subject.get_size() == 1);
+            }
+            THEN("it can be read out") {
+                REQUIRE(subject.try_read_isr(&out));
+                REQUIRE(out.index == 1);
+                REQUIRE(out.payload == -2);
+                REQUIRE(!subject.has_message_isr());
+            }
+        }
+        WHEN("the queue is filled") {
+            for (uint32_t i = 0; i < 4; ++i) {
+                REQUIRE(subject.try_write(TestMessage{.index = i}, 10));
+            }
+            THEN("further writes fail") {
+                REQUIRE(!subject.try_write(TestMessage{.index = 4}));
+                REQUIRE(subject.get_size() == 4);
+            }
+            THEN("messages come out in order") {
+                for (uint32_t i = 0; i < 4; ++i) {
+                    REQUIRE(subject.try_read_isr(&out));
+                    REQUIRE(out.index == i);
+                }
+                REQUIRE(!subject.has_message_isr());
+            }
+        }
+    }
+}
+
+SCENARIO("spsc message queue wraps around") {
+    GIVEN("a small queue") {
+        auto subject = SPSCMessageQueue<TestMessage, 2>{};
+        auto out = TestMessage{};
+        WHEN("many more messages than slots pass through") {
+            uint32_t read_count = 0;
+            for (uint32_t i = 0; i < 101; ++i) {
+                REQUIRE(subject.try_write_isr(TestMessage{.index = i}));
+                if (i % 2 == 1) {
+                    REQUIRE(subject.try_read(&out));
+                    REQUIRE(out.index == read_count++);
+                    REQUIRE(subject.try_read(&out));
+                    REQUIRE(out.index == read_count++);
+                }
+            }
+            THEN("the last message is still in order") {
+                REQUIRE(subject.try_read(&out));
+                REQUIRE(out.index == 100);
+                REQUIRE(!subject.has_message());
+            }
+        }
+    }
+}
+
+SCENARIO("spsc message queue reset") {
+    GIVEN("a queue with messages") {
+        auto subject = SPSCMessageQueue<TestMessage, 8>{"test queue"};
+        auto out = TestMessage{};
+        for (uint32_t i = 0; i < 5; ++i) {
+            REQUIRE(subject.try_write(TestMessage{.index = i}));
+        }
+        REQUIRE(subject.try_read(&out));
+        WHEN("the queue is reset") {
+            subject.reset();
+            THEN("it is empty") {
+                REQUIRE(!subject.has_message_isr());
+                REQUIRE(!subject.try_read_isr(&out));
+                REQUIRE(subject.get_size() == 0);
+            }
+            THEN("it can be written to capacity again") {
+                for (uint32_t i = 0; i < 8; ++i) {
+                    REQUIRE(subject.try_write(TestMessage{.index = i + 10}));
+                }
+                REQUIRE(!subject.try_write(TestMessage{}));
+                REQUIRE(subject.try_read_isr(&out));
+                REQUIRE(out.index == 10);
+            }
+        }
+    }
+}
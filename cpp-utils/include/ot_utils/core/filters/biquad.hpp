@@ -0,0 +1,134 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "ot_utils/core/fixed_point.hpp"
+
+// Biquad Cascade
+// An infinite impulse response (IIR) filter built from second order sections
+
+// Use this filter when a moving average is not sharp enough: a designed
+// low-pass (e.g. a Butterworth from scipy.signal.butter(..., output="sos"))
+// passes the signal with less delay for the same noise rejection.
+namespace ot_utils {
+
+namespace filters {
+
+/*
+ * One second order section of a filter design, with a0 normalized to 1:
+ *   y[n] = b0 x[n] + b1 x[n-1] + b2 x[n-2] - a1 y[n-1] - a2 y[n-2]
+ */
+struct BiquadSection {
+    double b0 = 1;
+    double b1 = 0;
+    double b2 = 0;
+    double a1 = 0;
+    double a2 = 0;
+};
+
+// A section's coefficients in fixed point at the cascade's radix.
+struct QuantizedBiquadSection {
+    int32_t b0 = 0;
+    int32_t b1 = 0;
+    int32_t b2 = 0;
+    int32_t a1 = 0;
+    int32_t a2 = 0;
+};
+
+/*
+ * Quantize a design at compile time. A stable section's a1 is within
+ * (-2, 2), so the radix must leave at least two integer bits.
+ */
+template <int Radix, std::size_t Sections>
+consteval auto quantize_biquads(
+    const std::array<BiquadSection, Sections>& design)
+    -> std::array<QuantizedBiquadSection, Sections> {
+    static_assert(Radix > 0 && Radix <= 29,
+                  "biquad coefficients need at least two integer bits");
+    std::array<QuantizedBiquadSection, Sections> quantized{};
+    for (std::size_t i = 0; i < Sections; ++i) {
+        quantized[i] = QuantizedBiquadSection{
+            .b0 = fixed_point::quantize<int32_t, Radix>(design[i].b0),
+            .b1 = fixed_point::quantize<int32_t, Radix>(design[i].b1),
+            .b2 = fixed_point::quantize<int32_t, Radix>(design[i].b2),
+            .a1 = fixed_point::quantize<int32_t, Radix>(design[i].a1),
+            .a2 = fixed_point::quantize<int32_t, Radix>(design[i].a2)};
+    }
+    return quantized;
+}
+
+/*
+ * A cascade of biquads run in direct form I on integer samples. Each
+ * section sums its products in 64 bits and shifts once, with error
+ * feedback, so samples of up to 24 significant bits (e.g. raw MMR920
+ * counts or S15Q16 readings in the sensor's range) filter without
+ * overflow and a constant input comes out exactly.
+ */
+template <std::size_t Sections, int Radix = 28>
+class BiquadCascade {
+  public:
+    using Coefficients = std::array<QuantizedBiquadSection, Sections>;
+
+    constexpr explicit BiquadCascade(const Coefficients& coefficients)
+        : coefficients(coefficients) {}
+
+    auto compute(int32_t input) -> int32_t {
+        int32_t x = input;
+        for (std::size_t i = 0; i < Sections; ++i) {
+            const auto& c = coefficients[i];
+            auto& s = state[i];
+            int64_t acc = int64_t(c.b0) * x + int64_t(c.b1) * s.x1 +
+                          int64_t(c.b2) * s.x2 - int64_t(c.a1) * s.y1 -
+                          int64_t(c.a2) * s.y2;
+            // carry what the shift drops over to the next sample, so that
+            // rounding doesn't build up in the feedback into an offset
+            acc += s.remainder;
+            auto y = int32_t(acc >> Radix);
+            s.remainder = acc - (int64_t(y) << Radix);
+            s.x2 = s.x1;
+            s.x1 = x;
+            s.y2 = s.y1;
+            s.y1 = y;
+            x = y;
+        }
+        return x;
+    }
+
+    /*
+     * Forget past samples. With a value, start as if that value had been
+     * the input forever, so the output does not ramp up from zero.
+     */
+    auto reset_filter(int32_t settled = 0) -> void {
+        int32_t x = settled;
+        for (std::size_t i = 0; i < Sections; ++i) {
+            const auto& c = coefficients[i];
+            // the section's output for a constant input is that input times
+            // its gain at DC, (b0 + b1 + b2) / (1 + a1 + a2)
+            int64_t numerator = int64_t(c.b0) + c.b1 + c.b2;
+            int64_t denominator = (int64_t(1) << Radix) + c.a1 + c.a2;
+            auto y = (denominator == 0)
+                         ? x
+                         : int32_t(numerator * x / denominator);
+            state[i] = SectionState{x, x, y, y, 0};
+            x = y;
+        }
+    }
+
+  private:
+    struct SectionState {
+        int32_t x1 = 0;
+        int32_t x2 = 0;
+        int32_t y1 = 0;
+        int32_t y2 = 0;
+        int64_t remainder = 0;
+    };
+
+    Coefficients coefficients;
+    std::array<SectionState, Sections> state{};
+};
+
+}  // namespace filters
+
+}  // namespace ot_utils
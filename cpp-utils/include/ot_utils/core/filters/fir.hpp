@@ -0,0 +1,76 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "ot_utils/core/fixed_point.hpp"
+
+// Finite Impulse Response Filter
+// A windowed filter with designed taps
+
+// Use this filter when a fixed delay matters more than sharpness: a
+// symmetric FIR (e.g. from scipy.signal.firwin) delays every frequency by
+// the same (Taps - 1) / 2 samples.
+namespace ot_utils {
+
+namespace filters {
+
+/*
+ * Quantize a filter's taps at compile time. Taps of a low-pass are all
+ * within (-1, 1), so the default radix leaves one integer bit.
+ */
+template <int Radix, std::size_t Taps>
+consteval auto quantize_taps(const std::array<double, Taps>& design)
+    -> std::array<int32_t, Taps> {
+    static_assert(Radix > 0 && Radix <= 30,
+                  "FIR taps need at least one integer bit");
+    std::array<int32_t, Taps> quantized{};
+    for (std::size_t i = 0; i < Taps; ++i) {
+        quantized[i] = fixed_point::quantize<int32_t, Radix>(design[i]);
+    }
+    return quantized;
+}
+
+/*
+ * An FIR filter on integer samples, summing in 64 bits and rounding once.
+ * Like BiquadCascade it takes samples of up to 24 significant bits.
+ */
+template <std::size_t Taps, int Radix = 30>
+class FIR {
+  public:
+    using Coefficients = std::array<int32_t, Taps>;
+
+    constexpr explicit FIR(const Coefficients& coefficients)
+        : coefficients(coefficients) {}
+
+    auto compute(int32_t input) -> int32_t {
+        window[newest] = input;
+        int64_t acc = 0;
+        // taps[0] goes with the newest sample
+        std::size_t sample = newest;
+        for (std::size_t i = 0; i < Taps; ++i) {
+            acc += int64_t(coefficients[i]) * window[sample];
+            sample = (sample == 0) ? Taps - 1 : sample - 1;
+        }
+        newest = (newest + 1 == Taps) ? 0 : newest + 1;
+        return int32_t((acc + rounding) >> Radix);
+    }
+
+    // Forget past samples, or start as if settled had always been the input.
+    auto reset_filter(int32_t settled = 0) -> void {
+        window.fill(settled);
+        newest = 0;
+    }
+
+  private:
+    static constexpr int64_t rounding = int64_t(1) << (Radix - 1);
+
+    Coefficients coefficients;
+    std::array<int32_t, Taps> window{};
+    std::size_t newest = 0;
+};
+
+}  // namespace filters
+
+}  // namespace ot_utils
@@ -3,6 +3,7 @@
 #include <cstdint>
 #include <cstdlib>
 
+#include <limits>
 #include <type_traits>
 
 namespace ot_utils {
@@ -27,6 +28,28 @@ auto convert_to_fixed_point(double value, int to_radix) -> integer_t {
     return integer_t(value * double(1LL << to_radix)); 
 }
 
+// Called only when a value given to quantize does not fit, which makes the
+// constant evaluation, and so the build, fail here.
+inline void quantized_value_out_of_range() {}
+
+/*
+ * Round a value to fixed point at compile time, e.g. a filter coefficient.
+ * Unlike convert_to_fixed_point this rounds to nearest, and a value that
+ * does not fit in integer_t at this radix is a compile error rather than
+ * a silent wrap.
+ */
+template <typename integer_t, int radix>
+requires std::is_integral_v<integer_t>
+consteval auto quantize(double value) -> integer_t {
+    double scaled = value * double(1LL << radix);
+    scaled += (scaled < 0) ? -0.5 : 0.5;
+    if (scaled >= double(std::numeric_limits<integer_t>::max()) + 1.0 ||
+        scaled <= double(std::numeric_limits<integer_t>::min()) - 1.0) {
+        quantized_value_out_of_range();
+    }
+    return integer_t(scaled);
+}
+
 template <typename integer_t>
 struct size_up;
 
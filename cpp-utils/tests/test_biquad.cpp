@@ -0,0 +1,112 @@
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+
+#include "catch2/catch.hpp"
+#include "ot_utils/core/filters/biquad.hpp"
+
+using namespace ot_utils;
+
+// A 4th order Butterworth low-pass at 0.05 of the sample rate, as two
+// sections.
+static constexpr std::array<filters::BiquadSection, 2> butterworth{
+    filters::BiquadSection{.b0 = 0.019036831587823894,
+                           .b1 = 0.038073663175647789,
+                           .b2 = 0.019036831587823894,
+                           .a1 = -1.4796742169311932,
+                           .a2 = 0.55582154328248878},
+    filters::BiquadSection{.b0 = 0.021883851967943044,
+                           .b1 = 0.043767703935886089,
+                           .b2 = 0.021883851967943044,
+                           .a1 = -1.7009643319435257,
+                           .a2 = 0.78849973981529786}};
+
+static constexpr auto quantized = filters::quantize_biquads<28>(butterworth);
+
+// The same filter in double precision.
+class ReferenceBiquads {
+  public:
+    auto compute(double x) -> double {
+        for (std::size_t i = 0; i < butterworth.size(); ++i) {
+            const auto& c = butterworth[i];
+            auto& s = state[i];
+            double y = c.b0 * x + c.b1 * s[0] + c.b2 * s[1] - c.a1 * s[2] -
+                       c.a2 * s[3];
+            s = {x, s[0], y, s[2]};
+            x = y;
+        }
+        return x;
+    }
+
+  private:
+    std::array<std::array<double, 4>, 2> state{};
+};
+
+// A step with a slow wave and fast noise on it, in about 20 bits.
+static auto test_signal(int n) -> int32_t {
+    double value = (n < 50 ? 0.0 : 400000.0) +
+                   100000.0 * std::sin(0.01 * n) +
+                   30000.0 * std::sin(2.5 * n) + 5000.0 * std::cos(1.3 * n);
+    return static_cast<int32_t>(value);
+}
+
+SCENARIO("Biquad coefficients are quantized at compile time") {
+    GIVEN("a design") {
+        THEN("each coefficient rounds to the nearest step") {
+            STATIC_REQUIRE(quantized[0].b0 == 5110161);
+            STATIC_REQUIRE(quantized[0].a1 == -397197023);
+            STATIC_REQUIRE(fixed_point::quantize<int32_t, 28>(-0.5) ==
+                           -(1 << 27));
+        }
+    }
+}
+
+SCENARIO("Biquad cascade filtering") {
+    filters::BiquadCascade<2> filter{quantized};
+    ReferenceBiquads reference{};
+
+    GIVEN("a noisy step") {
+        THEN("the output follows the double precision filter") {
+            for (int n = 0; n < 2000; ++n) {
+                auto input = test_signal(n);
+                auto expected = reference.compute(input);
+                auto result = filter.compute(input);
+                INFO("sample " << n);
+                REQUIRE(std::abs(result - expected) < 4.0);
+            }
+        }
+    }
+
+    GIVEN("a constant input") {
+        WHEN("the filter has run long enough to settle") {
+            int32_t result = 0;
+            for (int n = 0; n < 500; ++n) {
+                result = filter.compute(-123456);
+            }
+            THEN("the output is the input") {
+                REQUIRE(std::abs(result + 123456) <= 2);
+            }
+        }
+        WHEN("the filter is reset to that input") {
+            filter.reset_filter(-123456);
+            THEN("the output starts there") {
+                REQUIRE(std::abs(filter.compute(-123456) + 123456) <= 2);
+            }
+        }
+    }
+
+    GIVEN("fast noise alone") {
+        THEN("it is attenuated") {
+            int32_t peak = 0;
+            for (int n = 0; n < 500; ++n) {
+                auto result = filter.compute(
+                    static_cast<int32_t>(30000.0 * std::sin(2.5 * n)));
+                if (n > 100) {
+                    peak = std::max(peak, std::abs(result));
+                }
+            }
+            REQUIRE(peak < 30);
+        }
+    }
+}
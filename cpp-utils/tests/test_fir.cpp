@@ -0,0 +1,62 @@
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+
+#include "catch2/catch.hpp"
+#include "ot_utils/core/filters/fir.hpp"
+
+using namespace ot_utils;
+
+// A 15 tap Hamming windowed low-pass at 0.1 of the sample rate.
+static constexpr std::array<double, 15> taps{
+    -0.0035916613441644017, -0.0040643977832259121, 2.0492387085516212e-18,
+    0.021250696993780505,   0.067291532313762573,   0.12992020417969577,
+    0.18538176365066786,    0.20762372397896731,    0.18538176365066786,
+    0.12992020417969577,    0.067291532313762586,   0.021250696993780526,
+    2.049238708551622e-18,  -0.0040643977832259086, -0.0035916613441644017};
+
+static constexpr auto quantized = filters::quantize_taps<30>(taps);
+
+SCENARIO("FIR filtering") {
+    filters::FIR<taps.size()> filter{quantized};
+
+    GIVEN("an impulse") {
+        THEN("the output is the taps") {
+            constexpr int32_t impulse = 1 << 20;
+            for (std::size_t n = 0; n < taps.size(); ++n) {
+                auto result = filter.compute(n == 0 ? impulse : 0);
+                REQUIRE(std::abs(result - taps[n] * impulse) <= 1.0);
+            }
+            REQUIRE(filter.compute(0) == 0);
+        }
+    }
+
+    GIVEN("a noisy signal") {
+        THEN("the output follows the double precision filter") {
+            std::array<double, taps.size()> history{};
+            for (int n = 0; n < 1000; ++n) {
+                auto input = static_cast<int32_t>(
+                    200000.0 * std::sin(0.02 * n) +
+                    40000.0 * std::sin(2.9 * n));
+                for (std::size_t i = history.size() - 1; i > 0; --i) {
+                    history[i] = history[i - 1];
+                }
+                history[0] = input;
+                double expected = 0;
+                for (std::size_t i = 0; i < taps.size(); ++i) {
+                    expected += taps[i] * history[i];
+                }
+                INFO("sample " << n);
+                REQUIRE(std::abs(filter.compute(input) - expected) < 2.0);
+            }
+        }
+    }
+
+    GIVEN("a filter reset to a value") {
+        filter.reset_filter(5000);
+        THEN("a constant input passes straight through") {
+            REQUIRE(std::abs(filter.compute(5000) - 5000) <= 1);
+        }
+    }
+}
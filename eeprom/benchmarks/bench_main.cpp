@@ -0,0 +1,119 @@
+#include <unistd.h>
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+
+#include "benchmarks.hpp"
+#include "eeprom/simulation/backing_store.hpp"
+
+/*
+ * Host benchmark for the simulated eeprom's backing store: the cost of a
+ * write to the mapped store, with and without snapshots, against the
+ * seek, write and flush of the stdio store it replaced. The tail shows the
+ * writes that pay for a sync.
+ *
+ * Usage: eeprom-benchmarks [--writes N] [--json PATH]
+ */
+
+using namespace eeprom::simulator;
+
+namespace {
+
+auto bench_path(const char* name) -> std::string {
+    auto path = std::filesystem::temp_directory_path() /
+                ("eeprom-bench-" + std::to_string(getpid()) + "-" + name +
+                 ".bin");
+    std::filesystem::remove(path);
+    return path.string();
+}
+
+// Writes walk through the store a value at a time, as the usage counters do
+using Value = std::array<uint8_t, 8>;
+
+auto address_of(uint32_t write) -> uint16_t {
+    return static_cast<uint16_t>((write * sizeof(Value)) %
+                                 BackingStore::BACKING_SIZE);
+}
+
+void time_stdio(uint32_t writes, benchmarks::Results& results) {
+    auto path = bench_path("stdio");
+    auto* file = fopen(path.c_str(), "w+b");
+    if (file == nullptr) {
+        fprintf(stderr, "could not open %s\n", path.c_str());
+        return;
+    }
+    auto value = Value{1, 2, 3, 4, 5, 6, 7, 8};
+    auto sampler = benchmarks::Sampler{writes};
+    for (uint32_t i = 0; i < writes; ++i) {
+        sampler.time([&]() {
+            fseek(file, address_of(i), SEEK_SET);
+            fwrite(value.data(), 1, value.size(), file);
+            fflush(file);
+        });
+    }
+    fclose(file);
+    std::filesystem::remove(path);
+    results.push_back(sampler.summarize("stdio write and flush"));
+}
+
+void time_mapped(uint32_t writes, bool snapshot,
+                 benchmarks::Results& results) {
+    auto path = bench_path(snapshot ? "snapshot" : "mapped");
+    auto sampler = benchmarks::Sampler{writes};
+    {
+        auto store = BackingStore(
+            BackingOptions{
+                .path = path, .sync_writes = 1024, .snapshot = snapshot},
+            0);
+        auto value = Value{1, 2, 3, 4, 5, 6, 7, 8};
+        for (uint32_t i = 0; i < writes; ++i) {
+            sampler.time([&]() {
+                store.write(value.data(), address_of(i), value.size());
+            });
+        }
+    }
+    std::filesystem::remove(path);
+    std::filesystem::remove(path + ".tmp");
+    results.push_back(
+        sampler.summarize(snapshot ? "mapped, snapshot every 1024"
+                                   : "mapped, msync every 1024"));
+}
+
+}  // namespace
+
+auto main(int argc, char** argv) -> int {
+    uint32_t writes = 20000;
+    const char* json_path = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--writes") == 0 && i + 1 < argc) {
+            writes = strtoul(argv[++i], nullptr, 0);
+        } else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            json_path = argv[++i];
+        } else {
+            fprintf(stderr, "usage: %s [--writes N] [--json PATH]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+    if (writes == 0) {
+        fprintf(stderr, "--writes must be greater than zero\n");
+        return 1;
+    }
+
+    auto results = benchmarks::Results{};
+    time_stdio(writes, results);
+    time_mapped(writes, false, results);
+    time_mapped(writes, true, results);
+
+    benchmarks::print_results(results);
+    if (json_path != nullptr && !benchmarks::write_json(results, json_path)) {
+        fprintf(stderr, "could not write %s\n", json_path);
+        return 1;
+    }
+    return 0;
+}
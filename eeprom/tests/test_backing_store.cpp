@@ -0,0 +1,227 @@
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "catch2/catch.hpp"
+#include "eeprom/simulation/backing_store.hpp"
+
+using namespace eeprom::simulator;
+
+static auto test_path(const std::string& name) -> std::string {
+    auto path = std::filesystem::temp_directory_path() /
+                ("eeprom-" + std::to_string(getpid()) + "-" + name + ".bin");
+    std::filesystem::remove(path);
+    return path.string();
+}
+
+static auto file_contents(const std::string& path) -> std::vector<uint8_t> {
+    auto file = std::ifstream(path, std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(file),
+                                std::istreambuf_iterator<char>());
+}
+
+/*
+ * The crash test writes a running count into a ring of slots, so that the
+ * state of the file after a crash says how many writes it holds.
+ */
+static constexpr uint64_t slots = 32;
+// The child lets the parent know once this many writes have gone in.
+static constexpr uint64_t writes_before_kill = 1024;
+
+static auto read_slot(BackingStore& store, uint64_t slot) -> uint64_t {
+    uint64_t value = 0;
+    store.read(reinterpret_cast<uint8_t*>(&value),
+               static_cast<uint16_t>(slot * sizeof(value)), sizeof(value));
+    return value;
+}
+
+/*
+ * The count a slot holds once the first `writes` counts have gone in.
+ */
+static auto expected_slot(uint64_t slot, uint64_t writes) -> uint64_t {
+    if (writes < slot || (slot == 0 && writes < slots)) {
+        return UINT64_MAX;
+    }
+    return writes - ((writes - slot) % slots);
+}
+
+/*
+ * Write counts from a child process until it is killed, after letting the
+ * parent know that enough have gone in.
+ */
+static void write_until_killed(const BackingOptions& options) {
+    std::array<int, 2> ready{};
+    REQUIRE(pipe(ready.data()) == 0);
+    auto child = fork();
+    REQUIRE(child >= 0);
+    if (child == 0) {
+        close(ready[0]);
+        auto store = BackingStore(options, 0);
+        for (uint64_t count = 1;; ++count) {
+            store.write(reinterpret_cast<const uint8_t*>(&count),
+                        static_cast<uint16_t>((count % slots) * sizeof(count)),
+                        sizeof(count));
+            if (count == writes_before_kill) {
+                static_cast<void>(::write(ready[1], "x", 1));
+            }
+        }
+    }
+    close(ready[1]);
+    char byte = 0;
+    REQUIRE(::read(ready[0], &byte, 1) == 1);
+    close(ready[0]);
+    kill(child, SIGKILL);
+    int status = 0;
+    waitpid(child, &status, 0);
+    REQUIRE(WIFSIGNALED(status));
+}
+
+SCENARIO("backing the simulated eeprom with a mapped file") {
+    GIVEN("a new backing file") {
+        auto path = test_path("new");
+        WHEN("it is opened") {
+            { auto store = BackingStore(BackingOptions{.path = path}, 0); }
+            THEN("it is the size of the eeprom and erased") {
+                auto contents = file_contents(path);
+                REQUIRE(contents.size() == BackingStore::BACKING_SIZE);
+                REQUIRE(std::all_of(contents.begin(), contents.end(),
+                                    [](auto b) { return b == 0xff; }));
+            }
+        }
+        WHEN("it is opened with a serial number") {
+            auto store = BackingStore(BackingOptions{.path = path}, 0x00021234);
+            THEN("the serial number starts it off") {
+                auto header = std::array<uint8_t, 6>{};
+                store.read(header.data(), 0, header.size());
+                REQUIRE(header ==
+                        std::array<uint8_t, 6>{0, 0, 0, 2, 0, 0});
+                auto serial = std::array<uint8_t, 4>{};
+                store.read(serial.data(), 4, serial.size());
+                REQUIRE(serial == std::array<uint8_t, 4>{0, 0, 0x12, 0x34});
+            }
+        }
+        std::filesystem::remove(path);
+    }
+
+    GIVEN("a backing file shorter than the eeprom") {
+        auto path = test_path("short");
+        {
+            auto file = std::ofstream(path, std::ios::binary);
+            file.write("\x01\x02\x03\x04", 4);
+        }
+        auto store = BackingStore(BackingOptions{.path = path}, 0);
+        THEN("it is extended without losing what was there") {
+            auto start = std::array<uint8_t, 5>{};
+            store.read(start.data(), 0, start.size());
+            REQUIRE(start == std::array<uint8_t, 5>{1, 2, 3, 4, 0xff});
+            REQUIRE(std::filesystem::file_size(path) ==
+                    BackingStore::BACKING_SIZE);
+        }
+        std::filesystem::remove(path);
+    }
+
+    GIVEN("a store that has been written to") {
+        auto path = test_path("reopen");
+        auto data = std::array<uint8_t, 4>{0xde, 0xad, 0xbe, 0xef};
+        {
+            auto store = BackingStore(
+                BackingOptions{.path = path, .sync_writes = 0}, 0);
+            store.write(data.data(), 100, data.size());
+        }
+        WHEN("it is opened again") {
+            auto store = BackingStore(BackingOptions{.path = path}, 0);
+            THEN("the write is still there") {
+                auto read = std::array<uint8_t, 4>{};
+                store.read(read.data(), 100, read.size());
+                REQUIRE(read == data);
+            }
+        }
+        std::filesystem::remove(path);
+    }
+
+    GIVEN("a store in snapshot mode") {
+        auto path = test_path("snapshot");
+        auto store = BackingStore(
+            BackingOptions{.path = path, .sync_writes = 0, .snapshot = true},
+            0);
+        auto data = std::array<uint8_t, 2>{0x12, 0x34};
+        store.write(data.data(), 10, data.size());
+        THEN("reads see the write") {
+            auto read = std::array<uint8_t, 2>{};
+            store.read(read.data(), 10, read.size());
+            REQUIRE(read == data);
+        }
+        THEN("the file does not until it is synced") {
+            REQUIRE(file_contents(path)[10] == 0xff);
+            store.sync();
+            auto contents = file_contents(path);
+            REQUIRE(contents.size() == BackingStore::BACKING_SIZE);
+            REQUIRE(contents[10] == 0x12);
+            REQUIRE(contents[11] == 0x34);
+            REQUIRE(!std::filesystem::exists(path + ".tmp"));
+        }
+        std::filesystem::remove(path);
+    }
+}
+
+SCENARIO("recovering the simulated eeprom after a crash") {
+    GIVEN("a simulator killed while writing through the mapping") {
+        auto path = test_path("killed");
+        write_until_killed(BackingOptions{.path = path, .sync_writes = 64});
+        auto store = BackingStore(BackingOptions{.path = path}, 0);
+        THEN("every write but the one in progress is in the file") {
+            uint64_t writes = 0;
+            for (uint64_t slot = 0; slot < slots; ++slot) {
+                auto value = read_slot(store, slot);
+                if (value != UINT64_MAX && value % slots == slot) {
+                    writes = std::max(writes, value);
+                }
+            }
+            REQUIRE(writes >= writes_before_kill);
+            auto mismatched = 0;
+            for (uint64_t slot = 0; slot < slots; ++slot) {
+                if (read_slot(store, slot) != expected_slot(slot, writes)) {
+                    mismatched++;
+                }
+            }
+            REQUIRE(mismatched <= 1);
+        }
+        std::filesystem::remove(path);
+    }
+
+    GIVEN("a simulator killed while keeping snapshots") {
+        auto path = test_path("killed-snapshot");
+        write_until_killed(BackingOptions{
+            .path = path, .sync_writes = 16, .snapshot = true});
+        REQUIRE(std::filesystem::file_size(path) ==
+                BackingStore::BACKING_SIZE);
+        auto store = BackingStore(BackingOptions{.path = path}, 0);
+        THEN("the file is exactly one of the snapshots") {
+            uint64_t writes = 0;
+            for (uint64_t slot = 0; slot < slots; ++slot) {
+                auto value = read_slot(store, slot);
+                if (value != UINT64_MAX) {
+                    writes = std::max(writes, value);
+                }
+            }
+            REQUIRE(writes >= writes_before_kill);
+            REQUIRE(writes % 16 == 0);
+            for (uint64_t slot = 0; slot < slots; ++slot) {
+                REQUIRE(read_slot(store, slot) == expected_slot(slot, writes));
+            }
+        }
+        std::filesystem::remove(path);
+        std::filesystem::remove(path + ".tmp");
+    }
+}
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cstring>
 #include <vector>
 
@@ -351,6 +352,37 @@ SCENARIO("writing to data partition") {
                            write_message.data.begin() + write_message.length,
                            data_value.begin()));
         }
+        THEN("Asking to hear when a write is done") {
+            auto data_value = std::array<uint8_t, 4>{0x01, 0x02, 0x03, 0x04};
+            auto answered = 0;
+            REQUIRE(subject.write_data(
+                data_entry_key, data_value.size(), data_value,
+                [](void* param) { ++*static_cast<int*>(param); },
+                &answered));
+            read_message =
+                std::get<message::ReadEepromMessage>(queue_client.messages[0]);
+            read_message.callback(
+                message::EepromMessage{
+                    .memory_address = read_message.memory_address,
+                    .length = read_message.length,
+                    .data = data_table_mock},
+                read_message.callback_param);
+            // the barrier follows the write to the eeprom task
+            REQUIRE(queue_client.messages.size() == 3);
+            REQUIRE(std::holds_alternative<message::WriteEepromMessage>(
+                queue_client.messages[1]));
+            auto barrier = std::get<message::WriteBarrierMessage>(
+                queue_client.messages[2]);
+            barrier.callback(barrier.callback_param);
+            REQUIRE(answered == 1);
+        }
+        THEN("A write to a key that is not there is not started") {
+            auto data_value = std::array<uint8_t, 4>{};
+            REQUIRE(!subject.write_data(
+                data_entry_key + 4, data_value.size(), data_value,
+                [](void* param) { std::ignore = param; }, nullptr));
+            REQUIRE(queue_client.messages.empty());
+        }
     }
 }
 
@@ -659,3 +691,150 @@ SCENARIO("reading large data from partition") {
         }
     }
 }
+
+/*
+ * An eeprom that applies writes as they are sent and answers reads when
+ * asked to, so that the reads a step sends can be counted.
+ */
+struct FakeEEPromTaskClient {
+    void send_eeprom_queue(const task::TaskMessage& m) {
+        std::visit([this](const auto& o) { this->handle(o); }, m);
+    }
+    void handle(const message::ConfigRequestMessage& m) {
+        m.callback(
+            message::ConfigResponseMessage{
+                .chip = hardware_iface::EEPromChipType::ST_M24128_BF,
+                .addr_bytes = 2,
+                .mem_size = static_cast<types::data_length>(memory.size()),
+                .default_byte_value = 0x00},
+            m.callback_param);
+    }
+    void handle(const message::WriteEepromMessage& m) {
+        std::copy_n(m.data.begin(), m.length,
+                    memory.begin() + m.memory_address);
+    }
+    void handle(const message::ReadEepromMessage& m) { reads.push_back(m); }
+    template <typename Other>
+    void handle(const Other&) {}
+
+    void answer_reads() {
+        while (!reads.empty()) {
+            auto read = reads.front();
+            reads.erase(reads.begin());
+            auto data = types::EepromData{};
+            std::copy_n(memory.begin() + read.memory_address, read.length,
+                        data.begin());
+            read.callback(
+                message::EepromMessage{.message_index = read.message_index,
+                                       .memory_address = read.memory_address,
+                                       .length = read.length,
+                                       .data = data},
+                read.callback_param);
+        }
+    }
+
+    std::array<uint8_t, 16384> memory{};
+    std::vector<message::ReadEepromMessage> reads{};
+};
+
+SCENARIO("reading several keys in one batch") {
+    auto eeprom_client = FakeEEPromTaskClient{};
+    auto read_listener = MockListener{};
+    auto tail_accessor = dev_data::DevDataTailAccessor{eeprom_client};
+    auto dev_data_buffer = dev_data::DataBufferType<8>{};
+    auto subject = dev_data::DevDataAccessor{eeprom_client, read_listener,
+                                             dev_data_buffer, tail_accessor};
+    eeprom_client.answer_reads();
+    // keys 0, 1 and 2 sit one after another down from the end of memory
+    subject.create_data_part(0, 8);
+    eeprom_client.answer_reads();
+    subject.create_data_part(1, 4);
+    eeprom_client.answer_reads();
+    subject.create_data_part(2, 4);
+    eeprom_client.answer_reads();
+    tail_accessor.finish_data_rev();
+    REQUIRE(subject.read_write_ready());
+    // the low byte of each address is its value
+    for (std::size_t i = 16368; i < 16384; ++i) {
+        eeprom_client.memory[i] = static_cast<uint8_t>(i);
+    }
+    auto out = dev_data::BatchBufferType{};
+    out.fill(0xAA);
+
+    GIVEN("a batch of keys") {
+        auto requests =
+            std::array<dev_data::DataRequest, dev_data::max_batch_keys>{
+                dev_data::DataRequest{.key = 2, .len = 0},
+                dev_data::DataRequest{.key = 0, .len = 0},
+                dev_data::DataRequest{.key = 1, .len = 2}};
+        subject.get_data_batch(requests, 3, out, 77);
+        THEN("their table entries are read as one span") {
+            REQUIRE(eeprom_client.reads.size() == 2);
+            REQUIRE(eeprom_client.reads[0].memory_address ==
+                    addresses::data_address_begin);
+            REQUIRE(eeprom_client.reads[0].length == 8);
+            REQUIRE(eeprom_client.reads[1].length == 4);
+        }
+        WHEN("the table entries come back") {
+            auto table_reads = eeprom_client.reads;
+            eeprom_client.reads.clear();
+            for (const auto& table_read : table_reads) {
+                auto data = types::EepromData{};
+                std::copy_n(
+                    eeprom_client.memory.begin() + table_read.memory_address,
+                    table_read.length, data.begin());
+                table_read.callback(
+                    message::EepromMessage{
+                        .message_index = table_read.message_index,
+                        .memory_address = table_read.memory_address,
+                        .length = table_read.length,
+                        .data = data},
+                    table_read.callback_param);
+            }
+            THEN("the values are read as one span") {
+                REQUIRE(eeprom_client.reads.size() == 2);
+                REQUIRE(eeprom_client.reads[0].memory_address == 16368);
+                REQUIRE(eeprom_client.reads[1].memory_address == 16376);
+                REQUIRE(eeprom_client.reads[1].message_index == 77);
+                REQUIRE(read_listener.call_count == 0);
+            }
+            AND_WHEN("the values come back") {
+                eeprom_client.answer_reads();
+                THEN("each lands in its own slot and the listener is told") {
+                    REQUIRE(read_listener.call_count == 1);
+                    auto expected = dev_data::BatchBufferType{
+                        0xf0, 0xf1, 0xf2, 0xf3, 0,    0,    0,    0,
+                        0xf8, 0xf9, 0xfa, 0xfb, 0xfc, 0xfd, 0xfe, 0xff,
+                        0xf4, 0xf5, 0,    0,    0,    0,    0,    0};
+                    REQUIRE(out == expected);
+                }
+            }
+        }
+    }
+
+    GIVEN("a batch with a key that is not in the table") {
+        auto requests =
+            std::array<dev_data::DataRequest, dev_data::max_batch_keys>{
+                dev_data::DataRequest{.key = 9, .len = 0},
+                dev_data::DataRequest{.key = 1, .len = 0}};
+        subject.get_data_batch(requests, 2, out, 0);
+        eeprom_client.answer_reads();
+        THEN("it reads as zeroes and the rest are still read") {
+            REQUIRE(read_listener.call_count == 1);
+            REQUIRE(std::all_of(out.begin(), out.begin() + 8,
+                                [](auto b) { return b == 0; }));
+            REQUIRE(out[8] == 0xf4);
+            REQUIRE(out[11] == 0xf7);
+        }
+    }
+
+    GIVEN("an empty batch") {
+        auto requests =
+            std::array<dev_data::DataRequest, dev_data::max_batch_keys>{};
+        subject.get_data_batch(requests, 0, out, 0);
+        THEN("it finishes without reading") {
+            REQUIRE(eeprom_client.reads.empty());
+            REQUIRE(read_listener.call_count == 1);
+        }
+    }
+}
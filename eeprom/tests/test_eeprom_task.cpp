@@ -1,3 +1,7 @@
+#include <algorithm>
+#include <initializer_list>
+#include <vector>
+
 #include "catch2/catch.hpp"
 #include "common/tests/mock_message_queue.hpp"
 #include "common/tests/mock_queue_client.hpp"
@@ -19,6 +23,35 @@ class MockHardwareIface : public hardware_iface::EEPromHardwareIface {
     std::vector<bool> set_calls{};
 };
 
+/*
+ * Answer the oldest write in the i2c queue, and the poll it sets off, as
+ * the eeprom would once its write cycle is done. The transactions stay in
+ * the queue.
+ */
+template <typename Handler, typename Queue>
+void finish_write_cycle(Handler& eeprom, Queue& i2c_queue) {
+    auto write_response = task::TaskMessage(i2c::messages::TransactionResponse{
+        .id = i2c::messages::TransactionIdentifier{.token =
+                                                       eeprom.WRITE_TOKEN}});
+    eeprom.handle_message(write_response);
+    auto queued = std::vector<i2c::writer::TaskMessage>{};
+    auto message = i2c::writer::TaskMessage{};
+    while (i2c_queue.try_read(&message)) {
+        queued.push_back(message);
+    }
+    auto poll = std::get<i2c::messages::Transact>(queued.back());
+    REQUIRE(poll.id.token == eeprom.ACK_POLL_TOKEN);
+    REQUIRE(poll.transaction.single_attempt);
+    queued.pop_back();
+    for (const auto& other : queued) {
+        i2c_queue.try_write(other);
+    }
+    auto poll_response = task::TaskMessage(i2c::messages::TransactionResponse{
+        .id = i2c::messages::TransactionIdentifier{.token =
+                                                       eeprom.ACK_POLL_TOKEN}});
+    eeprom.handle_message(poll_response);
+}
+
 SCENARIO("Sending messages to Eeprom task") {
     test_mocks::MockMessageQueue<i2c::writer::TaskMessage> i2c_queue{};
     test_mocks::MockI2CResponseQueue response_queue{};
@@ -36,6 +69,14 @@ SCENARIO("Sending messages to Eeprom task") {
             .memory_address = address, .length = data_length, .data = data});
         WHEN("the message is sent") {
             eeprom.handle_message(write_msg);
+            THEN("it waits for more writes to join it") {
+                REQUIRE(i2c_queue.get_size() == 0);
+                REQUIRE(eeprom.has_pending_write());
+            }
+        }
+        WHEN("the message is sent and the queue runs dry") {
+            eeprom.handle_message(write_msg);
+            eeprom.flush_write();
             THEN("the i2c queue is populated with a transact command") {
                 REQUIRE(i2c_queue.get_size() == 1);
 
@@ -72,6 +113,7 @@ SCENARIO("Sending messages to Eeprom task") {
             .memory_address = address, .length = data_length, .data = data});
         WHEN("the message is sent") {
             eeprom.handle_message(write_msg);
+            eeprom.flush_write();
             THEN("the i2c queue is not populated with a transact command") {
                 REQUIRE(i2c_queue.get_size() == 0);
             }
@@ -86,6 +128,15 @@ SCENARIO("Sending messages to Eeprom task") {
             .memory_address = address, .length = data_length, .data = data});
         WHEN("the message is sent") {
             eeprom.handle_message(write_msg);
+            eeprom.flush_write();
+            THEN("only the first page is written") {
+                REQUIRE(i2c_queue.get_size() == 1);
+            }
+        }
+        WHEN("the first page's write cycle finishes") {
+            eeprom.handle_message(write_msg);
+            eeprom.flush_write();
+            finish_write_cycle(eeprom, i2c_queue);
             THEN("the i2c queue is populated with two transact commands") {
                 REQUIRE(i2c_queue.get_size() == 2);
                 // first message
@@ -184,6 +235,7 @@ SCENARIO("Sending messages to 16 bit address Eeprom task") {
             .memory_address = address, .length = data_length, .data = data});
         WHEN("the message is sent") {
             eeprom_16.handle_message(write_msg);
+            eeprom_16.flush_write();
             THEN("the i2c queue is populated with a transact command") {
                 REQUIRE(i2c_queue.get_size() == 1);
 
@@ -222,6 +274,15 @@ SCENARIO("Sending messages to 16 bit address Eeprom task") {
             .memory_address = address, .length = data_length, .data = data});
         WHEN("the message is sent") {
             eeprom_16.handle_message(write_msg);
+            eeprom_16.flush_write();
+            THEN("only the first page is written") {
+                REQUIRE(i2c_queue.get_size() == 1);
+            }
+        }
+        WHEN("the first page's write cycle finishes") {
+            eeprom_16.handle_message(write_msg);
+            eeprom_16.flush_write();
+            finish_write_cycle(eeprom_16, i2c_queue);
             THEN("the i2c queue is populated with two transact commands") {
                 REQUIRE(i2c_queue.get_size() == 2);
 
@@ -352,6 +413,7 @@ SCENARIO("Transaction response handling.") {
         auto write_msg = task::TaskMessage(message::WriteEepromMessage{
             .memory_address = address, .length = data_length, .data = data});
         eeprom.handle_message(write_msg);
+        eeprom.flush_write();
 
         WHEN("a transaction response is sent") {
             auto transaction_response =
@@ -370,4 +432,479 @@ SCENARIO("Transaction response handling.") {
         }
     }
 }
+
+SCENARIO("Coalescing writes") {
+    test_mocks::MockMessageQueue<i2c::writer::TaskMessage> i2c_queue{};
+    test_mocks::MockI2CResponseQueue response_queue{};
+    auto writer = i2c::writer::Writer<test_mocks::MockMessageQueue>{};
+    writer.set_queue(&i2c_queue);
+    auto hardware_iface =
+        MockHardwareIface(hardware_iface::EEPromChipType::ST_M24128_BF);
+    auto eeprom =
+        task::EEPromMessageHandler{writer, response_queue, hardware_iface};
+    auto write = [&eeprom](types::address address,
+                           std::initializer_list<uint8_t> bytes) {
+        auto data = types::EepromData{};
+        std::copy(bytes.begin(), bytes.end(), data.begin());
+        auto message = task::TaskMessage(message::WriteEepromMessage{
+            .memory_address = address,
+            .length = static_cast<types::data_length>(bytes.size()),
+            .data = data});
+        eeprom.handle_message(message);
+    };
+    auto next_transaction = [&i2c_queue]() {
+        auto i2c_message = i2c::writer::TaskMessage{};
+        REQUIRE(i2c_queue.try_read(&i2c_message));
+        return std::get<i2c::messages::Transact>(i2c_message);
+    };
+
+    GIVEN("writes that follow on from each other") {
+        write(0x40, {1, 2, 3, 4});
+        write(0x44, {5, 6, 7, 8});
+        write(0x48, {9, 10});
+        eeprom.flush_write();
+        THEN("they go out as one transaction") {
+            REQUIRE(i2c_queue.get_size() == 1);
+            auto transact = next_transaction();
+            REQUIRE(transact.transaction.bytes_to_write == 12);
+            REQUIRE(transact.transaction.write_buffer ==
+                    i2c::messages::MaxMessageBuffer{0x00, 0x40, 1, 2, 3, 4, 5,
+                                                    6, 7, 8, 9, 10});
+            REQUIRE(hardware_iface.set_calls == std::vector<bool>{false});
+        }
+    }
+    GIVEN("writes that overlap") {
+        write(0x40, {1, 2, 3, 4});
+        write(0x42, {7, 8, 9});
+        write(0x41, {6});
+        eeprom.flush_write();
+        THEN("the later bytes win") {
+            auto transact = next_transaction();
+            REQUIRE(transact.transaction.bytes_to_write == 7);
+            REQUIRE(transact.transaction.write_buffer ==
+                    i2c::messages::MaxMessageBuffer{0x00, 0x40, 1, 6, 7, 8,
+                                                    9});
+        }
+    }
+    GIVEN("writes that fill a page") {
+        for (uint8_t i = 0; i < 8; ++i) {
+            auto base = static_cast<uint8_t>(i * 8);
+            write(0x40 + base,
+                  {base, uint8_t(base + 1), uint8_t(base + 2),
+                   uint8_t(base + 3), uint8_t(base + 4), uint8_t(base + 5),
+                   uint8_t(base + 6), uint8_t(base + 7)});
+        }
+        eeprom.flush_write();
+        THEN("they go out as one page write") {
+            REQUIRE(i2c_queue.get_size() == 1);
+            auto i2c_message = i2c::writer::TaskMessage{};
+            i2c_queue.try_read(&i2c_message);
+            auto page = std::get<i2c::messages::BufferWrite>(i2c_message);
+            REQUIRE(page.id.token == eeprom.PAGE_WRITE_TOKEN);
+            REQUIRE(page.size == 66);
+            REQUIRE(page.data[0] == 0x00);
+            REQUIRE(page.data[1] == 0x40);
+            for (uint8_t i = 0; i < 64; ++i) {
+                REQUIRE(page.data[2 + i] == i);
+            }
+            REQUIRE(hardware_iface.set_calls == std::vector<bool>{false});
+        }
+    }
+    GIVEN("writes on different pages") {
+        write(0x3c, {1, 2, 3, 4});
+        write(0x40, {5, 6});
+        THEN("they are not joined") {
+            REQUIRE(i2c_queue.get_size() == 1);
+            REQUIRE(next_transaction().transaction.bytes_to_write == 6);
+        }
+    }
+    GIVEN("a read after a write") {
+        write(0x40, {1, 2});
+        auto read = task::TaskMessage(
+            message::ReadEepromMessage{.memory_address = 0x40, .length = 2});
+        eeprom.handle_message(read);
+        THEN("the write goes out first") {
+            REQUIRE(!eeprom.has_pending_write());
+            REQUIRE(i2c_queue.get_size() == 1);
+            REQUIRE(next_transaction().id.token == eeprom.WRITE_TOKEN);
+        }
+        THEN("the read waits for the write cycle") {
+            finish_write_cycle(eeprom, i2c_queue);
+            REQUIRE(i2c_queue.get_size() == 2);
+            static_cast<void>(next_transaction());
+            auto transact = next_transaction();
+            REQUIRE(transact.id.token == 0);
+            REQUIRE(transact.transaction.bytes_to_read == 2);
+        }
+    }
+}
+
+template <class Message>
+using LongMockQueue = test_mocks::MockMessageQueue<Message, 32>;
+
+SCENARIO("Writing whole pages") {
+    LongMockQueue<i2c::writer::TaskMessage> i2c_queue{};
+    test_mocks::MockI2CResponseQueue response_queue{};
+    auto writer = i2c::writer::Writer<LongMockQueue>{};
+    auto hardware_iface =
+        MockHardwareIface(hardware_iface::EEPromChipType::ST_M24128_BF);
+    auto eeprom =
+        task::EEPromMessageHandler{writer, response_queue, hardware_iface};
+    auto write_page = [&eeprom](types::address address) {
+        for (types::address offset = 0; offset < 64;
+             offset += types::max_data_length) {
+            auto message = task::TaskMessage(message::WriteEepromMessage{
+                .memory_address = types::address(address + offset),
+                .length = types::max_data_length,
+                .data = types::EepromData{1, 2, 3, 4, 5, 6, 7, 8}});
+            eeprom.handle_message(message);
+        }
+        eeprom.flush_write();
+    };
+    auto count_queued = [&i2c_queue]() {
+        auto transacts = 0;
+        auto page_writes = 0;
+        auto message = i2c::writer::TaskMessage{};
+        while (i2c_queue.try_read(&message)) {
+            if (std::holds_alternative<i2c::messages::BufferWrite>(message)) {
+                page_writes++;
+            } else {
+                transacts++;
+            }
+        }
+        return std::make_pair(transacts, page_writes);
+    };
+    auto page_write_done = task::TaskMessage(i2c::messages::TransactionResponse{
+        .id = i2c::messages::TransactionIdentifier{.token = static_cast<
+                                                       uint32_t>(-4)}});
+
+    GIVEN("a page write on the bus") {
+        writer.set_queue(&i2c_queue);
+        write_page(0x40);
+        REQUIRE(count_queued() == std::make_pair(0, 1));
+        WHEN("another page is written") {
+            write_page(0x80);
+            THEN("it waits for the first one's write cycle") {
+                REQUIRE(count_queued() == std::make_pair(0, 0));
+            }
+            AND_WHEN("the first one's write cycle is done") {
+                eeprom.handle_message(page_write_done);
+                auto poll_done =
+                    task::TaskMessage(i2c::messages::TransactionResponse{
+                        .id = i2c::messages::TransactionIdentifier{
+                            .token = eeprom.ACK_POLL_TOKEN}});
+                eeprom.handle_message(poll_done);
+                THEN("it goes out as a page write") {
+                    // the ack poll, then the page
+                    REQUIRE(count_queued() == std::make_pair(1, 1));
+                    REQUIRE(hardware_iface.set_calls ==
+                            std::vector<bool>{false, true, false});
+                }
+            }
+        }
+        WHEN("so many transfers wait on it that they all have to go out") {
+            for (std::size_t i = 0; i < eeprom.MAX_HELD; ++i) {
+                auto read = task::TaskMessage(message::ReadEepromMessage{
+                    .memory_address = 0x100, .length = 2});
+                eeprom.handle_message(read);
+            }
+            write_page(0x80);
+            THEN("the page still in use is not overwritten") {
+                // the reads, then the second page as transaction sized
+                // writes of 14 bytes
+                REQUIRE(count_queued() ==
+                        std::make_pair(int(eeprom.MAX_HELD) + 5, 0));
+            }
+        }
+    }
+}
+
+SCENARIO("Polling the eeprom after a write") {
+    test_mocks::MockMessageQueue<i2c::writer::TaskMessage> i2c_queue{};
+    test_mocks::MockI2CResponseQueue response_queue{};
+    auto writer = i2c::writer::Writer<test_mocks::MockMessageQueue>{};
+    writer.set_queue(&i2c_queue);
+    auto hardware_iface = MockHardwareIface{};
+    auto eeprom =
+        task::EEPromMessageHandler{writer, response_queue, hardware_iface};
+    auto poll_response = [](bool failed) {
+        return task::TaskMessage(i2c::messages::TransactionResponse{
+            .id = i2c::messages::TransactionIdentifier{.token = static_cast<
+                                                           uint32_t>(-2)},
+            .failed = failed});
+    };
+
+    GIVEN("a write followed by a read") {
+        auto write = task::TaskMessage(message::WriteEepromMessage{
+            .memory_address = 8, .length = 1, .data = {1}});
+        auto read = task::TaskMessage(
+            message::ReadEepromMessage{.memory_address = 8, .length = 1});
+        eeprom.handle_message(write);
+        eeprom.handle_message(read);
+        auto write_response =
+            task::TaskMessage(i2c::messages::TransactionResponse{
+                .id = i2c::messages::TransactionIdentifier{
+                    .token = eeprom.WRITE_TOKEN}});
+        eeprom.handle_message(write_response);
+        auto i2c_message = i2c::writer::TaskMessage{};
+        i2c_queue.try_read(&i2c_message);
+        WHEN("the write completes") {
+            THEN("the eeprom is polled with just the memory address") {
+                REQUIRE(i2c_queue.get_size() == 1);
+                i2c_queue.try_read(&i2c_message);
+                auto poll = std::get<i2c::messages::Transact>(i2c_message);
+                REQUIRE(poll.id.token == eeprom.ACK_POLL_TOKEN);
+                REQUIRE(poll.transaction.single_attempt);
+                REQUIRE(poll.transaction.bytes_to_write == 1);
+                REQUIRE(poll.transaction.bytes_to_read == 0);
+            }
+        }
+        WHEN("the eeprom does not answer the poll") {
+            i2c_queue.reset();
+            auto busy = poll_response(true);
+            eeprom.handle_message(busy);
+            THEN("it waits to be sent again and the read keeps waiting") {
+                REQUIRE(i2c_queue.get_size() == 0);
+                REQUIRE(eeprom.has_ack_poll_retry());
+            }
+            AND_WHEN("the tick has not moved on") {
+                eeprom.retry_ack_poll(0);
+                THEN("nothing is sent") { REQUIRE(i2c_queue.get_size() == 0); }
+            }
+            AND_WHEN("the next tick comes") {
+                eeprom.retry_ack_poll(1);
+                THEN("it is polled again") {
+                    REQUIRE(i2c_queue.get_size() == 1);
+                    i2c_queue.try_read(&i2c_message);
+                    REQUIRE(std::get<i2c::messages::Transact>(i2c_message)
+                                .id.token == eeprom.ACK_POLL_TOKEN);
+                    REQUIRE(!eeprom.has_ack_poll_retry());
+                }
+            }
+        }
+        WHEN("the eeprom answers the poll") {
+            i2c_queue.reset();
+            auto done = poll_response(false);
+            eeprom.handle_message(done);
+            THEN("the read goes out") {
+                REQUIRE(i2c_queue.get_size() == 1);
+                i2c_queue.try_read(&i2c_message);
+                REQUIRE(std::get<i2c::messages::Transact>(i2c_message)
+                            .id.token == 0);
+            }
+        }
+        WHEN("the eeprom never answers") {
+            for (uint32_t i = 0; i < eeprom.MAX_ACK_POLLS; ++i) {
+                i2c_queue.reset();
+                auto busy = poll_response(true);
+                eeprom.handle_message(busy);
+                eeprom.retry_ack_poll();
+            }
+            THEN("polling stops and the read goes out") {
+                REQUIRE(i2c_queue.get_size() == 1);
+                i2c_queue.try_read(&i2c_message);
+                REQUIRE(std::get<i2c::messages::Transact>(i2c_message)
+                            .id.token == 0);
+            }
+        }
+    }
+}
+
+SCENARIO("Waiting for writes to finish") {
+    test_mocks::MockMessageQueue<i2c::writer::TaskMessage> i2c_queue{};
+    test_mocks::MockI2CResponseQueue response_queue{};
+    auto writer = i2c::writer::Writer<test_mocks::MockMessageQueue>{};
+    writer.set_queue(&i2c_queue);
+    auto hardware_iface = MockHardwareIface{};
+    auto eeprom =
+        task::EEPromMessageHandler{writer, response_queue, hardware_iface};
+    auto answered = 0;
+    auto barrier = task::TaskMessage(message::WriteBarrierMessage{
+        .callback = [](void* param) { ++*static_cast<int*>(param); },
+        .callback_param = &answered});
+
+    GIVEN("no writes") {
+        eeprom.handle_message(barrier);
+        THEN("the barrier is answered straight away") {
+            REQUIRE(answered == 1);
+        }
+    }
+    GIVEN("a write that is still gathering") {
+        auto write = task::TaskMessage(message::WriteEepromMessage{
+            .memory_address = 8, .length = 1, .data = {1}});
+        eeprom.handle_message(write);
+        eeprom.handle_message(barrier);
+        THEN("the write goes out and the barrier waits") {
+            REQUIRE(i2c_queue.get_size() == 1);
+            REQUIRE(answered == 0);
+        }
+        WHEN("the write has been sent") {
+            auto write_response =
+                task::TaskMessage(i2c::messages::TransactionResponse{
+                    .id = i2c::messages::TransactionIdentifier{
+                        .token = eeprom.WRITE_TOKEN}});
+            eeprom.handle_message(write_response);
+            THEN("the barrier waits for the write cycle") {
+                REQUIRE(answered == 0);
+            }
+            AND_WHEN("the eeprom answers the poll") {
+                auto done = task::TaskMessage(
+                    i2c::messages::TransactionResponse{
+                        .id = i2c::messages::TransactionIdentifier{
+                            .token = eeprom.ACK_POLL_TOKEN}});
+                eeprom.handle_message(done);
+                THEN("the barrier is answered once") {
+                    REQUIRE(answered == 1);
+                    eeprom.handle_message(done);
+                    REQUIRE(answered == 1);
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("Serving reads from the eeprom shadow") {
+    test_mocks::MockMessageQueue<i2c::writer::TaskMessage> i2c_queue{};
+    test_mocks::MockI2CResponseQueue response_queue{};
+    auto writer = i2c::writer::Writer<test_mocks::MockMessageQueue>{};
+    writer.set_queue(&i2c_queue);
+    auto hardware_iface = MockHardwareIface{};
+
+    auto eeprom =
+        task::EEPromMessageHandler{writer, response_queue, hardware_iface};
+    auto read_response_handler = ReadResponseHandler{};
+    auto read_at = [&](types::address address, types::data_length length) {
+        return task::TaskMessage(message::ReadEepromMessage{
+            .memory_address = address,
+            .length = length,
+            .callback = ReadResponseHandler::callback,
+            .callback_param = &read_response_handler});
+    };
+    // Answer the chunk read in the i2c queue as an eeprom whose every byte
+    // holds its own address, and return that address.
+    auto answer_chunk = [&](bool failed) -> uint8_t {
+        auto i2c_message = i2c::writer::TaskMessage{};
+        REQUIRE(i2c_queue.try_read(&i2c_message));
+        auto chunk = std::get<i2c::messages::Transact>(i2c_message);
+        REQUIRE(chunk.id.token == eeprom.SHADOW_TOKEN);
+        auto address = chunk.transaction.write_buffer[0];
+        auto response = i2c::messages::TransactionResponse{
+            .id = chunk.id,
+            .bytes_read = chunk.transaction.bytes_to_read,
+            .failed = failed};
+        for (std::size_t i = 0; i < chunk.transaction.bytes_to_read; ++i) {
+            response.read_buffer[i] = static_cast<uint8_t>(address + i);
+        }
+        auto message = task::TaskMessage(response);
+        eeprom.handle_message(message);
+        return address;
+    };
+
+    GIVEN("a shadow that is loading") {
+        eeprom.load_shadow();
+        THEN("the first chunk is read from the start of the eeprom") {
+            REQUIRE(i2c_queue.get_size() == 1);
+            auto i2c_message = i2c::writer::TaskMessage{};
+            i2c_queue.try_read(&i2c_message);
+            auto chunk = std::get<i2c::messages::Transact>(i2c_message);
+            REQUIRE(chunk.id.token == eeprom.SHADOW_TOKEN);
+            REQUIRE(chunk.transaction.write_buffer[0] == 0);
+            REQUIRE(chunk.transaction.bytes_to_read ==
+                    i2c::messages::MAX_BUFFER_SIZE);
+        }
+        WHEN("one chunk has been read") {
+            REQUIRE(answer_chunk(false) == 0);
+            THEN("the next chunk is read after it") {
+                REQUIRE(answer_chunk(false) ==
+                        i2c::messages::MAX_BUFFER_SIZE);
+            }
+            AND_WHEN("a read falls in it") {
+                auto read = read_at(4, 3);
+                eeprom.handle_message(read);
+                THEN("it is answered without the bus") {
+                    REQUIRE(i2c_queue.get_size() == 1);
+                    REQUIRE(read_response_handler.message ==
+                            message::EepromMessage{
+                                .memory_address = 4,
+                                .length = 3,
+                                .data = types::EepromData{4, 5, 6}});
+                }
+            }
+            AND_WHEN("a read falls past it") {
+                auto read = read_at(40, 3);
+                eeprom.handle_message(read);
+                THEN("it goes to the eeprom") {
+                    REQUIRE(i2c_queue.get_size() == 2);
+                }
+            }
+        }
+        WHEN("the chunk being read is written to") {
+            auto write = task::TaskMessage(message::WriteEepromMessage{
+                .memory_address = 2,
+                .length = 2,
+                .data = types::EepromData{0xaa, 0xbb}});
+            eeprom.handle_message(write);
+            REQUIRE(answer_chunk(false) == 0);
+            THEN("the chunk is read again once the write is done") {
+                eeprom.flush_write();
+                finish_write_cycle(eeprom, i2c_queue);
+                auto i2c_message = i2c::writer::TaskMessage{};
+                i2c_queue.try_read(&i2c_message);
+                REQUIRE(std::get<i2c::messages::Transact>(i2c_message)
+                            .id.token == eeprom.WRITE_TOKEN);
+                REQUIRE(answer_chunk(false) == 0);
+            }
+        }
+        WHEN("a chunk cannot be read") {
+            answer_chunk(true);
+            THEN("loading stops") { REQUIRE(i2c_queue.get_size() == 0); }
+        }
+    }
+
+    GIVEN("a loaded shadow") {
+        eeprom.load_shadow();
+        for (std::size_t i = 0;
+             i < hardware_iface.get_eeprom_mem_size() /
+                     i2c::messages::MAX_BUFFER_SIZE;
+             ++i) {
+            answer_chunk(false);
+        }
+        REQUIRE(i2c_queue.get_size() == 0);
+        WHEN("reads come in") {
+            auto first = read_at(0, 8);
+            eeprom.handle_message(first);
+            auto last = read_at(250, 6);
+            eeprom.handle_message(last);
+            THEN("none of them use the bus") {
+                REQUIRE(i2c_queue.get_size() == 0);
+                REQUIRE(read_response_handler.message ==
+                        message::EepromMessage{
+                            .memory_address = 250,
+                            .length = 6,
+                            .data = types::EepromData{250, 251, 252, 253, 254,
+                                                      255}});
+            }
+        }
+        WHEN("a read follows a write that has not gone out") {
+            auto write = task::TaskMessage(message::WriteEepromMessage{
+                .memory_address = 100,
+                .length = 2,
+                .data = types::EepromData{0xaa, 0xbb}});
+            eeprom.handle_message(write);
+            auto read = read_at(99, 4);
+            eeprom.handle_message(read);
+            THEN("the read sees the write") {
+                REQUIRE(read_response_handler.message ==
+                        message::EepromMessage{
+                            .memory_address = 99,
+                            .length = 4,
+                            .data = types::EepromData{99, 0xaa, 0xbb, 102}});
+            }
+            THEN("the write is still gathering") {
+                REQUIRE(eeprom.has_pending_write());
+                REQUIRE(i2c_queue.get_size() == 0);
+            }
+        }
+    }
+}
 }  // namespace eeprom
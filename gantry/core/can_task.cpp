@@ -2,6 +2,7 @@
 
 #include <span>
 
+#include "can/core/acceptance_filter.hpp"
 #include "can/core/can_bus.hpp"
 #include "can/core/can_writer_task.hpp"
 #include "can/core/dispatch.hpp"
@@ -10,6 +11,7 @@
 #include "can/core/message_handlers/motor.hpp"
 #include "can/core/message_handlers/move_group.hpp"
 #include "can/core/message_handlers/system.hpp"
+#include "can/core/message_writer.hpp"
 #include "common/core/freertos_task.hpp"
 #include "common/core/logging.h"
 #include "common/core/version.h"
@@ -76,13 +78,12 @@ static auto dispatcher =
                                    system_dispatch_target,
                                    eeprom_dispatch_target};
 
-auto static reader_message_buffer =
-    can::freertos_dispatch::FreeRTOSCanBufferControl<
-        can_task::reader_message_buffer_size, decltype(dispatcher)>{dispatcher};
-
-auto static reader_task = can_task::CanMessageReaderTask{reader_message_buffer};
+auto static reader_task = can_task::CanMessageReaderTask{dispatcher};
 auto static writer_task = can_task::CanMessageWriterTask{can_sender_queue};
 
+/** Tells the host when received frames are dropped. */
+static auto drop_reporter = can::message_writer::MessageWriter{my_node_id};
+
 auto static reader_task_control =
     freertos_task::FreeRTOSTask<512, can_task::CanMessageReaderTask>{
         reader_task};
@@ -99,7 +100,10 @@ auto can_task::start_reader(can::bus::CanBus& canbus)
     -> can_task::CanMessageReaderTask& {
     LOG("Starting the CAN reader task");
 
-    canbus.setup_node_id_filter(my_node_id);
+    can::acceptance_filter::add_filters(
+        canbus,
+        can::acceptance_filter::compile_for<can_task::GantryDispatcherType>(
+            my_node_id));
 
     reader_task_control.start(5, "can reader task", &canbus);
 
@@ -115,6 +119,8 @@ auto can_task::start_writer(can::bus::CanBus& canbus)
     -> can_task::CanMessageWriterTask& {
     LOG("Starting the CAN writer task");
 
+    drop_reporter.set_writer(writer_task);
+    reader_task.set_drop_reporter(drop_reporter);
     writer_task_control.start(5, "can writer task", &canbus);
     return writer_task;
 }
@@ -72,7 +72,7 @@ void gantry::tasks::start_tasks(
         move_group_task_builder.start(5, "move group", ::queues, ::queues);
     auto& move_status_reporter = move_status_task_builder.start(
         5, "move status", ::queues, motion_controller.get_mechanical_config(),
-        ::queues);
+        ::queues, ::queues.move_status_events);
 
     auto& spi_task = spi_task_builder.start(5, "spi task", spi_device);
     spi_task_client.set_queue(&spi_task.get_queue());
@@ -106,7 +106,7 @@ void gantry::tasks::start_tasks(
     ::queues.motion_queue = &motion.get_queue();
     ::queues.motor_driver_queue = &tmc2160_driver.get_queue();
     ::queues.move_group_queue = &move_group.get_queue();
-    ::queues.set_queue(&can_writer.get_queue());
+    ::queues.set_writer(can_writer);
     ::queues.move_status_report_queue = &move_status_reporter.get_queue();
     ::queues.spi_queue = &spi_task.get_queue();
     ::queues.i2c2_queue = &i2c2_task.get_queue();
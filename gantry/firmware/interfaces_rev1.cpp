@@ -244,10 +244,10 @@ static auto canbus = can::hal::bus::HalCanBus(
 /**
  * The pending move queue
  */
-static freertos_message_queue::FreeRTOSMessageQueue<motor_messages::Move>
+static spsc_message_queue::SPSCMessageQueue<motor_messages::Move>
     motor_queue("Motor Queue");
 
-static freertos_message_queue::FreeRTOSMessageQueue<
+static spsc_message_queue::SPSCMessageQueue<
     can::messages::UpdateMotorPositionEstimationRequest>
     update_position_queue("Position Queue");
 
@@ -271,8 +271,8 @@ static stall_check::StallCheck stallcheck(
  * Handler of motor interrupts.
  */
 static motor_handler::MotorInterruptHandler motor_interrupt(
-    motor_queue, gantry::queues::get_queues(), motor_hardware_iface, stallcheck,
-    update_position_queue);
+    motor_queue, gantry::queues::get_queues().move_status_events,
+    motor_hardware_iface, stallcheck, update_position_queue);
 
 static auto encoder_background_timer =
     motor_encoder::BackgroundTimer(motor_interrupt, motor_hardware_iface);
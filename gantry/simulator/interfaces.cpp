@@ -38,10 +38,10 @@ static auto motor_interface = sim_motor_hardware_iface::SimMotorHardwareIface(
 /**
  * The pending move queue
  */
-static freertos_message_queue::FreeRTOSMessageQueue<motor_messages::Move>
+static spsc_message_queue::SPSCMessageQueue<motor_messages::Move>
     motor_queue("Motor Queue");
 
-static freertos_message_queue::FreeRTOSMessageQueue<
+static spsc_message_queue::SPSCMessageQueue<
     can::messages::UpdateMotorPositionEstimationRequest>
     update_position_queue("Position Queue");
 
@@ -89,8 +89,8 @@ static stall_check::StallCheck stallcheck(
  * Handler of motor interrupts.
  */
 static motor_handler::MotorInterruptHandler motor_interrupt(
-    motor_queue, gantry::queues::get_queues(), motor_interface, stallcheck,
-    update_position_queue);
+    motor_queue, gantry::queues::get_queues().move_status_events,
+    motor_interface, stallcheck, update_position_queue);
 
 static motor_interrupt_driver::MotorInterruptDriver A(motor_queue,
                                                       motor_interrupt,
@@ -33,6 +33,9 @@ def generate_can_cpp(output: io.StringIO, constants_mod: ModuleType) -> None:
         write_enum_cpp(constants_mod.SensorType, output)
         write_enum_cpp(constants_mod.SensorId, output)
         write_enum_cpp(constants_mod.SensorOutputBinding, output)
+        # Newer than the pinned opentrons_hardware, which lacks it
+        if hasattr(constants_mod, "SensorStreamMode"):
+            write_enum_cpp(constants_mod.SensorStreamMode, output)
         write_enum_cpp(constants_mod.SensorThresholdMode, output)
         write_enum_cpp(constants_mod.PipetteTipActionType, output)
         write_enum_cpp(constants_mod.GearMotorId, output)
@@ -53,6 +56,8 @@ def generate_can_c(output: io.StringIO, constants_mod: ModuleType, arbitration_i
     write_enum_c(constants_mod.SensorType, output, can)
     write_enum_c(constants_mod.SensorId, output, can)
     write_enum_c(constants_mod.SensorOutputBinding, output, can)
+    if hasattr(constants_mod, "SensorStreamMode"):
+        write_enum_c(constants_mod.SensorStreamMode, output, can)
     write_enum_c(constants_mod.SensorThresholdMode, output, can)
     write_enum_c(constants_mod.PipetteTipActionType, output, can)
     write_enum_c(constants_mod.GearMotorId, output, can)
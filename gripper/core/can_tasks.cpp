@@ -1,7 +1,11 @@
 #include <span>
 
+#include "can/core/acceptance_filter.hpp"
+#include "can/core/message_writer.hpp"
 #include "eeprom/core/message_handler.hpp"
 #include "gripper/core/can_task.hpp"
+#include "motor-control/core/tasks/brushed_move_group_task.hpp"
+#include "motor-control/core/tasks/move_group_task.hpp"
 
 using namespace can::dispatch;
 
@@ -91,16 +95,16 @@ CheckForNodeId check_for_z{.node_id = can::ids::NodeId::gripper_z};
 
 CheckForNodeId check_for_g{.node_id = can::ids::NodeId::gripper_g};
 
-static auto dispatcher_z = can::dispatch::Dispatcher(
+static auto dispatcher_z = can::dispatch::ParsingDispatcher(
     check_for_z, motor_dispatch_target, motion_group_dispatch_target,
     motion_dispatch_target);
 
-static auto dispatcher_g = can::dispatch::Dispatcher(
+static auto dispatcher_g = can::dispatch::ParsingDispatcher(
     check_for_g, brushed_motion_dispatch_target, brushed_motor_dispatch_target,
     brushed_motion_group_dispatch_target);
 
 /** Dispatcher to the various handlers */
-static auto main_dispatcher = can::dispatch::Dispatcher(
+static auto main_dispatcher = can::dispatch::ParsingDispatcher(
     [](uint32_t arbitration_id) -> bool {
         auto arb = can::arbitration_id::ArbitrationId(arbitration_id);
         auto node_id = arb.node_id();
@@ -113,10 +117,23 @@ static auto main_dispatcher = can::dispatch::Dispatcher(
     gripper_info_dispatch_target, eeprom_dispatch_target,
     sensor_dispatch_target);
 
-auto static reader_message_buffer =
-    freertos_message_buffer::FreeRTOSMessageBuffer<1024>{};
-static auto reader_message_buffer_writer =
-    can::message_buffer::CanMessageBufferWriter(reader_message_buffer);
+/** Receive filters for the messages main_dispatcher takes */
+static constexpr auto receive_filters =
+    can::acceptance_filter::compile_for<decltype(main_dispatcher)>(
+        can::ids::NodeId::gripper, can::ids::NodeId::gripper_z,
+        can::ids::NodeId::gripper_g);
+
+/** Room for a full move group to both the z stage and the jaw. */
+static constexpr auto reader_frame_pool_size =
+    can::frame_pool::pool_size_for_burst(
+        move_group_task::max_moves_per_group +
+        brushed_move_group_task::max_moves_per_group);
+auto static reader_frame_pool =
+    can::freertos_dispatch::FreeRTOSCanFramePool<reader_frame_pool_size>{};
+
+/** Tells the host when received frames are dropped. */
+static auto drop_reporter =
+    can::message_writer::MessageWriter{can::ids::NodeId::gripper};
 
 /**
  * New CAN message callback.
@@ -126,8 +143,7 @@ static auto reader_message_buffer_writer =
  * @param length Message data length
  */
 void callback(void*, uint32_t identifier, uint8_t* data, uint8_t length) {
-    reader_message_buffer_writer.send_from_isr(identifier, data,
-                                               data + length);  // NOLINT
+    reader_frame_pool.send_from_isr(identifier, data, data + length);  // NOLINT
 }
 
 /**
@@ -139,33 +155,12 @@ void callback(void*, uint32_t identifier, uint8_t* data, uint8_t length) {
     can::bus::CanBus* can_bus) {
     can_bus->set_incoming_message_callback(nullptr, callback);
 
-    auto filter = can::arbitration_id::ArbitrationId();
-
-    // Accept broadcast
-    filter.node_id(can::ids::NodeId::broadcast);
-    can_bus->add_filter(CanFilterType::mask, CanFilterConfig::to_fifo0, filter,
-                        can::arbitration_id::ArbitrationId::node_id_bit_mask);
-
-    // Accept any gripper
-    filter.node_id(can::ids::NodeId::gripper);
-    can_bus->add_filter(CanFilterType::mask, CanFilterConfig::to_fifo1, filter,
-                        can::arbitration_id::ArbitrationId::node_id_bit_mask);
-
-    // Accept gripper z
-    filter.node_id(can::ids::NodeId::gripper_z);
-    can_bus->add_filter(CanFilterType::mask, CanFilterConfig::to_fifo1, filter,
-                        can::arbitration_id::ArbitrationId::node_id_bit_mask);
-
-    // Accept gripper g
-    filter.node_id(can::ids::NodeId::gripper_g);
-    can_bus->add_filter(CanFilterType::mask, CanFilterConfig::to_fifo1, filter,
-                        can::arbitration_id::ArbitrationId::node_id_bit_mask);
-
-    // Reject everything else.
-    can_bus->add_filter(CanFilterType::mask, CanFilterConfig::reject, 0, 0);
+    // Accept broadcast and any gripper, for the messages the dispatcher
+    // takes. Reject everything else.
+    can::acceptance_filter::add_filters(*can_bus, receive_filters);
 
-    auto poller = can::freertos_dispatch::FreeRTOSCanBufferPoller(
-        reader_message_buffer, main_dispatcher);
+    auto poller = can::freertos_dispatch::FreeRTOSCanFramePoller(
+        reader_frame_pool, main_dispatcher);
     poller();
 }
 
@@ -201,6 +196,8 @@ auto can_task::start_writer(can::bus::CanBus& canbus)
     -> can_task::CanMessageWriterTask& {
     LOG("Starting the CAN writer task");
 
+    drop_reporter.set_writer(writer_task);
+    reader_frame_pool.set_drop_reporter(drop_reporter);
     writer_task_control.start(5, "can writer task", &canbus);
     return writer_task;
 }
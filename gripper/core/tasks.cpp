@@ -16,9 +16,9 @@
 
 static auto tasks = gripper_tasks::AllTask{};
 static auto queues = gripper_tasks::QueueClient{can::ids::NodeId::gripper};
-static std::array<float, SENSOR_BUFFER_SIZE> sensor_buffer;
+static SensorBuffer sensor_buffer;
 #ifdef USE_TWO_BUFFERS
-static std::array<float, SENSOR_BUFFER_SIZE> sensor_buffer_front;
+static SensorBuffer sensor_buffer_front;
 #endif
 
 static auto eeprom_task_builder =
@@ -76,7 +76,7 @@ void gripper_tasks::start_tasks(
     auto& can_writer = can_task::start_writer(can_bus);
     can_task::start_reader(can_bus);
     tasks.can_writer = &can_writer;
-    queues.set_queue(&can_writer.get_queue());
+    queues.set_writer(can_writer);
 
     auto& i2c2_task = i2c2_task_builder.start(5, "i2c2", i2c2);
     i2c2_task_client.set_queue(&i2c2_task.get_queue());
@@ -136,8 +136,8 @@ void gripper_tasks::start_tasks(
 
     g_tasks::start_task(grip_motor, tasks, queues, tail_accessor);
 
-    z_tasks::get_queues().set_queue(&can_writer.get_queue());
-    g_tasks::get_queues().set_queue(&can_writer.get_queue());
+    z_tasks::get_queues().set_writer(can_writer);
+    g_tasks::get_queues().set_writer(can_writer);
 
     zmh_tsk.start_task();
     gmh_tsk.start_task();
@@ -49,7 +49,8 @@ void z_tasks::start_task(
         5, "tmc2130 driver", driver_configs, z_queues, spi_task_client);
     auto& move_status_reporter = move_status_task_builder.start(
         5, "move status", z_queues,
-        z_motor.motion_controller.get_mechanical_config(), z_queues);
+        z_motor.motion_controller.get_mechanical_config(), z_queues,
+        z_queues.move_status_events);
     auto& spi_task = spi_task_builder.start(5, "spi", spi_device);
 #if PCBA_PRIMARY_REVISION != 'b'
     auto& z_usage_storage_task = z_usage_storage_task_builder.start(
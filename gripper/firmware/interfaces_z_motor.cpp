@@ -158,15 +158,14 @@ static tmc2130::configs::TMC2130DriverConfig MotorDriverConfigurations{
  * The pending move queue
  */
 #ifdef USE_SENSOR_MOVE
-static freertos_message_queue::FreeRTOSMessageQueue<
-    motor_messages::SensorSyncMove>
+static spsc_message_queue::SPSCMessageQueue<motor_messages::SensorSyncMove>
     motor_queue("Motor Queue");
 #else
-static freertos_message_queue::FreeRTOSMessageQueue<motor_messages::Move>
+static spsc_message_queue::SPSCMessageQueue<motor_messages::Move>
     motor_queue("Motor Queue");
 #endif
 
-static freertos_message_queue::FreeRTOSMessageQueue<
+static spsc_message_queue::SPSCMessageQueue<
     can::messages::UpdateMotorPositionEstimationRequest>
     update_position_queue("Position Queue");
 
@@ -203,8 +202,8 @@ static motor_class::Motor z_motor{
  * Handler of motor interrupts.
  */
 static motor_handler::MotorInterruptHandler motor_interrupt(
-    motor_queue, gripper_tasks::z_tasks::get_queues(), motor_hardware_iface,
-    stallcheck, update_position_queue);
+    motor_queue, gripper_tasks::z_tasks::get_queues().move_status_events,
+    motor_hardware_iface, stallcheck, update_position_queue);
 
 static auto encoder_background_timer =
     motor_encoder::BackgroundTimer(motor_interrupt, motor_hardware_iface);
@@ -234,6 +233,11 @@ auto z_motor_iface::get_z_motor() -> motor_class::Motor<lms::LeadScrewConfig>& {
     return z_motor;
 }
 
+auto z_motor_iface::get_z_motor_hardware()
+    -> motor_hardware::StepperMotorHardwareIface& {
+    return motor_hardware_iface;
+}
+
 auto z_motor_iface::get_tmc2130_driver_configs()
     -> tmc2130::configs::TMC2130DriverConfig& {
     return MotorDriverConfigurations;
@@ -118,6 +118,15 @@ auto main() -> int {
     i2c_comms2.set_handle(i2c_handles.i2c2);
     i2c_comms3.set_handle(i2c_handles.i2c3);
 
+    // samples are stamped with the scheduler tick and the z position
+    sensor_hardware.set_sample_stamp_source(
+        sensors::hardware::SampleStampSource{
+            .tick = []() -> uint32_t { return xTaskGetTickCount(); },
+            .step_position = []() -> uint32_t {
+                return z_motor_iface::get_z_motor_hardware()
+                    .get_step_tracker();
+            }});
+
     canbus.start(can_bit_timings);
     gripper_tasks::start_tasks(
         canbus, z_motor_iface::get_z_motor(),
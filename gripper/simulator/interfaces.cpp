@@ -29,15 +29,14 @@ static auto motor_interface =
  */
 
 #ifdef USE_SENSOR_MOVE
-static freertos_message_queue::FreeRTOSMessageQueue<
-    motor_messages::SensorSyncMove>
+static spsc_message_queue::SPSCMessageQueue<motor_messages::SensorSyncMove>
     motor_queue("Motor Queue");
 #else
-static freertos_message_queue::FreeRTOSMessageQueue<motor_messages::Move>
+static spsc_message_queue::SPSCMessageQueue<motor_messages::Move>
     motor_queue("Motor Queue");
 #endif
 
-static freertos_message_queue::FreeRTOSMessageQueue<
+static spsc_message_queue::SPSCMessageQueue<
     can::messages::UpdateMotorPositionEstimationRequest>
     update_position_queue("Position Queue");
 
@@ -101,8 +100,8 @@ static stall_check::StallCheck stallcheck(
  * Handler of motor interrupts.
  */
 static motor_handler::MotorInterruptHandler motor_interrupt(
-    motor_queue, gripper_tasks::z_tasks::get_queues(), motor_interface,
-    stallcheck, update_position_queue);
+    motor_queue, gripper_tasks::z_tasks::get_queues().move_status_events,
+    motor_interface, stallcheck, update_position_queue);
 
 static motor_interrupt_driver::MotorInterruptDriver A(motor_queue,
                                                       motor_interrupt,
@@ -2,6 +2,7 @@
 
 #include <span>
 
+#include "can/core/acceptance_filter.hpp"
 #include "can/core/dispatch.hpp"
 #include "can/core/freertos_can_dispatch.hpp"
 #include "can/core/ids.hpp"
@@ -10,12 +11,14 @@
 #include "can/core/message_handlers/move_group.hpp"
 #include "can/core/message_handlers/presence_sensing.hpp"
 #include "can/core/message_handlers/system.hpp"
+#include "can/core/message_writer.hpp"
 #include "can/core/messages.hpp"
 #include "common/core/freertos_message_queue.hpp"
 #include "common/core/freertos_task.hpp"
 #include "common/core/version.h"
 #include "eeprom/core/message_handler.hpp"
 #include "head/core/queues.hpp"
+#include "motor-control/core/tasks/move_group_task.hpp"
 
 static auto& right_queues = head_tasks::get_right_queues();
 static auto& left_queues = head_tasks::get_left_queues();
@@ -36,7 +39,9 @@ using MoveGroupDispatchTarget = can::dispatch::DispatchParseTarget<
     can::messages::AddLinearMoveRequest,
     can::messages::ClearAllMoveGroupsRequest,
     can::messages::ExecuteMoveGroupRequest, can::messages::GetMoveGroupRequest,
-    can::messages::HomeRequest, can::messages::StopRequest>;
+    can::messages::HomeRequest, can::messages::StopRequest,
+    can::messages::AddJerkMoveRequest, can::messages::ExecuteMoveStreamRequest,
+    can::messages::EndMoveStreamRequest>;
 using MotionControllerDispatchTarget = can::dispatch::DispatchParseTarget<
     can::message_handlers::motion::MotionHandler<head_tasks::MotorQueueClient>,
     can::messages::DisableMotorRequest, can::messages::EnableMotorRequest,
@@ -50,7 +55,8 @@ using SystemDispatchTarget = can::dispatch::DispatchParseTarget<
     can::message_handlers::system::SystemMessageHandler<
         head_tasks::HeadQueueClient>,
     can::messages::DeviceInfoRequest, can::messages::InitiateFirmwareUpdate,
-    can::messages::FirmwareUpdateStatusRequest, can::messages::TaskInfoRequest>;
+    can::messages::FirmwareUpdateStatusRequest, can::messages::TaskInfoRequest,
+    can::messages::TransmitLaneStatusRequest>;
 using PresenceSensingDispatchTarget = can::dispatch::DispatchParseTarget<
     can::message_handlers::presence_sensing::PresenceSensingHandler<
         head_tasks::HeadQueueClient>,
@@ -133,16 +139,16 @@ CheckForNodeId check_for_node_id_left{.node_id = can::ids::NodeId::head_l};
 CheckForNodeId check_for_node_id_right{.node_id = can::ids::NodeId::head_r};
 
 /** Dispatcher to the various right motor handlers */
-static auto dispatcher_right_motor = can::dispatch::Dispatcher(
+static auto dispatcher_right_motor = can::dispatch::ParsingDispatcher(
     check_for_node_id_right, motor_dispatch_target_right,
     motion_dispatch_target_right, move_group_dispatch_target_right);
 
 /** Dispatcher to the various left motor handlers */
-static auto dispatcher_left_motor = can::dispatch::Dispatcher(
+static auto dispatcher_left_motor = can::dispatch::ParsingDispatcher(
     check_for_node_id_left, motor_dispatch_target_left,
     motion_dispatch_target_left, move_group_dispatch_target_left);
 
-static auto main_dispatcher = can::dispatch::Dispatcher(
+static auto main_dispatcher = can::dispatch::ParsingDispatcher(
     [](uint32_t arbitration_id) -> bool {
         auto arb = can::arbitration_id::ArbitrationId(arbitration_id);
         auto node_id = arb.node_id();
@@ -155,13 +161,25 @@ static auto main_dispatcher = can::dispatch::Dispatcher(
     presence_sensing_dispatch_target, system_dispatch_target,
     eeprom_dispatch_target);
 
+/** Receive filters for the messages main_dispatcher takes */
+static constexpr auto receive_filters =
+    can::acceptance_filter::compile_for<decltype(main_dispatcher)>(
+        can::ids::NodeId::head, can::ids::NodeId::head_l,
+        can::ids::NodeId::head_r);
+
 /**
- * The type of the message buffer populated by HAL ISR.
+ * The pool of frame slots populated by HAL ISR, with room for a full move
+ * group to both mounts.
  */
-static auto read_can_message_buffer =
-    freertos_message_buffer::FreeRTOSMessageBuffer<1024>{};
-static auto read_can_message_buffer_writer =
-    can::message_buffer::CanMessageBufferWriter(read_can_message_buffer);
+static constexpr auto read_can_frame_pool_size =
+    can::frame_pool::pool_size_for_burst(
+        2 * move_group_task::max_moves_per_group);
+static auto read_can_frame_pool =
+    can::freertos_dispatch::FreeRTOSCanFramePool<read_can_frame_pool_size>{};
+
+/** Tells the host when received frames are dropped. */
+static auto drop_reporter =
+    can::message_writer::MessageWriter{can::ids::NodeId::head};
 
 /**
  * New CAN message callback.
@@ -171,8 +189,8 @@ static auto read_can_message_buffer_writer =
  * @param length Message data length
  */
 void callback(void*, uint32_t identifier, uint8_t* data, uint8_t length) {
-    read_can_message_buffer_writer.send_from_isr(identifier, data,
-                                                 data + length);  // NOLINT
+    read_can_frame_pool.send_from_isr(identifier, data,
+                                      data + length);  // NOLINT
 }
 
 /**
@@ -184,33 +202,12 @@ void callback(void*, uint32_t identifier, uint8_t* data, uint8_t length) {
     can::bus::CanBus* can_bus) {
     can_bus->set_incoming_message_callback(nullptr, callback);
 
-    auto filter = can::arbitration_id::ArbitrationId();
-
-    // Accept broadcast
-    filter.node_id(can::ids::NodeId::broadcast);
-    can_bus->add_filter(CanFilterType::mask, CanFilterConfig::to_fifo0, filter,
-                        can::arbitration_id::ArbitrationId::node_id_bit_mask);
-
-    // Accept any head
-    filter.node_id(can::ids::NodeId::head);
-    can_bus->add_filter(CanFilterType::mask, CanFilterConfig::to_fifo1, filter,
-                        can::arbitration_id::ArbitrationId::node_id_bit_mask);
-
-    // Accept head right
-    filter.node_id(can::ids::NodeId::head_r);
-    can_bus->add_filter(CanFilterType::mask, CanFilterConfig::to_fifo1, filter,
-                        can::arbitration_id::ArbitrationId::node_id_bit_mask);
-
-    // Accept head left
-    filter.node_id(can::ids::NodeId::head_l);
-    can_bus->add_filter(CanFilterType::mask, CanFilterConfig::to_fifo1, filter,
-                        can::arbitration_id::ArbitrationId::node_id_bit_mask);
-
+    // Accept broadcast and any head, for the messages the dispatcher takes.
     // Reject everything else.
-    can_bus->add_filter(CanFilterType::mask, CanFilterConfig::reject, 0, 0);
+    can::acceptance_filter::add_filters(*can_bus, receive_filters);
 
-    auto poller = can::freertos_dispatch::FreeRTOSCanBufferPoller(
-        read_can_message_buffer, main_dispatcher);
+    auto poller = can::freertos_dispatch::FreeRTOSCanFramePoller(
+        read_can_frame_pool, main_dispatcher);
     poller();
 }
 
@@ -232,6 +229,8 @@ auto can_task::start_reader(can::bus::CanBus& canbus)
 
 auto can_task::start_writer(can::bus::CanBus& canbus)
     -> can_task::CanMessageWriterTask& {
+    drop_reporter.set_writer(writer_task);
+    read_can_frame_pool.set_drop_reporter(drop_reporter);
     writer_task_control.start(5, "can writer task", &canbus);
     return writer_task;
 }
@@ -137,7 +137,7 @@ void head_tasks::start_tasks(
     head_tasks_col.update_data_rev_task = &eeprom_data_rev_update_task;
 #endif
     // Assign head queue client message queue pointers
-    head_queues.set_queue(&can_writer.get_queue());
+    head_queues.set_writer(can_writer);
     head_queues.presence_sensing_driver_queue = &presence_sensing.get_queue();
     head_queues.i2c3_queue = &i2c3_task.get_queue();
     head_queues.i2c3_poller_queue = &i2c3_poller_task.get_queue();
@@ -154,7 +154,8 @@ void head_tasks::start_tasks(
         5, "left move group", left_queues, left_queues);
     auto& left_move_status_reporter = left_move_status_task_builder.start(
         5, "left move status", left_queues,
-        left_motion_controller.get_mechanical_config(), left_queues);
+        left_motion_controller.get_mechanical_config(), left_queues,
+        left_queues.move_status_events);
 #if PCBA_PRIMARY_REVISION != 'b'
     auto& left_usage_storage_task = left_usage_storage_task_builder.start(
         5, "left usage storage", left_queues, head_queues, tail_accessor);
@@ -174,7 +175,7 @@ void head_tasks::start_tasks(
     left_queues.motion_queue = &left_motion.get_queue();
     left_queues.motor_queue = &left_tmc2160_driver.get_queue();
     left_queues.move_group_queue = &left_move_group.get_queue();
-    left_queues.set_queue(&can_writer.get_queue());
+    left_queues.set_writer(can_writer);
     left_queues.move_status_report_queue =
         &left_move_status_reporter.get_queue();
 #if PCBA_PRIMARY_REVISION != 'b'
@@ -191,7 +192,8 @@ void head_tasks::start_tasks(
         5, "right move group", right_queues, right_queues);
     auto& right_move_status_reporter = right_move_status_task_builder.start(
         5, "right move status", right_queues,
-        right_motion_controller.get_mechanical_config(), right_queues);
+        right_motion_controller.get_mechanical_config(), right_queues,
+        right_queues.move_status_events);
 #if PCBA_PRIMARY_REVISION != 'b'
     auto& right_usage_storage_task = right_usage_storage_task_builder.start(
         5, "right usage storage", right_queues, head_queues, tail_accessor);
@@ -214,7 +216,7 @@ void head_tasks::start_tasks(
     right_queues.motion_queue = &right_motion.get_queue();
     right_queues.motor_queue = &right_tmc2160_driver.get_queue();
     right_queues.move_group_queue = &right_move_group.get_queue();
-    right_queues.set_queue(&can_writer.get_queue());
+    right_queues.set_writer(can_writer);
     right_queues.move_status_report_queue =
         &right_move_status_reporter.get_queue();
 #if PCBA_PRIMARY_REVISION != 'b'
@@ -42,16 +42,16 @@ static auto motor_interface_right =
 static auto motor_interface_left =
     sim_motor_hardware_iface::SimMotorHardwareIface(MoveMessageHardware::z_l);
 
-static freertos_message_queue::FreeRTOSMessageQueue<motor_messages::Move>
+static spsc_message_queue::SPSCMessageQueue<motor_messages::Move>
     motor_queue_right("Motor Queue Right");
-static freertos_message_queue::FreeRTOSMessageQueue<motor_messages::Move>
+static spsc_message_queue::SPSCMessageQueue<motor_messages::Move>
     motor_queue_left("Motor Queue Left");
 
-static freertos_message_queue::FreeRTOSMessageQueue<
+static spsc_message_queue::SPSCMessageQueue<
     can::messages::UpdateMotorPositionEstimationRequest>
     update_position_queue_right("PQueue Right");
 
-static freertos_message_queue::FreeRTOSMessageQueue<
+static spsc_message_queue::SPSCMessageQueue<
     can::messages::UpdateMotorPositionEstimationRequest>
     update_position_queue_left("PQueue Left");
 
@@ -94,8 +94,8 @@ static stall_check::StallCheck stallcheck_right(
     linear_config.get_usteps_per_mm() / 1000.0F, utils::STALL_THRESHOLD_UM);
 
 static motor_handler::MotorInterruptHandler motor_interrupt_right(
-    motor_queue_right, head_tasks::get_right_queues(), motor_interface_right,
-    stallcheck_right, update_position_queue_right);
+    motor_queue_right, head_tasks::get_right_queues().move_status_events,
+    motor_interface_right, stallcheck_right, update_position_queue_right);
 
 static stall_check::StallCheck stallcheck_left(
     linear_config.get_encoder_pulses_per_mm() / 1000.0F,
@@ -117,8 +117,8 @@ static motor_class::Motor motor_right{
     motor_queue_right, update_position_queue_right};
 
 static motor_handler::MotorInterruptHandler motor_interrupt_left(
-    motor_queue_left, head_tasks::get_left_queues(), motor_interface_left,
-    stallcheck_left, update_position_queue_left);
+    motor_queue_left, head_tasks::get_left_queues().move_status_events,
+    motor_interface_left, stallcheck_left, update_position_queue_left);
 
 static motor_class::Motor motor_left{
     motor_sys_config, motor_interface_left,
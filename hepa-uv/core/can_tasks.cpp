@@ -1,5 +1,7 @@
 #include <span>
 
+#include "can/core/acceptance_filter.hpp"
+#include "can/core/message_writer.hpp"
 #include "eeprom/core/message_handler.hpp"
 #include "hepa-uv/core/can_task.hpp"
 #include "hepa-uv/core/hepa_task.hpp"
@@ -63,7 +65,7 @@ struct CheckForNodeId {
 };
 
 /** Dispatcher to the various handlers */
-static auto main_dispatcher = can::dispatch::Dispatcher(
+static auto main_dispatcher = can::dispatch::ParsingDispatcher(
     [](uint32_t arbitration_id) -> bool {
         auto arb = can::arbitration_id::ArbitrationId(arbitration_id);
         auto node_id = arb.node_id();
@@ -73,10 +75,19 @@ static auto main_dispatcher = can::dispatch::Dispatcher(
     system_dispatch_target, hepauv_info_dispatch_target, eeprom_dispatch_target,
     hepa_dispatch_target, uv_dispatch_target);
 
-auto static reader_message_buffer =
-    freertos_message_buffer::FreeRTOSMessageBuffer<1024>{};
-static auto reader_message_buffer_writer =
-    can::message_buffer::CanMessageBufferWriter(reader_message_buffer);
+/** Receive filters for the messages main_dispatcher takes */
+static constexpr auto receive_filters =
+    can::acceptance_filter::compile_for<decltype(main_dispatcher)>(
+        can::ids::NodeId::hepa_uv);
+
+/** No move groups come to this board, only a few requests at a time. */
+static constexpr std::size_t reader_frame_pool_size = 16;
+auto static reader_frame_pool =
+    can::freertos_dispatch::FreeRTOSCanFramePool<reader_frame_pool_size>{};
+
+/** Tells the host when received frames are dropped. */
+static auto drop_reporter =
+    can::message_writer::MessageWriter{can::ids::NodeId::hepa_uv};
 
 /**
  * New CAN message callback.
@@ -86,8 +97,7 @@ static auto reader_message_buffer_writer =
  * @param length Message data length
  */
 void callback(void*, uint32_t identifier, uint8_t* data, uint8_t length) {
-    reader_message_buffer_writer.send_from_isr(identifier, data,
-                                               data + length);  // NOLINT
+    reader_frame_pool.send_from_isr(identifier, data, data + length);  // NOLINT
 }
 
 /**
@@ -97,23 +107,12 @@ void callback(void*, uint32_t identifier, uint8_t* data, uint8_t length) {
     can::bus::CanBus* can_bus) {
     can_bus->set_incoming_message_callback(nullptr, callback);
 
-    auto filter = can::arbitration_id::ArbitrationId();
-
-    // Accept broadcast
-    filter.node_id(can::ids::NodeId::broadcast);
-    can_bus->add_filter(CanFilterType::mask, CanFilterConfig::to_fifo0, filter,
-                        can::arbitration_id::ArbitrationId::node_id_bit_mask);
-
-    // Accept Hepa/UV
-    filter.node_id(can::ids::NodeId::hepa_uv);
-    can_bus->add_filter(CanFilterType::mask, CanFilterConfig::to_fifo1, filter,
-                        can::arbitration_id::ArbitrationId::node_id_bit_mask);
-
+    // Accept broadcast and Hepa/UV, for the messages the dispatcher takes.
     // Reject everything else.
-    can_bus->add_filter(CanFilterType::mask, CanFilterConfig::reject, 0, 0);
+    can::acceptance_filter::add_filters(*can_bus, receive_filters);
 
-    auto poller = can::freertos_dispatch::FreeRTOSCanBufferPoller(
-        reader_message_buffer, main_dispatcher);
+    auto poller = can::freertos_dispatch::FreeRTOSCanFramePoller(
+        reader_frame_pool, main_dispatcher);
     poller();
 }
 
@@ -149,6 +148,8 @@ auto can_task::start_writer(can::bus::CanBus& canbus)
     -> can_task::CanMessageWriterTask& {
     LOG("Starting the CAN writer task");
 
+    drop_reporter.set_writer(writer_task);
+    reader_frame_pool.set_drop_reporter(drop_reporter);
     writer_task_control.start(5, "can writer task", &canbus);
     return writer_task;
 }
@@ -87,7 +87,7 @@ void hepauv_tasks::start_tasks(
     tasks.uv_task_handler = &uv_task;
     tasks.led_control_task_handler = &led_control_task;
 
-    queues.set_queue(&can_writer.get_queue());
+    queues.set_writer(can_writer);
     queues.i2c2_queue = &i2c2_task.get_queue();
     queues.i2c2_poller_queue = &i2c2_poller_task.get_queue();
     queues.eeprom_queue = &eeprom_task.get_queue();
@@ -7,11 +7,26 @@
 #include "task.h"
 
 #define MAX_I2C_HANDLES (3)
+// Ticks to wait for a transfer to finish when it is not retried. Two ticks
+// make sure at least a whole one passes.
+#define TRANSFER_WAIT_MIN (2)
+// Ticks to back off before retrying a transfer that failed.
+#define TRANSFER_RETRY_DELAY (1)
 
 typedef struct {
     I2C_HandleTypeDef *i2c_handle;
     TaskHandle_t task_to_notify;
     bool should_retry;
+    // the asynchronous transfer in progress, if callback is set
+    uint16_t dev_address;
+    uint8_t *read_data;
+    uint16_t read_size;
+    bool reading;
+    i2c_transfer_callback callback;
+    void *callback_context;
+    // the task sleeping in hal_i2c_transfer
+    TaskHandle_t transfer_waiter;
+    bool transfer_succeeded;
 } NotificationHandle_t;
 
 static NotificationHandle_t _notification_handles[MAX_I2C_HANDLES];
@@ -37,11 +52,42 @@ static void initialize_notification_handles() {
             _notification_handles[i].i2c_handle = NULL;
             _notification_handles[i].task_to_notify = NULL;
             _notification_handles[i].should_retry = false;
+            _notification_handles[i].callback = NULL;
+            _notification_handles[i].transfer_waiter = NULL;
         }
         _initialized = true;
     }
 }
 
+/**
+ * @brief Finish the asynchronous transfer in progress.
+ */
+static void finish_transfer(NotificationHandle_t *instance, bool succeeded) {
+    i2c_transfer_callback callback = instance->callback;
+    instance->callback = NULL;
+    callback(instance->callback_context, succeeded);
+}
+
+/**
+ * @brief Move an asynchronous transfer on from its write to its read, or
+ * finish it.
+ */
+static void handle_transfer_callback(NotificationHandle_t *instance,
+                                     bool error) {
+    if (error || instance->reading || instance->read_size == 0) {
+        finish_transfer(instance, !error);
+        return;
+    }
+    // the write ended without a stop, so this read goes out after a
+    // repeated start
+    instance->reading = true;
+    if (HAL_I2C_Master_Seq_Receive_IT(
+            instance->i2c_handle, instance->dev_address, instance->read_data,
+            instance->read_size, I2C_LAST_FRAME) != HAL_OK) {
+        finish_transfer(instance, false);
+    }
+}
+
 /**
  * @brief Common handler for all I2C callbacks.
  */
@@ -51,6 +97,10 @@ static void handle_i2c_callback(I2C_HandleTypeDef *i2c_handle, bool error) {
     if(instance == NULL) {
         return;
     }
+    if(instance->callback != NULL) {
+        handle_transfer_callback(instance, error);
+        return;
+    }
     if(instance->task_to_notify == NULL) {
         return;
     }
@@ -150,6 +200,106 @@ bool hal_i2c_master_receive(HAL_I2C_HANDLE handle, uint16_t DevAddress, uint8_t
     return rx_result == HAL_OK;
 }
 
+bool hal_i2c_start_transfer(HAL_I2C_HANDLE handle, uint16_t dev_address,
+                            uint8_t *write_data, uint16_t write_size,
+                            uint8_t *read_data, uint16_t read_size,
+                            i2c_transfer_callback callback, void *context) {
+    I2C_HandleTypeDef* i2c_handle = (I2C_HandleTypeDef*)handle;
+    NotificationHandle_t *instance = lookup_handle(i2c_handle);
+
+    if(instance == NULL || instance->callback != NULL || callback == NULL) {
+        return false;
+    }
+    if(write_size == 0 && read_size == 0) {
+        return false;
+    }
+
+    // everything the interrupt needs is in place before the transfer starts
+    instance->dev_address = dev_address;
+    instance->read_data = read_data;
+    instance->read_size = read_size;
+    instance->reading = (write_size == 0);
+    instance->callback_context = context;
+    instance->callback = callback;
+
+    HAL_StatusTypeDef result = HAL_OK;
+    if (write_size != 0) {
+        result = HAL_I2C_Master_Seq_Transmit_IT(
+            i2c_handle, dev_address, write_data, write_size,
+            (read_size != 0) ? I2C_FIRST_FRAME : I2C_FIRST_AND_LAST_FRAME);
+    } else {
+        result = HAL_I2C_Master_Seq_Receive_IT(
+            i2c_handle, dev_address, read_data, read_size,
+            I2C_FIRST_AND_LAST_FRAME);
+    }
+    if (result != HAL_OK) {
+        instance->callback = NULL;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Wake the task waiting in hal_i2c_transfer.
+ */
+static void wake_transfer_waiter(void *context, bool succeeded) {
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    NotificationHandle_t *instance = (NotificationHandle_t*)context;
+    instance->transfer_succeeded = succeeded;
+    vTaskNotifyGiveFromISR(instance->transfer_waiter,
+                           &xHigherPriorityTaskWoken);
+    portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+}
+
+bool hal_i2c_transfer(HAL_I2C_HANDLE handle, uint16_t dev_address,
+                      uint8_t *write_data, uint16_t write_size,
+                      uint8_t *read_data, uint16_t read_size,
+                      uint32_t timeout) {
+    I2C_HandleTypeDef* i2c_handle = (I2C_HandleTypeDef*)handle;
+    NotificationHandle_t *instance = lookup_handle(i2c_handle);
+
+    if(instance == NULL) {
+        return false;
+    }
+
+    // a single attempt still has to wait for the interrupt
+    uint32_t wait = (timeout < TRANSFER_WAIT_MIN) ? TRANSFER_WAIT_MIN : timeout;
+    uint32_t tickstart = HAL_GetTick();
+    do {
+        // drop any notification left over from an earlier transfer so it
+        // cannot be taken for this one finishing
+        (void)ulTaskNotifyTake(pdTRUE, 0);
+        instance->transfer_waiter = xTaskGetCurrentTaskHandle();
+        instance->transfer_succeeded = false;
+        if (!hal_i2c_start_transfer(handle, dev_address, write_data,
+                                    write_size, read_data, read_size,
+                                    wake_transfer_waiter, instance)) {
+            // the peripheral is still busy; let it settle
+            vTaskDelay(TRANSFER_RETRY_DELAY);
+            continue;
+        }
+        if (ulTaskNotifyTake(pdTRUE, wait) != 1) {
+            // the interrupt may finish the transfer while we give up on it,
+            // so only one of us may take the callback
+            taskENTER_CRITICAL();
+            bool in_progress = (instance->callback != NULL);
+            instance->callback = NULL;
+            taskEXIT_CRITICAL();
+            if (in_progress) {
+                // the interrupt never fired, so give the bus back
+                HAL_I2C_Master_Abort_IT(i2c_handle, dev_address);
+                return false;
+            }
+            (void)ulTaskNotifyTake(pdTRUE, 0);
+        }
+        if (instance->transfer_succeeded) {
+            return true;
+        }
+        vTaskDelay(TRANSFER_RETRY_DELAY);
+    } while ((HAL_GetTick() - tickstart) < timeout);
+    return false;
+}
+
 
 void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef *i2c_handle){
     handle_i2c_callback(i2c_handle, false);
@@ -8,6 +8,8 @@ using namespace i2c::hardware;
  * Public:
  * master_transmit - send out a command to I2C
  * master_receive - receive data from the I2C line
+ * start_transfer - start a write and/or read, finished from the interrupt
+ * transfer - run a write and/or read, sleeping until it is done
  *
  *
  */
@@ -22,6 +24,20 @@ auto I2C::central_receive(uint8_t* data, uint16_t size, uint16_t dev_address,
     return hal_i2c_master_receive(handle, dev_address, data, size, timeout);
 }
 
+auto I2C::start_transfer(const Transfer& transfer, TransferCallback callback,
+                         void* context) -> bool {
+    return hal_i2c_start_transfer(handle, transfer.dev_address,
+                                  transfer.write_data, transfer.write_size,
+                                  transfer.read_data, transfer.read_size,
+                                  callback, context);
+}
+
+auto I2C::transfer(const Transfer& transfer, uint32_t timeout) -> bool {
+    return hal_i2c_transfer(handle, transfer.dev_address, transfer.write_data,
+                            transfer.write_size, transfer.read_data,
+                            transfer.read_size, timeout);
+}
+
 auto I2C::set_handle(HAL_I2C_HANDLE i2c_handle) -> void {
     handle = i2c_handle;
     i2c_register_handle(handle);
@@ -38,6 +38,26 @@ auto SimI2C::central_receive(uint8_t *data, uint16_t size, uint16_t dev_address,
     return ret_val;
 }
 
+auto SimI2C::start_transfer(const Transfer &transfer, TransferCallback callback,
+                            void *context) -> bool {
+    // the simulated bus is done as soon as it starts
+    callback(context, this->transfer(transfer, 0));
+    return true;
+}
+
+auto SimI2C::transfer(const Transfer &transfer, uint32_t timeout) -> bool {
+    if (transfer.write_size != 0 &&
+        !central_transmit(transfer.write_data, transfer.write_size,
+                          transfer.dev_address, timeout)) {
+        return false;
+    }
+    if (transfer.read_size != 0) {
+        return central_receive(transfer.read_data, transfer.read_size,
+                               transfer.dev_address, timeout);
+    }
+    return true;
+}
+
 auto SimI2C::get_last_transmitted() const -> const std::vector<uint8_t> & {
     return last_transmitted;
 }
@@ -67,7 +67,7 @@ SCENARIO("test poll management") {
 
     auto poll_handler =
         i2c::tasks::I2CPollerMessageHandler<test_mocks::MockMessageQueue,
-                                            test_mocks::MockTimer,
+                                            test_mocks::MockClockedTimer,
                                             decltype(poll_queue)>{writer,
                                                                   poll_queue};
     auto& poller = poll_handler.continuous_polls;
@@ -111,10 +111,10 @@ SCENARIO("test poll management") {
                         std::visit([](auto& msg) { return get_address(msg); },
                                    which_msg));
                 REQUIRE(
-                    poller.polls[0].timer.get_period() ==
+                    poll_handler.scheduler.period(&poller.polls[0]) ==
                     static_cast<uint32_t>(std::visit(
                         [](auto& msg) { return get_period(msg); }, which_msg)));
-                REQUIRE(poller.polls[0].timer.is_running());
+                REQUIRE(poll_handler.scheduler.is_scheduled(&poller.polls[0]));
                 REQUIRE(poller.polls[0].id.token ==
                         std::visit([](auto& msg) { return get_poll_id(msg); },
                                    which_msg));
@@ -124,7 +124,7 @@ SCENARIO("test poll management") {
                 poll_iter++;
                 for (; poll_iter != poller.polls.end(); poll_iter++) {
                     REQUIRE(poll_iter->transactions[0].address == 0);
-                    REQUIRE(!poll_iter->timer.is_running());
+                    REQUIRE(!poll_handler.scheduler.is_scheduled(&*poll_iter));
                     REQUIRE(poll_iter->id.token == 0);
                 }
             }
@@ -168,10 +168,10 @@ SCENARIO("test poll management") {
               std::visit([](auto& msg) { return get_address(msg); },
                          original_message));
         CHECK(
-            poller.polls[0].timer.get_period() ==
+            poll_handler.scheduler.period(&poller.polls[0]) ==
             static_cast<uint32_t>(std::visit(
                 [](auto& msg) { return get_period(msg); }, original_message)));
-        CHECK(poller.polls[0].timer.is_running());
+        CHECK(poll_handler.scheduler.is_scheduled(&poller.polls[0]));
         CHECK(poller.polls[0].id.token ==
               std::visit([](auto& msg) { return get_poll_id(msg); },
                          original_message));
@@ -216,11 +216,11 @@ SCENARIO("test poll management") {
                 REQUIRE(poller.polls[0].transactions[0].address ==
                         std::visit([](auto& msg) { return get_address(msg); },
                                    new_message));
-                REQUIRE(poller.polls[0].timer.get_period() ==
+                REQUIRE(poll_handler.scheduler.period(&poller.polls[0]) ==
                         static_cast<uint32_t>(std::visit(
                             [](auto& msg) { return get_period(msg); },
                             new_message)));
-                REQUIRE(poller.polls[0].timer.is_running());
+                REQUIRE(poll_handler.scheduler.is_scheduled(&poller.polls[0]));
                 REQUIRE(poller.polls[0].id.token ==
                         std::visit([](auto& msg) { return get_poll_id(msg); },
                                    new_message));
@@ -230,7 +230,7 @@ SCENARIO("test poll management") {
                 poll_iter++;
                 for (; poll_iter != poller.polls.end(); poll_iter++) {
                     REQUIRE(poll_iter->transactions[0].address == 0);
-                    REQUIRE(!poll_iter->timer.is_running());
+                    REQUIRE(!poll_handler.scheduler.is_scheduled(&*poll_iter));
                     REQUIRE(poll_iter->id.token == 0);
                 }
             }
@@ -273,7 +273,7 @@ SCENARIO("test poll management") {
             THEN("the polling should stop and the slot should be freed") {
                 REQUIRE(poller.polls[0].transactions[0].address == 0);
                 REQUIRE(poller.polls[0].id.token == 0);
-                REQUIRE(!poller.polls[0].timer.is_running());
+                REQUIRE(!poll_handler.scheduler.is_scheduled(&poller.polls[0]));
             }
         }
         WHEN("sending a message to a different id") {
@@ -315,11 +315,11 @@ SCENARIO("test poll management") {
                 REQUIRE(poller.polls[0].transactions[0].address ==
                         std::visit([](auto& msg) { return get_address(msg); },
                                    original_message));
-                REQUIRE(poller.polls[0].timer.get_period() ==
+                REQUIRE(poll_handler.scheduler.period(&poller.polls[0]) ==
                         static_cast<uint32_t>(std::visit(
                             [](auto& msg) { return get_period(msg); },
                             original_message)));
-                REQUIRE(poller.polls[0].timer.is_running());
+                REQUIRE(poll_handler.scheduler.is_scheduled(&poller.polls[0]));
                 REQUIRE(poller.polls[0].id.token ==
                         std::visit([](auto& msg) { return get_poll_id(msg); },
                                    original_message));
@@ -328,11 +328,11 @@ SCENARIO("test poll management") {
                 REQUIRE(poller.polls[1].transactions[0].address ==
                         std::visit([](auto& msg) { return get_address(msg); },
                                    new_message));
-                REQUIRE(poller.polls[1].timer.get_period() ==
+                REQUIRE(poll_handler.scheduler.period(&poller.polls[1]) ==
                         static_cast<uint32_t>(std::visit(
                             [](auto& msg) { return get_period(msg); },
                             new_message)));
-                REQUIRE(poller.polls[1].timer.is_running());
+                REQUIRE(poll_handler.scheduler.is_scheduled(&poller.polls[1]));
                 REQUIRE(poller.polls[1].id.token ==
                         std::visit([](auto& msg) { return get_poll_id(msg); },
                                    new_message));
@@ -343,10 +343,123 @@ SCENARIO("test poll management") {
                 poll_iter++;
                 for (; poll_iter != poller.polls.end(); poll_iter++) {
                     REQUIRE(poll_iter->transactions[0].address == 0);
-                    REQUIRE(!poll_iter->timer.is_running());
+                    REQUIRE(!poll_handler.scheduler.is_scheduled(&*poll_iter));
                     REQUIRE(poll_iter->id.token == 0);
                 }
             }
         }
     }
 }
+
+SCENARIO("finding polls from their responses") {
+    test_mocks::MockMessageQueue<i2c::writer::TaskMessage> i2c_queue{};
+    auto writer = i2c::writer::Writer<test_mocks::MockMessageQueue>{};
+    writer.set_queue(&i2c_queue);
+
+    test_mocks::MockMessageQueue<i2c::poller::TaskMessage> poll_queue{};
+    test_mocks::MockI2CResponseQueue response_queue{};
+
+    auto poll_handler =
+        i2c::tasks::I2CPollerMessageHandler<test_mocks::MockMessageQueue,
+                                            test_mocks::MockClockedTimer,
+                                            decltype(poll_queue)>{writer,
+                                                                  poll_queue};
+    auto& poller = poll_handler.continuous_polls;
+    auto poll_message = [&](uint32_t token, int delay_ms) {
+        return i2c::poller::TaskMessage{
+            i2c::messages::ConfigureSingleRegisterContinuousPolling{
+                .delay_ms = delay_ms,
+                .first = {.address = 0x67,
+                          .bytes_to_read = 3,
+                          .bytes_to_write = 1,
+                          .write_buffer{}},
+                .id = {.token = token},
+                .response_writer =
+                    i2c::messages::ResponseWriter(response_queue)}};
+    };
+    auto run_until_transaction = [&]() {
+        while (!i2c_queue.has_message()) {
+            poll_handler.scheduler.timer.fire();
+        }
+        i2c::writer::TaskMessage message{};
+        i2c_queue.try_read(&message);
+        return std::get<i2c::messages::Transact>(message);
+    };
+    auto respond = [&](const i2c::messages::Transact& transact) {
+        static_cast<void>(transact.response_writer.write(
+            test_mocks::dummy_response(transact)));
+        i2c::poller::TaskMessage response{};
+        poll_queue.try_read(&response);
+        poll_handler.handle_message(response);
+    };
+
+    GIVEN("a running poll") {
+        auto message = poll_message(0x1000, 10);
+        poll_handler.handle_message(message);
+        auto transact = run_until_transaction();
+        THEN("its transactions keep the caller's token and carry a handle") {
+            REQUIRE(transact.id.token == 0x1000);
+            REQUIRE(transact.id.poll_handle != 0);
+        }
+        WHEN("the response comes back") {
+            respond(transact);
+            THEN("it goes upstream") {
+                REQUIRE(response_queue.get_size() == 1);
+                REQUIRE(test_mocks::get_response(response_queue).id.token ==
+                        0x1000);
+            }
+        }
+        WHEN("the poll is replaced before its response comes back") {
+            auto stop = poll_message(0x1000, 0);
+            poll_handler.handle_message(stop);
+            auto replacement = poll_message(0x2000, 10);
+            poll_handler.handle_message(replacement);
+            REQUIRE(poller.polls[0].id.token == 0x2000);
+            respond(transact);
+            THEN("the late response is dropped") {
+                REQUIRE(!response_queue.has_message());
+            }
+            THEN("the replacement gets a new handle") {
+                REQUIRE(poller.polls[0].id.poll_handle !=
+                        transact.id.poll_handle);
+            }
+        }
+        WHEN("a response carries a handle for the other kind of poll") {
+            auto foreign = transact;
+            foreign.id.poll_handle ^= 0x80;
+            respond(foreign);
+            THEN("it is dropped") { REQUIRE(!response_queue.has_message()); }
+        }
+    }
+
+    GIVEN("every poll slot in use") {
+        for (uint32_t token = 1; token <= poller.polls.size(); token++) {
+            auto message = poll_message(token, 10);
+            poll_handler.handle_message(message);
+        }
+        WHEN("another poll is requested") {
+            auto message = poll_message(0x3000, 10);
+            poll_handler.handle_message(message);
+            THEN("it is rejected upstream") {
+                REQUIRE(response_queue.get_size() == 1);
+                auto response = test_mocks::get_response(response_queue);
+                REQUIRE(response.poll_rejected);
+                REQUIRE(response.id.is_completed_poll);
+                REQUIRE(response.id.token == 0x3000);
+                REQUIRE(response.bytes_read == 0);
+            }
+            THEN("no running poll is disturbed") {
+                for (uint32_t i = 0; i < poller.polls.size(); i++) {
+                    REQUIRE(poller.polls[i].id.token == i + 1);
+                }
+            }
+        }
+        WHEN("a poll that is not running is stopped") {
+            auto message = poll_message(0x3000, 0);
+            poll_handler.handle_message(message);
+            THEN("nothing is sent upstream") {
+                REQUIRE(!response_queue.has_message());
+            }
+        }
+    }
+}
@@ -25,6 +25,13 @@ auto get_message(test_mocks::MockMessageQueue<i2c::writer::TaskMessage>& q)
     return std::get<Message>(empty_msg);
 }
 
+// The scheduler's timer fires each time its period passes, counting from
+// when it was last fired or set.
+template <typename Scheduler>
+void run_for(Scheduler& scheduler, int ms) {
+    scheduler.timer.run_for(ms);
+}
+
 SCENARIO("test the limited-count i2c poller") {
     test_mocks::MockMessageQueue<i2c::writer::TaskMessage> i2c_queue{};
 
@@ -36,7 +43,7 @@ SCENARIO("test the limited-count i2c poller") {
 
     auto poll_handler =
         i2c::tasks::I2CPollerMessageHandler<test_mocks::MockMessageQueue,
-                                            test_mocks::MockTimer,
+                                            test_mocks::MockClockedTimer,
                                             decltype(poll_queue)>{writer,
                                                                   poll_queue};
 
@@ -67,23 +74,23 @@ SCENARIO("test the limited-count i2c poller") {
             THEN("nothing is immediately enqueued") {
                 REQUIRE(!i2c_queue.has_message());
             }
-            THEN("a poll object is provisioned with a timer") {
+            THEN("a poll object is scheduled") {
                 REQUIRE(poll.transactions[0] == original_txn);
                 REQUIRE(poll.transactions[1].address == 0);
-                REQUIRE(poll.timer.get_period() ==
+                REQUIRE(poll_handler.scheduler.period(&poll) ==
                         static_cast<uint32_t>(delay));
-                REQUIRE(poll.timer.is_running());
+                REQUIRE(poll_handler.scheduler.is_scheduled(&poll));
             }
             THEN("only one poll object is provisioned") {
                 auto poll_iter = limited_polls.polls.begin();
                 poll_iter++;
                 for (; poll_iter != limited_polls.polls.end(); poll_iter++) {
                     REQUIRE(poll_iter->transactions[0].address == 0);
-                    REQUIRE(!poll_iter->timer.is_running());
+                    REQUIRE(!poll_handler.scheduler.is_scheduled(&*poll_iter));
                 }
             }
-            AND_WHEN("firing the timer once") {
-                poll.timer.fire();
+            AND_WHEN("running for one period") {
+                run_for(poll_handler.scheduler, delay);
                 THEN("a correct transaction is sent to the i2c task") {
                     REQUIRE(i2c_queue.get_size() == 1);
                     auto transaction =
@@ -113,7 +120,7 @@ SCENARIO("test the limited-count i2c poller") {
                     }
                 }
             }
-            AND_WHEN("firing the timer poll_count-1 times") {
+            AND_WHEN("running for poll_count-1 periods") {
                 auto response_buffer = i2c::messages::MaxMessageBuffer{
                     0xaa, 0xbb, 0xcc, 0xdd, 0xee};
                 i2c::messages::TransactionResponse response{
@@ -123,11 +130,13 @@ SCENARIO("test the limited-count i2c poller") {
                 };
 
                 for (int count = 0; count < (poll_count - 1); count++) {
-                    poll.timer.fire();
+                    run_for(poll_handler.scheduler, delay);
                     auto msg = get_message<i2c::messages::Transact>(i2c_queue);
                     CHECK(msg.transaction == original_txn);
                     CHECK(msg.id.token == 12314);
                     CHECK(msg.id.is_completed_poll == false);
+                    // the i2c task answers with the transaction's own id
+                    response.id = msg.id;
                     static_cast<void>(msg.response_writer.write(response));
                     auto resp = get_message<i2c::messages::TransactionResponse>(
                         poll_queue);
@@ -147,7 +156,7 @@ SCENARIO("test the limited-count i2c poller") {
                     }
 
                     AND_WHEN("firing the last poll") {
-                        poll.timer.fire();
+                        run_for(poll_handler.scheduler, delay);
                         auto last_txn =
                             get_message<i2c::messages::Transact>(i2c_queue);
                         auto response_buffer = i2c::messages::MaxMessageBuffer{
@@ -172,7 +181,8 @@ SCENARIO("test the limited-count i2c poller") {
                             REQUIRE(upstream.id.is_completed_poll == true);
                         }
                         THEN("the poll is no longer active") {
-                            REQUIRE(!poll.timer.is_running());
+                            REQUIRE(
+                                !poll_handler.scheduler.is_scheduled(&poll));
                             REQUIRE(poll.transactions[0].address == 0);
                         }
                     }
@@ -215,22 +225,22 @@ SCENARIO("test the limited-count i2c poller") {
             THEN("nothing is immediately enqueued") {
                 REQUIRE(!i2c_queue.has_message());
             }
-            THEN("a poll object is provisioned with a timer") {
+            THEN("a poll object is scheduled") {
                 REQUIRE(poll.transactions[0].address == addr);
-                REQUIRE(poll.timer.get_period() ==
+                REQUIRE(poll_handler.scheduler.period(&poll) ==
                         static_cast<uint32_t>(delay));
-                REQUIRE(poll.timer.is_running());
+                REQUIRE(poll_handler.scheduler.is_scheduled(&poll));
             }
             THEN("only one poll object is provisioned") {
                 auto poll_iter = limited_polls.polls.begin();
                 poll_iter++;
                 for (; poll_iter != limited_polls.polls.end(); poll_iter++) {
                     REQUIRE(poll_iter->transactions[0].address == 0);
-                    REQUIRE(!poll_iter->timer.is_running());
+                    REQUIRE(!poll_handler.scheduler.is_scheduled(&*poll_iter));
                 }
             }
-            AND_WHEN("firing the timer once") {
-                poll.timer.fire();
+            AND_WHEN("running for one period") {
+                run_for(poll_handler.scheduler, delay);
                 THEN(
                     "a correct first-reg transaction is sent to the i2c task") {
                     REQUIRE(i2c_queue.get_size() == 1);
@@ -309,13 +319,13 @@ SCENARIO("test the limited-count i2c poller") {
                     }
                 }
             }
-            AND_WHEN("firing the timer enough times to exhaust the poll") {
+            AND_WHEN("running for enough periods to exhaust the poll") {
                 auto first_response_buf =
                     i2c::messages::MaxMessageBuffer{0xf, 0xe, 0xd, 0xc, 0xb};
                 auto second_response_buf = i2c::messages::MaxMessageBuffer{
                     0xff, 0xee, 0xdd, 0xcc, 0xbb};
                 for (int count = 0; count < (poll_count - 1); count++) {
-                    poll.timer.fire();
+                    run_for(poll_handler.scheduler, delay);
                     auto txn = get_message<i2c::messages::Transact>(i2c_queue);
                     i2c::messages::TransactionResponse first_response{
                         .id = txn.id,
@@ -362,7 +372,7 @@ SCENARIO("test the limited-count i2c poller") {
                     }
                 }
                 AND_WHEN("completing the last transaction") {
-                    poll.timer.fire();
+                    run_for(poll_handler.scheduler, delay);
                     auto txn = get_message<i2c::messages::Transact>(i2c_queue);
                     i2c::messages::TransactionResponse first_response{
                         .id = txn.id,
@@ -403,7 +413,7 @@ SCENARIO("test the limited-count i2c poller") {
                         REQUIRE(upstream.read_buffer == second_response_buf);
                     }
                     THEN("the poll is no longer active") {
-                        REQUIRE(!poll.timer.is_running());
+                        REQUIRE(!poll_handler.scheduler.is_scheduled(&poll));
                         REQUIRE(poll.transactions[0].address == 0);
                     }
                 }
@@ -423,7 +433,7 @@ SCENARIO("test the ongoing i2c polling") {
 
     auto poll_handler =
         i2c::tasks::I2CPollerMessageHandler<test_mocks::MockMessageQueue,
-                                            test_mocks::MockTimer,
+                                            test_mocks::MockClockedTimer,
                                             decltype(poll_queue)>{writer,
                                                                   poll_queue};
 
@@ -442,8 +452,8 @@ SCENARIO("test the ongoing i2c polling") {
             .response_writer = i2c::messages::ResponseWriter(response_queue)};
         auto tm = i2c::poller::TaskMessage{poll_msg};
         poll_handler.handle_message(tm);
-        WHEN("the poll timer fires") {
-            poll_handler.continuous_polls.polls[0].timer.fire();
+        WHEN("one poll period passes") {
+            run_for(poll_handler.scheduler, 100);
             THEN("a transaction should be enqueued") {
                 auto transaction =
                     get_message<i2c::messages::Transact>(i2c_queue);
@@ -475,8 +485,8 @@ SCENARIO("test the ongoing i2c polling") {
                                 response_msg.read_buffer);
                     }
                 }
-                AND_WHEN("the timer fires again") {
-                    poll_handler.continuous_polls.polls[0].timer.fire();
+                AND_WHEN("another period passes") {
+                    run_for(poll_handler.scheduler, 100);
                     THEN(
                         "another transaction should be enqueued with the same "
                         "stimulus") {
@@ -513,8 +523,8 @@ SCENARIO("test the ongoing i2c polling") {
             .response_writer = i2c::messages::ResponseWriter(response_queue)};
         auto tm = i2c::poller::TaskMessage{poll_msg};
         poll_handler.handle_message(tm);
-        WHEN("the poll timer fires") {
-            poll_handler.continuous_polls.polls[0].timer.fire();
+        WHEN("one poll period passes") {
+            run_for(poll_handler.scheduler, 100);
             THEN("a transaction should be enqueued") {
                 auto transaction =
                     get_message<i2c::messages::Transact>(i2c_queue);
@@ -567,9 +577,8 @@ SCENARIO("test the ongoing i2c polling") {
                                 REQUIRE(upstream.id.transaction_index == 1);
                                 REQUIRE(upstream.read_buffer ==
                                         second_resp_buffer);
-                                AND_WHEN("the timer fires again") {
-                                    poll_handler.continuous_polls.polls[0]
-                                        .timer.fire();
+                                AND_WHEN("another period passes") {
+                                    run_for(poll_handler.scheduler, 100);
                                     THEN(
                                         "another transaction should be "
                                         "enqueued with the first") {
@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <array>
 #include <cstring>
 #include <vector>
 
@@ -134,3 +136,128 @@ SCENARIO("read and write data to the i2c task") {
         }
     }
 }
+
+namespace {
+
+// Acknowledges only writes that start with its register.
+class OneRegisterDevice : public i2c::hardware::I2CDeviceBase {
+  public:
+    OneRegisterDevice() : I2CDeviceBase(0x20) {}
+    auto handle_write(const uint8_t *data, uint16_t) -> bool final {
+        return data[0] == 0x10;
+    }
+    auto handle_read(uint8_t *data, uint16_t size) -> bool final {
+        std::fill_n(data, size, u8(0x42));
+        return true;
+    }
+};
+
+struct TransferResult {
+    int calls = 0;
+    bool succeeded = false;
+};
+
+void record_transfer(void *context, bool succeeded) {
+    auto *result = static_cast<TransferResult *>(context);
+    result->calls++;
+    result->succeeded = succeeded;
+}
+
+}  // namespace
+
+SCENARIO("asynchronous transfers on the simulated bus") {
+    GIVEN("a bus with one device") {
+        auto device = OneRegisterDevice{};
+        auto sim_i2c = i2c::hardware::SimI2C{{{0x20, device}}};
+        auto write_buf = std::array{u8(0x10)};
+        auto read_buf = std::array<uint8_t, 2>{};
+        auto result = TransferResult{};
+        auto transfer = i2c::hardware::Transfer{.dev_address = 0x20,
+                                                .write_data = write_buf.data(),
+                                                .write_size = 1,
+                                                .read_data = read_buf.data(),
+                                                .read_size = 2};
+        WHEN("a write then read is started") {
+            REQUIRE(sim_i2c.start_transfer(transfer, record_transfer, &result));
+            THEN("the callback says it succeeded once both are done") {
+                REQUIRE(result.calls == 1);
+                REQUIRE(result.succeeded);
+                REQUIRE(sim_i2c.get_transmit_count() == 1);
+                REQUIRE(sim_i2c.get_receive_count() == 1);
+                REQUIRE(read_buf == std::array{u8(0x42), u8(0x42)});
+            }
+        }
+        WHEN("the device does not acknowledge the write") {
+            write_buf[0] = 0x11;
+            REQUIRE(sim_i2c.start_transfer(transfer, record_transfer, &result));
+            THEN("the callback says it failed and nothing is read") {
+                REQUIRE(result.calls == 1);
+                REQUIRE(!result.succeeded);
+                REQUIRE(sim_i2c.get_receive_count() == 0);
+            }
+        }
+        WHEN("a transfer is only a read") {
+            transfer.write_size = 0;
+            THEN("it runs without a write") {
+                REQUIRE(sim_i2c.transfer(transfer, 10));
+                REQUIRE(sim_i2c.get_transmit_count() == 0);
+                REQUIRE(sim_i2c.get_receive_count() == 1);
+            }
+        }
+    }
+}
+
+SCENARIO("the i2c task reports transactions that do not go through") {
+    GIVEN("an i2c task on a bus with one device") {
+        auto device = OneRegisterDevice{};
+        auto sim_i2c = i2c::hardware::SimI2C{{{0x20, device}}};
+        auto i2c_handler = i2c::tasks::I2CMessageHandler{sim_i2c};
+        test_mocks::MockI2CResponseQueue response_queue{};
+        auto transaction = i2c::messages::Transaction{
+            .address = 0x20,
+            .bytes_to_read = 0,
+            .bytes_to_write = 1,
+            .write_buffer = i2c::messages::MaxMessageBuffer{u8(0x10)},
+            .single_attempt = true};
+        auto send = [&]() {
+            auto message = i2c::writer::TaskMessage{i2c::messages::Transact{
+                .transaction = transaction,
+                .id = i2c::messages::TransactionIdentifier{.token = 3},
+                .response_writer =
+                    i2c::messages::ResponseWriter(response_queue)}};
+            i2c_handler.handle_message(message);
+        };
+        WHEN("the device acknowledges") {
+            send();
+            THEN("the response says so") {
+                REQUIRE(!test_mocks::get_response(response_queue).failed);
+            }
+        }
+        WHEN("the device does not acknowledge") {
+            transaction.write_buffer[0] = 0x11;
+            send();
+            THEN("the response says it failed") {
+                REQUIRE(test_mocks::get_response(response_queue).failed);
+            }
+        }
+        WHEN("a write longer than a transaction is sent from a buffer") {
+            auto data = std::array<uint8_t, 40>{};
+            data[0] = 0x10;
+            auto message = i2c::writer::TaskMessage{i2c::messages::BufferWrite{
+                .address = 0x20,
+                .data = data.data(),
+                .size = data.size(),
+                .id = i2c::messages::TransactionIdentifier{.token = 4},
+                .response_writer =
+                    i2c::messages::ResponseWriter(response_queue)}};
+            i2c_handler.handle_message(message);
+            THEN("all of it goes out in one transfer") {
+                REQUIRE(sim_i2c.get_transmit_count() == 1);
+                REQUIRE(sim_i2c.get_last_transmitted().size() == data.size());
+                auto response = test_mocks::get_response(response_queue);
+                REQUIRE(response.id.token == 4);
+                REQUIRE(!response.failed);
+            }
+        }
+    }
+}
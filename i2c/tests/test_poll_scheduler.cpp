@@ -0,0 +1,214 @@
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "catch2/catch.hpp"
+#include "common/tests/mock_timer.hpp"
+#include "i2c/core/messages.hpp"
+#include "i2c/core/poll_scheduler.hpp"
+
+using namespace i2c::poll_scheduler;
+
+using Scheduler = PollScheduler<test_mocks::MockClockedTimer, 4>;
+
+struct Recorder {
+    std::vector<std::pair<int, uint32_t>>* log;
+    int name;
+    const test_mocks::MockClockedTimer* clock;
+};
+
+static void record(void* context) {
+    auto* recorder = static_cast<Recorder*>(context);
+    recorder->log->emplace_back(recorder->name,
+                                recorder->clock->get_tick_ms());
+}
+
+SCENARIO("estimating transaction bus time") {
+    GIVEN("a register read") {
+        auto transaction = i2c::messages::Transaction{
+            .address = 0x67, .bytes_to_read = 3, .bytes_to_write = 1};
+        THEN("it counts both address bytes, the data and the conditions") {
+            // 6 bytes of 9 clocks, start, repeated start and stop
+            REQUIRE(transaction_us(transaction) == 570);
+        }
+    }
+    GIVEN("a write") {
+        auto transaction = i2c::messages::Transaction{
+            .address = 0x67, .bytes_to_read = 0, .bytes_to_write = 2};
+        THEN("there is no repeated start") {
+            REQUIRE(transaction_us(transaction) == 290);
+        }
+    }
+    GIVEN("an empty transaction") {
+        auto transaction = i2c::messages::Transaction{};
+        THEN("it takes no time") { REQUIRE(transaction_us(transaction) == 0); }
+    }
+}
+
+SCENARIO("placing polls on a shared timeline") {
+    Scheduler scheduler{};
+    std::vector<std::pair<int, uint32_t>> log{};
+    auto run_for = [&](uint32_t ms) { scheduler.timer.run_for(ms); };
+    auto schedule = [&](void* context, uint32_t period_ms, uint32_t busy_us) {
+        return scheduler.schedule(context, record, period_ms, busy_us);
+    };
+    Recorder a{&log, 1, &scheduler.timer};
+    Recorder b{&log, 2, &scheduler.timer};
+    Recorder c{&log, 3, &scheduler.timer};
+
+    GIVEN("no polls") {
+        THEN("the timer is not running") {
+            REQUIRE(!scheduler.timer.is_running());
+            REQUIRE(scheduler.timer.get_period() == SLOT_MS);
+        }
+    }
+
+    GIVEN("a single poll") {
+        REQUIRE(schedule(&a, 10, 600));
+        THEN("the timer runs until the poll is due") {
+            REQUIRE(scheduler.timer.is_running());
+            run_for(1);
+            REQUIRE(scheduler.timer.get_period() == 9);
+        }
+        THEN("it is scheduled with its period") {
+            REQUIRE(scheduler.is_scheduled(&a));
+            REQUIRE(scheduler.period(&a) == 10);
+            REQUIRE(!scheduler.is_scheduled(&b));
+        }
+        WHEN("time passes") {
+            run_for(35);
+            THEN("it runs once a period, starting a period from now") {
+                REQUIRE(log == std::vector<std::pair<int, uint32_t>>{
+                                   {1, 10}, {1, 20}, {1, 30}});
+            }
+        }
+        WHEN("it is unscheduled") {
+            scheduler.unschedule(&a);
+            run_for(20);
+            THEN("it no longer runs and the timer stops") {
+                REQUIRE(log.empty());
+                REQUIRE(!scheduler.is_scheduled(&a));
+                REQUIRE(!scheduler.timer.is_running());
+            }
+            THEN("the timer is left ready to start on the next slot") {
+                REQUIRE(scheduler.timer.get_period() == SLOT_MS);
+            }
+        }
+        WHEN("it is rescheduled") {
+            run_for(3);
+            REQUIRE(schedule(&a, 5, 600));
+            run_for(10);
+            THEN("it keeps one place with the new period") {
+                REQUIRE(scheduler.period(&a) == 5);
+                REQUIRE(log == std::vector<std::pair<int, uint32_t>>{
+                                   {1, 8}, {1, 13}});
+            }
+        }
+    }
+
+    GIVEN("two polls with the same period") {
+        REQUIRE(schedule(&a, 10, 600));
+        REQUIRE(schedule(&b, 10, 600));
+        WHEN("time passes") {
+            run_for(30);
+            THEN("they take different slots") {
+                REQUIRE(log == std::vector<std::pair<int, uint32_t>>{
+                                   {2, 1}, {1, 10}, {2, 11}, {1, 20}, {2, 21},
+                                   {1, 30}});
+            }
+        }
+        WHEN("one of them has run") {
+            run_for(1);
+            THEN("the timer waits for the other") {
+                REQUIRE(scheduler.timer.get_period() == 9);
+            }
+        }
+    }
+
+    GIVEN("a poll added partway through another's period") {
+        REQUIRE(schedule(&a, 10, 600));
+        run_for(5);
+        REQUIRE(schedule(&b, 10, 600));
+        WHEN("time passes") {
+            run_for(30);
+            THEN("the first poll keeps its spacing") {
+                REQUIRE(log == std::vector<std::pair<int, uint32_t>>{
+                                   {1, 10}, {2, 15}, {1, 20}, {2, 25},
+                                   {1, 30}, {2, 35}});
+            }
+        }
+    }
+
+    GIVEN("a faster poll added partway through another's period") {
+        REQUIRE(schedule(&a, 10, 600));
+        run_for(2);
+        REQUIRE(schedule(&b, 3, 100));
+        WHEN("time passes") {
+            run_for(20);
+            THEN("it runs on time without moving the first poll") {
+                REQUIRE(log == std::vector<std::pair<int, uint32_t>>{
+                                   {2, 5}, {2, 8}, {1, 10}, {2, 11}, {2, 14},
+                                   {2, 17}, {1, 20}, {2, 20}});
+            }
+        }
+    }
+
+    GIVEN("a poll that is moved more often than the other is due") {
+        REQUIRE(schedule(&a, 10, 600));
+        WHEN("it is moved every few slots") {
+            for (int i = 0; i < 10; i++) {
+                run_for(3);
+                REQUIRE(schedule(&b, 10, 600));
+            }
+            THEN("the other poll still runs every period") {
+                REQUIRE(log == std::vector<std::pair<int, uint32_t>>{
+                                   {1, 10}, {1, 20}, {1, 30}});
+            }
+        }
+    }
+
+    GIVEN("polls whose periods share a factor") {
+        REQUIRE(schedule(&a, 2, 600));
+        REQUIRE(schedule(&b, 4, 600));
+        THEN("the second poll avoids every slot of the first") {
+            for (uint32_t slot = 1; slot <= 8; slot++) {
+                REQUIRE(scheduler.load_us(slot) <= 600);
+            }
+        }
+    }
+
+    GIVEN("more polls than a period has slots") {
+        REQUIRE(schedule(&a, 2, 400));
+        REQUIRE(schedule(&b, 2, 500));
+        WHEN("a third poll is added") {
+            REQUIRE(schedule(&c, 2, 300));
+            run_for(2);
+            THEN("it shares the slot with the least bus time") {
+                REQUIRE(scheduler.load_us(0) + scheduler.load_us(1) == 1200);
+                REQUIRE(std::max(scheduler.load_us(0), scheduler.load_us(1)) ==
+                        700);
+            }
+            THEN("polls sharing a slot run back to back in one tick") {
+                REQUIRE(log == std::vector<std::pair<int, uint32_t>>{
+                                   {2, 1}, {1, 2}, {3, 2}});
+            }
+        }
+    }
+
+    GIVEN("a full scheduler") {
+        Recorder d{&log, 4, &scheduler.timer};
+        Recorder e{&log, 5, &scheduler.timer};
+        REQUIRE(schedule(&a, 10, 100));
+        REQUIRE(schedule(&b, 10, 100));
+        REQUIRE(schedule(&c, 10, 100));
+        REQUIRE(schedule(&d, 10, 100));
+        THEN("another poll cannot be added") {
+            REQUIRE(!schedule(&e, 10, 100));
+            REQUIRE(!scheduler.is_scheduled(&e));
+        }
+        THEN("a scheduled poll can still be moved") {
+            REQUIRE(schedule(&d, 20, 100));
+            REQUIRE(scheduler.period(&d) == 20);
+        }
+    }
+}
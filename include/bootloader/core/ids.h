@@ -30,6 +30,9 @@ typedef enum {
     can_messageid_set_serial_number = 0x30a,
     can_messageid_get_motor_usage_request = 0x30b,
     can_messageid_get_motor_usage_response = 0x30c,
+    can_messageid_transmit_lane_status_request = 0x30d,
+    can_messageid_transmit_lane_status_response = 0x30e,
+    can_messageid_multi_message_frame = 0xf,
     can_messageid_stop_request = 0x0,
     can_messageid_error_message = 0x2,
     can_messageid_get_status_request = 0x1,
@@ -48,6 +51,10 @@ typedef enum {
     can_messageid_clear_all_move_groups_request = 0x19,
     can_messageid_home_request = 0x20,
     can_messageid_add_sensor_move_request = 0x23,
+    can_messageid_add_jerk_move_request = 0x24,
+    can_messageid_execute_move_stream_request = 0x25,
+    can_messageid_end_move_stream_request = 0x26,
+    can_messageid_move_stream_credit_response = 0x27,
     can_messageid_move_completed = 0x13,
     can_messageid_motor_position_request = 0x12,
     can_messageid_motor_position_response = 0x14,
@@ -127,6 +134,10 @@ typedef enum {
     can_messageid_set_hepa_uv_state_request = 0x93,
     can_messageid_get_hepa_uv_state_request = 0x94,
     can_messageid_get_hepa_uv_state_response = 0x95,
+    can_messageid_sensor_stream_request = 0x96,
+    can_messageid_sensor_stream_response = 0x97,
+    can_messageid_sensor_stream_data = 0x98,
+    can_messageid_batch_sensor_stamps_response = 0x99,
 } CANMessageId;
 
 /** Can bus arbitration id node id. */
@@ -173,6 +184,7 @@ typedef enum {
     can_errorcode_reed_open = 0xf,
     can_errorcode_motor_driver_error_detected = 0x10,
     can_errorcode_safety_relay_inactive = 0x11,
+    can_errorcode_move_stream_underrun = 0x12,
 } CANErrorCode;
 
 /** Tool types detected on Head. */
@@ -215,8 +227,15 @@ typedef enum {
     can_sensoroutputbinding_max_threshold_sync = 0x4,
     can_sensoroutputbinding_auto_baseline_report = 0x8,
     can_sensoroutputbinding_multi_sensor_sync = 0x10,
+    can_sensoroutputbinding_stamp_samples = 0x20,
 } CANSensorOutputBinding;
 
+/** How a sensor's readings are streamed. */
+typedef enum {
+    can_sensorstreammode_batch = 0x0,
+    can_sensorstreammode_delta = 0x1,
+} CANSensorStreamMode;
+
 /** How a sensor's threshold should be interpreted. */
 typedef enum {
     can_sensorthresholdmode_absolute = 0x0,
@@ -0,0 +1,247 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#include "can/core/arbitration_id.hpp"
+#include "can/core/can_bus.hpp"
+#include "can/core/dispatch.hpp"
+#include "can/core/ids.hpp"
+#include "can/core/types.h"
+
+/*
+ * Receive filters generated from the messages a board's dispatcher takes.
+ *
+ * Each filter is a mask over the node id and message id fields of the
+ * arbitration id. There is one set of message id filters for broadcast
+ * frames and one for the board's own node ids, and a last filter that
+ * rejects everything else, so frames no dispatcher would take are dropped
+ * by the CAN peripheral instead of waking the receive interrupt.
+ *
+ * The filters may let through a few message ids that are not in the
+ * dispatcher; the dispatcher still ignores those.
+ */
+namespace can::acceptance_filter {
+
+using namespace can::ids;
+using ArbitrationId = can::arbitration_id::ArbitrationId;
+
+// The FDCAN on the STM32G4 has eight extended id filter elements.
+constexpr std::size_t max_filters = 8;
+
+// Message id filters per node filter: one node filter for broadcast and one
+// for the board's own node ids share what is left after the reject filter.
+constexpr std::size_t message_blocks = (max_filters - 1) / 2;
+
+/**
+ * A filter to program with CanBus::add_filter.
+ */
+struct Filter {
+    CanFilterType type;
+    CanFilterConfig config;
+    uint32_t val1;
+    uint32_t val2;
+};
+
+/**
+ * The filters for a board, in the order they are to be added.
+ */
+struct FilterTable {
+    std::array<Filter, max_filters> filters{};
+    std::size_t count = 0;
+
+    [[nodiscard]] constexpr auto begin() const { return filters.cbegin(); }
+    [[nodiscard]] constexpr auto end() const {
+        return filters.cbegin() + count;
+    }
+};
+
+/**
+ * An aligned power of two sized run of field values.
+ */
+struct Block {
+    uint32_t value;
+    uint32_t size;
+
+    [[nodiscard]] constexpr auto contains(const Block& other) const -> bool {
+        return other.value >= value && other.value < value + size;
+    }
+
+    /** The mask for this block in a field that is field_mask wide. */
+    [[nodiscard]] constexpr auto mask(uint32_t field_mask) const -> uint32_t {
+        return ~(size - 1) & field_mask;
+    }
+};
+
+/**
+ * The smallest block that holds both blocks.
+ */
+constexpr auto common_block(const Block& first, const Block& second)
+    -> Block {
+    auto size = std::max(first.size, second.size);
+    while ((first.value & ~(size - 1)) != (second.value & ~(size - 1))) {
+        size <<= 1;
+    }
+    return Block{.value = first.value & ~(size - 1), .size = size};
+}
+
+template <std::size_t N>
+struct Cover {
+    std::array<Block, N> blocks{};
+    std::size_t count = 0;
+};
+
+/**
+ * Cover a set of field values with at most budget blocks.
+ *
+ * Neighbouring blocks are merged for as long as a merge lets in no value
+ * that is not in the set, and then for as long as there are too many
+ * blocks, each time taking the merge that lets in the fewest.
+ *
+ * @param values The values, sorted and without repeats
+ * @param count The number of values
+ * @param budget The largest number of blocks to return
+ */
+template <std::size_t N>
+constexpr auto cover(const std::array<uint32_t, N>& values, std::size_t count,
+                     std::size_t budget) -> Cover<N> {
+    auto result = Cover<N>{};
+    for (std::size_t i = 0; i < count; ++i) {
+        result.blocks[result.count++] = Block{.value = values[i], .size = 1};
+    }
+    auto& blocks = result.blocks;
+    while (result.count > 1) {
+        auto best = Block{};
+        auto best_first = std::size_t{0};
+        auto best_last = std::size_t{0};
+        auto best_cost = std::numeric_limits<uint32_t>::max();
+        for (std::size_t i = 0; i + 1 < result.count; ++i) {
+            auto merged = common_block(blocks[i], blocks[i + 1]);
+            auto first = i;
+            while (first > 0 && merged.contains(blocks[first - 1])) {
+                --first;
+            }
+            auto last = i + 1;
+            auto covered = blocks[i].size;
+            for (auto j = first; j < i; ++j) {
+                covered += blocks[j].size;
+            }
+            while (last < result.count && merged.contains(blocks[last])) {
+                covered += blocks[last++].size;
+            }
+            if (merged.size - covered < best_cost) {
+                best = merged;
+                best_first = first;
+                best_last = last;
+                best_cost = merged.size - covered;
+            }
+        }
+        if (best_cost != 0 && result.count <= budget) {
+            break;
+        }
+        blocks[best_first] = best;
+        std::copy(blocks.begin() + best_last, blocks.begin() + result.count,
+                  blocks.begin() + best_first + 1);
+        result.count -= best_last - best_first - 1;
+    }
+    return result;
+}
+
+template <typename List>
+struct MessageIds;
+
+/**
+ * The sorted message ids of a MessageList and the multi message frame id,
+ * which the dispatchers unpack. An id may be listed more than once.
+ */
+template <typename... T>
+struct MessageIds<can::dispatch::MessageList<T...>> {
+    static constexpr auto value = []() {
+        auto ids = std::array<uint32_t, sizeof...(T) + 1>{
+            static_cast<uint32_t>(T::id)...,
+            static_cast<uint32_t>(MessageId::multi_message_frame)};
+        std::sort(ids.begin(), ids.end());
+        return ids;
+    }();
+};
+
+/**
+ * The message id blocks for a MessageList.
+ */
+template <typename List>
+constexpr auto message_cover = []() {
+    auto ids = MessageIds<List>::value;
+    auto count = static_cast<std::size_t>(
+        std::unique(ids.begin(), ids.end()) - ids.begin());
+    return cover(ids, count, message_blocks);
+}();
+
+/**
+ * Build the receive filters for a board.
+ *
+ * @tparam Messages The MessageList of the board's dispatcher
+ * @param nodes The node ids the board answers to, besides broadcast
+ * @return The filters to add.
+ */
+template <typename Messages, std::size_t NodeCount>
+requires(NodeCount > 0) constexpr auto compile(
+    const std::array<NodeId, NodeCount>& nodes) -> FilterTable {
+    auto node_block =
+        Block{.value = static_cast<uint32_t>(nodes[0]), .size = 1};
+    for (auto node : nodes) {
+        node_block = common_block(
+            node_block, Block{.value = static_cast<uint32_t>(node), .size = 1});
+    }
+    auto table = FilterTable{};
+    auto add = [&table](const Block& node, CanFilterConfig config) {
+        const auto& messages = message_cover<Messages>;
+        for (std::size_t i = 0; i < messages.count; ++i) {
+            const auto& message = messages.blocks[i];
+            table.filters[table.count++] = Filter{
+                .type = CanFilterType::mask,
+                .config = config,
+                .val1 = (node.value << ArbitrationId::node_id_shift) |
+                        (message.value << ArbitrationId::message_id_shift),
+                .val2 = (node.mask(ArbitrationId::node_id_mask)
+                         << ArbitrationId::node_id_shift) |
+                        (message.mask(ArbitrationId::message_id_mask)
+                         << ArbitrationId::message_id_shift)};
+        }
+    };
+    add(Block{.value = static_cast<uint32_t>(NodeId::broadcast), .size = 1},
+        CanFilterConfig::to_fifo0);
+    add(node_block, CanFilterConfig::to_fifo1);
+    table.filters[table.count++] = Filter{.type = CanFilterType::mask,
+                                          .config = CanFilterConfig::reject,
+                                          .val1 = 0,
+                                          .val2 = 0};
+    return table;
+}
+
+/**
+ * Build the receive filters for the messages a dispatcher takes.
+ *
+ * @tparam Dispatcher A ParsingDispatcher type
+ * @param nodes The node ids the board answers to, besides broadcast
+ * @return The filters to add.
+ */
+template <typename Dispatcher, std::same_as<NodeId>... Nodes>
+requires(sizeof...(Nodes) > 0) constexpr auto compile_for(Nodes... nodes)
+    -> FilterTable {
+    return compile<typename Dispatcher::Messages>(
+        std::array<NodeId, sizeof...(Nodes)>{nodes...});
+}
+
+/**
+ * Add a table of filters to a CAN bus.
+ */
+inline void add_filters(can::bus::CanBus& bus, const FilterTable& table) {
+    for (const auto& filter : table) {
+        bus.add_filter(filter.type, filter.config, filter.val1, filter.val2);
+    }
+}
+
+}  // namespace can::acceptance_filter
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+
+#include "can/core/can_message_buffer.hpp"
+#include "can/core/message_core.hpp"
+#include "common/core/bit_utils.hpp"
+#include "common/core/spsc_message_queue.hpp"
+
+namespace can::frame_pool {
+
+using namespace can::message_buffer;
+
+/**
+ * A received CAN frame, as stored in a pool slot.
+ */
+struct CanFrame {
+    uint32_t arbitration_id;
+    uint8_t length;
+    std::array<uint8_t, message_core::MaxMessageSize> data;
+};
+
+/**
+ * Slots kept beside a burst for the requests that come with it: clearing
+ * the move groups, executing one and the status polls in between.
+ */
+constexpr std::size_t burst_headroom = 8;
+
+/**
+ * The pool size that holds a burst of back to back frames, such as a full
+ * move group to each motor on a node, before the dispatching task runs.
+ *
+ * @param burst The number of frames in the burst.
+ */
+constexpr auto pool_size_for_burst(std::size_t burst) -> std::size_t {
+    return std::bit_ceil(burst + burst_headroom);
+}
+
+/**
+ * A fixed pool of CAN frame slots shared between the CAN receive interrupt
+ * and the task that dispatches received frames.
+ *
+ * The interrupt copies each frame into a free slot and hands the slot's
+ * index to the task; the task hands the slot straight to its listener and
+ * then gives the index back. The payload is written once and parsed where
+ * it lies instead of being copied through a message buffer.
+ *
+ * Slot ownership moves through two lock-free index rings: the free ring is
+ * written by the task and read by the interrupt, the ready ring the other
+ * way round. Exactly one interrupt may write frames and exactly one task
+ * may dispatch them.
+ *
+ * @tparam PoolSize The number of slots. Must be a power of two.
+ */
+template <std::size_t PoolSize>
+class CanFramePool {
+    static_assert(std::has_single_bit(PoolSize),
+                  "CanFramePool size must be a power of two");
+    static_assert(PoolSize <= 256, "CanFramePool indices are one byte");
+
+  public:
+    using Index = uint8_t;
+
+    CanFramePool() {
+        for (std::size_t i = 0; i < PoolSize; ++i) {
+            static_cast<void>(free_slots.try_write(static_cast<Index>(i)));
+        }
+    }
+    CanFramePool(const CanFramePool&) = delete;
+    CanFramePool(CanFramePool&&) = delete;
+    auto operator=(const CanFramePool&) -> CanFramePool& = delete;
+    auto operator=(CanFramePool&&) -> CanFramePool&& = delete;
+    ~CanFramePool() = default;
+
+    /**
+     * Copy a received frame into a free slot and mark it ready. Called from
+     * the receive interrupt. Payload bytes past the largest CAN FD frame are
+     * dropped.
+     *
+     * @param arbitration_id the arbitration id
+     * @param buffer Payload iterator
+     * @param limit End of payload
+     * @return False if there was no free slot and the frame was dropped.
+     */
+    template <bit_utils::ByteIterator Input, typename Limit>
+    requires std::sized_sentinel_for<Limit, Input>
+    auto write(uint32_t arbitration_id, Input buffer, Limit limit) -> bool {
+        auto index = Index{};
+        if (!free_slots.try_read(&index)) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        auto& frame = slots[index];
+        auto length = std::min(static_cast<std::size_t>(limit - buffer),
+                               frame.data.size());
+        frame.arbitration_id = arbitration_id;
+        frame.length = static_cast<uint8_t>(length);
+        std::copy_n(buffer, length, frame.data.begin());
+        static_cast<void>(ready_slots.try_write(index));
+        return true;
+    }
+
+    /**
+     * Hand the oldest ready frame to a listener and free its slot. Called
+     * from the dispatching task.
+     *
+     * @param listener The listener to handle the frame.
+     * @return False if no frame was ready.
+     */
+    template <CanMessageBufferListener Listener>
+    auto dispatch_one(Listener& listener) -> bool {
+        auto index = Index{};
+        if (!ready_slots.try_read(&index)) {
+            return false;
+        }
+        auto& frame = slots[index];
+        listener.handle(frame.arbitration_id, frame.data.begin(),
+                        frame.data.begin() + frame.length);
+        static_cast<void>(free_slots.try_write(index));
+        return true;
+    }
+
+    /**
+     * Dispatch ready frames until there are none left.
+     *
+     * @param listener The listener to handle the frames.
+     * @return The number of frames dispatched.
+     */
+    template <CanMessageBufferListener Listener>
+    auto dispatch_all(Listener& listener) -> std::size_t {
+        std::size_t count = 0;
+        while (dispatch_one(listener)) {
+            ++count;
+        }
+        return count;
+    }
+
+    [[nodiscard]] auto has_frame() const -> bool {
+        return ready_slots.has_message();
+    }
+
+    /**
+     * The number of frames that were dropped because every slot was in use.
+     * This is never reset.
+     */
+    [[nodiscard]] auto get_dropped_count() const -> uint32_t {
+        return dropped.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * The number of frames dropped since the last call. Called from the
+     * dispatching task.
+     */
+    auto take_new_drops() -> uint32_t {
+        auto count = get_dropped_count();
+        auto new_drops = count - reported_drops;
+        reported_drops = count;
+        return new_drops;
+    }
+
+  private:
+    std::array<CanFrame, PoolSize> slots{};
+    spsc_message_queue::SPSCMessageQueue<Index, PoolSize> free_slots{};
+    spsc_message_queue::SPSCMessageQueue<Index, PoolSize> ready_slots{};
+    std::atomic<uint32_t> dropped{0};
+    uint32_t reported_drops{0};
+};
+
+}  // namespace can::frame_pool
@@ -1,11 +1,13 @@
 #pragma once
 
 #include <array>
+#include <atomic>
 
 #include "can/core/can_bus.hpp"
 #include "can/core/ids.hpp"
 #include "can/core/message_core.hpp"
 #include "can/core/messages.hpp"
+#include "can/core/transmit_scheduler.hpp"
 #include "common/core/logging.h"
 #include "common/core/message_queue.hpp"
 
@@ -16,8 +18,59 @@ struct TaskMessage {
     can::messages::ResponseMessageType message;
 };
 
+/**
+ * The places for bulk messages between their senders and the bulk lane of
+ * the writer task. A sender takes one before it queues a bulk message and
+ * is turned away if there are none left; the writer task gives it back once
+ * the frame is sent. So the bulk lane always has room for what is queued,
+ * and only senders of bulk data feel the bus being busy.
+ */
+class BulkCredits {
+  public:
+    explicit BulkCredits(uint32_t limit) : limit{limit}, available{limit} {}
+
+    auto take() -> bool {
+        auto left = available.load();
+        while (left != 0) {
+            if (available.compare_exchange_weak(left, left - 1)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void give_back() {
+        auto left = available.load();
+        while (left < limit) {
+            if (available.compare_exchange_weak(left, left + 1)) {
+                return;
+            }
+        }
+    }
+
+    [[nodiscard]] auto get_available() const -> uint32_t {
+        return available.load();
+    }
+
+  private:
+    uint32_t limit;
+    std::atomic<uint32_t> available;
+};
+
 /**
  * Entry point for a CAN sender class.
+ *
+ * Messages are taken off the queue as soon as they arrive and held in a
+ * TransmitScheduler, so an error or a move ack never waits behind a burst
+ * of bulk data that was queued before it. The queue is always drained;
+ * senders of bulk data are held back by the task's BulkCredits instead, so
+ * the bulk lane has room for whatever they queue. If a message still finds
+ * its lane full, frames are sent until it has room.
+ *
+ * If coalescing is turned on, a small frame that would go out alone is held
+ * for up to coalesce_deadline_ticks so that responses queued right behind
+ * it can share its frame.
+ *
  * @tparam QueueImpl
  */
 template <template <class> class QueueImpl>
@@ -38,34 +91,106 @@ class MessageWriterTask {
 
     ~MessageWriterTask() = default;
 
+    // How long the bus is left to other traffic, in ticks, once a burst of
+    // bulk frames has been sent
+    static constexpr uint32_t bulk_holdoff_ticks = 2;
+
+    // How long a small frame waits, in ticks, for others to pack with it
+    static constexpr uint32_t coalesce_deadline_ticks = 1;
+
     /**
      * Task entry point.
      */
     [[noreturn]] void operator()(can::bus::CanBus* can) {
-        TaskMessage message{};
         while (true) {
-            if (queue.try_read(&message, queue.max_delay)) {
-                auto arbitration_id = message.arbitration_id;
-                std::visit(
-                    [this, can, arbitration_id](auto m) {
-                        this->handle(can, arbitration_id, m);
-                    },
-                    message.message);
-            }
+            run_once(can);
+        }
+    }
+
+    /**
+     * Take in everything that is queued, waiting if there is nothing to
+     * send, and then send the next frame.
+     */
+    void run_once(can::bus::CanBus* can) {
+        auto has_ready = scheduler.has_ready();
+        auto holding_off = !has_ready && scheduler.bulk_paused();
+        auto timeout = static_cast<uint32_t>(queue.max_delay);
+        if (has_ready) {
+            timeout = scheduler.next_is_alone() ? coalesce_deadline_ticks : 0;
+        } else if (holding_off) {
+            timeout = bulk_holdoff_ticks;
+        }
+        auto message = TaskMessage{};
+        if (queue.try_read(&message, timeout)) {
+            do {
+                take(can, message);
+            } while (queue.try_read(&message, 0));
+        } else if (holding_off) {
+            scheduler.resume_bulk();
         }
+        send_next(can);
     }
 
+    /**
+     * Pack small responses for the same node into multi message frames.
+     * Only turn this on if the receiving end unpacks them.
+     */
+    void set_coalescing(bool enabled) { scheduler.set_coalescing(enabled); }
+
     [[nodiscard]] auto get_queue() const -> QueueType& { return queue; }
 
+    [[nodiscard]] auto get_bulk_credits() -> BulkCredits& {
+        return bulk_credits;
+    }
+
+    [[nodiscard]] auto get_scheduler() const
+        -> const transmit_scheduler::TransmitScheduler& {
+        return scheduler;
+    }
+
   private:
-    void handle(can::bus::CanBus* can, uint32_t arbitration_id,
-                const auto& message) {
-        auto length = message.serialize(data.begin(), data.end());
-        can->send(arbitration_id, data.begin(), to_canfd_length(length));
+    using TransmitLane = transmit_scheduler::TransmitLane;
+
+    void take(can::bus::CanBus* can, const TaskMessage& message) {
+        auto lane = std::visit(
+            [](const auto& m) {
+                return transmit_scheduler::lane_of<
+                    std::remove_cvref_t<decltype(m)>>();
+            },
+            message.message);
+        while (scheduler.is_full(lane)) {
+            if (!send_next(can)) {
+                // the lane is full of paused bulk frames
+                scheduler.resume_bulk();
+            }
+        }
+        scheduler.push(message.arbitration_id, message.message);
+    }
+
+    auto send_next(can::bus::CanBus* can) -> bool {
+        auto bulk_before = scheduler.depth(TransmitLane::bulk);
+        auto frame = can::frame_pool::CanFrame{};
+        if (!scheduler.pop(frame)) {
+            return false;
+        }
+        send(can, frame);
+        if (scheduler.depth(TransmitLane::bulk) != bulk_before) {
+            bulk_credits.give_back();
+        }
+        return true;
+    }
+
+    static void send(can::bus::CanBus* can,
+                     can::frame_pool::CanFrame& frame) {
+        can->send(frame.arbitration_id, frame.data.data(),
+                  to_canfd_length(frame.length));
     }
 
     QueueType& queue;
-    std::array<uint8_t, message_core::MaxMessageSize> data{};
+    transmit_scheduler::TransmitScheduler scheduler{};
+    BulkCredits bulk_credits{
+        transmit_scheduler::TransmitScheduler::lane_depths[static_cast<
+            std::size_t>(TransmitLane::bulk)]};
 };
 
 /**
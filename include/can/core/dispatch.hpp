@@ -1,12 +1,17 @@
 #pragma once
 
-#include <functional>
+#include <concepts>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
 
 #include "arbitration_id.hpp"
 #include "can/core/ids.hpp"
 #include "can_message_buffer.hpp"
 #include "common/core/bit_utils.hpp"
 #include "common/core/message_buffer.hpp"
+#include "multi_message_frame.hpp"
 #include "parse.hpp"
 
 namespace can::dispatch {
@@ -22,25 +27,75 @@ using namespace can::arbitration_id;
 template <HasMessageID... T>
 class MessageIdCollection {
   public:
-    MessageIdCollection() {
-        // Use fold to populate array
-        auto i = 0;
-        ((([&i, this]() -> void { this->arr[i++] = T::id; })()), ...);
-        // Sort for binary search
-        std::sort(arr.begin(), arr.end());
-    }
-
     /**
      * Look up message id in collection
      * @param id message id
      * @return True if present
      */
     [[nodiscard]] auto in(can::ids::MessageId id) const -> bool {
-        return std::binary_search(arr.cbegin(), arr.cend(), id);
+        return MessageIdTable<T...>::contains(id);
     }
+};
 
-  private:
-    std::array<can::ids::MessageId, sizeof...(T)> arr{};
+/**
+ * A list of message types.
+ */
+template <typename... T>
+struct MessageList {};
+
+namespace detail {
+
+/**
+ * Append the types to List, skipping any it already has.
+ */
+template <typename List, typename... T>
+struct Union;
+
+template <typename... L>
+struct Union<MessageList<L...>> {
+    using type = MessageList<L...>;
+};
+
+template <typename... L, typename Head, typename... Tail>
+struct Union<MessageList<L...>, Head, Tail...> {
+    using type = typename std::conditional_t<
+        (std::same_as<Head, L> || ...), Union<MessageList<L...>, Tail...>,
+        Union<MessageList<L..., Head>, Tail...>>::type;
+};
+
+/**
+ * The types of all the lists, each once.
+ */
+template <typename... Lists>
+struct Join {
+    using type = MessageList<>;
+};
+
+template <typename... T, typename... Rest>
+struct Join<MessageList<T...>, Rest...> {
+    using type = typename Union<typename Join<Rest...>::type, T...>::type;
+};
+
+template <typename List>
+struct ParserFor;
+
+template <typename... T>
+struct ParserFor<MessageList<T...>> {
+    using type = Parser<T...>;
+};
+
+}  // namespace detail
+
+/**
+ * Concept describing a listener that takes messages that have already been
+ * parsed. It lists the message types it takes and is handed each of them
+ * with dispatch(arbitration_id, message).
+ * @tparam T The type of the class
+ */
+template <typename T>
+concept ParsedMessageListener = requires {
+    typename T::Messages;
+    { T::template accepts<std::monostate> } -> std::convertible_to<bool>;
 };
 
 /**
@@ -67,6 +122,12 @@ requires HandlesMessages<HandlerType, MessageTypes...> &&
   public:
     DispatchParseTarget(HandlerType& handler) : handler{handler}, parser{} {}
 
+    using Messages = MessageList<MessageTypes...>;
+
+    template <typename Message>
+    static constexpr bool accepts =
+        (std::same_as<Message, MessageTypes> || ...);
+
     template <bit_utils::ByteIterator Input, typename Limit>
     requires std::sentinel_for<Limit, Input>
     void handle(uint32_t arbitration_id, Input input, Limit limit) {
@@ -75,6 +136,17 @@ requires HandlesMessages<HandlerType, MessageTypes...> &&
         handler.handle(result);
     }
 
+    /**
+     * Hand the handler a message that a ParsingDispatcher has parsed.
+     */
+    template <typename Message>
+    requires accepts<Message>
+    void dispatch(uint32_t, const Message& message) {
+        auto result = typename Parser<MessageTypes...>::Result{
+            std::in_place_type<Message>, message};
+        handler.handle(result);
+    }
+
   private:
     HandlerType& handler;
     Parser<MessageTypes...> parser;
@@ -124,31 +196,131 @@ struct StandardArbIdTest {
 
 /**
  * A CanMessageBufferListener that will dispatch messages to other
- * CanMessageBufferListeners
+ * CanMessageBufferListeners. The messages in a multi message frame are handed
+ * on one at a time.
+ * @tparam ArbitrationIdTest Callable that decides from an arbitration id
+ * whether a message is for these listeners
  * @tparam Listener CanMessageBufferListener objects
  */
-template <CanMessageBufferListener... Listener>
+template <typename ArbitrationIdTest, CanMessageBufferListener... Listener>
+requires std::predicate<const ArbitrationIdTest&, uint32_t>
 class Dispatcher {
   public:
-    using ArbitrationIdTest = std::function<bool(uint32_t identifier)>;
     explicit Dispatcher(ArbitrationIdTest test, Listener&... listener)
         : registered{listener...}, test{std::move(test)} {}
 
     template <bit_utils::ByteIterator Input, typename Limit>
     requires std::sentinel_for<Limit, Input>
     void handle(uint32_t arbitration_id, Input input, Limit limit) {
+        if (!test(arbitration_id)) {
+            return;
+        }
+        if (multi_message_frame::is_multi_message_frame(arbitration_id)) {
+            multi_message_frame::for_each_entry(
+                arbitration_id, input, limit,
+                [this](uint32_t id, auto start, auto end) {
+                    handle(id, start, end);
+                });
+            return;
+        }
+        std::apply(
+            [arbitration_id, input, limit](auto&... x) {
+                (x.handle(arbitration_id, input, limit), ...);
+            },
+            registered);
+    }
+
+  private:
+    std::tuple<Listener&...> registered;
+    ArbitrationIdTest test;
+};
+
+/**
+ * A CanMessageBufferListener that parses each message once and hands it to
+ * only the listeners that take its type.
+ *
+ * The body is parsed by one Parser over the message types of all the
+ * listeners together, and the parsed message is passed by reference to
+ * each listener whose type list has it. Which listeners those are is
+ * decided while compiling.
+ *
+ * A ParsingDispatcher is itself a ParsedMessageListener, so dispatchers can
+ * be nested; a nested dispatcher applies its own arbitration id test to the
+ * messages it is handed. Multi message frames are unpacked and each message
+ * in them is parsed and routed on its own.
+ *
+ * @tparam ArbitrationIdTest Callable that decides from an arbitration id
+ * whether a message is for these listeners
+ * @tparam Listener ParsedMessageListener objects
+ */
+template <typename ArbitrationIdTest, ParsedMessageListener... Listener>
+requires std::predicate<const ArbitrationIdTest&, uint32_t>
+class ParsingDispatcher {
+  public:
+    using Messages =
+        typename detail::Join<typename Listener::Messages...>::type;
+
+    template <typename Message>
+    static constexpr bool accepts =
+        (Listener::template accepts<Message> || ...);
+
+    explicit ParsingDispatcher(ArbitrationIdTest test, Listener&... listener)
+        : registered{listener...}, test{std::move(test)} {}
+
+    template <bit_utils::ByteIterator Input, typename Limit>
+    requires std::sentinel_for<Limit, Input>
+    void handle(uint32_t arbitration_id, Input input, Limit limit) {
+        if (!test(arbitration_id)) {
+            return;
+        }
+        if (multi_message_frame::is_multi_message_frame(arbitration_id)) {
+            multi_message_frame::for_each_entry(
+                arbitration_id, input, limit,
+                [this](uint32_t id, auto start, auto end) {
+                    handle(id, start, end);
+                });
+            return;
+        }
+        auto arb = ArbitrationId(arbitration_id);
+        auto result = parser.parse(MessageId{arb.message_id()}, input, limit);
+        std::visit(
+            [this, arbitration_id](const auto& message) {
+                route(arbitration_id, message);
+            },
+            result);
+    }
+
+    template <typename Message>
+    requires accepts<Message>
+    void dispatch(uint32_t arbitration_id, const Message& message) {
         if (test(arbitration_id)) {
-            std::apply(
-                [arbitration_id, input, limit](auto&... x) {
-                    (x.handle(arbitration_id, input, limit), ...);
-                },
-                registered);
+            route(arbitration_id, message);
         }
     }
 
   private:
+    void route(uint32_t, const std::monostate&) {}
+
+    template <typename Message>
+    void route(uint32_t arbitration_id, const Message& message) {
+        std::apply(
+            [arbitration_id, &message](auto&... listener) {
+                (route_to(listener, arbitration_id, message), ...);
+            },
+            registered);
+    }
+
+    template <typename ListenerType, typename Message>
+    static void route_to(ListenerType& listener, uint32_t arbitration_id,
+                         const Message& message) {
+        if constexpr (ListenerType::template accepts<Message>) {
+            listener.dispatch(arbitration_id, message);
+        }
+    }
+
     std::tuple<Listener&...> registered;
     ArbitrationIdTest test;
+    typename detail::ParserFor<Messages>::type parser{};
 };
 
 }  // namespace can::dispatch
@@ -1,12 +1,19 @@
 #pragma once
 
+#include <atomic>
+
 #include "FreeRTOS.h"
 #include "can_bus.hpp"
+#include "can_frame_pool.hpp"
 #include "can_message_buffer.hpp"
 #include "common/core/freertos_message_buffer.hpp"
 #include "common/core/freertos_task.hpp"
+#include "common/core/logging.h"
 #include "dispatch.hpp"
 #include "message_core.hpp"
+#include "message_writer.hpp"
+#include "messages.hpp"
+#include "task.h"
 
 namespace can::freertos_dispatch {
 
@@ -15,6 +22,7 @@ using namespace message_buffer;
 using namespace can::bus;
 using namespace can::message_buffer;
 using namespace can::dispatch;
+using namespace can::frame_pool;
 using namespace freertos_message_buffer;
 using namespace freertos_task;
 
@@ -50,6 +58,145 @@ class FreeRTOSCanBufferPoller {
     CanMessageBufferReader<BufferType, Listener> reader;
 };
 
+/**
+ * A CanFramePool whose dispatching task sleeps until the CAN receive
+ * interrupt hands it a frame.
+ *
+ * @tparam PoolSize The number of frame slots.
+ */
+template <std::size_t PoolSize>
+class FreeRTOSCanFramePool {
+  public:
+    static auto constexpr max_delay = portMAX_DELAY;
+
+    FreeRTOSCanFramePool() = default;
+    FreeRTOSCanFramePool(const FreeRTOSCanFramePool&) = delete;
+    FreeRTOSCanFramePool(FreeRTOSCanFramePool&&) = delete;
+    auto operator=(const FreeRTOSCanFramePool&)
+        -> FreeRTOSCanFramePool& = delete;
+    auto operator=(FreeRTOSCanFramePool&&) -> FreeRTOSCanFramePool&& = delete;
+    ~FreeRTOSCanFramePool() = default;
+
+    /**
+     * Store a received frame and wake the task reading the pool. Called
+     * from the CAN receive interrupt.
+     *
+     * @param arbitration_id the arbitration id
+     * @param buffer Payload iterator
+     * @param limit End of payload
+     * @return False if the pool was full and the frame was dropped.
+     */
+    template <bit_utils::ByteIterator Input, typename Limit>
+    requires std::sized_sentinel_for<Limit, Input>
+    auto send_from_isr(uint32_t arbitration_id, Input buffer, Limit limit)
+        -> bool {
+        if (!pool.write(arbitration_id, buffer, limit)) {
+            return false;
+        }
+        auto* task = reader.load(std::memory_order_acquire);
+        if (task != nullptr) {
+            BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+            vTaskNotifyGiveFromISR(task, &xHigherPriorityTaskWoken);
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-cstyle-cast)
+            portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+        }
+        return true;
+    }
+
+    /**
+     * Wait for frames and dispatch every frame that is ready. Must always be
+     * called from the same task.
+     *
+     * @param listener The listener to handle the frames.
+     * @param timeout How long to wait if no frame is ready.
+     * @return The number of frames dispatched.
+     */
+    template <CanMessageBufferListener Listener, typename TimeoutType>
+    requires std::is_integral_v<TimeoutType>
+    auto read(Listener& listener, TimeoutType timeout) -> std::size_t {
+        reader.store(xTaskGetCurrentTaskHandle(), std::memory_order_release);
+        if (!pool.has_frame()) {
+            // A frame that arrives after the check above leaves a
+            // notification behind, so this returns at once.
+            ulTaskNotifyTake(pdTRUE, timeout);
+        }
+        auto count = pool.dispatch_all(listener);
+        report_drops();
+        return count;
+    }
+
+    [[nodiscard]] auto get_dropped_count() const -> uint32_t {
+        return pool.get_dropped_count();
+    }
+
+    /**
+     * Send the host an error after frames are dropped, since a request that
+     * never reached its handler otherwise only shows up as a timeout.
+     *
+     * @param writer The writer the error is sent through.
+     */
+    void set_drop_reporter(can::message_writer::MessageWriter& writer) {
+        drop_reporter = &writer;
+    }
+
+  private:
+    void report_drops() {
+        if (drop_reporter == nullptr) {
+            return;
+        }
+        auto drops = pool.take_new_drops();
+        if (drops == 0) {
+            return;
+        }
+        LOG("CAN receive pool full, %lu frames dropped",
+            static_cast<unsigned long>(drops));
+        drop_reporter->send_can_message(
+            can::ids::NodeId::host,
+            can::messages::ErrorMessage{
+                .message_index = 0,
+                .severity = can::ids::ErrorSeverity::recoverable,
+                .error_code = can::ids::ErrorCode::hardware});
+    }
+
+    CanFramePool<PoolSize> pool{};
+    std::atomic<TaskHandle_t> reader{nullptr};
+    can::message_writer::MessageWriter* drop_reporter{nullptr};
+};
+
+/**
+ * A FreeRTOS task entry point that dispatches the frames in a
+ * FreeRTOSCanFramePool.
+ *
+ * @tparam PoolSize The number of frame slots.
+ * @tparam Listener The CanMessageBufferListener type
+ */
+template <std::size_t PoolSize, CanMessageBufferListener Listener>
+class FreeRTOSCanFramePoller {
+  public:
+    using PoolType = FreeRTOSCanFramePool<PoolSize>;
+
+    /**
+     * Constructor
+     * @param pool The pool that the CAN receive interrupt writes to.
+     * @param listener The listener to be called back with each frame.
+     */
+    FreeRTOSCanFramePoller(PoolType& pool, Listener& listener)
+        : pool{pool}, listener{listener} {}
+
+    /**
+     * Task entry point.
+     */
+    [[noreturn]] void operator()() {
+        for (;;) {
+            pool.read(listener, pool.max_delay);
+        }
+    }
+
+  private:
+    PoolType& pool;
+    Listener& listener;
+};
+
 /**
  * A FreeRTOS message buffer for CAN messages along with a reader and writer.
  * @tparam BufferSize Size of the buffer in bytes.
@@ -70,32 +217,39 @@ struct FreeRTOSCanBufferControl {
 
 /**
  * A FreeRTOS task entry point that registers a callback with CAN, writes
- * messages to a MessageBuffer and dispatches new messages to Dispatcher.
+ * frames to a FreeRTOSCanFramePool and dispatches them to Dispatcher.
  *
- * @tparam BufferSize The message buffer size
+ * @tparam PoolSize The number of frame slots
  * @tparam Dispatcher The dispatcher to receive CAN messages.
  */
-template <std::size_t BufferSize, CanMessageBufferListener Dispatcher>
+template <std::size_t PoolSize, CanMessageBufferListener Dispatcher>
 class FreeRTOSCanReader {
   public:
-    using Control = FreeRTOSCanBufferControl<BufferSize, Dispatcher>;
     /**
      * Constructor
      */
-    FreeRTOSCanReader(Control& message_buffer)
-        : message_buffer{message_buffer} {}
+    FreeRTOSCanReader(Dispatcher& dispatcher) : dispatcher{dispatcher} {}
 
     /**
      * The task entry
      */
     [[noreturn]] void operator()(CanBus* can_bus) {
         can_bus->set_incoming_message_callback(
-            this, FreeRTOSCanReader<BufferSize, Dispatcher>::callback);
+            this, FreeRTOSCanReader<PoolSize, Dispatcher>::callback);
         for (;;) {
-            message_buffer.reader.read(message_buffer.message_buffer.max_delay);
+            frame_pool.read(dispatcher, frame_pool.max_delay);
         }
     }
 
+    /**
+     * Send the host an error after received frames are dropped.
+     *
+     * @param writer The writer the error is sent through.
+     */
+    void set_drop_reporter(can::message_writer::MessageWriter& writer) {
+        frame_pool.set_drop_reporter(writer);
+    }
+
   private:
     /**
      * CAN ISR callback
@@ -106,13 +260,14 @@ class FreeRTOSCanReader {
      */
     static void callback(void* instance_data, uint32_t identifier,
                          uint8_t* data, uint8_t length) {
-        auto instance = static_cast<FreeRTOSCanReader<BufferSize, Dispatcher>*>(
+        auto instance = static_cast<FreeRTOSCanReader<PoolSize, Dispatcher>*>(
             instance_data);
-        instance->message_buffer.writer.send_from_isr(identifier, data,
-                                                      data + length);  // NOLINT
+        instance->frame_pool.send_from_isr(identifier, data,
+                                           data + length);  // NOLINT
     }
 
-    Control& message_buffer;
+    FreeRTOSCanFramePool<PoolSize> frame_pool{};
+    Dispatcher& dispatcher;
 };
 
 }  // namespace can::freertos_dispatch
\ No newline at end of file
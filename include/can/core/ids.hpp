@@ -32,6 +32,9 @@ enum class MessageId {
     set_serial_number = 0x30a,
     get_motor_usage_request = 0x30b,
     get_motor_usage_response = 0x30c,
+    transmit_lane_status_request = 0x30d,
+    transmit_lane_status_response = 0x30e,
+    multi_message_frame = 0xf,
     stop_request = 0x0,
     error_message = 0x2,
     get_status_request = 0x1,
@@ -50,6 +53,10 @@ enum class MessageId {
     clear_all_move_groups_request = 0x19,
     home_request = 0x20,
     add_sensor_move_request = 0x23,
+    add_jerk_move_request = 0x24,
+    execute_move_stream_request = 0x25,
+    end_move_stream_request = 0x26,
+    move_stream_credit_response = 0x27,
     move_completed = 0x13,
     motor_position_request = 0x12,
     motor_position_response = 0x14,
@@ -129,6 +136,10 @@ enum class MessageId {
     set_hepa_uv_state_request = 0x93,
     get_hepa_uv_state_request = 0x94,
     get_hepa_uv_state_response = 0x95,
+    sensor_stream_request = 0x96,
+    sensor_stream_response = 0x97,
+    sensor_stream_data = 0x98,
+    batch_sensor_stamps_response = 0x99,
 };
 
 /** Can bus arbitration id node id. */
@@ -175,6 +186,7 @@ enum class ErrorCode {
     reed_open = 0xf,
     motor_driver_error_detected = 0x10,
     safety_relay_inactive = 0x11,
+    move_stream_underrun = 0x12,
 };
 
 /** Error Severity levels. */
@@ -225,6 +237,13 @@ enum class SensorOutputBinding {
     max_threshold_sync = 0x4,
     auto_baseline_report = 0x8,
     multi_sensor_sync = 0x10,
+    stamp_samples = 0x20,
+};
+
+/** How a sensor's readings are streamed. */
+enum class SensorStreamMode {
+    batch = 0x0,
+    delta = 0x1,
 };
 
 /** How a sensor's threshold should be interpreted. */
@@ -16,12 +16,15 @@ class MoveGroupHandler {
         std::variant<std::monostate, AddLinearMoveRequest,
                      ClearAllMoveGroupsRequest, ExecuteMoveGroupRequest,
                      GetMoveGroupRequest, HomeRequest, StopRequest,
-                     AddSensorMoveRequest>;
+                     AddSensorMoveRequest, AddJerkMoveRequest,
+                     ExecuteMoveStreamRequest, EndMoveStreamRequest>;
 #else
     using MessageType =
         std::variant<std::monostate, AddLinearMoveRequest,
                      ClearAllMoveGroupsRequest, ExecuteMoveGroupRequest,
-                     GetMoveGroupRequest, HomeRequest, StopRequest>;
+                     GetMoveGroupRequest, HomeRequest, StopRequest,
+                     AddJerkMoveRequest, ExecuteMoveStreamRequest,
+                     EndMoveStreamRequest>;
 #endif
 
     MoveGroupHandler(Client &task_client) : task_client{task_client} {}
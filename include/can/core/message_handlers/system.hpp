@@ -55,7 +55,8 @@ class SystemMessageHandler {
 
     using MessageType =
         std::variant<std::monostate, DeviceInfoRequest, InitiateFirmwareUpdate,
-                     FirmwareUpdateStatusRequest, TaskInfoRequest>;
+                     FirmwareUpdateStatusRequest, TaskInfoRequest,
+                     TransmitLaneStatusRequest>;
 
     /**
      * Message handler
@@ -98,6 +99,13 @@ class SystemMessageHandler {
         }
     }
 
+    void visit(TransmitLaneStatusRequest &m) {
+        // The writer task fills in the counts
+        auto r = TransmitLaneStatusResponse{};
+        can::messages::add_resp_ind(r, m);
+        writer.send_can_message(can::ids::NodeId::host, r);
+    }
+
     CanClient &writer;
     can::messages::DeviceInfoResponse response;
 };
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#include "can/core/ids.hpp"
+#include "message_core.hpp"
+
+namespace can::message_id_table {
+
+using namespace can::ids;
+using namespace can::message_core;
+
+namespace detail {
+
+// The arbitration id has 11 bits of message id
+constexpr int max_bits = 11;
+constexpr uint32_t candidates_per_size = 256;
+
+struct Layout {
+    uint32_t multiplier;
+    int bits;
+};
+
+constexpr auto slot(MessageId id, uint32_t multiplier, int bits)
+    -> std::size_t {
+    return (static_cast<uint32_t>(id) * multiplier) >> (32 - bits);
+}
+
+/**
+ * Scratch space for the search. A slot is only taken if its stamp matches
+ * the current attempt, so it never has to be cleared between attempts.
+ */
+template <typename Entry>
+struct Scratch {
+    std::array<uint16_t, std::size_t{1} << max_bits> stamps{};
+    std::array<Entry, std::size_t{1} << max_bits> owners{};
+    uint16_t attempt = 0;
+};
+
+template <typename Entry, std::size_t N>
+constexpr auto is_perfect(const std::array<MessageId, N>& ids,
+                          uint32_t multiplier, int bits,
+                          Scratch<Entry>& scratch) -> bool {
+    ++scratch.attempt;
+    for (std::size_t i = 0; i < N; ++i) {
+        auto index = slot(ids[i], multiplier, bits);
+        if (scratch.stamps[index] == scratch.attempt &&
+            ids[scratch.owners[index]] != ids[i]) {
+            return false;
+        }
+        scratch.stamps[index] = scratch.attempt;
+        scratch.owners[index] = static_cast<Entry>(i);
+    }
+    return true;
+}
+
+template <typename Entry, std::size_t N>
+constexpr auto find_layout(const std::array<MessageId, N>& ids) -> Layout {
+    auto scratch = Scratch<Entry>{};
+    auto bits = 1;
+    if (N > 1) {
+        bits = static_cast<int>(std::bit_width(2 * N - 1));
+    }
+    for (; bits < max_bits; ++bits) {
+        // The first candidate keeps the low bits of the id; the rest come
+        // from a fixed sequence of odd multipliers.
+        if (is_perfect(ids, 1U << (32 - bits), bits, scratch)) {
+            return Layout{.multiplier = 1U << (32 - bits), .bits = bits};
+        }
+        uint32_t multiplier = 0x9e3779b1;
+        for (uint32_t i = 0; i < candidates_per_size; ++i) {
+            if (is_perfect(ids, multiplier, bits, scratch)) {
+                return Layout{.multiplier = multiplier, .bits = bits};
+            }
+            multiplier = (multiplier * 1664525U + 1013904223U) | 1U;
+        }
+    }
+    return Layout{.multiplier = 1U << (32 - max_bits), .bits = max_bits};
+}
+
+template <typename Entry, std::size_t N, Layout layout>
+constexpr auto build_slots(const std::array<MessageId, N>& ids) {
+    std::array<Entry, std::size_t{1} << layout.bits> table{};
+    std::fill(table.begin(), table.end(), static_cast<Entry>(N));
+    for (std::size_t i = 0; i < N; ++i) {
+        table[slot(ids[i], layout.multiplier, layout.bits)] =
+            static_cast<Entry>(i);
+    }
+    return table;
+}
+
+}  // namespace detail
+
+/**
+ * A perfect hash from message id to the position of a type in a list of
+ * message types, built entirely at compile time.
+ *
+ * An id is hashed by multiplying it by a constant and keeping the top bits
+ * of the product. While compiling, multipliers are tried until one sends
+ * every id in the list to a slot of its own, doubling the table if none
+ * does. A table as wide as the message id field always works (the
+ * multiplier then just shifts the id into place), so the search ends.
+ *
+ * A lookup is a multiply, a shift, a table read and one compare.
+ *
+ * @tparam T Types that match the HasMessageID concept.
+ */
+template <HasMessageID... T>
+class MessageIdTable {
+    using Entry =
+        std::conditional_t<(sizeof...(T) < 0xff), uint8_t, uint16_t>;
+    static constexpr std::array<MessageId, sizeof...(T)> ids{T::id...};
+    static_assert(((static_cast<uint32_t>(T::id) <
+                    (1U << detail::max_bits)) &&
+                   ...),
+                  "message ids must fit in the arbitration id");
+    static constexpr detail::Layout layout =
+        detail::find_layout<Entry>(ids);
+    // Empty slots point one past the last id, at an id that cannot be
+    // received, so a lookup needs no separate check for them.
+    static constexpr auto slots =
+        detail::build_slots<Entry, sizeof...(T), layout>(ids);
+    static constexpr std::array<uint16_t, sizeof...(T) + 1> slot_ids{
+        static_cast<uint16_t>(T::id)..., 0xffff};
+
+  public:
+    /** The result of index_of for an id that is not in the table. */
+    static constexpr std::size_t npos = sizeof...(T);
+
+    /**
+     * Look up the position of a message id in T. If an id appears more than
+     * once the last position is returned.
+     *
+     * @param id message id
+     * @return position in T or npos
+     */
+    [[nodiscard]] static constexpr auto index_of(MessageId id) -> std::size_t {
+        std::size_t entry =
+            slots[detail::slot(id, layout.multiplier, layout.bits)];
+        return slot_ids[entry] == static_cast<uint16_t>(id) ? entry : npos;
+    }
+
+    /**
+     * Look up message id in table
+     * @param id message id
+     * @return True if present
+     */
+    [[nodiscard]] static constexpr auto contains(MessageId id) -> bool {
+        return index_of(id) != npos;
+    }
+
+    /** The number of slots in the table. */
+    [[nodiscard]] static constexpr auto table_size() -> std::size_t {
+        return slots.size();
+    }
+};
+
+}  // namespace can::message_id_table
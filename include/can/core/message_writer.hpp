@@ -1,6 +1,7 @@
 #pragma once
 
 #include <array>
+#include <type_traits>
 
 #include "arbitration_id.hpp"
 #include "can/core/can_writer_task.hpp"
@@ -18,11 +19,14 @@ class MessageWriter {
   public:
     using QueueType = freertos_message_queue::FreeRTOSMessageQueue<
         can::message_writer_task::TaskMessage>;
+    using WriterTaskType = can::message_writer_task::MessageWriterTask<
+        freertos_message_queue::FreeRTOSMessageQueue>;
 
     explicit MessageWriter(can::ids::NodeId node_id) : node_id(node_id) {}
 
     /**
-     * Write a message to the can bus
+     * Write a message to the can bus. Bulk data is turned away while the
+     * writer task has as much of it as its bulk lane holds.
      *
      * @tparam Serializable The message type
      * @param node The node id
@@ -42,14 +46,34 @@ class MessageWriter {
         arbitration_id.originating_node_id(node_id);
         task_message.arbitration_id = arbitration_id;
         task_message.message = message;
-        return queue->try_write(task_message);
+        constexpr bool bulk =
+            can::transmit_scheduler::lane_of<
+                std::remove_cvref_t<ResponseMessage>>() ==
+            can::transmit_scheduler::TransmitLane::bulk;
+        if constexpr (bulk) {
+            if (bulk_credits != nullptr && !bulk_credits->take()) {
+                return false;
+            }
+        }
+        if (!queue->try_write(task_message)) {
+            if (bulk && bulk_credits != nullptr) {
+                bulk_credits->give_back();
+            }
+            return false;
+        }
+        return true;
     }
 
     void set_queue(QueueType* q) { queue = q; }
+    void set_writer(WriterTaskType& writer) {
+        queue = &writer.get_queue();
+        bulk_credits = &writer.get_bulk_credits();
+    }
     void set_node_id(can::ids::NodeId id) { node_id = id; }
 
   private:
     can::ids::NodeId node_id;
     QueueType* queue{nullptr};
+    can::message_writer_task::BulkCredits* bulk_credits{nullptr};
 };
 }  // namespace can::message_writer
@@ -23,6 +23,10 @@ using stepper_timer_ticks = uint32_t;
 using brushed_timer_ticks = uint32_t;
 using mm_per_tick = int32_t;
 using um_per_tick_sq = int32_t;
+// Jerk needs far more resolution than a q0.31 um/tick^3 gives at stepper
+// timer rates, so it carries JERK_RADIX fractional bits instead of 31.
+using um_per_tick_cu = int32_t;
+constexpr const int JERK_RADIX = 47;
 
 /**
  * These types model the messages being sent and received over the can bus.
@@ -212,6 +216,34 @@ struct TaskInfoResponse : BaseMessage<MessageId::task_info_response> {
     auto operator==(const TaskInfoResponse& other) const -> bool = default;
 };
 
+using TransmitLaneStatusRequest =
+    Empty<MessageId::transmit_lane_status_request>;
+
+/**
+ * The number of frames waiting in each lane of the CAN transmit scheduler
+ * and the most there have been, in the order of
+ * can::transmit_scheduler::TransmitLane. The writer task fills in the
+ * counts when it takes this response.
+ */
+// NOLINTNEXTLINE(cppcoreguidelines-pro-type-member-init)
+struct TransmitLaneStatusResponse
+    : BaseMessage<MessageId::transmit_lane_status_response> {
+    uint32_t message_index;
+    std::array<uint8_t, 4> depth{};
+    std::array<uint8_t, 4> max_depth{};
+
+    template <bit_utils::ByteIterator Output, typename Limit>
+    auto serialize(Output body, Limit limit) const -> uint8_t {
+        auto iter = bit_utils::int_to_bytes(message_index, body, limit);
+        iter = std::copy(depth.cbegin(), depth.cend(), iter);
+        iter = std::copy(max_depth.cbegin(), max_depth.cend(), iter);
+        return iter - body;
+    }
+
+    auto operator==(const TransmitLaneStatusResponse& other) const
+        -> bool = default;
+};
+
 using StopRequest = Empty<MessageId::stop_request>;
 
 using EnableMotorRequest = Empty<MessageId::enable_motor_request>;
@@ -374,6 +406,56 @@ struct AddLinearMoveRequest : BaseMessage<MessageId::add_move_request> {
     auto operator==(const AddLinearMoveRequest& other) const -> bool = default;
 };
 
+/**
+ * A linear move whose acceleration changes at a constant rate, so that one
+ * segment can cover a whole S-curve ramp. jerk is in um/tick^3 with
+ * JERK_RADIX fractional bits; the other fields are as in
+ * AddLinearMoveRequest.
+ */
+struct AddJerkMoveRequest : BaseMessage<MessageId::add_jerk_move_request> {
+    uint32_t message_index;
+    uint8_t group_id;
+    uint8_t seq_id;
+    stepper_timer_ticks duration;
+    um_per_tick_sq acceleration;
+    mm_per_tick velocity;
+    um_per_tick_cu jerk;
+    uint8_t request_stop_condition;
+
+    template <bit_utils::ByteIterator Input, typename Limit>
+    static auto parse(Input body, Limit limit) -> AddJerkMoveRequest {
+        uint8_t group_id = 0;
+        uint8_t seq_id = 0;
+        stepper_timer_ticks duration = 0;
+        um_per_tick_sq acceleration = 0;
+        mm_per_tick velocity = 0;
+        um_per_tick_cu jerk = 0;
+        uint8_t request_stop_condition = 0;
+        uint32_t msg_ind = 0;
+
+        body = bit_utils::bytes_to_int(body, limit, msg_ind);
+        body = bit_utils::bytes_to_int(body, limit, group_id);
+        body = bit_utils::bytes_to_int(body, limit, seq_id);
+        body = bit_utils::bytes_to_int(body, limit, duration);
+        body = bit_utils::bytes_to_int(body, limit, acceleration);
+        body = bit_utils::bytes_to_int(body, limit, velocity);
+        body = bit_utils::bytes_to_int(body, limit, jerk);
+        body = bit_utils::bytes_to_int(body, limit, request_stop_condition);
+        return AddJerkMoveRequest{
+            .message_index = msg_ind,
+            .group_id = group_id,
+            .seq_id = seq_id,
+            .duration = duration,
+            .acceleration = acceleration,
+            .velocity = velocity,
+            .jerk = jerk,
+            .request_stop_condition = request_stop_condition,
+        };
+    }
+
+    auto operator==(const AddJerkMoveRequest& other) const -> bool = default;
+};
+
 struct HomeRequest : BaseMessage<MessageId::home_request> {
     uint32_t message_index;
     uint8_t group_id;
@@ -471,6 +553,43 @@ struct ExecuteMoveGroupRequest
 using ClearAllMoveGroupsRequest =
     Empty<MessageId::clear_all_move_groups_request>;
 
+/**
+ * Moves added with this group id while a move stream is open are run as
+ * soon as they arrive rather than stored in a move group.
+ */
+constexpr uint8_t MOVE_STREAM_GROUP_ID = 0xfe;
+
+/**
+ * Open a move stream. The node answers with a MoveStreamCreditResponse
+ * granting the number of segments the host may send ahead, and grants more
+ * with further MoveStreamCreditResponses as segments complete. If the
+ * stream runs out of segments before it is ended, the motor stops and a
+ * move_stream_underrun error is sent.
+ */
+using ExecuteMoveStreamRequest =
+    Empty<MessageId::execute_move_stream_request>;
+
+/**
+ * Close a move stream once the segments already sent have run. The stream
+ * completes with a MoveCompleted carrying this message's index.
+ */
+using EndMoveStreamRequest = Empty<MessageId::end_move_stream_request>;
+
+struct MoveStreamCreditResponse
+    : BaseMessage<MessageId::move_stream_credit_response> {
+    uint32_t message_index;
+    uint8_t credits;
+
+    template <bit_utils::ByteIterator Output, typename Limit>
+    auto serialize(Output body, Limit limit) const -> uint8_t {
+        auto iter = bit_utils::int_to_bytes(message_index, body, limit);
+        iter = bit_utils::int_to_bytes(credits, iter, limit);
+        return iter - body;
+    }
+    auto operator==(const MoveStreamCreditResponse& other) const
+        -> bool = default;
+};
+
 struct MoveCompleted : BaseMessage<MessageId::move_completed> {
     uint32_t message_index;
     uint8_t group_id;
@@ -1021,6 +1140,45 @@ struct BatchReadFromSensorResponse
         -> bool = default;
 };
 
+/**
+ * The stamps of the samples in the BatchReadFromSensorResponse sent just
+ * before it. The first sample's tick and step position are given whole and
+ * each one after that as its change from the sample before it.
+ */
+struct BatchSensorStampsResponse
+    : BaseMessage<MessageId::batch_sensor_stamps_response> {
+    uint32_t message_index = 0;
+    can::ids::SensorType sensor{};
+    can::ids::SensorId sensor_id{};
+    uint8_t data_length = 0;
+    uint32_t first_tick = 0;
+    uint32_t first_step_position = 0;
+    std::array<uint8_t, BATCH_SENSOR_MAX_LEN - 1> tick_deltas{};
+    std::array<int16_t, BATCH_SENSOR_MAX_LEN - 1> step_deltas{};
+
+    template <bit_utils::ByteIterator Output, typename Limit>
+    auto serialize(Output body, Limit limit) const -> uint8_t {
+        auto iter = bit_utils::int_to_bytes(message_index, body, limit);
+        iter =
+            bit_utils::int_to_bytes(static_cast<uint8_t>(sensor), iter, limit);
+        iter = bit_utils::int_to_bytes(static_cast<uint8_t>(sensor_id), iter,
+                                       limit);
+        iter = bit_utils::int_to_bytes(data_length, iter, limit);
+        iter = bit_utils::int_to_bytes(first_tick, iter, limit);
+        iter = bit_utils::int_to_bytes(first_step_position, iter, limit);
+        // statically sized like BatchReadFromSensorResponse
+        for (auto delta : tick_deltas) {
+            iter = bit_utils::int_to_bytes(delta, iter, limit);
+        }
+        for (auto delta : step_deltas) {
+            iter = bit_utils::int_to_bytes(delta, iter, limit);
+        }
+        return iter - body;
+    }
+    auto operator==(const BatchSensorStampsResponse& other) const
+        -> bool = default;
+};
+
 struct SetSensorThresholdRequest
     : BaseMessage<MessageId::set_sensor_threshold_request> {
     uint32_t message_index;
@@ -1410,6 +1568,115 @@ struct BindSensorOutputResponse
         -> bool = default;
 };
 
+struct SensorStreamRequest : BaseMessage<MessageId::sensor_stream_request> {
+    uint32_t message_index;
+    can::ids::SensorType sensor;
+    can::ids::SensorId sensor_id;
+    can::ids::SensorStreamMode mode;
+
+    template <bit_utils::ByteIterator Input, typename Limit>
+    static auto parse(Input body, Limit limit) -> SensorStreamRequest {
+        uint8_t _sensor = 0;
+        uint8_t _id = 0;
+        uint8_t _mode = 0;
+        uint32_t msg_ind = 0;
+
+        body = bit_utils::bytes_to_int(body, limit, msg_ind);
+        body = bit_utils::bytes_to_int(body, limit, _sensor);
+        body = bit_utils::bytes_to_int(body, limit, _id);
+        body = bit_utils::bytes_to_int(body, limit, _mode);
+        return SensorStreamRequest{
+            .message_index = msg_ind,
+            .sensor = static_cast<can::ids::SensorType>(_sensor),
+            .sensor_id = static_cast<can::ids::SensorId>(_id),
+            .mode = static_cast<can::ids::SensorStreamMode>(_mode)};
+    }
+
+    auto operator==(const SensorStreamRequest& other) const -> bool = default;
+};
+
+// The number of fractional bits in SensorStreamResponse::scale.
+constexpr int SENSOR_STREAM_SCALE_RADIX = 32;
+
+/**
+ * The reply to a SensorStreamRequest, with the mode the sensor will use,
+ * the time between its samples and the size of one count of a streamed
+ * sample in the sensor's units (Pa, pF), with SENSOR_STREAM_SCALE_RADIX
+ * fractional bits.
+ */
+struct SensorStreamResponse : BaseMessage<MessageId::sensor_stream_response> {
+    uint32_t message_index = 0;
+    can::ids::SensorType sensor{};
+    can::ids::SensorId sensor_id{};
+    can::ids::SensorStreamMode mode{};
+    uint16_t sample_period_us = 0;
+    uint32_t scale = 0;
+
+    template <bit_utils::ByteIterator Output, typename Limit>
+    auto serialize(Output body, Limit limit) const -> uint8_t {
+        auto iter = bit_utils::int_to_bytes(message_index, body, limit);
+        iter =
+            bit_utils::int_to_bytes(static_cast<uint8_t>(sensor), iter, limit);
+        iter = bit_utils::int_to_bytes(static_cast<uint8_t>(sensor_id), iter,
+                                       limit);
+        iter =
+            bit_utils::int_to_bytes(static_cast<uint8_t>(mode), iter, limit);
+        iter = bit_utils::int_to_bytes(sample_period_us, iter, limit);
+        iter = bit_utils::int_to_bytes(scale, iter, limit);
+        return iter - body;
+    }
+
+    auto operator==(const SensorStreamResponse& other) const
+        -> bool = default;
+};
+
+// Max len = max size - uint32(message_index) - 2x uint8(sensor_type,
+// sensor_id) - uint16(sequence) - uint32(first_sample) - uint32(first_tick)
+// - 2x uint8 (sample_count, data_length)
+constexpr size_t SENSOR_STREAM_MAX_BYTES = size_t(
+    can::message_core::MaxMessageSize - 4 - 1 - 1 - 2 - 4 - 4 - 1 - 1);
+
+/**
+ * Delta encoded sensor samples, each a whole number of counts of the scale
+ * in the SensorStreamResponse; see common/core/delta_encoding.hpp.
+ * sequence counts the frames of the stream and first_sample is the number
+ * of the first sample in this frame counted from the start of the stream,
+ * so a missing frame or dropped samples show up as a gap. first_tick is
+ * the scheduler tick the first sample was taken at; the rest follow it a
+ * sample period apart.
+ */
+struct SensorStreamData : BaseMessage<MessageId::sensor_stream_data> {
+    uint32_t message_index = 0;
+    can::ids::SensorType sensor{};
+    can::ids::SensorId sensor_id{};
+    uint16_t sequence = 0;
+    uint32_t first_sample = 0;
+    uint32_t first_tick = 0;
+    uint8_t sample_count = 0;
+    uint8_t data_length = 0;
+    std::array<uint8_t, SENSOR_STREAM_MAX_BYTES> data{};
+
+    template <bit_utils::ByteIterator Output, typename Limit>
+    auto serialize(Output body, Limit limit) const -> uint8_t {
+        auto iter = bit_utils::int_to_bytes(message_index, body, limit);
+        iter =
+            bit_utils::int_to_bytes(static_cast<uint8_t>(sensor), iter, limit);
+        iter = bit_utils::int_to_bytes(static_cast<uint8_t>(sensor_id), iter,
+                                       limit);
+        iter = bit_utils::int_to_bytes(sequence, iter, limit);
+        iter = bit_utils::int_to_bytes(first_sample, iter, limit);
+        iter = bit_utils::int_to_bytes(first_tick, iter, limit);
+        iter = bit_utils::int_to_bytes(sample_count, iter, limit);
+        iter = bit_utils::int_to_bytes(data_length, iter, limit);
+        for (auto i = 0; i < data_length && iter != limit; i++) {
+            *iter++ = data.at(i);
+        }
+        return iter - body;
+    }
+
+    auto operator==(const SensorStreamData& other) const -> bool = default;
+};
+
 using TipStatusQueryRequest = Empty<MessageId::get_tip_status_request>;
 
 // NOLINTNEXTLINE(cppcoreguidelines-pro-type-member-init)
@@ -1926,6 +2193,8 @@ using ResponseMessageType = std::variant<
     PushTipPresenceNotification, GetMotorUsageResponse, GripperJawStateResponse,
     GripperJawHoldoffResponse, HepaUVInfoResponse, GetHepaFanStateResponse,
     GetHepaUVStateResponse, MotorStatusResponse, GearMotorStatusResponse,
-    ReadMotorDriverErrorStatusResponse>;
+    ReadMotorDriverErrorStatusResponse, MoveStreamCreditResponse,
+    TransmitLaneStatusResponse, SensorStreamResponse, SensorStreamData,
+    BatchSensorStampsResponse>;
 
 }  // namespace can::messages
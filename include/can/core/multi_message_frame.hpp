@@ -0,0 +1,150 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <ranges>
+
+#include "can/core/arbitration_id.hpp"
+#include "can/core/can_frame_pool.hpp"
+#include "can/core/ids.hpp"
+#include "can/core/message_core.hpp"
+#include "common/core/bit_utils.hpp"
+
+/*
+ * A multi message frame carries several small messages for the same node in
+ * one CAN frame. Its body is a count followed by that many entries, each a
+ * two byte message id, a one byte payload length and the payload. Every
+ * entry has the arbitration id of the frame with its own message id put in.
+ * Anything after the last entry is padding.
+ */
+namespace can::multi_message_frame {
+
+using namespace can::ids;
+
+constexpr std::size_t header_size = 1;
+constexpr std::size_t entry_header_size = 3;
+
+/**
+ * True if two arbitration ids differ only in their message id, so messages
+ * sent with them can share a frame.
+ */
+constexpr auto same_route(uint32_t first, uint32_t second) -> bool {
+    constexpr auto mask = static_cast<uint32_t>(
+        can::arbitration_id::ArbitrationId::message_id_bit_mask);
+    return (first & ~mask) == (second & ~mask);
+}
+
+/**
+ * True if a frame with this much payload can go in a multi message frame
+ * along with at least one more message.
+ */
+constexpr auto packable(std::size_t length) -> bool {
+    return header_size + 2 * entry_header_size + length <=
+           message_core::MaxMessageSize;
+}
+
+/**
+ * Builds a multi message frame out of serialized frames.
+ */
+class Packer {
+  public:
+    /**
+     * Start a multi message frame with a first message.
+     */
+    explicit Packer(const can::frame_pool::CanFrame& first) {
+        auto arb = can::arbitration_id::ArbitrationId{first.arbitration_id};
+        arb.message_id(MessageId::multi_message_frame);
+        frame.arbitration_id = arb;
+        frame.length = header_size;
+        frame.data[0] = 0;
+        static_cast<void>(add(first));
+    }
+
+    /**
+     * Add a message if it goes to the same place as the first one and there
+     * is room for it.
+     *
+     * @return False if the message was not added.
+     */
+    auto add(const can::frame_pool::CanFrame& message) -> bool {
+        if (!same_route(frame.arbitration_id, message.arbitration_id) ||
+            frame.length + entry_header_size + message.length >
+                frame.data.size()) {
+            return false;
+        }
+        auto arb = can::arbitration_id::ArbitrationId{message.arbitration_id};
+        auto* iter = frame.data.begin() + frame.length;
+        iter = bit_utils::int_to_bytes(static_cast<uint16_t>(arb.message_id()),
+                                       iter, frame.data.end());
+        *iter++ = message.length;
+        iter = std::copy_n(message.data.cbegin(), message.length, iter);
+        frame.length = static_cast<uint8_t>(iter - frame.data.begin());
+        frame.data[0]++;
+        return true;
+    }
+
+    [[nodiscard]] auto count() const -> std::size_t { return frame.data[0]; }
+
+    [[nodiscard]] auto get() const -> const can::frame_pool::CanFrame& {
+        return frame;
+    }
+
+  private:
+    can::frame_pool::CanFrame frame{};
+};
+
+/**
+ * Call a function with the arbitration id and payload of each message in a
+ * multi message frame. Entries that run past the end of the frame, and
+ * multi message frames inside the frame, are skipped.
+ *
+ * @param arbitration_id The arbitration id of the multi message frame
+ * @param input Start of the frame's payload
+ * @param limit End of the frame's payload
+ * @param callback Called with (arbitration id, input, limit) of each entry.
+ * @return The number of entries handed to callback.
+ */
+template <bit_utils::ByteIterator Input, typename Limit, typename Callback>
+requires std::sentinel_for<Limit, Input>
+auto for_each_entry(uint32_t arbitration_id, Input input, Limit limit,
+                    Callback&& callback) -> std::size_t {
+    if (input == limit) {
+        return 0;
+    }
+    auto count = static_cast<std::size_t>(*input++);
+    std::size_t handled = 0;
+    auto arb = can::arbitration_id::ArbitrationId{arbitration_id};
+    for (std::size_t i = 0; i < count; ++i) {
+        if (std::ranges::distance(input, limit) <
+            static_cast<std::ptrdiff_t>(entry_header_size)) {
+            break;
+        }
+        uint16_t message_id = 0;
+        input = bit_utils::bytes_to_int(input, limit, message_id);
+        auto length = static_cast<std::ptrdiff_t>(*input++);
+        if (std::ranges::distance(input, limit) < length) {
+            break;
+        }
+        auto end = std::next(input, length);
+        if (static_cast<MessageId>(message_id) !=
+            MessageId::multi_message_frame) {
+            arb.message_id(static_cast<MessageId>(message_id));
+            callback(arb.get_id(), input, end);
+            ++handled;
+        }
+        input = end;
+    }
+    return handled;
+}
+
+/**
+ * True if an arbitration id is that of a multi message frame.
+ */
+inline auto is_multi_message_frame(uint32_t arbitration_id) -> bool {
+    return can::arbitration_id::ArbitrationId{arbitration_id}.message_id() ==
+           MessageId::multi_message_frame;
+}
+
+}  // namespace can::multi_message_frame
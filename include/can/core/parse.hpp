@@ -1,15 +1,18 @@
 #pragma once
 
+#include <array>
 #include <variant>
 
 #include "can/core/ids.hpp"
 #include "common/core/bit_utils.hpp"
 #include "message_core.hpp"
+#include "message_id_table.hpp"
 
 namespace can::parse {
 
 using namespace can::ids;
 using namespace can::message_core;
+using namespace can::message_id_table;
 
 /**
  * Parser of can message bodies.
@@ -31,18 +34,30 @@ class Parser {
     template <bit_utils::ByteIterator Iterator>
     auto parse(MessageId message_id, const Iterator& payload,
                const Iterator& limit) -> Result {
-        auto result = Result{std::monostate{}};
-        // Fold expression over Parsable template type.
-        // Create a lambda that accepts the id and body.
-        ((([&result, message_id, &payload, &limit]() -> void {
-             // If message id matches Parsable's id parse will build the result.
-             if (message_id == T::id) {
-                 result = T::parse(payload, limit);
-             }
-         })()),
-         ...);
-        return result;
+        auto index = Table::index_of(message_id);
+        if (index == Table::npos) {
+            return Result{std::monostate{}};
+        }
+        return parsers<Iterator>[index](payload, limit);
     }
+
+  private:
+    using Table = MessageIdTable<T...>;
+
+    template <bit_utils::ByteIterator Iterator>
+    using ParseFunction = auto (*)(const Iterator&, const Iterator&) -> Result;
+
+    template <typename Message, bit_utils::ByteIterator Iterator>
+    static auto parse_as(const Iterator& payload, const Iterator& limit)
+        -> Result {
+        return Message::parse(payload, limit);
+    }
+
+    // Parse functions in the same order as T, so the position the table
+    // finds for an id is the function to call.
+    template <bit_utils::ByteIterator Iterator>
+    static constexpr std::array<ParseFunction<Iterator>, sizeof...(T)>
+        parsers{&parse_as<T, Iterator>...};
 };
 
 }  // namespace can::parse
@@ -0,0 +1,264 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <variant>
+
+#include "can/core/can_frame_pool.hpp"
+#include "can/core/messages.hpp"
+#include "can/core/multi_message_frame.hpp"
+
+namespace can::transmit_scheduler {
+
+using namespace can::messages;
+
+/**
+ * The lanes of the transmit scheduler, highest priority first.
+ */
+enum class TransmitLane : uint8_t {
+    // Errors and stop requests
+    error,
+    // Move acks, which the host's move group timing waits on
+    motion_ack,
+    // Everything else
+    response,
+    // Data that is sent in large amounts
+    bulk,
+};
+
+constexpr std::size_t lane_count = 4;
+
+template <typename Message, typename... T>
+constexpr bool is_any_of = (std::is_same_v<Message, T> || ...);
+
+/**
+ * The lane a response message type is sent in.
+ */
+template <typename Message>
+constexpr auto lane_of() -> TransmitLane {
+    if constexpr (is_any_of<Message, ErrorMessage, StopRequest>) {
+        return TransmitLane::error;
+    } else if constexpr (is_any_of<Message, MoveCompleted, TipActionResponse,
+                                   MoveStreamCreditResponse>) {
+        return TransmitLane::motion_ack;
+    } else if constexpr (is_any_of<Message, ReadFromSensorResponse,
+                                   BatchReadFromSensorResponse,
+                                   BatchSensorStampsResponse,
+                                   SensorStreamData, TaskInfoResponse>) {
+        return TransmitLane::bulk;
+    } else {
+        return TransmitLane::response;
+    }
+}
+
+/**
+ * Orders serialized CAN frames for transmission.
+ *
+ * Frames are kept in one FIFO lane per message class and the highest
+ * priority lane that has a frame is always sent first. Bulk frames are
+ * also capped: after bulk_burst of them in a row the bulk lane is paused
+ * until a frame from another lane is sent or the owner resumes it, which
+ * the writer task does once the bus has been left to other traffic for a
+ * while.
+ *
+ * With coalescing turned on, small acks and responses at the head of their
+ * lane that go to the same node are sent together in one multi message
+ * frame. It is off by default because the receiver has to unpack them.
+ */
+class TransmitScheduler {
+  public:
+    static constexpr std::array<std::size_t, lane_count> lane_depths{4, 8, 4,
+                                                                     4};
+    static constexpr std::size_t bulk_burst = 4;
+
+    /**
+     * Serialize a message into the back of its lane.
+     *
+     * @param arbitration_id The arbitration id
+     * @param message The message
+     * @return False if the lane is full.
+     */
+    auto push(uint32_t arbitration_id, const ResponseMessageType& message)
+        -> bool {
+        return std::visit(
+            [this, arbitration_id](const auto& m) -> bool {
+                return this->push(arbitration_id, m);
+            },
+            message);
+    }
+
+    template <typename Message>
+    auto push(uint32_t arbitration_id, const Message& message) -> bool {
+        constexpr auto lane = static_cast<std::size_t>(lane_of<Message>());
+        if (counts[lane] == lane_depths[lane]) {
+            return false;
+        }
+        auto& frame = slot(lane, counts[lane]);
+        frame.arbitration_id = arbitration_id;
+        if constexpr (std::is_same_v<Message, TransmitLaneStatusResponse>) {
+            auto status = message;
+            fill_status(status);
+            frame.length =
+                status.serialize(frame.data.begin(), frame.data.end());
+        } else {
+            frame.length =
+                message.serialize(frame.data.begin(), frame.data.end());
+        }
+        counts[lane]++;
+        max_counts[lane] = std::max(max_counts[lane], counts[lane]);
+        return true;
+    }
+
+    /**
+     * Take the next frame to send.
+     *
+     * @param frame Set to the frame to send.
+     * @return False if no lane may send.
+     */
+    auto pop(can::frame_pool::CanFrame& frame) -> bool {
+        for (std::size_t lane = 0; lane < lane_count; ++lane) {
+            if (counts[lane] == 0 || (is_bulk(lane) && bulk_paused())) {
+                continue;
+            }
+            take(lane, frame);
+            if (coalescing && may_coalesce(lane)) {
+                coalesce(lane, frame);
+            }
+            if (is_bulk(lane)) {
+                bulk_sent++;
+            } else {
+                bulk_sent = 0;
+            }
+            return true;
+        }
+        return false;
+    }
+
+    /** True if pop() has a frame to send. */
+    [[nodiscard]] auto has_ready() const -> bool {
+        for (std::size_t lane = 0; lane < lane_count; ++lane) {
+            if (counts[lane] != 0 && !(is_bulk(lane) && bulk_paused())) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * True if the frame pop() would send next is a small frame with nothing
+     * behind it in its lane, so it would be sent on its own.
+     */
+    [[nodiscard]] auto next_is_alone() const -> bool {
+        for (std::size_t lane = 0; lane < lane_count; ++lane) {
+            if (counts[lane] != 0 && !(is_bulk(lane) && bulk_paused())) {
+                return coalescing && may_coalesce(lane) &&
+                       counts[lane] == 1 &&
+                       multi_message_frame::packable(
+                           frames[lane_offsets[lane] + heads[lane]].length);
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Turn packing small frames together on or off. Only the motion ack and
+     * response lanes are packed. A multi message frame goes out with a low
+     * message id, so packed bulk data would win arbitration over other
+     * nodes' acks, and errors are sent on their own as soon as they are
+     * queued.
+     */
+    void set_coalescing(bool enabled) { coalescing = enabled; }
+
+    [[nodiscard]] auto get_coalescing() const -> bool { return coalescing; }
+
+    [[nodiscard]] auto bulk_paused() const -> bool {
+        return bulk_sent >= bulk_burst;
+    }
+
+    void resume_bulk() { bulk_sent = 0; }
+
+    [[nodiscard]] auto is_full(TransmitLane lane) const -> bool {
+        auto index = static_cast<std::size_t>(lane);
+        return counts[index] == lane_depths[index];
+    }
+
+    [[nodiscard]] auto depth(TransmitLane lane) const -> uint8_t {
+        return counts[static_cast<std::size_t>(lane)];
+    }
+
+    [[nodiscard]] auto max_depth(TransmitLane lane) const -> uint8_t {
+        return max_counts[static_cast<std::size_t>(lane)];
+    }
+
+  private:
+    static constexpr auto lane_offsets = []() {
+        auto offsets = std::array<std::size_t, lane_count>{};
+        for (std::size_t lane = 1; lane < lane_count; ++lane) {
+            offsets[lane] = offsets[lane - 1] + lane_depths[lane - 1];
+        }
+        return offsets;
+    }();
+    static constexpr std::size_t total_depth =
+        lane_offsets[lane_count - 1] + lane_depths[lane_count - 1];
+    static_assert(std::tuple_size_v<decltype(
+                      TransmitLaneStatusResponse::depth)> == lane_count,
+                  "TransmitLaneStatusResponse must report every lane");
+
+    static constexpr auto is_bulk(std::size_t lane) -> bool {
+        return lane == static_cast<std::size_t>(TransmitLane::bulk);
+    }
+
+    static constexpr auto may_coalesce(std::size_t lane) -> bool {
+        return lane == static_cast<std::size_t>(TransmitLane::motion_ack) ||
+               lane == static_cast<std::size_t>(TransmitLane::response);
+    }
+
+    auto slot(std::size_t lane, std::size_t position)
+        -> can::frame_pool::CanFrame& {
+        return frames[lane_offsets[lane] +
+                      (heads[lane] + position) % lane_depths[lane]];
+    }
+
+    void take(std::size_t lane, can::frame_pool::CanFrame& frame) {
+        frame = slot(lane, 0);
+        heads[lane] = (heads[lane] + 1) % lane_depths[lane];
+        counts[lane]--;
+    }
+
+    /**
+     * Pack the frames that follow a frame in its lane in with it, for as
+     * long as they go to the same node and fit.
+     */
+    void coalesce(std::size_t lane, can::frame_pool::CanFrame& frame) {
+        if (counts[lane] == 0 ||
+            !multi_message_frame::packable(frame.length)) {
+            return;
+        }
+        auto packer = multi_message_frame::Packer{frame};
+        while (counts[lane] != 0 && packer.add(slot(lane, 0))) {
+            heads[lane] = (heads[lane] + 1) % lane_depths[lane];
+            counts[lane]--;
+        }
+        if (packer.count() > 1) {
+            frame = packer.get();
+        }
+    }
+
+    void fill_status(TransmitLaneStatusResponse& status) const {
+        status.depth = counts;
+        status.max_depth = max_counts;
+    }
+
+    std::array<can::frame_pool::CanFrame, total_depth> frames{};
+    std::array<uint8_t, lane_count> heads{};
+    std::array<uint8_t, lane_count> counts{};
+    std::array<uint8_t, lane_count> max_counts{};
+    std::size_t bulk_sent = 0;
+    bool coalescing = false;
+};
+
+}  // namespace can::transmit_scheduler
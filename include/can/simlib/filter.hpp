@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+
 #include "can/core/types.h"
 
 namespace can::sim::filter {
@@ -26,20 +28,29 @@ class Filter {
      * @return True if message is to be accepted by this filter.
      */
     bool operator()(uint32_t arbitration_id) const {
-        auto matches = false;
+        // Return true only if the filter matched and the config is not reject.
+        return matches(arbitration_id) ? !rejects() : false;
+    }
+
+    /**
+     * @param arbitration_id
+     * @return True if the arbitration id matches this filter.
+     */
+    [[nodiscard]] auto matches(uint32_t arbitration_id) const -> bool {
         switch (type) {
             case (CanFilterType::mask):
-                matches = (val2 & arbitration_id) == val1;
-                break;
+                return (val2 & arbitration_id) == val1;
             case (CanFilterType::range):
-                matches = arbitration_id >= val1 && arbitration_id <= val2;
-                break;
+                return arbitration_id >= val1 && arbitration_id <= val2;
             case (CanFilterType::exact):
-                matches = arbitration_id == val1 || arbitration_id == val2;
-                break;
+                return arbitration_id == val1 || arbitration_id == val2;
         }
-        // Return true only if the filter matched and the config is not reject.
-        return matches ? config != CanFilterConfig::reject : false;
+        return false;
+    }
+
+    /** True if messages that match this filter are rejected. */
+    [[nodiscard]] auto rejects() const -> bool {
+        return config == CanFilterConfig::reject;
     }
 
   private:
@@ -49,4 +60,22 @@ class Filter {
     uint32_t val2;
 };
 
+/**
+ * Apply filters the way the FDCAN does: the first filter that matches
+ * decides, and a message that matches no filter is accepted.
+ *
+ * @param filters The filters, in the order they were added
+ * @param arbitration_id
+ * @return True if the message is accepted.
+ */
+template <typename Filters>
+auto accepts(const Filters& filters, uint32_t arbitration_id) -> bool {
+    for (const auto& filter : filters) {
+        if (filter.matches(arbitration_id)) {
+            return !filter.rejects();
+        }
+    }
+    return true;
+}
+
 }  // namespace can::sim::filter
\ No newline at end of file
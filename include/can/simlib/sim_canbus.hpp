@@ -106,12 +106,9 @@ class SimCANBus : public CanBus {
                     break;
                 }
 
-                // If there are filters and any of them return true we can
-                // accept the message.
-                if (bus->filters.empty() ||
-                    std::any_of(
-                        bus->filters.cbegin(), bus->filters.cend(),
-                        [arb_id](const auto& f) { return f(arb_id); })) {
+                // The first filter the message matches decides whether it
+                // is accepted, as it does in the FDCAN.
+                if (can::sim::filter::accepts(bus->filters, arb_id)) {
                     if (bus->new_message_callback) {
                         bus->new_message_callback(
                             bus->new_message_callback_data, arb_id,
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <ranges>
+
+#include "common/core/bit_utils.hpp"
+
+/*
+ * Delta encoding of a series of 32 bit samples.
+ *
+ * Each sample is stored as its difference from the one before it (the
+ * first as its difference from 0), zigzag mapped so that small negative
+ * differences are small numbers, and written as a varint: seven bits per
+ * byte, least significant first, with the top bit set on every byte but
+ * the last. A slowly changing signal takes one or two bytes a sample
+ * instead of four.
+ */
+namespace delta_encoding {
+
+// A 32 bit value never takes more than five varint bytes.
+constexpr std::size_t max_varint_size = 5;
+
+constexpr auto zigzag(int32_t value) -> uint32_t {
+    return (static_cast<uint32_t>(value) << 1) ^
+           static_cast<uint32_t>(value >> 31);
+}
+
+constexpr auto unzigzag(uint32_t value) -> int32_t {
+    return static_cast<int32_t>((value >> 1) ^ (~(value & 1) + 1));
+}
+
+constexpr auto varint_size(uint32_t value) -> std::size_t {
+    std::size_t size = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        ++size;
+    }
+    return size;
+}
+
+/**
+ * Write a varint.
+ *
+ * @return Iterator at one past the last byte written, or output if the
+ * value does not fit before limit.
+ */
+template <bit_utils::ByteIterator Output, typename Limit>
+requires std::sentinel_for<Limit, Output>
+auto write_varint(uint32_t value, Output output, Limit limit) -> Output {
+    if (std::ranges::distance(output, limit) <
+        static_cast<std::ptrdiff_t>(varint_size(value))) {
+        return output;
+    }
+    while (value >= 0x80) {
+        *output++ = static_cast<uint8_t>(value | 0x80);
+        value >>= 7;
+    }
+    *output++ = static_cast<uint8_t>(value);
+    return output;
+}
+
+/**
+ * Read a varint.
+ *
+ * @return Iterator at one past the last byte read, or input if there was
+ * no complete varint before limit.
+ */
+template <bit_utils::ByteIterator Input, typename Limit>
+requires std::sentinel_for<Limit, Input>
+auto read_varint(Input input, Limit limit, uint32_t& value) -> Input {
+    uint32_t result = 0;
+    auto iter = input;
+    for (std::size_t i = 0; i < max_varint_size && iter != limit; ++i) {
+        auto byte = static_cast<uint8_t>(*iter++);
+        result |= static_cast<uint32_t>(byte & 0x7f) << (7 * i);
+        if ((byte & 0x80) == 0) {
+            value = result;
+            return iter;
+        }
+    }
+    return input;
+}
+
+/**
+ * Writes samples into a byte buffer for as long as they fit.
+ */
+template <bit_utils::ByteIterator Output, typename Limit>
+requires std::sentinel_for<Limit, Output>
+class DeltaEncoder {
+  public:
+    DeltaEncoder(Output output, Limit limit)
+        : start{output}, output{output}, limit{limit} {}
+
+    /**
+     * Add the next sample.
+     *
+     * @return False if it does not fit. Nothing is written then.
+     */
+    auto add(int32_t sample) -> bool {
+        auto delta = static_cast<int32_t>(static_cast<uint32_t>(sample) -
+                                          static_cast<uint32_t>(previous));
+        auto next = write_varint(zigzag(delta), output, limit);
+        if (next == output) {
+            return false;
+        }
+        output = next;
+        previous = sample;
+        ++samples;
+        return true;
+    }
+
+    /** The number of samples written. */
+    [[nodiscard]] auto count() const -> std::size_t { return samples; }
+
+    /** The number of bytes written. */
+    [[nodiscard]] auto size() const -> std::size_t {
+        return static_cast<std::size_t>(std::distance(start, output));
+    }
+
+  private:
+    Output start;
+    Output output;
+    Limit limit;
+    int32_t previous = 0;
+    std::size_t samples = 0;
+};
+
+/**
+ * Read back samples written by a DeltaEncoder.
+ *
+ * @param input Start of the encoded samples
+ * @param limit End of the encoded samples
+ * @param count The number of samples to read
+ * @param callback Called with each sample in order.
+ * @return The number of samples read, which is less than count if the
+ * bytes ran out.
+ */
+template <bit_utils::ByteIterator Input, typename Limit, typename Callback>
+requires std::sentinel_for<Limit, Input>
+auto decode(Input input, Limit limit, std::size_t count, Callback&& callback)
+    -> std::size_t {
+    int32_t previous = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        uint32_t value = 0;
+        auto next = read_varint(input, limit, value);
+        if (next == input) {
+            return i;
+        }
+        input = next;
+        previous = static_cast<int32_t>(static_cast<uint32_t>(previous) +
+                                        static_cast<uint32_t>(unzigzag(value)));
+        callback(previous);
+    }
+    return count;
+}
+
+}  // namespace delta_encoding
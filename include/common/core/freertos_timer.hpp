@@ -73,6 +73,11 @@ class FreeRTOSTimer {
 
     void stop() { xTimerStop(timer, 1); }
 
+    // Ticks since the scheduler started, in ms
+    [[nodiscard]] static auto get_tick_ms() -> uint32_t {
+        return xTaskGetTickCount() * portTICK_PERIOD_MS;
+    }
+
   private:
     TimerHandle_t timer{};
     Callback callback;
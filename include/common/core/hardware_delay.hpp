@@ -2,8 +2,11 @@
 // Not my favorite way to check this, but if we don't have access
 // to vTaskDelay during host compilation so just dummy the function
 
+#include <cstdint>
+
 #ifdef ENABLE_CROSS_ONLY_HEADERS
 #include "FreeRTOS.h"
+#include "task.h"
 #endif
 
 template <typename T>
@@ -15,3 +18,13 @@ static void vtask_hardware_delay(T ticks) {
     std::ignore = ticks;
 #endif
 }
+
+// Ticks since the scheduler started, which are ms at our tick rate. Always 0
+// during host compilation.
+inline auto hardware_tick_count() -> uint32_t {
+#ifdef ENABLE_CROSS_ONLY_HEADERS
+    return xTaskGetTickCount();
+#else
+    return 0;
+#endif
+}
@@ -0,0 +1,118 @@
+/*
+ * sample_ring contains a lock-free single-producer/single-consumer ring of
+ * sensor samples. The producer is the path that takes readings off the bus
+ * and the consumer is the path that exports them over CAN; the consumer can
+ * look at and copy out what is waiting before it decides how much of it to
+ * consume, so samples are only dropped from the ring once they are sent.
+ *
+ * The capacity must be a power of two so that a slot is found by masking a
+ * free running index rather than with a modulo and a bounds check.
+ */
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+
+namespace sample_ring {
+
+template <typename Sample, size_t capacity>
+class SampleRing {
+    static_assert(std::has_single_bit(capacity),
+                  "SampleRing capacity must be a power of two");
+    static_assert(std::is_trivially_copyable_v<Sample>,
+                  "SampleRing samples must be trivially copyable");
+
+  public:
+    explicit SampleRing() = default;
+    auto operator=(SampleRing&) -> SampleRing& = delete;
+    auto operator=(SampleRing&&) -> SampleRing&& = delete;
+    SampleRing(SampleRing&) = delete;
+    SampleRing(SampleRing&&) = delete;
+    ~SampleRing() = default;
+
+    [[nodiscard]] static constexpr auto max_size() -> size_t {
+        return capacity;
+    }
+
+    /**
+     * Add a sample. Producer side.
+     *
+     * @return False if the ring is full. The sample is not added then.
+     */
+    auto push(Sample sample) -> bool {
+        auto write = write_index.load(std::memory_order_relaxed);
+        if (write - read_index.load(std::memory_order_acquire) >= capacity) {
+            return false;
+        }
+        slots[write & mask] = sample;
+        write_index.store(write + 1, std::memory_order_release);
+        return true;
+    }
+
+    [[nodiscard]] auto size() const -> size_t {
+        return write_index.load(std::memory_order_acquire) -
+               read_index.load(std::memory_order_acquire);
+    }
+
+    [[nodiscard]] auto empty() const -> bool { return size() == 0; }
+
+    [[nodiscard]] auto full() const -> bool { return size() == capacity; }
+
+    /**
+     * The i-th oldest sample, which must be less than size(). Consumer side.
+     */
+    [[nodiscard]] auto operator[](size_t i) -> Sample& {
+        return slots[(read_index.load(std::memory_order_relaxed) + i) & mask];
+    }
+
+    [[nodiscard]] auto operator[](size_t i) const -> const Sample& {
+        return slots[(read_index.load(std::memory_order_relaxed) + i) & mask];
+    }
+
+    /**
+     * Copy out the oldest samples without consuming them. Consumer side.
+     *
+     * @return The number of samples copied, which is the lesser of the size
+     * of out and the number waiting.
+     */
+    auto copy(std::span<Sample> out) const -> size_t {
+        auto read = read_index.load(std::memory_order_relaxed);
+        auto count = std::min(out.size(), size());
+        auto start = static_cast<size_t>(read & mask);
+        auto first = std::min(count, capacity - start);
+        std::copy_n(slots.cbegin() + start, first, out.begin());
+        std::copy_n(slots.cbegin(), count - first, out.begin() + first);
+        return count;
+    }
+
+    /**
+     * Drop the oldest samples, at most as many as are waiting. Consumer
+     * side.
+     */
+    void consume(size_t count) {
+        auto read = read_index.load(std::memory_order_relaxed);
+        count = std::min(count, size());
+        read_index.store(read + static_cast<uint32_t>(count),
+                         std::memory_order_release);
+    }
+
+    /** Drop every waiting sample. Consumer side. */
+    void clear() {
+        read_index.store(write_index.load(std::memory_order_acquire),
+                         std::memory_order_release);
+    }
+
+  private:
+    static constexpr uint32_t mask = capacity - 1;
+    std::atomic<uint32_t> write_index{0};
+    std::atomic<uint32_t> read_index{0};
+    std::array<Sample, capacity> slots{};
+};
+
+}  // namespace sample_ring
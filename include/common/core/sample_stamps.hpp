@@ -0,0 +1,126 @@
+/*
+ * sample_stamps keeps, for each sample waiting in a sensor buffer, the tick
+ * it was taken at and the step position of the motor the sensor moves with.
+ *
+ * A stamp is eight bytes but consecutive samples are only a few ticks and a
+ * few steps apart, so each one is stored as its difference from the stamp
+ * before it in four bytes, and only the stamp of the oldest waiting sample
+ * is kept whole.
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#include "common/core/sample_ring.hpp"
+
+namespace sample_stamps {
+
+/** When a sample was taken and where the motor was then. */
+struct SampleStamp {
+    uint32_t tick = 0;
+    uint32_t step_position = 0;
+
+    auto operator==(const SampleStamp& other) const -> bool = default;
+};
+
+/** A stamp stored as the change from the stamp before it. */
+struct StampDelta {
+    uint16_t ticks = 0;
+    int16_t steps = 0;
+};
+
+/**
+ * The stamps of the samples in a buffer, oldest first. Unlike a
+ * SampleRing, both ends must be used from the same task.
+ */
+template <std::size_t capacity>
+class SampleStamps {
+  public:
+    /**
+     * Add the stamp of the newest sample.
+     *
+     * A change bigger than a StampDelta holds is clamped, and the stamp
+     * after it makes up the difference.
+     *
+     * @return False if there is no room. The stamp is not added then.
+     */
+    auto push(SampleStamp stamp) -> bool {
+        if (deltas.full()) {
+            return false;
+        }
+        auto delta = StampDelta{};
+        if (deltas.empty()) {
+            oldest_stamp = stamp;
+            newest_stamp = stamp;
+        } else {
+            delta.ticks = static_cast<uint16_t>(
+                std::min(stamp.tick - newest_stamp.tick,
+                         uint32_t{std::numeric_limits<uint16_t>::max()}));
+            delta.steps = static_cast<int16_t>(std::clamp(
+                static_cast<int32_t>(stamp.step_position -
+                                     newest_stamp.step_position),
+                int32_t{std::numeric_limits<int16_t>::min()},
+                int32_t{std::numeric_limits<int16_t>::max()}));
+            newest_stamp = apply(newest_stamp, delta);
+        }
+        return deltas.push(delta);
+    }
+
+    [[nodiscard]] auto size() const -> std::size_t { return deltas.size(); }
+
+    [[nodiscard]] auto empty() const -> bool { return deltas.empty(); }
+
+    /** The stamp of the oldest waiting sample, if there is one. */
+    [[nodiscard]] auto oldest() const -> SampleStamp { return oldest_stamp; }
+
+    /**
+     * The change from the stamp of the (i-1)-th oldest sample to that of
+     * the i-th, for 0 < i < size().
+     */
+    [[nodiscard]] auto operator[](std::size_t i) const -> StampDelta {
+        return deltas[i];
+    }
+
+    /**
+     * The number of the oldest samples, at most count, that are no more
+     * than max_ticks apart from one to the next.
+     */
+    [[nodiscard]] auto run(std::size_t count, uint16_t max_ticks) const
+        -> std::size_t {
+        count = std::min(count, size());
+        for (std::size_t i = 1; i < count; ++i) {
+            if (deltas[i].ticks > max_ticks) {
+                return i;
+            }
+        }
+        return count;
+    }
+
+    /** Drop the stamps of the oldest samples. */
+    void consume(std::size_t count) {
+        count = std::min(count, size());
+        for (std::size_t i = 1; i <= count && i < size(); ++i) {
+            oldest_stamp = apply(oldest_stamp, deltas[i]);
+        }
+        deltas.consume(count);
+    }
+
+    void clear() { deltas.clear(); }
+
+  private:
+    static auto apply(SampleStamp stamp, StampDelta delta) -> SampleStamp {
+        return SampleStamp{
+            .tick = stamp.tick + delta.ticks,
+            .step_position = stamp.step_position +
+                             static_cast<uint32_t>(int32_t{delta.steps})};
+    }
+
+    sample_ring::SampleRing<StampDelta, capacity> deltas{};
+    SampleStamp oldest_stamp{};
+    SampleStamp newest_stamp{};
+};
+
+}  // namespace sample_stamps
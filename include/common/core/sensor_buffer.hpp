@@ -1,5 +1,31 @@
 #pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "common/core/sample_ring.hpp"
+#include "common/core/sample_stamps.hpp"
+
 #ifndef SENSOR_BUFF_SIZE
 constexpr size_t SENSOR_BUFF_SIZE = 1;
 #endif
 constexpr size_t SENSOR_BUFFER_SIZE = SENSOR_BUFF_SIZE;
+
+// Sensor samples waiting to go out over CAN, as S15Q16 fixed point. While a
+// sensor is stamping or streaming its samples, stamps holds one stamp per
+// waiting sample; otherwise it is empty.
+class SensorBuffer
+    : public sample_ring::SampleRing<int32_t, SENSOR_BUFFER_SIZE> {
+  public:
+    void consume(size_t count) {
+        stamps.consume(count);
+        SampleRing::consume(count);
+    }
+
+    void clear() {
+        stamps.clear();
+        SampleRing::clear();
+    }
+
+    sample_stamps::SampleStamps<SENSOR_BUFFER_SIZE> stamps{};
+};
@@ -0,0 +1,157 @@
+/*
+ * spsc_message_queue contains a lock-free single-producer/single-consumer
+ * ring that satisfies the MessageQueue concept without calling into the
+ * kernel. It is intended for paths where one side is an interrupt handler
+ * that runs at a high rate (e.g. the motion controller feeding the step
+ * timer interrupt), so that checking for and popping a message is a couple
+ * of atomic index operations rather than a kernel critical section.
+ *
+ * Exactly one context may write and exactly one context may read. reset()
+ * may be called from either side; it discards everything currently in the
+ * ring, and a read that races with it fails rather than returning a message
+ * that was reset away.
+ */
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace spsc_message_queue {
+
+template <typename Message, size_t queue_size = 16>
+class SPSCMessageQueue {
+    static_assert(std::has_single_bit(queue_size),
+                  "SPSCMessageQueue size must be a power of two");
+    static_assert(std::is_trivially_copyable_v<Message>,
+                  "SPSCMessageQueue messages are copied in and out of slots "
+                  "and must be trivially copyable");
+
+  public:
+    // The ring never blocks; timeouts are accepted only so it can stand in
+    // for a FreeRTOSMessageQueue.
+    static auto constexpr max_delay = 0;
+    static auto constexpr capacity = queue_size;
+
+    explicit SPSCMessageQueue(const char*) : SPSCMessageQueue() {}
+    explicit SPSCMessageQueue() = default;
+    auto operator=(SPSCMessageQueue&) -> SPSCMessageQueue& = delete;
+    auto operator=(SPSCMessageQueue&&) -> SPSCMessageQueue&& = delete;
+    SPSCMessageQueue(SPSCMessageQueue&) = delete;
+    SPSCMessageQueue(SPSCMessageQueue&&) = delete;
+    ~SPSCMessageQueue() = default;
+
+    auto try_write(const Message& message) -> bool {
+        auto write = write_index.load(std::memory_order_relaxed);
+        if (write - read_index.load(std::memory_order_acquire) >= queue_size) {
+            return false;
+        }
+        slots[write & mask] = message;
+        write_index.store(write + 1, std::memory_order_release);
+        return true;
+    }
+
+    template <typename TimeoutType>
+    requires std::is_integral_v<TimeoutType>
+    auto try_write(const Message& message, TimeoutType) -> bool {
+        return try_write(message);
+    }
+
+    template <typename OtherMessage>
+    requires std::constructible_from<Message, OtherMessage>
+    auto try_write(const OtherMessage& om) -> bool {
+        Message our_message(om);
+        return try_write(our_message);
+    }
+
+    template <typename OtherMessage, typename TimeoutType>
+    requires std::constructible_from<Message, OtherMessage> &&
+        std::is_integral_v<TimeoutType>
+    auto try_write(const OtherMessage& om, TimeoutType) -> bool {
+        return try_write(om);
+    }
+
+    static auto try_write_static(void* slf, const auto& om) -> bool {
+        auto instance =
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+            reinterpret_cast<SPSCMessageQueue<Message, queue_size>*>(slf);
+        return instance->try_write(om);
+    }
+
+    [[nodiscard]] auto try_write_isr(const Message& message) -> bool {
+        return try_write(message);
+    }
+
+    auto try_read(Message* message) -> bool {
+        auto read = read_index.load(std::memory_order_acquire);
+        if (read == write_index.load(std::memory_order_acquire)) {
+            return false;
+        }
+        *message = slots[read & mask];
+        // A concurrent reset() moves the read index past this slot, in which
+        // case the copy above may be stale and is dropped.
+        return read_index.compare_exchange_strong(read, read + 1,
+                                                  std::memory_order_acq_rel);
+    }
+
+    template <typename TimeoutType>
+    requires std::is_integral_v<TimeoutType>
+    auto try_read(Message* message, TimeoutType) -> bool {
+        return try_read(message);
+    }
+
+    auto try_read_isr(Message* message) -> bool { return try_read(message); }
+
+    [[nodiscard]] auto has_message() const -> bool {
+        return read_index.load(std::memory_order_acquire) !=
+               write_index.load(std::memory_order_acquire);
+    }
+
+    [[nodiscard]] auto has_message_isr() const -> bool { return has_message(); }
+
+    [[nodiscard]] auto peek(Message* message) const -> bool {
+        auto read = read_index.load(std::memory_order_acquire);
+        if (read == write_index.load(std::memory_order_acquire)) {
+            return false;
+        }
+        *message = slots[read & mask];
+        return read_index.load(std::memory_order_acquire) == read;
+    }
+
+    template <typename TimeoutType>
+    requires std::is_integral_v<TimeoutType>
+    [[nodiscard]] auto peek(Message* message, TimeoutType) const -> bool {
+        return peek(message);
+    }
+
+    [[nodiscard]] auto peek_isr(Message* message) const -> bool {
+        return peek(message);
+    }
+
+    void reset() {
+        auto read = read_index.load(std::memory_order_relaxed);
+        while (!read_index.compare_exchange_weak(
+            read, write_index.load(std::memory_order_acquire),
+            std::memory_order_acq_rel)) {
+        }
+    }
+
+    [[nodiscard]] auto get_size() const -> size_t {
+        return write_index.load(std::memory_order_acquire) -
+               read_index.load(std::memory_order_acquire);
+    }
+
+  private:
+    static constexpr uint32_t mask = queue_size - 1;
+    // Indices run freely and are masked on access, so full and empty are
+    // distinguishable without sacrificing a slot.
+    std::atomic<uint32_t> write_index{0};
+    std::atomic<uint32_t> read_index{0};
+    std::array<Message, queue_size> slots{};
+};
+
+}  // namespace spsc_message_queue
@@ -68,10 +68,15 @@ class MockMessageQueue {
         return queue_data_structure.empty() != 1;
     }
 
-    auto peek_isr(Message* message) const -> bool { return try_read(message); }
+    auto peek_isr(Message* message) const -> bool { return peek(message, 0); }
 
     auto peek(Message* message, uint32_t timeout_ticks) const -> bool {
-        return try_read(message, timeout_ticks);
+        static_cast<void>(timeout_ticks);
+        if (has_message()) {
+            *message = queue_data_structure.front();
+            return true;
+        }
+        return false;
     }
 
     void reset() { queue_data_structure.clear(); }
@@ -45,4 +45,71 @@ class MockTimer {
     bool running = false;
 };
 
+/**
+ * A timer with its own tick count that runs like a FreeRTOS software timer:
+ * it fires a period after it is started or its period is changed, and every
+ * period after that.
+ */
+class MockClockedTimer {
+  public:
+    using Callback = std::function<void()>;
+    MockClockedTimer(const char* name, Callback&& callback, uint32_t period_ms)
+        : name(name), callback{std::move(callback)}, period_ms(period_ms) {}
+    auto operator=(MockClockedTimer&) -> MockClockedTimer& = delete;
+    auto operator=(MockClockedTimer&&) -> MockClockedTimer&& = delete;
+    MockClockedTimer(MockClockedTimer&) = delete;
+    MockClockedTimer(MockClockedTimer&&) = delete;
+    ~MockClockedTimer() {}
+
+    /** test harness interface
+     * */
+    const std::string& get_name() const { return name; }
+    uint32_t get_period() const { return period_ms; }
+
+    /** Move the tick count on a ms at a time, firing as the timer expires */
+    void run_for(uint32_t ms) {
+        for (uint32_t i = 0; i < ms; i++) {
+            tick_ms++;
+            if (running && tick_ms == expires_at) {
+                expires_at += period_ms;
+                callback();
+            }
+        }
+    }
+
+    /** Move the tick count on to when the timer next fires */
+    void fire() { run_for(running ? expires_at - tick_ms : period_ms); }
+
+    /*
+    ** mock interface
+    */
+    bool is_running() { return running; }
+
+    void update_callback(Callback&& new_callback) {
+        callback = std::move(new_callback);
+    }
+
+    void update_period(uint32_t period) {
+        period_ms = period;
+        expires_at = tick_ms + period;
+    }
+
+    void start() {
+        running = true;
+        expires_at = tick_ms + period_ms;
+    }
+
+    void stop() { running = false; }
+
+    uint32_t get_tick_ms() const { return tick_ms; }
+
+  private:
+    std::string name;
+    Callback callback;
+    uint32_t period_ms;
+    bool running = false;
+    uint32_t tick_ms = 0;
+    uint32_t expires_at = 0;
+};
+
 };  // namespace test_mocks
@@ -1,5 +1,7 @@
 #pragma once
+#include <algorithm>
 #include <array>
+#include <utility>
 
 #include "accessor.hpp"
 #include "addresses.hpp"
@@ -14,6 +16,17 @@ template <std::size_t SIZE>
 using DataBufferType = std::array<uint8_t, SIZE>;
 using DataTailType = std::array<uint8_t, addresses::lookup_table_tail_length>;
 
+// The most values one batch can read, enough for a full usage request.
+static constexpr std::size_t max_batch_keys = 5;
+using BatchBufferType =
+    DataBufferType<max_batch_keys * types::max_data_length>;
+
+struct DataRequest {
+    uint16_t key;
+    // 0 reads the whole value
+    uint16_t len;
+};
+
 enum TableAction { READ, WRITE, CREATE, INITALIZE };
 
 struct table_entry_action {
@@ -191,14 +204,19 @@ class DevDataAccessor
             message::ConfigRequestMessage{config_req_callback, this});
     }
 
+    /**
+     * Write a value, starting offset bytes into it.
+     * @return Whether the write was started
+     */
     template <std::size_t SIZE>
-    void write_data(uint16_t key, uint16_t len, uint16_t offset,
-                    std::array<uint8_t, SIZE>& data) {
+    auto write_data(uint16_t key, uint16_t len, uint16_t offset,
+                    std::array<uint8_t, SIZE>& data) -> bool {
+        write_barrier = message::WriteBarrierMessage{};
         if (read_write_ready()) {
             auto table_location = calculate_table_entry_start(key);
             if (table_location > tail_accessor.get_data_tail()) {
                 LOG("Error, attemping to read uninitalized value");
-                return;
+                return false;
             }
             if (len > data.size()) {
                 LOG("ERROR, trying to write %d bytes from a %lu byte buffer",
@@ -220,13 +238,32 @@ class DevDataAccessor
                 .length = static_cast<types::data_length>(2 * conf.addr_bytes),
                 .callback = table_action_callback,
                 .callback_param = this});
+            return true;
         }
+        return false;
     }
     template <std::size_t SIZE>
     void write_data(uint16_t key, uint16_t len,
                     std::array<uint8_t, SIZE>& data) {
         write_data(key, len, 0, data);
     }
+    /**
+     * Write a value and be called back, from the eeprom task, once the
+     * eeprom has finished writing it.
+     * @return Whether the write was started; if not there is no callback
+     */
+    template <std::size_t SIZE>
+    auto write_data(uint16_t key, uint16_t len,
+                    std::array<uint8_t, SIZE>& data,
+                    message::WriteCompleteCallback callback,
+                    void* callback_param) -> bool {
+        if (!write_data(key, len, 0, data)) {
+            return false;
+        }
+        write_barrier = message::WriteBarrierMessage{
+            .callback = callback, .callback_param = callback_param};
+        return true;
+    }
     template <std::size_t SIZE>
     void write_data(uint16_t key, std::array<uint8_t, SIZE>& data) {
         write_data(key, data.size(), 0, data);
@@ -262,6 +299,45 @@ class DevDataAccessor
         get_data(key, 0, 0, message_index);
     }
 
+    /**
+     * Read several values at once. First their lookup table entries and then
+     * their data are read as the fewest contiguous reads that cover them,
+     * each step sending all of its reads without waiting for any. Value i is
+     * put at i * max_data_length in out, zero padded, and the listener is
+     * called once when every value is in. A key that is not in the table
+     * reads as zeroes.
+     */
+    void get_data_batch(
+        const std::array<DataRequest, max_batch_keys>& requests,
+        std::size_t count, BatchBufferType& out, uint32_t message_index) {
+        if (!read_write_ready()) {
+            return;
+        }
+        batch_requests = requests;
+        batch_count = std::min(count, max_batch_keys);
+        batch_out = accessor::AccessorBuffer(out.begin(), out.end());
+        batch_reading = true;
+        batch_index = message_index;
+        out.fill(0x00);
+        auto spans = std::array<ReadSpan, max_batch_keys>{};
+        std::size_t span_count = 0;
+        for (std::size_t i = 0; i < batch_count; ++i) {
+            batch_regions[i] = ReadSpan{};
+            if (!data_part_exists(batch_requests[i].key)) {
+                LOG("Error, key %d is not in the lookup table",
+                    batch_requests[i].key);
+                continue;
+            }
+            spans[span_count++] = ReadSpan{
+                .memory_address =
+                    calculate_table_entry_start(batch_requests[i].key),
+                .length = static_cast<types::data_length>(2 * conf.addr_bytes)};
+        }
+        if (!send_batch_reads(spans, span_count, batch_table_callback)) {
+            read_batch_data();
+        }
+    }
+
     template <std::size_t SIZE>
     void create_data_part(uint16_t key, uint16_t len,
                           std::array<uint8_t, SIZE>& data) {
@@ -373,10 +449,194 @@ class DevDataAccessor
     }
 
   private:
+    struct ReadSpan {
+        types::address memory_address = 0;
+        types::data_length length = 0;
+    };
+
     DevDataTailAccessor<EEPromTaskClient>& tail_accessor;
     message::ConfigResponseMessage conf = message::ConfigResponseMessage{};
     bool config_updated{false};
     table_entry_action action_cmd_m = table_entry_action{};
+    // sent after the write in progress, if its caller wants to know when
+    // it is done
+    message::WriteBarrierMessage write_barrier = message::WriteBarrierMessage{};
+    std::array<DataRequest, max_batch_keys> batch_requests{};
+    // where each value of the batch is, once its table entry is in
+    std::array<ReadSpan, max_batch_keys> batch_regions{};
+    std::size_t batch_count = 0;
+    accessor::AccessorBuffer batch_out = accessor::AccessorBuffer{};
+    bool batch_reading{false};
+    std::size_t batch_bytes_left = 0;
+    uint32_t batch_index = 0;
+
+    /*
+     * Sort the spans, join the ones that overlap or touch and read each in
+     * pieces of at most max_data_length.
+     * @return false if there was nothing to read
+     */
+    auto send_batch_reads(std::array<ReadSpan, max_batch_keys>& spans,
+                          std::size_t span_count,
+                          message::ReadResponseCallback callback) -> bool {
+        std::sort(spans.begin(), spans.begin() + span_count,
+                  [](const ReadSpan& a, const ReadSpan& b) {
+                      return a.memory_address < b.memory_address;
+                  });
+        std::size_t joined = 0;
+        for (std::size_t i = 0; i < span_count; ++i) {
+            if (joined != 0) {
+                auto& last = spans[joined - 1];
+                auto last_end = last.memory_address + last.length;
+                if (spans[i].memory_address <= last_end) {
+                    auto end = std::max(last_end, spans[i].memory_address +
+                                                      spans[i].length);
+                    last.length =
+                        static_cast<types::data_length>(end -
+                                                        last.memory_address);
+                    continue;
+                }
+            }
+            spans[joined++] = spans[i];
+        }
+        // count it all up first so an early answer cannot finish the step
+        batch_bytes_left = 0;
+        for (std::size_t i = 0; i < joined; ++i) {
+            batch_bytes_left += spans[i].length;
+        }
+        if (batch_bytes_left == 0) {
+            return false;
+        }
+        for (std::size_t i = 0; i < joined; ++i) {
+            auto read_addr = spans[i].memory_address;
+            types::data_length bytes_remain = spans[i].length;
+            while (bytes_remain > 0) {
+                auto amount_to_read =
+                    std::min(bytes_remain, types::max_data_length);
+                this->eeprom_client.send_eeprom_queue(
+                    message::ReadEepromMessage{.message_index = batch_index,
+                                               .memory_address = read_addr,
+                                               .length = amount_to_read,
+                                               .callback = callback,
+                                               .callback_param = this});
+                bytes_remain -= amount_to_read;
+                read_addr += amount_to_read;
+            }
+        }
+        return true;
+    }
+
+    void read_batch_data() {
+        auto spans = std::array<ReadSpan, max_batch_keys>{};
+        std::size_t span_count = 0;
+        for (std::size_t i = 0; i < batch_count; ++i) {
+            if (batch_regions[i].length != 0) {
+                spans[span_count++] = batch_regions[i];
+            }
+        }
+        if (!send_batch_reads(spans, span_count, batch_data_callback)) {
+            finish_batch();
+        }
+    }
+
+    void finish_batch() {
+        batch_reading = false;
+        this->read_listener.read_complete(batch_index);
+    }
+
+    void batch_table_callback(const message::EepromMessage& m) {
+        auto entry_len = 2 * conf.addr_bytes;
+        for (std::size_t i = 0; i < batch_count; ++i) {
+            const auto& request = batch_requests[i];
+            if (!data_part_exists(request.key)) {
+                continue;
+            }
+            auto location = calculate_table_entry_start(request.key);
+            if (location < m.memory_address ||
+                location + entry_len > m.memory_address + m.length) {
+                continue;
+            }
+            auto [data_addr, data_len] = parse_table_entry(
+                // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+                m.data.begin() + (location - m.memory_address));
+            if (request.len != 0) {
+                data_len = request.len;
+            }
+            if (data_len > types::max_data_length) {
+                LOG("Warning, key %d is too long for a batch, truncating",
+                    request.key);
+                data_len = types::max_data_length;
+            }
+            batch_regions[i] = ReadSpan{
+                .memory_address =
+                    static_cast<types::address>(this->begin + data_addr),
+                .length = data_len};
+        }
+        batch_bytes_left -= std::min(batch_bytes_left, std::size_t(m.length));
+        if (batch_bytes_left == 0) {
+            read_batch_data();
+        }
+    }
+
+    void batch_data_callback(const message::EepromMessage& m) {
+        if (!batch_reading) {
+            return;
+        }
+        std::size_t read_start = m.memory_address;
+        std::size_t read_end = read_start + m.length;
+        for (std::size_t i = 0; i < batch_count; ++i) {
+            const auto& region = batch_regions[i];
+            std::size_t from = std::max(read_start,
+                                        std::size_t(region.memory_address));
+            std::size_t to = std::min(
+                read_end, std::size_t(region.memory_address + region.length));
+            if (from < to) {
+                auto slot = i * types::max_data_length +
+                            (from - region.memory_address);
+                std::copy_n(m.data.begin() + (from - read_start), to - from,
+                            // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+                            batch_out.begin() + slot);
+            }
+        }
+        batch_bytes_left -= std::min(batch_bytes_left, std::size_t(m.length));
+        if (batch_bytes_left == 0) {
+            finish_batch();
+        }
+    }
+
+    static void batch_table_callback(const message::EepromMessage& m,
+                                     void* param) {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        auto* self = reinterpret_cast<DevDataAccessor*>(param);
+        self->batch_table_callback(m);
+    }
+
+    static void batch_data_callback(const message::EepromMessage& m,
+                                    void* param) {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        auto* self = reinterpret_cast<DevDataAccessor*>(param);
+        self->batch_data_callback(m);
+    }
+
+    /*
+     * A lookup table entry is the value's offset from the start of the data
+     * section followed by its length.
+     */
+    auto parse_table_entry(const uint8_t* data_iter)
+        -> std::pair<types::address, types::data_length> {
+        types::address data_addr = 0;
+        types::data_length data_len = 0;
+        data_iter = bit_utils::bytes_to_int(
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            data_iter, data_iter + conf.addr_bytes, data_addr);
+        data_iter = bit_utils::bytes_to_int(
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            data_iter, data_iter + conf.addr_bytes, data_len);
+        if (conf.chip == hardware_iface::EEPromChipType::MICROCHIP_24AA02T) {
+            data_addr = data_addr >> hardware_iface::ADDR_BITS_DIFFERENCE;
+            data_len = data_len >> hardware_iface::ADDR_BITS_DIFFERENCE;
+        }
+        return {data_addr, data_len};
+    }
 
     // callbacks
     void config_req_callback(const message::ConfigResponseMessage& m) {
@@ -396,19 +656,7 @@ class DevDataAccessor
 
     // this method gets called when the dev_data accessor reads the lookup table
     void table_action_callback(const message::EepromMessage& m) {
-        const auto* data_iter = m.data.begin();
-        types::address data_addr = 0;
-        types::data_length data_len = 0;
-        data_iter = bit_utils::bytes_to_int(
-            // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
-            data_iter, data_iter + conf.addr_bytes, data_addr);
-        data_iter = bit_utils::bytes_to_int(
-            // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
-            data_iter, data_iter + conf.addr_bytes, data_len);
-        if (conf.chip == hardware_iface::EEPromChipType::MICROCHIP_24AA02T) {
-            data_addr = data_addr >> hardware_iface::ADDR_BITS_DIFFERENCE;
-            data_len = data_len >> hardware_iface::ADDR_BITS_DIFFERENCE;
-        }
+        auto [data_addr, data_len] = parse_table_entry(m.data.begin());
         bool do_initalize = false;
         switch (action_cmd_m.action) {
             // When we recive a message started from a create, the message will
@@ -468,6 +716,10 @@ class DevDataAccessor
                 this->write_at_offset(this->type_data, data_addr,
                                       data_addr + action_cmd_m.len,
                                       m.message_index);
+                if (write_barrier.callback != nullptr) {
+                    this->eeprom_client.send_eeprom_queue(write_barrier);
+                    write_barrier = message::WriteBarrierMessage{};
+                }
                 break;
         }
     }
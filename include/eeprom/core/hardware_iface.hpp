@@ -21,6 +21,11 @@ constexpr uint8_t ADDR_BITS_DIFFERENCE =
 
 enum class EEpromMemorySize { MICROCHIP_256_BYTE = 256, ST_16_KBYTE = 16384 };
 
+// The largest write page of the parts we use. The ST part latches up to this
+// many bytes and programs them in one write cycle, as long as write control
+// stays low from the start condition to the stop.
+constexpr std::size_t MAX_PAGE_SIZE = 64;
+
 inline auto get_i2c_device_address(
     EEPromChipType chip = EEPromChipType::ST_M24128_BF,
     uint16_t eeprom_addr = 0) -> uint16_t {
@@ -61,7 +66,7 @@ class EEPromHardwareIface {
                 eeprom_mem_size =
                     static_cast<size_t>(EEpromMemorySize::ST_16_KBYTE);
                 default_byte_value = 0xFF;
-                page_boundary = 64;
+                page_boundary = MAX_PAGE_SIZE;
                 break;
         }
         eeprom_chip_type = chip;
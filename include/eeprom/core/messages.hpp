@@ -59,6 +59,17 @@ struct ConfigRequestMessage {
     void* callback_param;
 };
 
+using WriteCompleteCallback = void (*)(void*);
+
+/**
+ * Asks to be called back once every write queued before it has finished
+ * its write cycle, or has been given up on.
+ */
+struct WriteBarrierMessage {
+    WriteCompleteCallback callback;
+    void* callback_param;
+};
+
 // EEpromMessage to OT Library
 // Write messages
 struct OTLibraryBookMessage {
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "eeprom/core/types.hpp"
+
+namespace eeprom {
+namespace shadow {
+
+// The header and lookup table grow up from the start of the eeprom and dev
+// data grows down from the end, so a window at each end covers what is
+// read most.
+static constexpr types::data_length window_size = 256;
+static constexpr std::size_t window_count = 2;
+
+struct Range {
+    types::address memory_address;
+    types::data_length length;
+};
+
+/**
+ * A copy in RAM of the busiest parts of the eeprom. It is loaded in chunks
+ * in address order; reads that fall in what has been loaded can be served
+ * without the bus and writes keep it current.
+ */
+class EEPromShadow {
+  public:
+    explicit EEPromShadow(std::size_t mem_size) {
+        auto first = std::min(mem_size, std::size_t(window_size));
+        windows[0] = Window{.begin = 0, .size = first};
+        if (mem_size > window_size) {
+            auto second = std::min(mem_size - window_size,
+                                   std::size_t(window_size));
+            windows[1] = Window{.begin = mem_size - second, .size = second};
+        }
+    }
+
+    /**
+     * The next range to load, no longer than max_length. Its length is 0
+     * once everything is loaded.
+     */
+    auto next_chunk(types::data_length max_length) -> Range {
+        for (auto& window : windows) {
+            if (window.loaded < window.size) {
+                in_flight = Range{
+                    .memory_address =
+                        static_cast<types::address>(window.begin +
+                                                    window.loaded),
+                    .length = static_cast<types::data_length>(std::min(
+                        window.size - window.loaded, std::size_t(max_length)))};
+                in_flight_stale = false;
+                return in_flight;
+            }
+        }
+        in_flight = Range{};
+        return in_flight;
+    }
+
+    /**
+     * Take in the chunk handed out by next_chunk. If it was written to while
+     * it was being read it is dropped, and next_chunk hands it out again.
+     */
+    void loaded(const uint8_t* data) {
+        auto chunk = in_flight;
+        in_flight = Range{};
+        if (in_flight_stale || chunk.length == 0) {
+            return;
+        }
+        for (std::size_t i = 0; i < window_count; ++i) {
+            auto& window = windows[i];
+            if (chunk.memory_address == window.begin + window.loaded) {
+                std::copy_n(data, chunk.length,
+                            bytes.begin() + i * window_size + window.loaded);
+                window.loaded += chunk.length;
+                return;
+            }
+        }
+    }
+
+    /**
+     * Copy out a range if all of it has been loaded.
+     * @return false if any of it has to come from the eeprom
+     */
+    [[nodiscard]] auto read(types::address memory_address,
+                            types::data_length length, uint8_t* out) const
+        -> bool {
+        for (std::size_t i = 0; i < window_count; ++i) {
+            const auto& window = windows[i];
+            if (memory_address >= window.begin &&
+                memory_address + length <= window.begin + window.loaded) {
+                std::copy_n(bytes.cbegin() + i * window_size +
+                                (memory_address - window.begin),
+                            length, out);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Apply a write to whatever part of the shadow it lands on.
+     */
+    void write(types::address memory_address, const uint8_t* data,
+               types::data_length length) {
+        std::size_t start = memory_address;
+        std::size_t end = start + length;
+        for (std::size_t i = 0; i < window_count; ++i) {
+            const auto& window = windows[i];
+            auto from = std::max(start, window.begin);
+            auto to = std::min(end, window.begin + window.loaded);
+            if (from < to) {
+                std::copy_n(data + (from - start), to - from,
+                            bytes.begin() + i * window_size +
+                                (from - window.begin));
+            }
+        }
+        std::size_t chunk_start = in_flight.memory_address;
+        std::size_t chunk_end = chunk_start + in_flight.length;
+        if (start < chunk_end && end > chunk_start) {
+            in_flight_stale = true;
+        }
+    }
+
+  private:
+    struct Window {
+        std::size_t begin = 0;
+        std::size_t size = 0;
+        std::size_t loaded = 0;
+    };
+
+    std::array<Window, window_count> windows{};
+    std::array<uint8_t, window_count * window_size> bytes{};
+    Range in_flight{};
+    bool in_flight_stale = false;
+};
+
+}  // namespace shadow
+}  // namespace eeprom
@@ -1,11 +1,17 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <variant>
+
 #include "common/core/bit_utils.hpp"
 #include "common/core/buffer_type.hpp"
+#include "common/core/hardware_delay.hpp"
 #include "common/core/logging.h"
 #include "common/core/message_queue.hpp"
 #include "common/core/message_utils.hpp"
 #include "eeprom/core/messages.hpp"
+#include "eeprom/core/shadow.hpp"
 #include "eeprom/core/types.hpp"
 #include "hardware_iface.hpp"
 #include "i2c/core/messages.hpp"
@@ -19,6 +25,7 @@ namespace task {
 using TaskMessage =
     std::variant<message::WriteEepromMessage, message::ReadEepromMessage,
                  message::OTLibraryReadMessage, message::ConfigRequestMessage,
+                 message::WriteBarrierMessage,
                  i2c::messages::TransactionResponse, std::monostate>;
 
 template <class I2CQueueWriter, class OwnQueue>
@@ -37,16 +44,365 @@ class EEPromMessageHandler {
     ~EEPromMessageHandler() = default;
 
     static constexpr auto WRITE_TOKEN = static_cast<uint32_t>(-1);
+    static constexpr auto ACK_POLL_TOKEN = static_cast<uint32_t>(-2);
+    static constexpr auto SHADOW_TOKEN = static_cast<uint32_t>(-3);
+    static constexpr auto PAGE_WRITE_TOKEN = static_cast<uint32_t>(-4);
     static constexpr auto MAX_INFLIGHT_READS = 10;
+    // Transfers that can wait for the eeprom to finish a write cycle.
+    static constexpr std::size_t MAX_HELD = 8;
+    // A device that is still not acknowledging after this many polls is
+    // assumed to be gone rather than busy.
+    static constexpr uint32_t MAX_ACK_POLLS = 20;
+    // Write barriers that can wait at once, one for each usage task.
+    static constexpr std::size_t MAX_WRITE_WAITERS = 4;
 
     void handle_message(TaskMessage &m) {
         std::visit([this](auto o) { this->visit(o); }, m);
     }
 
+    [[nodiscard]] auto has_pending_write() const -> bool {
+        return pending.length != 0;
+    }
+
+    /**
+     * Send out the write that adjacent writes are being gathered into. The
+     * task calls this once its queue is empty.
+     */
+    void flush_write() {
+        if (pending.length == 0) {
+            return;
+        }
+        auto write = pending;
+        pending = PendingWrite{};
+        submit(HeldTransfer{write});
+    }
+
+    [[nodiscard]] auto has_ack_poll_retry() const -> bool {
+        return ack_poll_retry;
+    }
+
+    /**
+     * Send an ack poll the eeprom did not answer again. The task calls this
+     * once a tick has gone by with nothing else to do.
+     */
+    void retry_ack_poll() {
+        if (ack_poll_retry) {
+            ack_poll_retry = false;
+            start_ack_poll();
+        }
+    }
+
+    /**
+     * Send an ack poll the eeprom did not answer again if the tick count
+     * has moved on since it failed, so a busy queue does not hold it up.
+     */
+    void retry_ack_poll(uint32_t now) {
+        if (now != ack_poll_failed_at) {
+            retry_ack_poll();
+        }
+    }
+
+    /**
+     * Start reading the shadowed parts of the eeprom into RAM, one full i2c
+     * buffer at a time. Reads in the parts loaded so far are answered
+     * without the bus from then on.
+     */
+    void load_shadow() {
+        if (!shadow_loading) {
+            shadow_loading = true;
+            load_next_chunk();
+        }
+    }
+
   private:
+    using PageBuffer = std::array<uint8_t, hardware_iface::MAX_PAGE_SIZE>;
+
+    /*
+     * Up to a page of data to write.
+     */
+    struct PendingWrite {
+        uint32_t message_index = 0;
+        types::address memory_address = 0;
+        types::data_length length = 0;
+        PageBuffer data{};
+    };
+
+    using HeldTransfer =
+        std::variant<std::monostate, PendingWrite, message::ReadEepromMessage,
+                     shadow::Range>;
+
+    /*
+     * How many data bytes fit in a write transaction after the memory
+     * address. Longer writes go out from page_buffer.
+     */
+    [[nodiscard]] auto transaction_capacity() const -> types::data_length {
+        return static_cast<types::data_length>(
+            i2c::messages::MAX_BUFFER_SIZE - hw_iface.get_eeprom_addr_bytes());
+    }
+
+    /*
+     * A write joins the pending one if it overlaps or touches it on the same
+     * page. Where they overlap the later write wins.
+     */
+    auto coalesce(const message::WriteEepromMessage &m) -> bool {
+        if (pending.length == 0) {
+            return false;
+        }
+        auto page = hw_iface.get_eeprom_page_boundary();
+        uint32_t start = pending.memory_address;
+        uint32_t end = start + pending.length;
+        uint32_t m_start = m.memory_address;
+        uint32_t m_end = m_start + m.length;
+        if (m_start / page != start / page || m_start > end || m_end < start) {
+            return false;
+        }
+        auto merged_start = std::min(start, m_start);
+        auto merged_end = std::max(end, m_end);
+        if (merged_end - merged_start > page) {
+            return false;
+        }
+        auto merged = PageBuffer{};
+        std::copy_n(pending.data.cbegin(), pending.length,
+                    merged.begin() + (start - merged_start));
+        std::copy_n(m.data.cbegin(), m.length,
+                    merged.begin() + (m_start - merged_start));
+        pending.memory_address = static_cast<types::address>(merged_start);
+        pending.length = static_cast<types::data_length>(merged_end -
+                                                         merged_start);
+        pending.data = merged;
+        return true;
+    }
+
+    [[nodiscard]] auto device_busy() const -> bool {
+        return writes_in_flight != 0 || ack_polling;
+    }
+
+    /*
+     * Transfers go out in the order they came in. While the eeprom is busy
+     * with a write cycle they wait here instead of being retried on the bus;
+     * if too many pile up they all go out and the i2c task retries them.
+     */
+    void submit(const HeldTransfer &transfer) {
+        if (!device_busy() && held_count == 0) {
+            issue(transfer);
+            return;
+        }
+        if (held_count == MAX_HELD) {
+            while (held_count != 0) {
+                issue(pop_held());
+            }
+            issue(transfer);
+            return;
+        }
+        held[(held_first + held_count) % MAX_HELD] = transfer;
+        held_count++;
+    }
+
+    auto pop_held() -> HeldTransfer {
+        auto transfer = held[held_first];
+        held[held_first] = std::monostate{};
+        held_first = (held_first + 1) % MAX_HELD;
+        held_count--;
+        return transfer;
+    }
+
+    void release_held() {
+        while (held_count != 0 && !device_busy()) {
+            issue(pop_held());
+        }
+        if (held_count == 0 && !device_busy()) {
+            for (std::size_t i = 0; i < waiter_count; ++i) {
+                write_waiters[i].callback(write_waiters[i].callback_param);
+            }
+            waiter_count = 0;
+        }
+    }
+
+    void issue(const HeldTransfer &transfer) {
+        std::visit([this](const auto &t) { this->issue_transfer(t); },
+                   transfer);
+    }
+
+    void issue_transfer(const std::monostate &) {}
+
+    /*
+     * Older boards use 1 byte addresses, if we're on an older board we need
+     * to drop the higher byte of the memory address when sending the message
+     * over i2c
+     */
+    auto put_memory_address(types::address memory_address,
+                            i2c::messages::MaxMessageBuffer &buffer)
+        -> uint8_t * {
+        if (hw_iface.get_eeprom_addr_bytes() ==
+            static_cast<size_t>(
+                hardware_iface::EEPromAddressType::EEPROM_ADDR_8_BIT)) {
+            memory_address = memory_address
+                             << hardware_iface::ADDR_BITS_DIFFERENCE;
+        }
+        auto *iter = buffer.begin();
+        return bit_utils::int_to_bytes(
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            memory_address, iter, (iter + hw_iface.get_eeprom_addr_bytes()));
+    }
+
+    /*
+     * A write that fits in a transaction is sent in one. A longer one goes
+     * out from page_buffer, which holds one write at a time; if it is still
+     * on the bus, which only happens when submit() has had to flush its
+     * held transfers, the write is sent as transaction sized pieces instead.
+     */
+    void issue_transfer(const PendingWrite &m) {
+        if (m.length <= transaction_capacity()) {
+            issue_write(m.message_index, m.memory_address, m.data.data(),
+                        m.length);
+        } else if (!page_write_in_flight) {
+            issue_page_write(m);
+        } else {
+            for (types::data_length offset = 0; offset < m.length;
+                 offset += transaction_capacity()) {
+                issue_write(
+                    m.message_index,
+                    static_cast<types::address>(m.memory_address + offset),
+                    m.data.data() + offset,
+                    std::min(transaction_capacity(),
+                             static_cast<types::data_length>(m.length -
+                                                             offset)));
+            }
+        }
+    }
+
+    void issue_write(uint32_t message_index, types::address memory_address,
+                     const uint8_t *data, types::data_length length) {
+        auto buffer = i2c::messages::MaxMessageBuffer{};
+        auto *iter = put_memory_address(memory_address, buffer);
+        // Remainder is data
+        iter = std::copy_n(data, length, iter);
+        // A write transaction.
+        auto transaction = i2c::messages::Transaction{
+            .message_index = message_index,
+            .address = hw_iface.get_eeprom_address(),
+            .bytes_to_read = 0,
+            .bytes_to_write = static_cast<std::size_t>(iter - buffer.begin()),
+            .write_buffer = buffer};
+        // Use the WRITE_TOKEN to disambiguate from the reads.
+        auto transaction_id =
+            i2c::messages::TransactionIdentifier{.token = WRITE_TOKEN};
+        // Write protect stays off from the start of the transaction to its
+        // stop, which is all a page write on either part needs.
+        hw_iface.disable();
+        if (writer.transact(transaction, transaction_id, own_queue)) {
+            writes_in_flight++;
+        } else {
+            // Failed to write transaction. Re-enable write protection.
+            hw_iface.enable();
+        }
+    }
+
+    void issue_page_write(const PendingWrite &m) {
+        auto address = i2c::messages::MaxMessageBuffer{};
+        auto *end = put_memory_address(m.memory_address, address);
+        auto *iter = std::copy(address.begin(), end, page_buffer.begin());
+        iter = std::copy_n(m.data.cbegin(), m.length, iter);
+        hw_iface.disable();
+        if (writer.write_buffer(
+                hw_iface.get_eeprom_address(), page_buffer.data(),
+                static_cast<uint16_t>(iter - page_buffer.begin()),
+                i2c::messages::TransactionIdentifier{.token =
+                                                         PAGE_WRITE_TOKEN},
+                own_queue)) {
+            writes_in_flight++;
+            page_write_in_flight = true;
+        } else {
+            hw_iface.enable();
+        }
+    }
+
+    void issue_transfer(const message::ReadEepromMessage &m) {
+        auto token = id_map.add(m);
+        if (!token) {
+            LOG("No space in the id map.");
+            // TODO (amit, 2022-05-04): Should we re-enqueue the message?
+            return;
+        }
+
+        // The transaction will write the memory address, then read the
+        // data.
+        auto write_buffer = i2c::messages::MaxMessageBuffer{};
+        auto *iter = put_memory_address(m.memory_address, write_buffer);
+
+        auto transaction = i2c::messages::Transaction{
+            .message_index = m.message_index,
+            .address = hw_iface.get_eeprom_address(),
+            .bytes_to_read = m.length,
+            .bytes_to_write =
+                static_cast<std::size_t>(iter - write_buffer.begin()),
+            .write_buffer{write_buffer}};
+        // The transaction identifier uses the token returned from id_map.add
+        auto transaction_id =
+            i2c::messages::TransactionIdentifier{.token = token.value()};
+
+        if (!writer.transact(transaction, transaction_id, own_queue)) {
+            // The writer cannot accept this message. Remove it from the id_map.
+            id_map.remove(token.value());
+        }
+    }
+
+    void issue_transfer(const shadow::Range &chunk) {
+        auto write_buffer = i2c::messages::MaxMessageBuffer{};
+        auto *iter = put_memory_address(chunk.memory_address, write_buffer);
+        auto transaction = i2c::messages::Transaction{
+            .address = hw_iface.get_eeprom_address(),
+            .bytes_to_read = chunk.length,
+            .bytes_to_write =
+                static_cast<std::size_t>(iter - write_buffer.begin()),
+            .write_buffer{write_buffer}};
+        shadow_loading = writer.transact(
+            transaction,
+            i2c::messages::TransactionIdentifier{.token = SHADOW_TOKEN},
+            own_queue);
+        if (!shadow_loading) {
+            LOG("Could not queue a read of the eeprom shadow.");
+        }
+    }
+
+    void load_next_chunk() {
+        auto chunk = shadow.next_chunk(i2c::messages::MAX_BUFFER_SIZE);
+        if (chunk.length == 0) {
+            shadow_loading = false;
+            return;
+        }
+        flush_write();
+        submit(HeldTransfer{chunk});
+    }
+
+    /*
+     * The eeprom ignores its address until it finishes a write cycle. Rather
+     * than wait out the worst case, address it once a tick until it answers;
+     * only the memory address is sent, which starts no write. The task is
+     * free to handle other messages between polls.
+     */
+    void start_ack_poll() {
+        auto buffer = i2c::messages::MaxMessageBuffer{};
+        auto *iter = put_memory_address(0, buffer);
+        auto transaction = i2c::messages::Transaction{
+            .address = hw_iface.get_eeprom_address(),
+            .bytes_to_read = 0,
+            .bytes_to_write = static_cast<std::size_t>(iter - buffer.begin()),
+            .write_buffer = buffer,
+            .single_attempt = true};
+        ack_polling = writer.transact(
+            transaction,
+            i2c::messages::TransactionIdentifier{.token = ACK_POLL_TOKEN},
+            own_queue);
+        if (!ack_polling) {
+            release_held();
+        }
+    }
+
     void split_write(message::WriteEepromMessage &m, uint16_t page_boundary) {
         // if we overrun the page we need to split it into two messages
-        uint16_t first_len = (m.memory_address + m.length) % page_boundary;
+        uint16_t first_len =
+            page_boundary - (m.memory_address % page_boundary);
         uint16_t sec_len = m.length - first_len;
         auto first =
             message::WriteEepromMessage{.message_index = m.message_index,
@@ -71,9 +427,37 @@ class EEPromMessageHandler {
      */
     void visit(i2c::messages::TransactionResponse &m) {
         LOG("Transaction with token %ud has completed.", m.id.token);
-        if (m.id.token == WRITE_TOKEN) {
+        if (m.id.token == WRITE_TOKEN || m.id.token == PAGE_WRITE_TOKEN) {
             // A write has completed
+            if (m.id.token == PAGE_WRITE_TOKEN) {
+                page_write_in_flight = false;
+            }
             hw_iface.enable();
+            if (writes_in_flight != 0 && --writes_in_flight == 0) {
+                ack_polls = 0;
+                start_ack_poll();
+            }
+        } else if (m.id.token == ACK_POLL_TOKEN) {
+            if (m.failed && ++ack_polls < MAX_ACK_POLLS) {
+                ack_poll_retry = true;
+                ack_poll_failed_at = hardware_tick_count();
+                return;
+            }
+            if (m.failed) {
+                LOG("The eeprom is not acknowledging after a write.");
+            }
+            ack_polling = false;
+            release_held();
+        } else if (m.id.token == SHADOW_TOKEN) {
+            if (m.failed) {
+                // what was loaded is still served; the rest comes from the
+                // bus
+                LOG("Failed to load the eeprom shadow.");
+                shadow_loading = false;
+                return;
+            }
+            shadow.loaded(m.read_buffer.data());
+            load_next_chunk();
         } else {
             // A read has completed
             auto id_map_entry = id_map.remove(m.id.token);
@@ -110,6 +494,7 @@ class EEPromMessageHandler {
                 "device storage");
             return;
         }
+        m.length = std::min(m.length, types::max_data_length);
 
         // If you attempt to write with a length that crosses the page boundary
         // (8 Bytes for MICROCHIP and 64 for ST) it will wrap and overwrite
@@ -120,47 +505,18 @@ class EEPromMessageHandler {
             return this->split_write(m, hw_iface.get_eeprom_page_boundary());
         }
 
-        // The ST eeprom has a page write function but that requires driving
-        // the write enable pin differently which would require us to change
-        // how we use enable_eeprom_write disable_eeprom_write calls in each
-        // firmware implementation however this would allow us to write 64
-        // bytes/cycle which may be performance boost.
+        // the shadow is written through so that reads see this write before
+        // it reaches the eeprom
+        shadow.write(m.memory_address, m.data.data(), m.length);
 
-        auto buffer = i2c::messages::MaxMessageBuffer{};
-        auto *iter = buffer.begin();
-
-        // Older boards use 1 byte addresses, if we're on an older board we
-        // need to drop the higher byte of the memory address when sending the
-        // the message over i2c
-        if (hw_iface.get_eeprom_addr_bytes() ==
-            static_cast<size_t>(
-                hardware_iface::EEPromAddressType::EEPROM_ADDR_8_BIT)) {
-            m.memory_address = m.memory_address
-                               << hardware_iface::ADDR_BITS_DIFFERENCE;
-        }
-        iter = bit_utils::int_to_bytes(
-            // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
-            m.memory_address, iter, (iter + hw_iface.get_eeprom_addr_bytes()));
-        // Remainder is data
-        iter = std::copy_n(
-            m.data.cbegin(),
-            std::min(buffer.size() - 1, static_cast<std::size_t>(m.length)),
-            iter);
-        // A write transaction.
-        auto transaction = i2c::messages::Transaction{
-            .message_index = m.message_index,
-            .address = hw_iface.get_eeprom_address(),
-            .bytes_to_read = 0,
-            .bytes_to_write = static_cast<std::size_t>(iter - buffer.begin()),
-            .write_buffer = buffer};
-        // Use the WRITE_TOKEN to disambiguate from the reads.
-        auto transaction_id =
-            i2c::messages::TransactionIdentifier{.token = WRITE_TOKEN};
-        hw_iface.disable();
-        if (!writer.transact(transaction, transaction_id, own_queue)) {
-            // Failed to write transaction. Re-enable write protection.
-            hw_iface.enable();
+        if (coalesce(m)) {
+            return;
         }
+        flush_write();
+        pending = PendingWrite{.message_index = m.message_index,
+                               .memory_address = m.memory_address,
+                               .length = m.length};
+        std::copy_n(m.data.cbegin(), m.length, pending.data.begin());
     }
 
     /**
@@ -181,47 +537,20 @@ class EEPromMessageHandler {
             return;
         }
 
-        auto token = id_map.add(m);
-        if (!token) {
-            LOG("No space in the id map.");
-            // TODO (amit, 2022-05-04): Should we re-enqueue the message?
+        auto data = types::EepromData{};
+        if (m.length <= data.size() &&
+            shadow.read(m.memory_address, m.length, data.data())) {
+            auto v = message::EepromMessage{.message_index = m.message_index,
+                                            .memory_address = m.memory_address,
+                                            .length = m.length,
+                                            .data = data};
+            m.callback(v, m.callback_param);
             return;
         }
 
-        // The transaction will write the memory address, then read the
-        // data.
-        auto write_buffer = i2c::messages::MaxMessageBuffer{};
-        auto *iter = write_buffer.begin();
-
-        // Older boards use 1 byte addresses, if we're on an older board we
-        // need to drop the higher byte of the memory address when sending the
-        // the message over i2c
-        if (hw_iface.get_eeprom_addr_bytes() ==
-            static_cast<size_t>(
-                hardware_iface::EEPromAddressType::EEPROM_ADDR_8_BIT)) {
-            m.memory_address = m.memory_address
-                               << hardware_iface::ADDR_BITS_DIFFERENCE;
-        }
-
-        iter = bit_utils::int_to_bytes(
-            // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
-            m.memory_address, iter, (iter + hw_iface.get_eeprom_addr_bytes()));
-
-        auto transaction = i2c::messages::Transaction{
-            .message_index = m.message_index,
-            .address = hw_iface.get_eeprom_address(),
-            .bytes_to_read = m.length,
-            .bytes_to_write =
-                static_cast<std::size_t>(iter - write_buffer.begin()),
-            .write_buffer{write_buffer}};
-        // The transaction identifier uses the token returned from id_map.add
-        auto transaction_id =
-            i2c::messages::TransactionIdentifier{.token = token.value()};
-
-        if (!writer.transact(transaction, transaction_id, own_queue)) {
-            // The writer cannot accept this message. Remove it from the id_map.
-            id_map.remove(token.value());
-        }
+        // the read has to see every write that came before it
+        flush_write();
+        submit(HeldTransfer{m});
     }
 
     void visit(message::OTLibraryReadMessage &m) {
@@ -281,6 +610,25 @@ class EEPromMessageHandler {
         // }
     }
 
+    /**
+     * Answer once the writes before this one are done. The pending write
+     * goes out now; held transfers include any writes still waiting for the
+     * bus, so the answer waits for those too.
+     */
+    void visit(message::WriteBarrierMessage &m) {
+        flush_write();
+        if (held_count == 0 && !device_busy()) {
+            m.callback(m.callback_param);
+            return;
+        }
+        if (waiter_count == MAX_WRITE_WAITERS) {
+            LOG("Too many write barriers waiting, answering one early.");
+            m.callback(m.callback_param);
+            return;
+        }
+        write_waiters.at(waiter_count++) = m;
+    }
+
     void visit(message::ConfigRequestMessage &m) {
         auto conf = message::ConfigResponseMessage{
             .chip = hw_iface.get_eeprom_chip_type(),
@@ -295,6 +643,25 @@ class EEPromMessageHandler {
     i2c::transaction::IdMap<message::ReadEepromMessage, MAX_INFLIGHT_READS>
         id_map{};
     hardware_iface::EEPromHardwareIface &hw_iface;
+    PendingWrite pending{};
+    std::array<HeldTransfer, MAX_HELD> held{};
+    std::size_t held_first = 0;
+    std::size_t held_count = 0;
+    uint32_t writes_in_flight = 0;
+    bool ack_polling = false;
+    uint32_t ack_polls = 0;
+    bool ack_poll_retry = false;
+    uint32_t ack_poll_failed_at = 0;
+    std::array<message::WriteBarrierMessage, MAX_WRITE_WAITERS>
+        write_waiters{};
+    std::size_t waiter_count = 0;
+    // The memory address and data of a write too long for a transaction,
+    // which the i2c task reads straight from here.
+    std::array<uint8_t, sizeof(types::address) + hardware_iface::MAX_PAGE_SIZE>
+        page_buffer{};
+    bool page_write_in_flight = false;
+    shadow::EEPromShadow shadow{hw_iface.get_eeprom_mem_size()};
+    bool shadow_loading = false;
 };
 
 /**
@@ -319,10 +686,25 @@ class EEPromTask {
     [[noreturn]] void operator()(i2c::writer::Writer<QueueImpl> *writer,
                                  hardware_iface::EEPromHardwareIface *pin) {
         auto handler = EEPromMessageHandler{*writer, get_queue(), *pin};
+        handler.load_shadow();
         TaskMessage message{};
         for (;;) {
-            if (queue.try_read(&message, queue.max_delay)) {
+            // a write is held back only as long as more messages are
+            // waiting that might extend it, and an unanswered ack poll
+            // waits a tick before it goes out again
+            auto timeout = static_cast<uint32_t>(queue.max_delay);
+            if (handler.has_pending_write()) {
+                timeout = 0;
+            } else if (handler.has_ack_poll_retry()) {
+                timeout = 1;
+            }
+            if (queue.try_read(&message, timeout)) {
                 handler.handle_message(message);
+                handler.retry_ack_poll(hardware_tick_count());
+            } else if (handler.has_pending_write()) {
+                handler.flush_write();
+            } else {
+                handler.retry_ack_poll();
             }
         }
     }
@@ -0,0 +1,217 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+#include "common/core/bit_utils.hpp"
+#include "common/core/logging.h"
+#include "eeprom/core/hardware_iface.hpp"
+
+namespace eeprom {
+namespace simulator {
+
+static constexpr std::string_view TEMPFILE_KEY = "<temp file>";
+
+struct BackingOptions {
+    std::string path = std::string(TEMPFILE_KEY);
+    // Sync the file after this many writes. 0 only syncs when the store
+    // closes.
+    uint32_t sync_writes = 64;
+    // Leave the file alone between syncs and replace it with a complete
+    // image on each one, so that it never holds a partial set of writes.
+    bool snapshot = false;
+};
+
+/**
+ * The simulated eeprom's memory, mapped from a file. Writes land in the
+ * mapping and are synced in batches. In the default mode the kernel owns
+ * them as soon as they are made, so they outlive the process however it
+ * ends; in snapshot mode the file only ever changes by an atomic rename.
+ */
+class BackingStore {
+  public:
+    static constexpr size_t BACKING_SIZE =
+        static_cast<size_t>(hardware_iface::EEpromMemorySize::ST_16_KBYTE);
+
+    BackingStore(const BackingOptions& config, const uint32_t backing_data)
+        : options(with_path(config)), memory(map(options, backing_data)) {}
+    BackingStore(const BackingStore&) = delete;
+    auto operator=(const BackingStore&) -> BackingStore& = delete;
+    BackingStore(BackingStore&&) = delete;
+    auto operator=(BackingStore&&) -> BackingStore&& = delete;
+    ~BackingStore() {
+        if (options.snapshot) {
+            sync();
+        } else if (msync(memory, BACKING_SIZE, MS_SYNC) != 0) {
+            fprintf(stderr, "msync of EEPROM file %s failed: %d %s\n",
+                    options.path.c_str(), errno, strerror(errno));
+        }
+        munmap(memory, BACKING_SIZE);
+    }
+
+    auto read(uint8_t* readbuf, uint16_t address, size_t size) -> void {
+        check_range("read", address, size);
+        std::copy_n(memory + address, size, readbuf);
+    }
+
+    auto write(const uint8_t* writebuf, uint16_t address, size_t size)
+        -> void {
+        check_range("write", address, size);
+        std::copy_n(writebuf, size, memory + address);
+        unsynced_writes++;
+        if (options.sync_writes != 0 &&
+            unsynced_writes >= options.sync_writes) {
+            sync();
+        }
+    }
+
+    /**
+     * Start writing back everything written since the last sync; in
+     * snapshot mode, replace the file with the current contents.
+     */
+    auto sync() -> void {
+        if (unsynced_writes == 0) {
+            return;
+        }
+        unsynced_writes = 0;
+        if (options.snapshot) {
+            write_snapshot();
+        } else if (msync(memory, BACKING_SIZE, MS_ASYNC) != 0) {
+            fprintf(stderr, "msync of EEPROM file %s failed: %d %s\n",
+                    options.path.c_str(), errno, strerror(errno));
+        }
+    }
+
+    [[nodiscard]] auto path() const -> const std::string& {
+        return options.path;
+    }
+
+  private:
+    static auto with_path(BackingOptions options) -> BackingOptions {
+        if (options.path == TEMPFILE_KEY) {
+            auto temp_path =
+                std::filesystem::temp_directory_path() / "eeprom.bin";
+            LOG("Backing up eeprom with tempfile at %s", temp_path.c_str());
+            // a temp file starts over every run
+            std::filesystem::remove(temp_path);
+            options.path = temp_path.string();
+        } else {
+            auto path = std::filesystem::path(options.path);
+            path.make_preferred();
+            options.path = path.string();
+        }
+        return options;
+    }
+
+    [[noreturn]] static void fail(const char* what, const std::string& path) {
+        fprintf(stderr, "Could not %s EEPROM file %s: %d %s\n", what,
+                path.c_str(), errno, strerror(errno));
+        std::abort();
+    }
+
+    /*
+     * Open the file, extending it to BACKING_SIZE if it is short without
+     * touching what is already there, and map it. A snapshot mapping is
+     * private so that writes never reach the file.
+     */
+    static auto map(const BackingOptions& options, const uint32_t backing_data)
+        -> uint8_t* {
+        int fd = open(options.path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd < 0) {
+            fail("open", options.path);
+        }
+        struct stat status {};
+        if (fstat(fd, &status) != 0) {
+            fail("stat", options.path);
+        }
+        auto size = static_cast<size_t>(status.st_size);
+        LOG("Backing up eeprom with %s (%s)", options.path.c_str(),
+            size == 0 ? "new" : "preexisting");
+        if (size < BACKING_SIZE) {
+            auto initial = initial_contents(backing_data);
+            auto written = pwrite(fd, initial.data() + size,
+                                  BACKING_SIZE - size, off_t(size));
+            if (written != static_cast<ssize_t>(BACKING_SIZE - size)) {
+                fail("extend", options.path);
+            }
+            LOG("Extended backing file to %zuB by writing %zuB from %zu",
+                BACKING_SIZE, BACKING_SIZE - size, size);
+        }
+        void* mapped =
+            mmap(nullptr, BACKING_SIZE, PROT_READ | PROT_WRITE,
+                 options.snapshot ? MAP_PRIVATE : MAP_SHARED, fd, 0);
+        // the mapping keeps the file open
+        close(fd);
+        if (mapped == MAP_FAILED) {
+            fail("map", options.path);
+        }
+        return static_cast<uint8_t*>(mapped);
+    }
+
+    static auto initial_contents(const uint32_t backing_data)
+        -> std::array<uint8_t, BACKING_SIZE> {
+        auto contents = std::array<uint8_t, BACKING_SIZE>{};
+        if (backing_data != 0) {
+            uint32_t instrument_type = (backing_data & 0xFFFF0000) >> 16;
+            uint32_t serial_number = backing_data & 0x0000FFFF;
+            auto iter = bit_utils::int_to_bytes(
+                instrument_type, contents.begin(), contents.end());
+            static_cast<void>(
+                bit_utils::int_to_bytes(serial_number, iter, contents.end()));
+        } else {
+            contents.fill(0xff);
+        }
+        return contents;
+    }
+
+    /*
+     * Write the contents to a file beside the backing file, make sure they
+     * are on disk and rename it over the backing file. Whatever happens to
+     * the process the backing file is either the old snapshot or the new
+     * one.
+     */
+    auto write_snapshot() -> void {
+        auto temp_path = options.path + ".tmp";
+        int fd = open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            fail("open snapshot of", options.path);
+        }
+        auto written = ::write(fd, memory, BACKING_SIZE);
+        if (written != static_cast<ssize_t>(BACKING_SIZE) || fsync(fd) != 0) {
+            fail("write snapshot of", options.path);
+        }
+        close(fd);
+        if (std::rename(temp_path.c_str(), options.path.c_str()) != 0) {
+            fail("replace", options.path);
+        }
+    }
+
+    auto check_range(const char* what, uint16_t address, size_t size) const
+        -> void {
+        if (address + size > BACKING_SIZE) {
+            fprintf(stderr,
+                    "EEPROM %s of %zu bytes at %d runs past the end of %s\n",
+                    what, size, address, options.path.c_str());
+            std::abort();
+        }
+    }
+
+    BackingOptions options;
+    uint8_t* memory;
+    uint32_t unsynced_writes = 0;
+};
+
+}  // namespace simulator
+}  // namespace eeprom
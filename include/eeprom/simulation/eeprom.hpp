@@ -1,11 +1,6 @@
 #pragma once
 
-#include <array>
-#include <cstdio>
-#include <cstring>
-#include <filesystem>
 #include <functional>
-#include <iterator>
 #include <string>
 
 #include "boost/program_options.hpp"
@@ -13,6 +8,7 @@
 #include "common/core/logging.h"
 #include "eeprom/core/hardware_iface.hpp"
 #include "eeprom/core/types.hpp"
+#include "eeprom/simulation/backing_store.hpp"
 #include "i2c/simulation/device.hpp"
 
 namespace eeprom {
@@ -27,16 +23,53 @@ class EEProm : public I2CDeviceBase,
     static auto add_options(po::options_description& cmdline_desc,
                             po::options_description& env_desc)
         -> std::function<std::string(std::string)> {
-        return BackingStore::add_options(cmdline_desc, env_desc);
+        cmdline_desc.add_options()(
+            "eeprom-filename,f",
+            po::value<std::string>()->default_value(std::string(TEMPFILE_KEY)),
+            "path to backing file for eeprom. if unspecified, a temp will "
+            "be used. May be specified in an environment file called "
+            "EEPROM_FILENAME.");
+        cmdline_desc.add_options()(
+            "eeprom-sync-writes",
+            po::value<uint32_t>()->default_value(BackingOptions{}.sync_writes),
+            "how many eeprom writes to batch into one sync of the backing "
+            "file. 0 syncs only on exit. May be specified in an environment "
+            "variable called EEPROM_SYNC_WRITES.");
+        cmdline_desc.add_options()(
+            "eeprom-snapshot",
+            po::value<bool>()->default_value(false)->implicit_value(true),
+            "only change the backing file by atomically replacing it with a "
+            "complete image on each sync. May be specified in an environment "
+            "variable called EEPROM_SNAPSHOT.");
+        env_desc.add_options()(
+            "eeprom-filename",
+            po::value<std::string>()->default_value(std::string(TEMPFILE_KEY)));
+        env_desc.add_options()(
+            "eeprom-sync-writes",
+            po::value<uint32_t>()->default_value(BackingOptions{}.sync_writes));
+        env_desc.add_options()("eeprom-snapshot",
+                               po::value<bool>()->default_value(false));
+        return [](std::string input_val) -> std::string {
+            if (input_val == "EEPROM_FILENAME") {
+                return "eeprom-filename";
+            }
+            if (input_val == "EEPROM_SYNC_WRITES") {
+                return "eeprom-sync-writes";
+            }
+            if (input_val == "EEPROM_SNAPSHOT") {
+                return "eeprom-snapshot";
+            }
+            return "";
+        };
     }
     explicit EEProm(po::variables_map& options, const uint32_t backing_data = 0)
         : I2CDeviceBase(hardware_iface::get_i2c_device_address()),
-          backing(options, backing_data) {}
+          backing(backing_options(options), backing_data) {}
     EEProm(hardware_iface::EEPromChipType chip, po::variables_map& options,
            const uint32_t backing_data = 0)
         : I2CDeviceBase(hardware_iface::get_i2c_device_address(chip)),
           hardware_iface::EEPromHardwareIface(chip),
-          backing(options, backing_data) {}
+          backing(backing_options(options), backing_data) {}
 
     auto handle_write(const uint8_t* data, uint16_t size) -> bool {
         auto* iter = data;
@@ -81,177 +114,20 @@ class EEProm : public I2CDeviceBase,
         write_protected = enabled;
     }
 
-    struct BackingStore {
-        static constexpr std::string_view TEMPFILE_KEY = "<temp file>";
-        static constexpr size_t BACKING_SIZE =
-            static_cast<size_t>(hardware_iface::EEpromMemorySize::ST_16_KBYTE);
-        BackingStore(const BackingStore&) = delete;
-        auto operator=(const BackingStore&) -> BackingStore& = delete;
-        BackingStore(BackingStore&&) = delete;
-        auto operator=(BackingStore&&) -> BackingStore&& = delete;
-        explicit BackingStore(const po::variables_map& variables,
-                              const uint32_t backing_data)
-            : backing(get_prepped_backing_file(variables, backing_data)) {}
-        ~BackingStore() {
-            if (backing) {
-                if (!std::ferror(backing)) {
-                    std::fflush(backing);
-                }
-                std::fclose(backing);
-            }
-        }
-        static auto get_temp_file() -> std::FILE* {
-            auto tempdir = std::filesystem::temp_directory_path();
-            auto temp_path = tempdir / "eeprom.bin";
-            LOG("Backing up eeprom with tempfile at %s", temp_path.c_str());
-            return std::fopen(temp_path.c_str(), "w+b");
-        }
-        static auto get_backing_file(std::string pathstr) -> std::FILE* {
-            auto path = std::filesystem::path(pathstr);
-            path.make_preferred();
-            // We have to try and open this in r+ first so we don't destroy
-            // the contents if it exists, but if it doesn't exist we'll get
-            // a nullptr
-            if (FILE* filep = std::fopen(path.c_str(), "r+b")) {
-                LOG("Backing up eeprom with %s (preexisting)", path.c_str());
-                return filep;
-            } else {
-                // and have to try again with w+, which will create the file
-                // if it doesn't exist, but would overwrite it if it did
-                LOG("Backing up eeprom with %s (new)", path.c_str());
-                return std::fopen(path.c_str(), "w+b");
-            }
-        }
-        static auto get_prepped_backing_file(std::string pathstr,
-                                             const uint32_t backing_data)
-            -> std::FILE* {
-            auto file = ((pathstr == TEMPFILE_KEY) ? get_temp_file()
-                                                   : get_backing_file(pathstr));
-            if (!file) {
-                fprintf(stderr, "Could not open backing file %s: %d %s\n",
-                        pathstr.c_str(), errno, strerror(errno));
-                std::abort();
-            }
-            // what's the current end of the file? (we may open with append)
-            auto start = std::ftell(file);
-            std::fseek(file, 0, SEEK_END);
-            auto size = static_cast<size_t>(std::ftell(file));
-            // extend file if necessary but don't truncate
-            if (size < BACKING_SIZE) {
-                std::fseek(file, BACKING_SIZE, SEEK_SET);
-                std::fseek(file, start, SEEK_SET);
-                auto tmp_backing = std::array<char, BACKING_SIZE>{};
-                if (backing_data != 0) {
-                    uint32_t instrument_type =
-                        (backing_data & 0xFFFF0000) >> 16;
-                    uint32_t serial_number = backing_data & 0x0000FFFF;
-                    auto iter = bit_utils::int_to_bytes(instrument_type,
-                                                        tmp_backing.begin(),
-                                                        tmp_backing.end());
-                    static_cast<void>(bit_utils::int_to_bytes(
-                        serial_number, iter, tmp_backing.end()));
-                } else {
-                    tmp_backing.fill(0xff);
-                }
-                std::fwrite(tmp_backing.data(), sizeof(tmp_backing[0]),
-                            BACKING_SIZE - start, file);
-                std::fflush(file);
-                LOG("Extended backing file to %uB by writing %uB from %ld",
-                    BACKING_SIZE, BACKING_SIZE - start, start);
-            }
-            // pointer back to 0, though we'll be doing a lot of SEEK_SET so it
-            // doesn't really matter
-            std::fseek(file, 0, SEEK_SET);
-            LOG("got file at %p\n", file);
-            return file;
-        }
-        static auto get_prepped_backing_file(const po::variables_map& variables,
-                                             const uint32_t backing_data)
-            -> FILE* {
-            return get_prepped_backing_file(
-                variables["eeprom-filename"].as<std::string>(), backing_data);
-        }
-        static auto add_options(po::options_description& cmdline,
-                                po::options_description& env)
-            -> std::function<std::string(std::string)> {
-            cmdline.add_options()(
-                "eeprom-filename,f",
-                po::value<std::string>()->default_value(
-                    std::string(TEMPFILE_KEY)),
-                "path to backing file for eeprom. if unspecified, a temp will "
-                "be used. May be specified in an environment file called "
-                "EEPROM_FILENAME.");
-            env.add_options()("eeprom-filename",
-                              po::value<std::string>()->default_value(
-                                  std::string(TEMPFILE_KEY)));
-            return [](std::string input_val) -> std::string {
-                if (input_val == "EEPROM_FILENAME") {
-                    return "eeprom-filename";
-                }
-                return "";
-            };
-        }
-        auto read(uint8_t* readbuf, uint16_t address, size_t size) -> void {
-            if (std::fseek(backing, address, SEEK_SET)) {
-                fprintf(stderr,
-                        "fseek to %d for EEPROM read on file %p failed: eof=%d "
-                        "err=%d %d %s",
-                        address, backing, std::feof(backing),
-                        std::ferror(backing), errno, strerror(errno));
-            }
-            auto read_count =
-                std::fread(readbuf, sizeof(readbuf[0]), size, backing);
-            if (read_count != size) {
-                if (std::feof(backing)) {
-                    fprintf(stderr,
-                            "EEPROM read of %ld bytes from %d read only %ld "
-                            "and hit eof\n",
-                            size, address, read_count);
-                    std::abort();
-                } else if (std::ferror(backing)) {
-                    fprintf(stderr,
-                            "EEPROM read of %ld bytes from %d on file %p read "
-                            "only %ld hit error: %d %s\n",
-                            size, address, backing, read_count, errno,
-                            strerror(errno));
-                    std::abort();
-                }
-            }
-        }
-
-        auto write(const uint8_t* writebuf, uint16_t address, size_t size)
-            -> void {
-            if (std::fseek(backing, address, SEEK_SET)) {
-                fprintf(stderr,
-                        "fseek to %d on file %p for EEPROM write failed: "
-                        "eof=%d err=%d %d %s",
-                        address, backing, std::feof(backing),
-                        std::ferror(backing), errno, strerror(errno));
-            }
-
-            auto write_count =
-                std::fwrite(writebuf, sizeof(writebuf[0]), size, backing);
-            if (write_count != size) {
-                if (std::feof(backing)) {
-                    fprintf(stderr, "EEPROM write of %ld bytes to %d hit eof\n",
-                            size, address);
-                    std::abort();
-                } else if (std::ferror(backing)) {
-                    fprintf(stderr,
-                            "EEPROM write of %ld bytes to %d on file %p caused "
-                            "error: %d %s\n",
-                            size, address, backing, errno, strerror(errno));
-                    std::abort();
-                }
-            }
-            std::fflush(backing);
-        }
-
-      private:
-        std::FILE* backing;
-    };
+    /**
+     * Write out anything that has not been synced yet.
+     */
+    void sync() { backing.sync(); }
 
   private:
+    static auto backing_options(const po::variables_map& options)
+        -> BackingOptions {
+        return BackingOptions{
+            .path = options["eeprom-filename"].as<std::string>(),
+            .sync_writes = options["eeprom-sync-writes"].as<uint32_t>(),
+            .snapshot = options["eeprom-snapshot"].as<bool>()};
+    }
+
     BackingStore backing;
     types::address current_address{0};
     bool write_protected{true};
@@ -10,6 +10,7 @@
 #include "eeprom/core/message_handler.hpp"
 #include "gantry/core/queues.hpp"
 #include "motor-control/core/stepper_motor/motor.hpp"
+#include "motor-control/core/tasks/move_group_task.hpp"
 
 namespace can_bus {
 class CanBus;
@@ -29,7 +30,9 @@ using MoveGroupDispatchTarget = can::dispatch::DispatchParseTarget<
     can::messages::AddLinearMoveRequest,
     can::messages::ClearAllMoveGroupsRequest,
     can::messages::ExecuteMoveGroupRequest, can::messages::GetMoveGroupRequest,
-    can::messages::HomeRequest, can::messages::StopRequest>;
+    can::messages::HomeRequest, can::messages::StopRequest,
+    can::messages::AddJerkMoveRequest, can::messages::ExecuteMoveStreamRequest,
+    can::messages::EndMoveStreamRequest>;
 using MotionControllerDispatchTarget = can::dispatch::DispatchParseTarget<
     can::message_handlers::motion::MotionHandler<gantry::queues::QueueClient>,
     can::messages::DisableMotorRequest, can::messages::EnableMotorRequest,
@@ -43,21 +46,24 @@ using SystemDispatchTarget = can::dispatch::DispatchParseTarget<
     can::message_handlers::system::SystemMessageHandler<
         gantry::queues::QueueClient>,
     can::messages::DeviceInfoRequest, can::messages::InitiateFirmwareUpdate,
-    can::messages::FirmwareUpdateStatusRequest, can::messages::TaskInfoRequest>;
+    can::messages::FirmwareUpdateStatusRequest, can::messages::TaskInfoRequest,
+    can::messages::TransmitLaneStatusRequest>;
 
 using EEpromDispatchTarget = can::dispatch::DispatchParseTarget<
     eeprom::message_handler::EEPromHandler<gantry::queues::QueueClient,
                                            gantry::queues::QueueClient>,
     can::messages::WriteToEEPromRequest, can::messages::ReadFromEEPromRequest>;
 
-using GantryDispatcherType =
-    can::dispatch::Dispatcher<MotorDispatchTarget, MoveGroupDispatchTarget,
-                              MotionControllerDispatchTarget,
-                              SystemDispatchTarget, EEpromDispatchTarget>;
+using GantryDispatcherType = can::dispatch::ParsingDispatcher<
+    can::dispatch::StandardArbIdTest, MotorDispatchTarget,
+    MoveGroupDispatchTarget, MotionControllerDispatchTarget,
+    SystemDispatchTarget, EEpromDispatchTarget>;
 
-auto constexpr reader_message_buffer_size = 1024;
+/** Room for a full move group to the axis motor. */
+auto constexpr reader_frame_pool_size = can::frame_pool::pool_size_for_burst(
+    move_group_task::max_moves_per_group);
 using CanMessageReaderTask =
-    can::freertos_dispatch::FreeRTOSCanReader<reader_message_buffer_size,
+    can::freertos_dispatch::FreeRTOSCanReader<reader_frame_pool_size,
                                               GantryDispatcherType>;
 
 /**
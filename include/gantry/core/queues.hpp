@@ -60,6 +60,9 @@ struct QueueClient : can::message_writer::MessageWriter {
         eeprom_queue{nullptr};
     freertos_message_queue::FreeRTOSMessageQueue<
         usage_storage_task::TaskMessage>* usage_storage_queue{nullptr};
+    // The step interrupt handler reports move status here instead of into
+    // move_status_report_queue.
+    move_status_reporter_task::MoveStatusEventLog<> move_status_events{};
 };
 
 /**
@@ -27,14 +27,18 @@ using MoveGroupDispatchTarget = can::dispatch::DispatchParseTarget<
     can::messages::ClearAllMoveGroupsRequest,
     can::messages::ExecuteMoveGroupRequest, can::messages::GetMoveGroupRequest,
     can::messages::HomeRequest, can::messages::StopRequest,
-    can::messages::AddSensorMoveRequest>;
+    can::messages::AddSensorMoveRequest, can::messages::AddJerkMoveRequest,
+    can::messages::ExecuteMoveStreamRequest,
+    can::messages::EndMoveStreamRequest>;
 #else
 using MoveGroupDispatchTarget = can::dispatch::DispatchParseTarget<
     can::message_handlers::move_group::MoveGroupHandler<z_tasks::QueueClient>,
     can::messages::AddLinearMoveRequest,
     can::messages::ClearAllMoveGroupsRequest,
     can::messages::ExecuteMoveGroupRequest, can::messages::GetMoveGroupRequest,
-    can::messages::HomeRequest, can::messages::StopRequest>;
+    can::messages::HomeRequest, can::messages::StopRequest,
+    can::messages::AddJerkMoveRequest, can::messages::ExecuteMoveStreamRequest,
+    can::messages::EndMoveStreamRequest>;
 #endif
 using MotionControllerDispatchTarget = can::dispatch::DispatchParseTarget<
     can::message_handlers::motion::MotionHandler<z_tasks::QueueClient>,
@@ -49,7 +53,8 @@ using SystemDispatchTarget = can::dispatch::DispatchParseTarget<
     can::message_handlers::system::SystemMessageHandler<
         gripper_tasks::QueueClient>,
     can::messages::DeviceInfoRequest, can::messages::InitiateFirmwareUpdate,
-    can::messages::FirmwareUpdateStatusRequest, can::messages::TaskInfoRequest>;
+    can::messages::FirmwareUpdateStatusRequest, can::messages::TaskInfoRequest,
+    can::messages::TransmitLaneStatusRequest>;
 using BrushedMotorDispatchTarget = can::dispatch::DispatchParseTarget<
     can::message_handlers::motor::BrushedMotorHandler<g_tasks::QueueClient>,
     can::messages::SetBrushedMotorVrefRequest,
@@ -82,7 +87,7 @@ using SensorDispatchTarget = can::dispatch::DispatchParseTarget<
     can::messages::SetSensorThresholdRequest,
     can::messages::BindSensorOutputRequest,
     can::messages::PeripheralStatusRequest,
-    can::messages::MaxSensorValueRequest>;
+    can::messages::MaxSensorValueRequest, can::messages::SensorStreamRequest>;
 
 auto constexpr reader_message_buffer_size = 1024;
 
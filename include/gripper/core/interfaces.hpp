@@ -20,6 +20,13 @@ void initialize();
  */
 auto get_z_motor() -> motor_class::Motor<lms::LeadScrewConfig> &;
 
+/**
+ * Access to the z motor hardware, for its position.
+ *
+ * @return The motor hardware.
+ */
+auto get_z_motor_hardware() -> motor_hardware::StepperMotorHardwareIface &;
+
 /**
  * Get the SPI interface
  * @return the SPI interface
@@ -220,6 +220,9 @@ struct QueueClient : can::message_writer::MessageWriter {
         spi_queue{nullptr};
     freertos_message_queue::FreeRTOSMessageQueue<
         usage_storage_task::TaskMessage>* z_usage_storage_queue{nullptr};
+    // The step interrupt handler reports move status here instead of into
+    // move_status_report_queue.
+    move_status_reporter_task::MoveStatusEventLog<> move_status_events{};
 };
 
 [[nodiscard]] auto get_queues() -> QueueClient&;
@@ -78,6 +78,9 @@ struct MotorQueueClient : can::message_writer::MessageWriter {
 
     freertos_message_queue::FreeRTOSMessageQueue<
         usage_storage_task::TaskMessage>* usage_storage_queue{nullptr};
+    // The step interrupt handler reports move status here instead of into
+    // move_status_report_queue.
+    move_status_reporter_task::MoveStatusEventLog<> move_status_events{};
 };
 
 /**
@@ -16,7 +16,8 @@ using SystemDispatchTarget = can::dispatch::DispatchParseTarget<
     can::message_handlers::system::SystemMessageHandler<
         hepauv_tasks::QueueClient>,
     can::messages::DeviceInfoRequest, can::messages::InitiateFirmwareUpdate,
-    can::messages::FirmwareUpdateStatusRequest, can::messages::TaskInfoRequest>;
+    can::messages::FirmwareUpdateStatusRequest, can::messages::TaskInfoRequest,
+    can::messages::TransmitLaneStatusRequest>;
 
 using HepaUVInfoDispatchTarget = can::dispatch::DispatchParseTarget<
     hepauv_info::HepaUVInfoMessageHandler<hepauv_tasks::QueueClient,
@@ -5,6 +5,25 @@
 namespace i2c {
 
 namespace hardware {
+
+/**
+ * A write, a read, or a write followed by a read after a repeated start.
+ * Either size may be 0.
+ */
+struct Transfer {
+    uint16_t dev_address = 0;
+    uint8_t* write_data = nullptr;
+    uint16_t write_size = 0;
+    uint8_t* read_data = nullptr;
+    uint16_t read_size = 0;
+};
+
+/**
+ * Called once when an asynchronous transfer finishes. On hardware this
+ * runs in the i2c interrupt.
+ */
+using TransferCallback = void (*)(void* context, bool succeeded);
+
 /**
  * Abstract i2c interfacew.
  */
@@ -32,6 +51,25 @@ class I2CBase {
     virtual auto central_receive(uint8_t* data, uint16_t size,
                                  uint16_t dev_address, uint32_t timeout)
         -> bool = 0;
+
+    /**
+     * Start a transfer and return without waiting for it. Only one transfer
+     * can be in progress on a bus.
+     * @return True if the transfer started, in which case callback will be
+     * called when it finishes
+     */
+    virtual auto start_transfer(const Transfer& transfer,
+                                TransferCallback callback, void* context)
+        -> bool = 0;
+
+    /**
+     * Run a transfer, sleeping the calling task until it finishes. A
+     * transfer the device does not acknowledge is retried until timeout
+     * has passed; with a timeout of 0 it is tried once.
+     * @return True if succeeded
+     */
+    virtual auto transfer(const Transfer& transfer, uint32_t timeout)
+        -> bool = 0;
 };
 
 }  // namespace hardware
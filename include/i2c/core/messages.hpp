@@ -19,11 +19,14 @@ using MaxMessageBuffer = std::array<uint8_t, MAX_BUFFER_SIZE>;
 ** for chaining response messages through the poller.
 ** The transaction index is used for multi-register reads; for these, the
 ** index is which transaction just completed.
+** The poll handle is set by the poller on the transactions of a poll so that
+** their responses find it again; callers leave it 0.
 */
 struct TransactionIdentifier {
     uint32_t token;
     bool is_completed_poll;
     uint8_t transaction_index;
+    uint16_t poll_handle;
     auto operator==(const TransactionIdentifier& other) const -> bool = default;
 };
 
@@ -31,6 +34,9 @@ struct TransactionIdentifier {
 ** Core data structure describing a single i2c transaction. The address should
 ** be the i2c address of the device; the write_buffer holds data to write and
 ** the size elements are the amounts to read or write.
+** A transaction the device doesn't acknowledge is normally retried for a
+** while; with single_attempt it is tried once, e.g. to poll whether an
+** eeprom has finished its write cycle.
 */
 struct Transaction {
     uint32_t message_index;
@@ -38,6 +44,7 @@ struct Transaction {
     size_t bytes_to_read;
     size_t bytes_to_write;
     MaxMessageBuffer write_buffer;
+    bool single_attempt;
 
     auto operator==(const Transaction&) const -> bool = default;
 };
@@ -46,6 +53,10 @@ struct Transaction {
 ** Response message that will be sent after a transaction completes, mirroring
 ** the transaction identifier that was associated with the transaction that just
 ** ended, and contains the data read out of the bus (if any).
+** A poll that could not be started because the poller had no room for it is
+** answered with a single completed response with poll_rejected set.
+** failed is set when the transfer did not go through, e.g. because the
+** device never acknowledged it.
 */
 struct TransactionResponse {
     auto operator==(const TransactionResponse&) const -> bool = default;
@@ -53,6 +64,8 @@ struct TransactionResponse {
     TransactionIdentifier id;
     size_t bytes_read;
     MaxMessageBuffer read_buffer;
+    bool poll_rejected;
+    bool failed;
 };
 
 /*
@@ -104,6 +117,22 @@ struct Transact {
     TransactionIdentifier id;
     ResponseWriter response_writer;
 };
+/*
+** Command a write of more data than a Transaction carries, such as a full
+** eeprom page. The data is not copied into the message: it stays in the
+** caller's buffer, which must be left alone until the response comes back.
+** A response is always sent, with failed set if the write did not go
+** through.
+*/
+struct BufferWrite {
+    uint32_t message_index;
+    uint16_t address;
+    uint8_t* data;
+    uint16_t size;
+    TransactionIdentifier id;
+    ResponseWriter response_writer;
+};
+
 /*
 ** Command a count-limited number of I2C reads from an single register
 ** of a single address at a specific poll timing. The poll timing may
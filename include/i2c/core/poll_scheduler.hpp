@@ -0,0 +1,321 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+
+#include "common/core/timer.hpp"
+#include "i2c/core/messages.hpp"
+
+namespace i2c {
+namespace poll_scheduler {
+
+// Polls are placed on a timeline of whole milliseconds, the resolution of
+// the software timers.
+static constexpr uint32_t SLOT_MS = 1;
+// The clock used to estimate how long a transaction holds the bus. This is
+// the slowest clock any of our buses is set up for.
+static constexpr uint32_t BUS_HZ = 100000;
+
+/**
+ * Estimate how long a transaction holds the bus, in us: nine clocks for
+ * each byte including the address bytes, and one for each start, repeated
+ * start and stop.
+ */
+constexpr auto transaction_us(const messages::Transaction& transaction)
+    -> uint32_t {
+    if (transaction.address == 0) {
+        return 0;
+    }
+    uint32_t bytes = 0;
+    uint32_t conditions = 1;
+    if (transaction.bytes_to_write != 0) {
+        bytes += 1 + transaction.bytes_to_write;
+        conditions++;
+    }
+    if (transaction.bytes_to_read != 0) {
+        bytes += 1 + transaction.bytes_to_read;
+        conditions++;
+    }
+    uint32_t clocks = bytes * 9 + conditions;
+    return (clocks * 1000000 + BUS_HZ - 1) / BUS_HZ;
+}
+
+/**
+ * A timer that can also read the tick count, in ms, for the timeline.
+ */
+template <typename TimerType>
+concept ClockedTimer = timer::Timer<TimerType> && requires(TimerType tt) {
+    { tt.get_tick_ms() } -> std::same_as<uint32_t>;
+};
+
+/**
+ * Called from the scheduler's timer when a poll's slot comes up.
+ */
+using SlotCallback = void (*)(void* context);
+
+/**
+ * One timer for every poll on a bus. Each poll is given a phase on a shared
+ * timeline of SLOT_MS slots, chosen from its period so that it shares slots
+ * with as little bus time as possible. Polls whose slots do coincide are
+ * run back to back from the same tick, in the order they were scheduled,
+ * instead of racing each other from their own timers.
+ *
+ * The timeline is the tick count, so a poll is due at the same slots
+ * however late the timer runs. The timer only fires for slots that have a
+ * poll due: after each tick it is set to the next one. Scheduling a poll
+ * only shortens that wait when the new poll is due sooner, so the polls
+ * already running keep their spacing. The timer is left at one slot when
+ * it stops, so starting it again never has to change the period of a
+ * stopped timer.
+ *
+ * schedule() and unschedule() run on the caller's task while tick() runs on
+ * the timer task, so a slot is filled in before its period is published and
+ * tick() reads the period before anything else in the slot. A tick runs
+ * every poll that came due since its last run, so a wait that is set while
+ * a tick is running delays a poll rather than skipping it.
+ */
+template <ClockedTimer TimerImpl, std::size_t MaxPolls>
+class PollScheduler {
+  public:
+    PollScheduler()
+        : timer(
+              "i2c poll scheduler", [this]() -> void { tick(); }, SLOT_MS) {}
+    PollScheduler(const PollScheduler&) = delete;
+    auto operator=(const PollScheduler&) -> PollScheduler& = delete;
+    PollScheduler(PollScheduler&&) = delete;
+    auto operator=(PollScheduler&&) -> PollScheduler& = delete;
+    ~PollScheduler() = default;
+
+    /**
+     * Put a poll on the timeline, or move it if it is already there. With
+     * no other polls it is first due a period from now.
+     * @param busy_us The bus time the poll takes each period
+     * @return False if there is no room for another poll
+     */
+    auto schedule(void* context, SlotCallback callback, uint32_t period_ms,
+                  uint32_t busy_us) -> bool {
+        unschedule(context);
+        auto* slot = free_slot();
+        if (slot == nullptr || period_ms == 0) {
+            return false;
+        }
+        auto period = period_ms / SLOT_MS;
+        if (period == 0) {
+            period = 1;
+        }
+        auto from = current_slot();
+        slot->phase = place(period, from);
+        slot->next_due = from + slots_until_due(slot->phase, period, from);
+        slot->busy_us = busy_us;
+        slot->callback = callback;
+        slot->context = context;
+        // the period goes in last since it is what marks the slot as in use
+        slot->period.store(period, std::memory_order_release);
+        wake_by(slot->next_due, from);
+        return true;
+    }
+
+    auto unschedule(const void* context) -> void {
+        auto* slot = find(context);
+        if (slot == nullptr) {
+            return;
+        }
+        slot->period.store(0, std::memory_order_release);
+        for (const auto& other : slots) {
+            if (other.period.load(std::memory_order_acquire) != 0) {
+                return;
+            }
+        }
+        timer.update_period(SLOT_MS);
+        timer.stop();
+    }
+
+    [[nodiscard]] auto is_scheduled(const void* context) const -> bool {
+        return find(context) != nullptr;
+    }
+
+    [[nodiscard]] auto period(const void* context) const -> uint32_t {
+        const auto* slot = find(context);
+        return (slot == nullptr)
+                   ? 0
+                   : slot->period.load(std::memory_order_acquire) * SLOT_MS;
+    }
+
+    /**
+     * The bus time of the polls due on the tick that many slots from now.
+     */
+    [[nodiscard]] auto load_us(uint32_t slots_from_now) const -> uint32_t {
+        uint32_t when = current_slot() + slots_from_now;
+        uint32_t load = 0;
+        for (const auto& slot : slots) {
+            auto period = slot.period.load(std::memory_order_acquire);
+            if (period != 0 && when % period == slot.phase) {
+                load += slot.busy_us;
+            }
+        }
+        return load;
+    }
+
+    TimerImpl timer;
+
+  private:
+    struct Slot {
+        std::atomic<uint32_t> period = 0;
+        uint32_t phase = 0;
+        // the slot the poll is next due in; only tick() moves it once the
+        // poll is scheduled
+        uint32_t next_due = 0;
+        uint32_t busy_us = 0;
+        SlotCallback callback = nullptr;
+        void* context = nullptr;
+    };
+
+    /**
+     * The number of slots from a slot to the next one after it in which a
+     * poll is due.
+     */
+    static constexpr auto slots_until_due(uint32_t phase, uint32_t period,
+                                          uint32_t from) -> uint32_t {
+        auto wait = (phase + period - from % period) % period;
+        return (wait == 0) ? period : wait;
+    }
+
+    [[nodiscard]] auto current_slot() const -> uint32_t {
+        return timer.get_tick_ms() / SLOT_MS;
+    }
+
+    // Whether slot a comes before slot b, across the tick count wrapping
+    static constexpr auto is_before(uint32_t a, uint32_t b) -> bool {
+        return static_cast<int32_t>(a - b) < 0;
+    }
+
+    auto tick() -> void {
+        auto now = current_slot();
+        for (auto& slot : slots) {
+            auto period = slot.period.load(std::memory_order_acquire);
+            if (period != 0 && !is_before(now, slot.next_due)) {
+                slot.callback(slot.context);
+                slot.next_due += ((now - slot.next_due) / period + 1) * period;
+            }
+        }
+        retime(now);
+    }
+
+    /**
+     * Set the timer to fire on the next slot with a poll due. With nothing
+     * scheduled the timer is left alone for unschedule() to stop.
+     */
+    auto retime(uint32_t now) -> void {
+        auto next = std::numeric_limits<uint32_t>::max();
+        for (const auto& slot : slots) {
+            auto period = slot.period.load(std::memory_order_acquire);
+            if (period != 0) {
+                next = std::min(next, is_before(now, slot.next_due)
+                                          ? slot.next_due - now
+                                          : uint32_t{1});
+            }
+        }
+        if (next == std::numeric_limits<uint32_t>::max()) {
+            return;
+        }
+        deadline.store(now + next, std::memory_order_relaxed);
+        timer.update_period(next * SLOT_MS);
+    }
+
+    /**
+     * Make sure the timer fires by the slot a new poll is due in. This only
+     * ever shortens the wait, and a stopped timer is started with the one
+     * slot period it was left at, so the first tick comes straight away
+     * and sets the wait from there.
+     */
+    auto wake_by(uint32_t due, uint32_t from) -> void {
+        if (!timer.is_running()) {
+            deadline.store(from + 1, std::memory_order_relaxed);
+            timer.start();
+            return;
+        }
+        if (is_before(due, deadline.load(std::memory_order_relaxed))) {
+            deadline.store(due, std::memory_order_relaxed);
+            timer.update_period((due - from) * SLOT_MS);
+        }
+    }
+
+    /*
+     * Two polls with periods p and q share a slot now and then exactly when
+     * their phases agree modulo gcd(p, q), so the bus time a phase would
+     * share is the sum over the polls it agrees with. Candidates are tried
+     * starting a period from now and the first with the least load wins.
+     */
+    [[nodiscard]] auto place(uint32_t period, uint32_t from) const
+        -> uint32_t {
+        std::array<uint32_t, MaxPolls> strides{};
+        for (std::size_t i = 0; i < MaxPolls; ++i) {
+            auto other = slots[i].period.load(std::memory_order_acquire);
+            if (other != 0) {
+                strides[i] = std::gcd(period, other);
+            }
+        }
+        uint32_t best_phase = from % period;
+        uint32_t best_load = std::numeric_limits<uint32_t>::max();
+        for (uint32_t offset = 0; offset < period; ++offset) {
+            uint32_t phase = (from + offset) % period;
+            uint32_t load = 0;
+            for (std::size_t i = 0; i < MaxPolls; ++i) {
+                if (strides[i] != 0 &&
+                    phase % strides[i] == slots[i].phase % strides[i]) {
+                    load += slots[i].busy_us;
+                }
+            }
+            if (load < best_load) {
+                best_phase = phase;
+                best_load = load;
+                if (load == 0) {
+                    break;
+                }
+            }
+        }
+        return best_phase;
+    }
+
+    auto free_slot() -> Slot* {
+        for (auto& slot : slots) {
+            if (slot.period.load(std::memory_order_acquire) == 0) {
+                return &slot;
+            }
+        }
+        return nullptr;
+    }
+
+    auto find(const void* context) -> Slot* {
+        for (auto& slot : slots) {
+            if (slot.period.load(std::memory_order_acquire) != 0 &&
+                slot.context == context) {
+                return &slot;
+            }
+        }
+        return nullptr;
+    }
+
+    [[nodiscard]] auto find(const void* context) const -> const Slot* {
+        for (const auto& slot : slots) {
+            if (slot.period.load(std::memory_order_acquire) != 0 &&
+                slot.context == context) {
+                return &slot;
+            }
+        }
+        return nullptr;
+    }
+
+    std::array<Slot, MaxPolls> slots{};
+    // the slot the timer is next set to fire in
+    std::atomic<uint32_t> deadline = 0;
+};
+
+};  // namespace poll_scheduler
+};  // namespace i2c
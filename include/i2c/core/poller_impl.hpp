@@ -1,18 +1,40 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
 #include <cstdint>
 #include <type_traits>
+#include <utility>
 #include <variant>
 
 #include "common/core/logging.h"
 #include "common/core/timer.hpp"
 #include "i2c/core/messages.hpp"
+#include "i2c/core/poll_scheduler.hpp"
 #include "i2c/core/writer.hpp"
 
+// Polls of each kind that can run at once on a bus. Boards with more
+// sensors to poll define this in their build.
+#ifndef I2C_MAX_POLLS
+constexpr std::size_t I2C_MAX_POLLS = 5;
+#endif
+
 namespace i2c {
 namespace poller_impl {
 
+static constexpr std::size_t MAX_POLLS = I2C_MAX_POLLS;
+
+// Both poll managers on a bus share one scheduler
+template <timer::Timer TimerImpl>
+using Scheduler = poll_scheduler::PollScheduler<TimerImpl, 2 * MAX_POLLS>;
+
+// The bus time a poll takes each period
+inline auto busy_us(const std::array<messages::Transaction, 2>& transactions)
+    -> uint32_t {
+    return poll_scheduler::transaction_us(transactions[0]) +
+           poll_scheduler::transaction_us(transactions[1]);
+}
+
 template <typename Message>
 concept ContinuousMessage =
     std::is_same_v<Message,
@@ -29,14 +51,13 @@ template <template <class> class QueueImpl, timer::Timer TimerImpl,
 requires MessageQueue<QueueImpl<writer::TaskMessage>, writer::TaskMessage>
 struct ContinuousPoll {
     using I2CWriterType = writer::Writer<QueueImpl>;
+    using SchedulerType = Scheduler<TimerImpl>;
+    static constexpr uint16_t HANDLE_KIND = 0x00;
 
     ContinuousPoll() = delete;
-    ContinuousPoll(I2CWriterType& writer, OwnQueueType& own_queue)
-        : timer(
-              "i2c cts poller", [this]() -> void { do_next_transaction(); },
-              100),
-          own_queue(own_queue),
-          writer(writer) {}
+    ContinuousPoll(I2CWriterType& writer, OwnQueueType& own_queue,
+                   SchedulerType& scheduler)
+        : scheduler(scheduler), own_queue(own_queue), writer(writer) {}
     ContinuousPoll(const ContinuousPoll&) = delete;
     auto operator=(const ContinuousPoll&) -> ContinuousPoll& = delete;
     ContinuousPoll(ContinuousPoll&&) = delete;
@@ -46,7 +67,7 @@ struct ContinuousPoll {
     decltype(transactions.cbegin()) current_transaction{transactions.cbegin()};
     messages::TransactionIdentifier id{};
     messages::ResponseWriter responder{};
-    TimerImpl timer;
+    SchedulerType& scheduler;
     OwnQueueType& own_queue;
     I2CWriterType& writer;
 
@@ -56,12 +77,15 @@ struct ContinuousPoll {
         current_transaction = transactions.cbegin();
         id = message.id;
         responder = message.response_writer;
-        timer.stop();
+        scheduler.unschedule(this);
         if (message.delay_ms != 0) {
             LOG("Beginning or altering continuous poll of %#04x id %d @ %d ms",
                 transactions[0].address, id.token, message.delay_ms);
-            timer.update_period(message.delay_ms);
-            timer.start();
+            if (!scheduler.schedule(this, on_slot, message.delay_ms,
+                                    busy_us(transactions))) {
+                LOG("Could not schedule continuous poll of %#04x",
+                    transactions[0].address);
+            }
         } else {
             transactions[0] = {};
             transactions[1] = {};
@@ -88,6 +112,9 @@ struct ContinuousPoll {
         transactions[0] = msg.first;
         transactions[1] = msg.second;
     }
+    static auto on_slot(void* context) -> void {
+        static_cast<ContinuousPoll*>(context)->do_next_transaction();
+    }
     auto do_next_transaction() -> void {
         id.transaction_index =
             ((current_transaction == transactions.cbegin()) ? 0 : 1);
@@ -105,13 +132,13 @@ template <template <class> class QueueImpl, timer::Timer TimerImpl,
 requires MessageQueue<QueueImpl<writer::TaskMessage>, writer::TaskMessage>
 struct LimitedPoll {
     using I2CWriterType = writer::Writer<QueueImpl>;
+    using SchedulerType = Scheduler<TimerImpl>;
+    static constexpr uint16_t HANDLE_KIND = 0x80;
+
     LimitedPoll() = delete;
-    LimitedPoll(I2CWriterType& writer, OwnQueueType& own_queue)
-        : timer(
-              "i2c limited poller", [this]() -> void { do_next_transaction(); },
-              1),
-          own_queue(own_queue),
-          writer(writer) {}
+    LimitedPoll(I2CWriterType& writer, OwnQueueType& own_queue,
+                SchedulerType& scheduler)
+        : scheduler(scheduler), own_queue(own_queue), writer(writer) {}
     LimitedPoll(const LimitedPoll&) = delete;
     auto operator=(const LimitedPoll&) -> LimitedPoll& = delete;
     LimitedPoll(LimitedPoll&&) = delete;
@@ -122,13 +149,13 @@ struct LimitedPoll {
     int remaining_polls = 0;
     messages::TransactionIdentifier id{};
     messages::ResponseWriter responder{};
-    TimerImpl timer;
+    SchedulerType& scheduler;
     OwnQueueType& own_queue;
     I2CWriterType& writer;
 
     template <LimitedMessage Message>
     auto handle_message(Message& message) -> void {
-        timer.stop();
+        scheduler.unschedule(this);
         update_transactions(message);
         responder = message.response_writer;
         id = message.id;
@@ -144,8 +171,11 @@ struct LimitedPoll {
                 transactions[0].address, message.delay_ms, remaining_polls);
             remaining_polls = message.polling;
             id.is_completed_poll = false;
-            timer.update_period(message.delay_ms);
-            timer.start();
+            if (!scheduler.schedule(this, on_slot, message.delay_ms,
+                                    busy_us(transactions))) {
+                LOG("Could not schedule limited poll of %#04x",
+                    transactions[0].address);
+            }
         }
     }
 
@@ -174,6 +204,10 @@ struct LimitedPoll {
         transactions[1] = msg.second;
     }
 
+    static auto on_slot(void* context) -> void {
+        static_cast<LimitedPoll*>(context)->do_next_transaction();
+    }
+
     auto do_next_transaction() -> void {
         const auto* first = transactions.cbegin();
         const auto* then_current = current_transaction;
@@ -190,7 +224,7 @@ struct LimitedPoll {
             id.transaction_index = 0;
         }
         if (remaining_polls == 0) {
-            timer.stop();
+            scheduler.unschedule(this);
             id.is_completed_poll = true;
         }
         writer.transact(*then_current, id, own_queue);
@@ -213,52 +247,117 @@ requires MessageQueue<QueueImpl<writer::TaskMessage>, writer::TaskMessage> &&
     PollType<PollT, QueueImpl, TimerImpl, OwnQueueType>
 
 struct PollManager {
-    static constexpr uint32_t MAX_CONTINUOUS_POLLS = 5;
+    static constexpr uint32_t MAX_CONTINUOUS_POLLS = MAX_POLLS;
     using PollType = PollT<QueueImpl, TimerImpl, OwnQueueType>;
     using Polls = std::array<PollType, MAX_CONTINUOUS_POLLS>;
     Polls polls;
-    explicit PollManager(typename PollType::I2CWriterType& writer,
-                         OwnQueueType& own_queue)
-        : polls{PollType(writer, own_queue), PollType(writer, own_queue),
-                PollType(writer, own_queue), PollType(writer, own_queue),
-                PollType(writer, own_queue)} {}
-
-    auto get_poller(messages::TransactionIdentifier id, bool& matched)
-        -> PollType* {
+    PollManager(typename PollType::I2CWriterType& writer,
+                OwnQueueType& own_queue,
+                typename PollType::SchedulerType& scheduler)
+        : PollManager(writer, own_queue, scheduler,
+                      std::make_index_sequence<MAX_CONTINUOUS_POLLS>{}) {}
+
+    /*
+    ** Polls are found from a response by the handle their transactions
+    ** carry: the slot index plus one in the low seven bits, which kind of
+    ** poll in bit 7, and the slot's generation in the high byte. A slot's
+    ** generation moves on each time it is given to a new token, so late
+    ** responses to a poll that has been replaced are dropped.
+    */
+    static_assert(MAX_CONTINUOUS_POLLS < 0x80,
+                  "poll handles have seven bits for the slot");
+
+    auto handle_of(const PollType& poll) const -> uint16_t {
+        auto index = static_cast<std::size_t>(&poll - polls.data());
+        return static_cast<uint16_t>((generations[index] << 8) |
+                                     PollType::HANDLE_KIND | (index + 1));
+    }
+
+    auto find_poller(uint16_t handle) -> PollType* {
+        std::size_t index = (handle & 0x7f);
+        if ((handle & 0x80) != PollType::HANDLE_KIND || index == 0 ||
+            index > MAX_CONTINUOUS_POLLS) {
+            return nullptr;
+        }
+        index--;
+        if (generations[index] != (handle >> 8) || polls[index].id.token == 0) {
+            return nullptr;
+        }
+        return &polls[index];
+    }
+
+    template <typename Message>
+    auto add_or_update(Message& message) -> void {
+        PollType* maybe_poller = nullptr;
         PollType* first_empty = nullptr;
         for (auto& poll : polls) {
-            if (poll.id.token == id.token) {
-                matched = true;
-                return &poll;
+            if (poll.id.token == message.id.token) {
+                maybe_poller = &poll;
+                break;
             }
             if (!first_empty && poll.id.token == 0) {
                 first_empty = &poll;
             }
         }
-        matched = false;
-        return first_empty;
-    }
-
-    template <typename Message>
-    auto add_or_update(Message& message) -> void {
-        bool matched = false;
-        auto maybe_poller = get_poller(message.id, matched);
         if (!maybe_poller) {
-            LOG("Could not add continuous poller for id %d",
-                message.first.address, message.id.token);
-            return;
+            if (!first_empty) {
+                reject(message);
+                return;
+            }
+            maybe_poller = first_empty;
+            generations[static_cast<std::size_t>(first_empty - polls.data())]++;
         }
         maybe_poller->handle_message(message);
+        maybe_poller->id.poll_handle = handle_of(*maybe_poller);
     }
 
     auto handle_response(messages::TransactionResponse& response) -> void {
-        bool matched = false;
-        auto maybe_poller = get_poller(response.id, matched);
-        if (!matched) {
+        auto maybe_poller = find_poller(response.id.poll_handle);
+        if (!maybe_poller) {
             return;
         }
         maybe_poller->handle_response(response);
     }
+
+  private:
+    template <std::size_t... Indices>
+    PollManager(typename PollType::I2CWriterType& writer,
+                OwnQueueType& own_queue,
+                typename PollType::SchedulerType& scheduler,
+                std::index_sequence<Indices...>)
+        : polls{make_poll<Indices>(writer, own_queue, scheduler)...} {}
+
+    template <std::size_t>
+    static auto make_poll(typename PollType::I2CWriterType& writer,
+                          OwnQueueType& own_queue,
+                          typename PollType::SchedulerType& scheduler)
+        -> PollType {
+        return PollType(writer, own_queue, scheduler);
+    }
+
+    template <typename Message>
+    static auto reject(Message& message) -> void {
+        if (message.delay_ms == 0) {
+            // nothing was running under this token, so there is nothing to
+            // stop
+            return;
+        }
+        LOG("Could not add poller for %#04x id %d, all %d are in use",
+            message.first.address, message.id.token,
+            static_cast<int>(MAX_CONTINUOUS_POLLS));
+        static_cast<void>(message.response_writer.write(
+            messages::TransactionResponse{
+                .message_index = message.first.message_index,
+                .id = {.token = message.id.token,
+                       .is_completed_poll = true,
+                       .transaction_index = 0,
+                       .poll_handle = 0},
+                .bytes_read = 0,
+                .read_buffer = {},
+                .poll_rejected = true}));
+    }
+
+    std::array<uint8_t, MAX_CONTINUOUS_POLLS> generations{};
 };
 
 template <template <class> class QueueImpl, timer::Timer TimerImpl,
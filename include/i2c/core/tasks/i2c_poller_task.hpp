@@ -20,8 +20,8 @@ class I2CPollerMessageHandler {
     I2CPollerMessageHandler(I2CWriterType &i2c_writer, OwnQueueType &own_queue)
         : i2c_writer{i2c_writer},
           own_queue(own_queue),
-          continuous_polls(i2c_writer, own_queue),
-          limited_polls(i2c_writer, own_queue) {}
+          continuous_polls(i2c_writer, own_queue, scheduler),
+          limited_polls(i2c_writer, own_queue, scheduler) {}
     I2CPollerMessageHandler(const I2CPollerMessageHandler &) = delete;
     I2CPollerMessageHandler(const I2CPollerMessageHandler &&) = delete;
     auto operator=(const I2CPollerMessageHandler &)
@@ -68,6 +68,7 @@ class I2CPollerMessageHandler {
   public:
     // these are public to make testing easier
 
+    poller_impl::Scheduler<TimerImpl> scheduler{};
     poller_impl::ContinuousPollManager<QueueImpl, TimerImpl, OwnQueueType>
         continuous_polls;
     poller_impl::LimitedPollManager<QueueImpl, TimerImpl, OwnQueueType>
@@ -29,31 +29,47 @@ class I2CMessageHandler {
 
     void visit(Transact &m) {
         messages::MaxMessageBuffer read_buf{};
-        if (m.transaction.bytes_to_write != 0) {
-            i2c_interface.central_transmit(
-                m.transaction.write_buffer.data(),
+        // a write and a read go out as one transfer with a repeated start
+        // rather than two with a stop and the task waking up in between
+        auto transfer = hardware::Transfer{
+            .dev_address = m.transaction.address,
+            .write_data = m.transaction.write_buffer.data(),
+            .write_size = static_cast<uint16_t>(
                 std::min(m.transaction.bytes_to_write,
-                         m.transaction.write_buffer.size()),
-                m.transaction.address, TIMEOUT);
-        }
-        if (m.transaction.bytes_to_read != 0) {
-            i2c_interface.central_receive(
-                read_buf.data(),
-                std::min(m.transaction.bytes_to_read, read_buf.size()),
-                m.transaction.address, TIMEOUT);
+                         m.transaction.write_buffer.size())),
+            .read_data = read_buf.data(),
+            .read_size = static_cast<uint16_t>(
+                std::min(m.transaction.bytes_to_read, read_buf.size()))};
+        bool succeeded = true;
+        if (transfer.write_size != 0 || transfer.read_size != 0) {
+            succeeded = i2c_interface.transfer(
+                transfer, m.transaction.single_attempt ? 0 : TIMEOUT);
         }
         static_cast<void>(m.response_writer.write(
             TransactionResponse{.message_index = m.transaction.message_index,
                                 .id = m.id,
                                 .bytes_read = m.transaction.bytes_to_read,
-                                .read_buffer = read_buf}));
+                                .read_buffer = read_buf,
+                                .failed = !succeeded}));
+    }
+
+    void visit(BufferWrite &m) {
+        auto transfer = hardware::Transfer{.dev_address = m.address,
+                                           .write_data = m.data,
+                                           .write_size = m.size};
+        auto succeeded = i2c_interface.transfer(transfer, TIMEOUT);
+        static_cast<void>(m.response_writer.write(
+            TransactionResponse{.message_index = m.message_index,
+                                .id = m.id,
+                                .failed = !succeeded}));
     }
 
     i2c::hardware::I2CBase &i2c_interface;
 
-    // Default timeout should be 1 second
-    // freertos expects this time to be in milliseconds
-    static constexpr auto TIMEOUT = 1000;
+    // How long to keep retrying a transfer the device doesn't acknowledge,
+    // in milliseconds. This covers an eeprom's write cycle without letting
+    // one device hold up everything else on the bus for long.
+    static constexpr auto TIMEOUT = 10;
 };
 
 /**
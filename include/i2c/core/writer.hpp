@@ -13,7 +13,8 @@
 
 namespace i2c {
 namespace writer {
-using TaskMessage = std::variant<std::monostate, messages::Transact>;
+using TaskMessage =
+    std::variant<std::monostate, messages::Transact, messages::BufferWrite>;
 template <template <class> class QueueImpl>
 requires MessageQueue<QueueImpl<TaskMessage>, TaskMessage>
 class Writer {
@@ -290,6 +291,29 @@ class Writer {
             .response_writer = messages::ResponseWriter(response_queue)});
     }
 
+    /**
+     * A write of data that stays in the caller's buffer, for writes larger
+     * than a transaction's buffer. The buffer must not change until the
+     * response arrives.
+     *
+     * @param device_address the i2c device address
+     * @param data the bytes to write
+     * @param size how many of them
+     * @param id returned in the response
+     * @param response_queue queue to respond to
+     */
+    template <messages::I2CResponseQueue ResponseQueue>
+    auto write_buffer(uint16_t device_address, uint8_t* data, uint16_t size,
+                      const messages::TransactionIdentifier& id,
+                      ResponseQueue& response_queue) -> bool {
+        return queue->try_write(messages::BufferWrite{
+            .address = device_address,
+            .data = data,
+            .size = size,
+            .id = id,
+            .response_writer = messages::ResponseWriter(response_queue)});
+    }
+
     void set_queue(QueueType* q) { queue = q; }
 
   private:
@@ -25,6 +25,33 @@ bool hal_i2c_master_transmit(HAL_I2C_HANDLE handle, uint16_t dev_address, uint8_
  */
 bool hal_i2c_master_receive(HAL_I2C_HANDLE handle, uint16_t dev_address, uint8_t *data, uint16_t size, uint32_t timeout);
 
+/**
+ * Called once when a transfer started with hal_i2c_start_transfer finishes,
+ * from the i2c interrupt.
+ */
+typedef void (*i2c_transfer_callback)(void *context, bool succeeded);
+
+/**
+ * Start a write, a read, or a write then a read after a repeated start, and
+ * return without waiting for it.
+ *
+ * @return True if the transfer started, in which case callback will be
+ * called when it finishes
+ */
+bool hal_i2c_start_transfer(HAL_I2C_HANDLE handle, uint16_t dev_address,
+                            uint8_t *write_data, uint16_t write_size,
+                            uint8_t *read_data, uint16_t read_size,
+                            i2c_transfer_callback callback, void *context);
+
+/**
+ * Run a transfer as hal_i2c_start_transfer does, sleeping the calling task
+ * until it finishes and retrying it until timeout if it fails.
+ */
+bool hal_i2c_transfer(HAL_I2C_HANDLE handle, uint16_t dev_address,
+                      uint8_t *write_data, uint16_t write_size,
+                      uint8_t *read_data, uint16_t read_size,
+                      uint32_t timeout);
+
 /**
  * enable writing to the eeprom.
  */
@@ -30,6 +30,19 @@ class I2C : public I2CBase {
     auto central_receive(uint8_t *data, uint16_t size, uint16_t dev_address,
                          uint32_t timeout) -> bool final;
 
+    /**
+     * Start a transfer, finished from the i2c interrupt.
+     * @return True if started
+     */
+    auto start_transfer(const Transfer &transfer, TransferCallback callback,
+                        void *context) -> bool final;
+
+    /**
+     * Run a transfer, sleeping until the i2c interrupt says it is done.
+     * @return True if succeeded
+     */
+    auto transfer(const Transfer &transfer, uint32_t timeout) -> bool final;
+
     auto set_handle(HAL_I2C_HANDLE i2c_handle) -> void;
 
   private:
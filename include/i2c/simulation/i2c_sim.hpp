@@ -21,6 +21,9 @@ class SimI2C : public I2CBase {
                           uint32_t timeout) -> bool final;
     auto central_receive(uint8_t *data, uint16_t size, uint16_t dev_address,
                          uint32_t timeout) -> bool final;
+    auto start_transfer(const Transfer &transfer, TransferCallback callback,
+                        void *context) -> bool final;
+    auto transfer(const Transfer &transfer, uint32_t timeout) -> bool final;
     auto get_transmit_count() const -> std::size_t;
     auto get_receive_count() const -> std::size_t;
     auto get_last_receive_length() const -> std::size_t;
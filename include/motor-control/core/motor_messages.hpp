@@ -10,6 +10,7 @@ namespace motor_messages {
 
 using mm_per_tick = can::messages::mm_per_tick;
 using um_per_tick_sq = can::messages::um_per_tick_sq;
+using um_per_tick_cu = can::messages::um_per_tick_cu;
 
 struct MotionConstraints {
     mm_per_tick min_velocity;
@@ -51,6 +52,7 @@ struct Move {  // NOLINT(cppcoreguidelines-pro-type-member-init)
     stepper_timer_ticks duration;  // in stepper timer ticks
     steps_per_tick velocity;
     steps_per_tick_sq acceleration;
+    steps_per_tick_cu jerk = 0;
     uint8_t group_id;
     uint8_t seq_id;
     uint8_t stop_condition = static_cast<uint8_t>(MoveStopCondition::none);
@@ -84,6 +86,7 @@ struct SensorSyncMove {  // NOLINT(cppcoreguidelines-pro-type-member-init)
     stepper_timer_ticks duration;  // in stepper timer ticks
     steps_per_tick velocity;
     steps_per_tick_sq acceleration;
+    steps_per_tick_cu jerk = 0;
     uint8_t group_id;
     uint8_t seq_id;
     uint8_t stop_condition = static_cast<uint8_t>(MoveStopCondition::none);
@@ -179,6 +182,21 @@ struct GripperJawStateResponse {
 
 const uint8_t NO_GROUP = 0xff;
 
+// Moves run from an open move stream carry this group id
+const uint8_t STREAM_GROUP = can::messages::MOVE_STREAM_GROUP_ID;
+// The sequence id of the marker that ends a move stream; stream segments
+// may not use it
+constexpr const uint8_t STREAM_END_SEQ = 0xff;
+// The number of stream segments the host may have in flight. This must fit
+// in the motion controller task queue as well as the step interrupt's move
+// queue.
+constexpr const uint8_t STREAM_WINDOW = 6;
+// Completed stream segments are returned to the host as credits in batches
+// of this size
+constexpr const uint8_t STREAM_CREDIT_BATCH = 2;
+static_assert(STREAM_CREDIT_BATCH <= STREAM_WINDOW);
+
 constexpr const int RADIX = 31;
+constexpr const int JERK_RADIX = can::messages::JERK_RADIX;
 
 }  // namespace motor_messages
@@ -5,6 +5,7 @@
 
 #include "can/core/messages.hpp"
 #include "common/core/freertos_message_queue.hpp"
+#include "common/core/spsc_message_queue.hpp"
 #include "motor-control/core/linear_motion_system.hpp"
 #include "motor-control/core/motor_hardware_interface.hpp"
 #include "motor-control/core/motor_messages.hpp"
@@ -24,13 +25,15 @@ using namespace motor_hardware;
 template <lms::MotorMechanicalConfig MEConfig>
 class MotionController {
   public:
+    // Moves are handed to the step timer interrupt over a lock-free ring so
+    // the interrupt never has to enter the kernel to look for the next move.
     using GenericQueue =
 #ifdef USE_SENSOR_MOVE
-        freertos_message_queue::FreeRTOSMessageQueue<SensorSyncMove>;
+        spsc_message_queue::SPSCMessageQueue<SensorSyncMove>;
 #else
-        freertos_message_queue::FreeRTOSMessageQueue<Move>;
+        spsc_message_queue::SPSCMessageQueue<Move>;
 #endif
-    using UpdatePositionQueue = freertos_message_queue::FreeRTOSMessageQueue<
+    using UpdatePositionQueue = spsc_message_queue::SPSCMessageQueue<
         can::messages::UpdateMotorPositionEstimationRequest>;
     MotionController(lms::LinearMotionSystemConfig<MEConfig> lms_config,
                      StepperMotorHardwareIface& hardware_iface,
@@ -74,6 +77,7 @@ class MotionController {
             can_msg.duration,
             velocity_steps,
             acceleration_steps,
+            0,
             can_msg.group_id,
             can_msg.seq_id,
             can_msg.request_stop_condition,
@@ -111,6 +115,49 @@ class MotionController {
         queue.try_write(msg);
     }
 
+    void move(const can::messages::AddJerkMoveRequest& can_msg) {
+        steps_per_tick velocity_steps =
+            fixed_point_multiply(steps_per_mm, can_msg.velocity);
+        steps_per_tick_sq acceleration_steps =
+            fixed_point_multiply(steps_per_um, can_msg.acceleration);
+        steps_per_tick_cu jerk_steps =
+            fixed_point_multiply(steps_per_um, can_msg.jerk);
+        SensorSyncMove msg{
+            .message_index = can_msg.message_index,
+            .duration = can_msg.duration,
+            .velocity = velocity_steps,
+            .acceleration = acceleration_steps,
+            .jerk = jerk_steps,
+            .group_id = can_msg.group_id,
+            .seq_id = can_msg.seq_id,
+            .stop_condition = can_msg.request_stop_condition,
+            .usage_key = hardware.get_usage_eeprom_config().get_distance_key(),
+            .sensor_id = can::ids::SensorId::UNUSED,
+            .sensor_type = can::ids::SensorType::UNUSED,
+            .binding_flags = 0};
+        if (!enabled) {
+            enable_motor();
+        }
+        queue.try_write(msg);
+    }
+
+    void end_stream(const can::messages::EndMoveStreamRequest& can_msg) {
+        SensorSyncMove msg{
+            .message_index = can_msg.message_index,
+            .duration = 0,
+            .velocity = 0,
+            .acceleration = 0,
+            .jerk = 0,
+            .group_id = motor_messages::STREAM_GROUP,
+            .seq_id = motor_messages::STREAM_END_SEQ,
+            .stop_condition = 0,
+            .usage_key = hardware.get_usage_eeprom_config().get_distance_key(),
+            .sensor_id = can::ids::SensorId::UNUSED,
+            .sensor_type = can::ids::SensorType::UNUSED,
+            .binding_flags = 0};
+        queue.try_write(msg);
+    }
+
     void move(const can::messages::HomeRequest& can_msg) {
         steps_per_tick velocity_steps =
             fixed_point_multiply(steps_per_mm, can_msg.velocity);
@@ -154,6 +201,43 @@ class MotionController {
         queue.try_write(msg);
     }
 
+    void move(const can::messages::AddJerkMoveRequest& can_msg) {
+        steps_per_tick velocity_steps =
+            fixed_point_multiply(steps_per_mm, can_msg.velocity);
+        steps_per_tick_sq acceleration_steps =
+            fixed_point_multiply(steps_per_um, can_msg.acceleration);
+        steps_per_tick_cu jerk_steps =
+            fixed_point_multiply(steps_per_um, can_msg.jerk);
+        Move msg{
+            .message_index = can_msg.message_index,
+            .duration = can_msg.duration,
+            .velocity = velocity_steps,
+            .acceleration = acceleration_steps,
+            .jerk = jerk_steps,
+            .group_id = can_msg.group_id,
+            .seq_id = can_msg.seq_id,
+            .stop_condition = can_msg.request_stop_condition,
+            .usage_key = hardware.get_usage_eeprom_config().get_distance_key()};
+        if (!enabled) {
+            enable_motor();
+        }
+        queue.try_write(msg);
+    }
+
+    void end_stream(const can::messages::EndMoveStreamRequest& can_msg) {
+        Move msg{
+            .message_index = can_msg.message_index,
+            .duration = 0,
+            .velocity = 0,
+            .acceleration = 0,
+            .jerk = 0,
+            .group_id = motor_messages::STREAM_GROUP,
+            .seq_id = motor_messages::STREAM_END_SEQ,
+            .stop_condition = 0,
+            .usage_key = hardware.get_usage_eeprom_config().get_distance_key()};
+        queue.try_write(msg);
+    }
+
     void move(const can::messages::HomeRequest& can_msg) {
         steps_per_tick velocity_steps =
             fixed_point_multiply(steps_per_mm, can_msg.velocity);
@@ -278,8 +362,7 @@ using namespace motor_hardware;
 template <lms::MotorMechanicalConfig MEConfig>
 class PipetteMotionController {
   public:
-    using GenericQueue =
-        freertos_message_queue::FreeRTOSMessageQueue<GearMotorMove>;
+    using GenericQueue = spsc_message_queue::SPSCMessageQueue<GearMotorMove>;
     PipetteMotionController(lms::LinearMotionSystemConfig<MEConfig> lms_config,
                             StepperMotorHardwareIface& hardware_iface,
                             MotionConstraints constraints, GenericQueue& queue,
@@ -320,6 +403,7 @@ class PipetteMotionController {
             can_msg.duration,
             velocity_steps,
             acceleration_steps,
+            0,
             can_msg.group_id,
             can_msg.seq_id,
             can_msg.request_stop_condition,
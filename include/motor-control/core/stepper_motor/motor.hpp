@@ -2,7 +2,7 @@
 
 #include <variant>
 
-#include "common/core/freertos_message_queue.hpp"
+#include "common/core/spsc_message_queue.hpp"
 #include "motion_controller.hpp"
 #include "motor-control/core/linear_motion_system.hpp"
 #include "motor-control/core/motor_messages.hpp"
@@ -14,17 +14,17 @@ class MotorHardwareIface;
 namespace motor_class {
 
 using namespace motor_messages;
-using namespace freertos_message_queue;
+using namespace spsc_message_queue;
 
 template <lms::MotorMechanicalConfig MEConfig>
 struct Motor {
 #ifdef USE_SENSOR_MOVE
-    using GenericQueue = FreeRTOSMessageQueue<SensorSyncMove>;
+    using GenericQueue = SPSCMessageQueue<SensorSyncMove>;
 #else
-    using GenericQueue = FreeRTOSMessageQueue<Move>;
+    using GenericQueue = SPSCMessageQueue<Move>;
 #endif
-    using UpdatePositionQueue = FreeRTOSMessageQueue<
-        can::messages::UpdateMotorPositionEstimationRequest>;
+    using UpdatePositionQueue =
+        SPSCMessageQueue<can::messages::UpdateMotorPositionEstimationRequest>;
 
     /**
      * Construct a motor
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <array>
 #include <atomic>
+#include <limits>
+#include <utility>
 
 #include "can/core/ids.hpp"
 #include "common/core/logging.h"
@@ -39,6 +42,9 @@ using namespace motor_messages;
  * Private:
  * get_move -> read from the queue to get the next available move message.
  * buffered_move -> The move message with all relevant info to complete a move.
+ * staged_move -> The next move, read out of the queue while buffered_move is
+ * still running so that starting it at the segment boundary is a swap of the
+ * two slots instead of a queue read.
  *
  * Attributes:
  * _has_active_move -> True if there is an active move to check whether
@@ -57,6 +63,8 @@ class MotorInterruptHandler {
     using MoveQueue = QueueImpl<MotorMoveMessage>;
     using UpdatePositionQueue =
         QueueImpl<can::messages::UpdateMotorPositionEstimationRequest>;
+    using MoveAck = decltype(std::declval<MotorMoveMessage&>().build_ack(
+        0, 0, 0, AckMessageId::complete_without_condition));
     MotorInterruptHandler() = delete;
     MotorInterruptHandler(MoveQueue& incoming_move_queue,
                           StatusClient& outgoing_queue,
@@ -105,30 +113,30 @@ class MotorInterruptHandler {
         if (!_has_active_move or
             hardware.position_flags.check_flag(
                 MotorPositionStatus::Flags::stepper_position_ok) or
-            buffered_move.check_stop_condition(
+            buffered_move->check_stop_condition(
                 MoveStopCondition::limit_switch_backoff)) {
             return;
         }
-        if (buffered_move.check_stop_condition(
+        if (buffered_move->check_stop_condition(
                 MoveStopCondition::limit_switch)) {
             // Since the encoders are always setup that negative is towards the
             // limit switch if the encoder has increased past the start position
             // we know that we've stalled which means on the z axis that
             // something is falling so we want to trigger a collision so we can
             // catch it before it hits something
-            if ((buffered_move.start_encoder_position -
+            if ((buffered_move->start_encoder_position -
                  hardware.get_encoder_pulses()) > 10) {
                 return;
             }
             cancel_and_clear_moves(can::ids::ErrorCode::collision_detected);
         }
 
-        if (buffered_move.check_stop_condition(MoveStopCondition::stall)) {
+        if (buffered_move->check_stop_condition(MoveStopCondition::stall)) {
             // if expected, finish move and clear queue to prepare for position
             // update
             finish_current_move(AckMessageId::stopped_by_condition);
             clear_queue_until_empty = true;
-        } else if (buffered_move.check_stop_condition(
+        } else if (buffered_move->check_stop_condition(
                        MoveStopCondition::ignore_stalls)) {
             if (stall_handled) {
                 return;
@@ -136,7 +144,7 @@ class MotorInterruptHandler {
             // send a warning
             status_queue_client.send_move_status_reporter_queue(
                 can::messages::ErrorMessage{
-                    .message_index = buffered_move.message_index,
+                    .message_index = buffered_move->message_index,
                     .severity = can::ids::ErrorSeverity::warning,
                     .error_code = can::ids::ErrorCode::collision_detected});
             status_queue_client.send_move_status_reporter_queue(
@@ -201,6 +209,9 @@ class MotorInterruptHandler {
     }
 
     void run_interrupt() {
+        // An ack held back at the last segment boundary goes out first so
+        // that it is always ordered before anything this tick reports.
+        send_deferred_ack();
         // handle various error states
         std::ignore = hardware.get_encoder_pulses();
         if (clear_queue_until_empty) {
@@ -235,17 +246,17 @@ class MotorInterruptHandler {
     void stop() { hardware.stop_timer_interrupt(); }
 
     [[nodiscard]] auto stop_condition_met() {
-        if (buffered_move.check_stop_condition(
+        if (buffered_move->check_stop_condition(
                 MoveStopCondition::limit_switch) &&
             homing_stopped()) {
             return true;
         }
-        if (buffered_move.check_stop_condition(
+        if (buffered_move->check_stop_condition(
                 MoveStopCondition::limit_switch_backoff) &&
             backed_off()) {
             return true;
         }
-        if (buffered_move.check_stop_condition(MoveStopCondition::sync_line) &&
+        if (buffered_move->check_stop_condition(MoveStopCondition::sync_line) &&
             sync_triggered()) {
             return true;
         }
@@ -280,6 +291,7 @@ class MotorInterruptHandler {
         }
         if (_has_active_move) {
             handle_update_position_queue_error();
+            stage_next_move();
             if (stop_condition_met()) {
                 return false;
             }
@@ -287,6 +299,19 @@ class MotorInterruptHandler {
                 return true;
             }
             if (!can_step()) {
+                if (_has_staged_move) {
+                    // Segment boundary with the next move already staged:
+                    // swap it in and keep stepping on this tick, and hold
+                    // the ack for the finished move until the next one.
+                    defer_ack(AckMessageId::complete_without_condition);
+                    finish_current_move_without_ack();
+                    update_move();
+                    return can_step() && tick();
+                }
+                if (stream_underrun()) {
+                    handle_stream_underrun();
+                    return false;
+                }
                 finish_current_move();
                 if (has_move_messages()) {
                     update_move();
@@ -322,8 +347,8 @@ class MotorInterruptHandler {
             // start position to the difference between the encoder pulse count
             // at the beginning and end this way the usage tracker will know how
             // far the motor moved.
-            buffered_move.start_encoder_position =
-                buffered_move.start_encoder_position -
+            buffered_move->start_encoder_position =
+                buffered_move->start_encoder_position -
                 hardware.get_encoder_pulses();
             hardware.reset_step_tracker();
             hardware.reset_encoder_pulses();
@@ -365,9 +390,13 @@ class MotorInterruptHandler {
          * if necessary.
          */
         tick_count++;
-        buffered_move.velocity += buffered_move.acceleration;
+        if (buffered_move->jerk == 0) {
+            buffered_move->velocity += buffered_move->acceleration;
+        } else {
+            integrate_jerk();
+        }
         auto old_position = position_tracker;
-        position_tracker += buffered_move.velocity;
+        position_tracker += buffered_move->velocity;
         if (overflow(old_position, position_tracker)) {
             position_tracker = old_position;
             // Don't need to sync the hardware step counter
@@ -377,22 +406,50 @@ class MotorInterruptHandler {
         return bool((old_position ^ position_tracker) & tick_flag);
     }
 
+    void integrate_jerk() {
+        /*
+         * Step the acceleration by the jerk and then the velocity by the
+         * acceleration. Acceleration is integrated with JERK_RADIX fractional
+         * bits; the bits below its own resolution are carried between ticks
+         * in jerk_remainder.
+         *
+         * As with the position in tick(), an update that would overflow is
+         * dropped and the previous value is kept.
+         */
+        auto acceleration =
+            (static_cast<int64_t>(buffered_move->acceleration)
+             << jerk_extra_bits) +
+            jerk_remainder + buffered_move->jerk;
+        auto next_acceleration = acceleration >> jerk_extra_bits;
+        if (!overflow(next_acceleration)) {
+            buffered_move->acceleration =
+                static_cast<steps_per_tick_sq>(next_acceleration);
+            jerk_remainder = acceleration & jerk_remainder_mask;
+        }
+        auto next_velocity = static_cast<int64_t>(buffered_move->velocity) +
+                             buffered_move->acceleration;
+        if (!overflow(next_velocity)) {
+            buffered_move->velocity =
+                static_cast<steps_per_tick>(next_velocity);
+        }
+    }
+
     [[nodiscard]] auto has_move_messages() const -> bool {
-        return move_queue.has_message_isr();
+        return _has_staged_move || move_queue.has_message_isr();
     }
     [[nodiscard]] auto can_step() const -> bool {
         /*
          * A motor should only try to take a step when the current position
          * does not equal the target position.
          */
-        return tick_count < buffered_move.duration;
+        return tick_count < buffered_move->duration;
     }
 #ifdef USE_SENSOR_MOVE
     auto send_bind_message(can::ids::SensorType sensor_type,
                            can::ids::SensorId sensor_id, uint8_t binding)
         -> void {
         auto msg = can::messages::BindSensorOutputRequest{
-            .message_index = buffered_move.message_index,
+            .message_index = buffered_move->message_index,
             .sensor = sensor_type,
             .sensor_id = sensor_id,
             .binding = binding};
@@ -411,25 +468,46 @@ class MotorInterruptHandler {
         }
     }
 #endif
+    /**
+     * @brief Read the next move out of the queue into the staged slot if it
+     * is empty, so the read happens on a tick in the middle of the current
+     * move rather than on the tick where the current move ends.
+     */
+    void stage_next_move() {
+        if (!_has_staged_move) {
+            _has_staged_move = move_queue.try_read_isr(staged_move);
+        }
+    }
+
     void update_move() {
-        _has_active_move = move_queue.try_read_isr(&buffered_move);
+        if (_has_staged_move) {
+            std::swap(buffered_move, staged_move);
+            _has_staged_move = false;
+            _has_active_move = true;
+        } else {
+            _has_active_move = move_queue.try_read_isr(buffered_move);
+        }
+        jerk_remainder = 0;
+        if (_has_active_move && discard_broken_stream_move()) {
+            return;
+        }
         if (_has_active_move) {
             hardware.enable_encoder();
-            buffered_move.start_encoder_position =
+            buffered_move->start_encoder_position =
                 hardware.get_encoder_pulses();
 #ifdef USE_SENSOR_MOVE
-            if (buffered_move.sensor_id != can::ids::SensorId::UNUSED) {
-                if (buffered_move.sensor_id == can::ids::SensorId::BOTH) {
-                    send_bind_message(buffered_move.sensor_type,
+            if (buffered_move->sensor_id != can::ids::SensorId::UNUSED) {
+                if (buffered_move->sensor_id == can::ids::SensorId::BOTH) {
+                    send_bind_message(buffered_move->sensor_type,
                                       can::ids::SensorId::S0,
-                                      buffered_move.binding_flags);
-                    send_bind_message(buffered_move.sensor_type,
+                                      buffered_move->binding_flags);
+                    send_bind_message(buffered_move->sensor_type,
                                       can::ids::SensorId::S1,
-                                      buffered_move.binding_flags);
+                                      buffered_move->binding_flags);
                 } else {
-                    send_bind_message(buffered_move.sensor_type,
-                                      buffered_move.sensor_id,
-                                      buffered_move.binding_flags);
+                    send_bind_message(buffered_move->sensor_type,
+                                      buffered_move->sensor_id,
+                                      buffered_move->binding_flags);
                 }
             }
 #endif
@@ -439,7 +517,7 @@ class MotorInterruptHandler {
         } else {
             hardware.negative_direction();
         }
-        if (_has_active_move && buffered_move.check_stop_condition(
+        if (_has_active_move && buffered_move->check_stop_condition(
                                     MoveStopCondition::limit_switch)) {
             position_tracker = 0x7FFFFFFFFFFFFFFF;
             update_hardware_step_tracker();
@@ -451,19 +529,70 @@ class MotorInterruptHandler {
     }
 
     /**
-     * @brief Pop the next message out of the motion queue and discard it.
+     * @brief Discard the staged move if there is one, otherwise pop the next
+     * message out of the motion queue and discard it.
      *
      * @return true if the queue still has another message, false if this
      * was the last message in the queue.
      */
     auto pop_and_discard_move() -> bool {
-        auto scratch = MotorMoveMessage{};
-        std::ignore = move_queue.try_read_isr(&scratch);
+        if (_has_staged_move) {
+            _has_staged_move = false;
+        } else {
+            auto scratch = MotorMoveMessage{};
+            std::ignore = move_queue.try_read_isr(&scratch);
+        }
         return has_move_messages();
     }
 
+    /**
+     * @brief A stream segment ended and the host has not sent the next one
+     * in time.
+     */
+    [[nodiscard]] auto stream_underrun() const -> bool {
+        return buffered_move->group_id == STREAM_GROUP &&
+               buffered_move->duration != 0 && !has_move_messages();
+    }
+
+    /**
+     * @brief Stop a stream that has run dry. The segment that just finished
+     * is acked as usual and followed by an underrun error; the stream
+     * segments that still arrive are discarded until the stream is ended.
+     */
+    void handle_stream_underrun() {
+        auto message_index = buffered_move->message_index;
+        finish_current_move();
+        status_queue_client.send_move_status_reporter_queue(
+            can::messages::ErrorMessage{
+                .message_index = message_index,
+                .severity = can::ids::ErrorSeverity::recoverable,
+                .error_code = can::ids::ErrorCode::move_stream_underrun});
+        stream_broken = true;
+    }
+
+    /**
+     * @brief Drop the move just taken up if it belongs to a stream that has
+     * underrun. The end marker of the stream, or any move outside it, runs
+     * as usual and ends the underrun.
+     *
+     * @return true if the move was dropped
+     */
+    auto discard_broken_stream_move() -> bool {
+        if (!stream_broken) {
+            return false;
+        }
+        if (buffered_move->group_id == STREAM_GROUP &&
+            buffered_move->duration != 0) {
+            _has_active_move = false;
+            set_buffered_move(MotorMoveMessage{});
+            return true;
+        }
+        stream_broken = false;
+        return false;
+    }
+
     [[nodiscard]] auto set_direction_pin() const -> bool {
-        return (buffered_move.velocity > 0);
+        return (buffered_move->velocity > 0);
     }
     void cancel_and_clear_moves(
         can::ids::ErrorCode err_code = can::ids::ErrorCode::hardware,
@@ -474,7 +603,7 @@ class MotorInterruptHandler {
         // when the cancel happened
         uint32_t message_index = 0;
         if (_has_active_move) {
-            message_index = buffered_move.message_index;
+            message_index = buffered_move->message_index;
         }
         status_queue_client.send_move_status_reporter_queue(
             can::messages::ErrorMessage{.message_index = message_index,
@@ -497,11 +626,12 @@ class MotorInterruptHandler {
         // we can't clear here from an interrupt context
         _has_active_move = false;
         tick_count = 0x0;
+        stream_broken = false;
     }
 
     void build_and_send_ack(AckMessageId ack_msg_id) {
-        if (buffered_move.group_id != NO_GROUP) {
-            auto ack = buffered_move.build_ack(
+        if (buffered_move->group_id != NO_GROUP) {
+            auto ack = buffered_move->build_ack(
                 hardware.get_step_tracker(), hardware.get_encoder_pulses(),
                 hardware.position_flags.get_flags(), ack_msg_id);
             static_cast<void>(
@@ -509,12 +639,34 @@ class MotorInterruptHandler {
         }
     }
 
+    /**
+     * @brief Snapshot the ack for the current move now and send it at the
+     * start of the next interrupt. Only one ack is ever held; if one is
+     * still pending it is sent before the new one is taken.
+     */
+    void defer_ack(AckMessageId ack_msg_id) {
+        send_deferred_ack();
+        if (buffered_move->group_id != NO_GROUP) {
+            deferred_ack = buffered_move->build_ack(
+                hardware.get_step_tracker(), hardware.get_encoder_pulses(),
+                hardware.position_flags.get_flags(), ack_msg_id);
+            _has_deferred_ack = true;
+        }
+    }
+
+    void send_deferred_ack() {
+        if (_has_deferred_ack) {
+            _has_deferred_ack = false;
+            static_cast<void>(
+                status_queue_client.send_move_status_reporter_queue(
+                    deferred_ack));
+        }
+    }
+
     void finish_current_move(
         AckMessageId ack_msg_id = AckMessageId::complete_without_condition) {
-        _has_active_move = false;
-        tick_count = 0x0;
-        stall_handled = false;
         build_and_send_ack(ack_msg_id);
+        finish_current_move_without_ack();
         set_buffered_move(MotorMoveMessage{});
         // update the stall check ideal encoder counts based on
         // last known location
@@ -533,10 +685,13 @@ class MotorInterruptHandler {
         position_tracker = 0;
         update_hardware_step_tracker();
         tick_count = 0x0;
+        jerk_remainder = 0;
         _has_active_move = false;
+        _has_staged_move = false;
         hardware.reset_encoder_pulses();
         stall_checker.reset_itr_counts(0);
         stall_handled = false;
+        stream_broken = false;
     }
 
     [[nodiscard]] static auto overflow(q31_31 current, q31_31 future) -> bool {
@@ -551,6 +706,15 @@ class MotorInterruptHandler {
         return bool((current ^ future) & overflow_flag);
     }
 
+    [[nodiscard]] static auto overflow(int64_t sq0_31_value) -> bool {
+        /*
+         * Check whether a velocity or acceleration integrated in 64 bits no
+         * longer fits in sq0_31.
+         */
+        return sq0_31_value > std::numeric_limits<sq0_31>::max() ||
+               sq0_31_value < std::numeric_limits<sq0_31>::min();
+    }
+
     // test interface
     [[nodiscard]] auto get_current_position() const -> q31_31 {
         return position_tracker;
@@ -561,10 +725,14 @@ class MotorInterruptHandler {
     }
 
     [[nodiscard]] auto get_buffered_move() const -> MotorMoveMessage {
-        return buffered_move;
+        return *buffered_move;
     }
     void set_buffered_move(MotorMoveMessage new_move) {
-        buffered_move = new_move;
+        *buffered_move = new_move;
+        jerk_remainder = 0;
+    }
+    [[nodiscard]] auto has_staged_move() const -> bool {
+        return _has_staged_move;
     }
 
     /**
@@ -649,10 +817,16 @@ class MotorInterruptHandler {
      * the velocity is nonzero.
      */
     auto is_moving() -> bool {
-        return has_active_move() && buffered_move.velocity != 0;
+        return has_active_move() && buffered_move->velocity != 0;
     }
 
   protected:
+    void finish_current_move_without_ack() {
+        _has_active_move = false;
+        tick_count = 0x0;
+        stall_handled = false;
+    }
+
     void update_hardware_step_tracker() {
         hardware.set_step_tracker(
             static_cast<uint32_t>(position_tracker >> 31));
@@ -682,6 +856,11 @@ class MotorInterruptHandler {
     uint64_t tick_count = 0x0;
     static constexpr const q31_31 tick_flag = 0x80000000;
     static constexpr const uint64_t overflow_flag = 0x8000000000000000;
+    static constexpr const int jerk_extra_bits = JERK_RADIX - RADIX;
+    static constexpr const int64_t jerk_remainder_mask =
+        (int64_t{1} << jerk_extra_bits) - 1;
+    // Acceleration below sq0_31 resolution accumulated from jerk
+    int64_t jerk_remainder = 0;
     // Tracks position with sub-microstep accuracy
     q31_31 position_tracker{0};
     MoveQueue& move_queue;
@@ -689,10 +868,17 @@ class MotorInterruptHandler {
     MotorHardware& hardware;
     stall_check::StallCheck& stall_checker;
     UpdatePositionQueue& update_position_queue;
-    MotorMoveMessage buffered_move = MotorMoveMessage{};
+    std::array<MotorMoveMessage, 2> move_slots{};
+    MotorMoveMessage* buffered_move = &move_slots[0];
+    MotorMoveMessage* staged_move = &move_slots[1];
+    bool _has_staged_move = false;
+    MoveAck deferred_ack{};
+    bool _has_deferred_ack = false;
     bool clear_queue_until_empty = false;
     bool stall_handled = false;
     bool in_estop = false;
+    // Set when a move stream underruns, until the stream is ended
+    bool stream_broken = false;
     std::atomic_bool _has_active_move = false;
 };
 }  // namespace motor_handler
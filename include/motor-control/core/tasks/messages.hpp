@@ -17,7 +17,8 @@ using MotionControlTaskMessage = std::variant<
     can::messages::UpdateMotorPositionEstimationRequest,
     can::messages::GetMotorUsageRequest, can::messages::MotorStatusRequest,
     can::messages::AddSensorMoveRequest,
-    can::messages::IncreaseEvoDispenseRequest>;
+    can::messages::IncreaseEvoDispenseRequest,
+    can::messages::AddJerkMoveRequest, can::messages::EndMoveStreamRequest>;
 
 using MoveGroupTaskMessage =
     std::variant<std::monostate, can::messages::AddLinearMoveRequest,
@@ -25,7 +26,10 @@ using MoveGroupTaskMessage =
                  can::messages::ExecuteMoveGroupRequest,
                  can::messages::GetMoveGroupRequest, can::messages::HomeRequest,
                  can::messages::StopRequest,
-                 can::messages::AddSensorMoveRequest>;
+                 can::messages::AddSensorMoveRequest,
+                 can::messages::AddJerkMoveRequest,
+                 can::messages::ExecuteMoveStreamRequest,
+                 can::messages::EndMoveStreamRequest>;
 #else
 using MotionControlTaskMessage = std::variant<
     std::monostate, can::messages::AddLinearMoveRequest,
@@ -36,14 +40,18 @@ using MotionControlTaskMessage = std::variant<
     can::messages::HomeRequest,
     can::messages::UpdateMotorPositionEstimationRequest,
     can::messages::GetMotorUsageRequest, can::messages::MotorStatusRequest,
-    can::messages::IncreaseEvoDispenseRequest>;
+    can::messages::IncreaseEvoDispenseRequest,
+    can::messages::AddJerkMoveRequest, can::messages::EndMoveStreamRequest>;
 
 using MoveGroupTaskMessage =
     std::variant<std::monostate, can::messages::AddLinearMoveRequest,
                  can::messages::ClearAllMoveGroupsRequest,
                  can::messages::ExecuteMoveGroupRequest,
                  can::messages::GetMoveGroupRequest, can::messages::HomeRequest,
-                 can::messages::StopRequest>;
+                 can::messages::StopRequest,
+                 can::messages::AddJerkMoveRequest,
+                 can::messages::ExecuteMoveStreamRequest,
+                 can::messages::EndMoveStreamRequest>;
 #endif
 
 using MotorDriverTaskMessage =
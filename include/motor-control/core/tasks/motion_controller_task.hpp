@@ -117,6 +117,29 @@ class MotionControllerMessageHandler {
         }
     }
 
+    void handle(const can::messages::AddJerkMoveRequest& m) {
+        LOG("Received add jerk move request: velocity=%d, acceleration=%d, "
+            "jerk=%d, groupid=%d, seqid=%d, duration=%d, stopcondition=%d",
+            m.velocity, m.acceleration, m.jerk, m.group_id, m.seq_id,
+            m.duration, m.request_stop_condition);
+        if (controller.check_tmc_diag0()) {
+            can_client.send_can_message(
+                can::ids::NodeId::host,
+                can::messages::ErrorMessage{
+                    .message_index = m.message_index,
+                    .severity = can::ids::ErrorSeverity::unrecoverable,
+                    .error_code =
+                        can::ids::ErrorCode::motor_driver_error_detected});
+        } else {
+            controller.move(m);
+        }
+    }
+
+    void handle(const can::messages::EndMoveStreamRequest& m) {
+        LOG("Received end move stream request");
+        controller.end_stream(m);
+    }
+
 #ifdef USE_SENSOR_MOVE
     void handle(const can::messages::AddSensorMoveRequest& m) {
         LOG("Received add linear move request: velocity=%d, acceleration=%d, "
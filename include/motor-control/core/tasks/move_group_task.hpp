@@ -17,12 +17,12 @@ constexpr std::size_t max_moves_per_group = 12;
 #ifdef USE_SENSOR_MOVE
 using MoveGroupType = move_group::MoveGroupManager<
     max_groups, max_moves_per_group, can::messages::AddLinearMoveRequest,
-    can::messages::HomeRequest, can::messages::AddSensorMoveRequest>;
+    can::messages::HomeRequest, can::messages::AddSensorMoveRequest,
+    can::messages::AddJerkMoveRequest>;
 #else
-using MoveGroupType =
-    move_group::MoveGroupManager<max_groups, max_moves_per_group,
-                                 can::messages::AddLinearMoveRequest,
-                                 can::messages::HomeRequest>;
+using MoveGroupType = move_group::MoveGroupManager<
+    max_groups, max_moves_per_group, can::messages::AddLinearMoveRequest,
+    can::messages::HomeRequest, can::messages::AddJerkMoveRequest>;
 #endif
 
 using TaskMessage = motor_control_task_messages::MoveGroupTaskMessage;
@@ -60,13 +60,19 @@ class MoveGroupMessageHandler {
     void handle(const can::messages::AddLinearMoveRequest& m) {
         LOG("Received add linear move request: groupid=%d, seqid=%d",
             m.group_id, m.seq_id);
-        static_cast<void>(move_groups[m.group_id].set_move(m));
+        add_move(m);
+    }
+
+    void handle(const can::messages::AddJerkMoveRequest& m) {
+        LOG("Received add jerk move request: groupid=%d, seqid=%d",
+            m.group_id, m.seq_id);
+        add_move(m);
     }
 
     void handle(const can::messages::HomeRequest& m) {
         LOG("Move Group Received home request: groupid=%d, seqid=%d\n",
             m.group_id, m.seq_id);
-        static_cast<void>(move_groups[m.group_id].set_move(m));
+        add_move(m);
     }
 
     void handle(const can::messages::GetMoveGroupRequest& m) {
@@ -84,6 +90,31 @@ class MoveGroupMessageHandler {
         for (auto& group : move_groups) {
             group.clear();
         }
+        stream_open = false;
+    }
+
+    void add_move(const auto& m) {
+        if (m.group_id == motor_messages::STREAM_GROUP) {
+            stream_move(m);
+            return;
+        }
+        static_cast<void>(move_groups[m.group_id].set_move(m));
+    }
+
+    void stream_move(const auto& m) {
+        // A segment with no duration or the end sequence id would be taken
+        // for the end of the stream by the step interrupt.
+        if (!stream_open || m.duration == 0 ||
+            m.seq_id == motor_messages::STREAM_END_SEQ) {
+            can_client.send_can_message(
+                can::ids::NodeId::host,
+                can::messages::ErrorMessage{
+                    .message_index = m.message_index,
+                    .severity = can::ids::ErrorSeverity::warning,
+                    .error_code = can::ids::ErrorCode::invalid_input});
+            return;
+        }
+        mc_client.send_motion_controller_queue(m);
     }
 
     void handle(const can::messages::ClearAllMoveGroupsRequest& m) {
@@ -104,6 +135,31 @@ class MoveGroupMessageHandler {
                                     can::messages::ack_from_request(m));
     }
 
+    void handle(const can::messages::ExecuteMoveStreamRequest& m) {
+        LOG("Received execute move stream request");
+        stream_open = true;
+        can_client.send_can_message(
+            can::ids::NodeId::host,
+            can::messages::MoveStreamCreditResponse{
+                .message_index = m.message_index,
+                .credits = motor_messages::STREAM_WINDOW});
+    }
+
+    void handle(const can::messages::EndMoveStreamRequest& m) {
+        LOG("Received end move stream request");
+        if (!stream_open) {
+            can_client.send_can_message(
+                can::ids::NodeId::host,
+                can::messages::ErrorMessage{
+                    .message_index = m.message_index,
+                    .severity = can::ids::ErrorSeverity::warning,
+                    .error_code = can::ids::ErrorCode::invalid_input});
+            return;
+        }
+        stream_open = false;
+        mc_client.send_motion_controller_queue(m);
+    }
+
     void handle(const can::messages::StopRequest& m) {
         LOG("Received StopRequest in MoveGroup");
         this->clear_move_groups();
@@ -115,7 +171,7 @@ class MoveGroupMessageHandler {
     void handle(const can::messages::AddSensorMoveRequest& m) {
         LOG("Received add sensor move request: groupid=%d, seqid=%d",
             m.group_id, m.seq_id);
-        static_cast<void>(move_groups[m.group_id].set_move(m));
+        add_move(m);
     }
 
     void visit_move(const std::monostate&) {}
@@ -124,6 +180,10 @@ class MoveGroupMessageHandler {
         mc_client.send_motion_controller_queue(m);
     }
 
+    void visit_move(const can::messages::AddJerkMoveRequest& m) {
+        mc_client.send_motion_controller_queue(m);
+    }
+
     void visit_move(const can::messages::HomeRequest& m) {
         mc_client.send_motion_controller_queue(m);
     }
@@ -137,6 +197,7 @@ class MoveGroupMessageHandler {
     MoveGroupType& move_groups;
     MotionControllerClient& mc_client;
     CanClient& can_client;
+    bool stream_open = false;
 };
 
 /**
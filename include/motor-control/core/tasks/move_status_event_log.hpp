@@ -0,0 +1,266 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+#include "can/core/ids.hpp"
+#include "can/core/messages.hpp"
+#include "common/core/spsc_message_queue.hpp"
+#include "motor-control/core/motor_messages.hpp"
+#include "motor-control/core/tasks/messages.hpp"
+#include "motor-control/core/usage_messages.hpp"
+
+namespace move_status_reporter_task {
+
+using TaskMessage = motor_control_task_messages::MoveStatusReporterTaskMessage;
+
+enum class MoveStatusEventType : uint8_t {
+    ack,
+    update_position_response,
+    error,
+    increase_error_count,
+};
+
+/**
+ * A compact record of something the step interrupt needs to report. It
+ * carries only the snapshot taken in the interrupt; the reporter task turns
+ * it back into the full message it stands for.
+ */
+struct MoveStatusEvent {
+    uint32_t message_index;
+    uint32_t step_position;
+    int32_t encoder_position;
+    int32_t start_encoder_position;
+    // usage key of a move for acks, error count key for error counts
+    uint16_t key;
+    // AckMessageId for acks, ErrorCode for errors
+    uint16_t code;
+    MoveStatusEventType type;
+    uint8_t group_id;
+    uint8_t seq_id;
+    // position flags for acks and position responses, ErrorSeverity for
+    // errors
+    uint8_t flags;
+};
+
+// The most events one move reports: an ack, an error and an error count.
+static constexpr std::size_t max_events_per_move = 3;
+// The most events one position update reports: an error and an error count.
+static constexpr std::size_t max_events_per_position_update = 2;
+
+/**
+ * A log that holds everything the step interrupt can report for the moves
+ * and position updates queued to it, plus the move it is running, without
+ * the reporter getting a chance to drain it.
+ */
+static constexpr std::size_t default_log_size = std::bit_ceil(
+    max_events_per_move *
+        (spsc_message_queue::SPSCMessageQueue<motor_messages::Move>::capacity +
+         1) +
+    max_events_per_position_update *
+        spsc_message_queue::SPSCMessageQueue<
+            can::messages::UpdateMotorPositionEstimationRequest>::capacity);
+
+/**
+ * The channel from a step interrupt handler to its move status reporter.
+ *
+ * This can be used as the status client of a MotorInterruptHandler. Each
+ * report is packed into a MoveStatusEvent and appended to a lock-free ring,
+ * so the interrupt only enters the kernel to report a move status when it
+ * has to wake the reporter task, which drains the ring with try_read().
+ *
+ * If the log does fill up anyway, the events that do not fit are counted
+ * and the message index of the last of them is kept so the reporter can
+ * tell the host which move went unreported.
+ *
+ * There must be exactly one interrupt handler writing to a log.
+ */
+template <std::size_t log_size = default_log_size>
+class MoveStatusEventLog {
+  public:
+    using Waker = void (*)(void*);
+
+    MoveStatusEventLog() = default;
+    MoveStatusEventLog(const MoveStatusEventLog&) = delete;
+    MoveStatusEventLog(const MoveStatusEventLog&&) = delete;
+    auto operator=(const MoveStatusEventLog&) = delete;
+    auto operator=(const MoveStatusEventLog&&) = delete;
+    ~MoveStatusEventLog() = default;
+
+    void send_move_status_reporter_queue(const motor_messages::Ack& m) {
+        append(MoveStatusEvent{
+            .message_index = m.message_index,
+            .step_position = m.current_position_steps,
+            .encoder_position = m.encoder_position,
+            .start_encoder_position = m.start_encoder_position,
+            .key = m.usage_key,
+            .code = static_cast<uint16_t>(m.ack_id),
+            .type = MoveStatusEventType::ack,
+            .group_id = m.group_id,
+            .seq_id = m.seq_id,
+            .flags = m.position_flags});
+    }
+
+    void send_move_status_reporter_queue(
+        const motor_messages::UpdatePositionResponse& m) {
+        append(MoveStatusEvent{
+            .message_index = m.message_index,
+            .step_position = m.stepper_position_counts,
+            .encoder_position = m.encoder_pulses,
+            .start_encoder_position = 0,
+            .key = 0,
+            .code = 0,
+            .type = MoveStatusEventType::update_position_response,
+            .group_id = 0,
+            .seq_id = 0,
+            .flags = m.position_flags});
+    }
+
+    void send_move_status_reporter_queue(
+        const can::messages::ErrorMessage& m) {
+        append(MoveStatusEvent{
+            .message_index = m.message_index,
+            .step_position = 0,
+            .encoder_position = 0,
+            .start_encoder_position = 0,
+            .key = 0,
+            .code = static_cast<uint16_t>(m.error_code),
+            .type = MoveStatusEventType::error,
+            .group_id = 0,
+            .seq_id = 0,
+            .flags = static_cast<uint8_t>(m.severity)});
+    }
+
+    void send_move_status_reporter_queue(
+        const usage_messages::IncreaseErrorCount& m) {
+        append(MoveStatusEvent{
+            .message_index = 0,
+            .step_position = 0,
+            .encoder_position = 0,
+            .start_encoder_position = 0,
+            .key = m.key,
+            .code = 0,
+            .type = MoveStatusEventType::increase_error_count,
+            .group_id = 0,
+            .seq_id = 0,
+            .flags = 0});
+    }
+
+    /**
+     * Take the oldest event out of the log and expand it into the reporter
+     * message it stands for.
+     *
+     * @return false if the log is empty
+     */
+    auto try_read(TaskMessage* message) -> bool {
+        auto event = MoveStatusEvent{};
+        if (!events.try_read(&event)) {
+            return false;
+        }
+        *message = expand(event);
+        return true;
+    }
+
+    [[nodiscard]] auto has_event() const -> bool {
+        return events.has_message();
+    }
+
+    /**
+     * Set what is called, from the interrupt, to wake the reader after
+     * start_waiting().
+     */
+    void set_waker(Waker waker, void* context) {
+        wake_context = context;
+        wake = waker;
+    }
+
+    /**
+     * Ask to be woken when the next event is appended. The reader calls
+     * this before it goes to sleep.
+     *
+     * @return false if there is already an event to read, in which case
+     * the reader should not sleep.
+     */
+    auto start_waiting() -> bool {
+        waiting.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (events.has_message()) {
+            waiting.store(false, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * The number of events that were dropped because the log was full. This
+     * is never reset.
+     */
+    [[nodiscard]] auto get_dropped_count() const -> uint32_t {
+        return dropped.load(std::memory_order_acquire);
+    }
+
+    /**
+     * The message index of the last event that was dropped.
+     */
+    [[nodiscard]] auto get_last_dropped_index() const -> uint32_t {
+        return last_dropped_index.load(std::memory_order_relaxed);
+    }
+
+    static auto expand(const MoveStatusEvent& event) -> TaskMessage {
+        switch (event.type) {
+            case MoveStatusEventType::ack:
+                return motor_messages::Ack{
+                    .message_index = event.message_index,
+                    .group_id = event.group_id,
+                    .seq_id = event.seq_id,
+                    .current_position_steps = event.step_position,
+                    .encoder_position = event.encoder_position,
+                    .position_flags = event.flags,
+                    .ack_id =
+                        static_cast<motor_messages::AckMessageId>(event.code),
+                    .start_encoder_position = event.start_encoder_position,
+                    .usage_key = event.key};
+            case MoveStatusEventType::update_position_response:
+                return motor_messages::UpdatePositionResponse{
+                    .message_index = event.message_index,
+                    .stepper_position_counts = event.step_position,
+                    .encoder_pulses = event.encoder_position,
+                    .position_flags = event.flags};
+            case MoveStatusEventType::error:
+                return can::messages::ErrorMessage{
+                    .message_index = event.message_index,
+                    .severity =
+                        static_cast<can::ids::ErrorSeverity>(event.flags),
+                    .error_code = static_cast<can::ids::ErrorCode>(event.code)};
+            case MoveStatusEventType::increase_error_count:
+                return usage_messages::IncreaseErrorCount{.key = event.key};
+        }
+        return std::monostate{};
+    }
+
+  private:
+    void append(const MoveStatusEvent& event) {
+        if (!events.try_write(event)) {
+            last_dropped_index.store(event.message_index,
+                                     std::memory_order_relaxed);
+            dropped.fetch_add(1, std::memory_order_release);
+        }
+        // A reader that saw the log empty has to see this event or be woken
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiting.exchange(false, std::memory_order_relaxed) &&
+            wake != nullptr) {
+            wake(wake_context);
+        }
+    }
+
+    spsc_message_queue::SPSCMessageQueue<MoveStatusEvent, log_size> events{};
+    std::atomic<uint32_t> dropped{0};
+    std::atomic<uint32_t> last_dropped_index{0};
+    std::atomic_bool waiting{false};
+    Waker wake = nullptr;
+    void* wake_context = nullptr;
+};
+
+}  // namespace move_status_reporter_task
@@ -5,8 +5,10 @@
 #include "can/core/can_writer_task.hpp"
 #include "can/core/ids.hpp"
 #include "can/core/messages.hpp"
+#include "common/core/logging.h"
 #include "motor-control/core/linear_motion_system.hpp"
 #include "motor-control/core/tasks/messages.hpp"
+#include "motor-control/core/tasks/move_status_event_log.hpp"
 #include "motor-control/core/tasks/usage_storage_task.hpp"
 #include "motor-control/core/utils.hpp"
 
@@ -46,6 +48,9 @@ class MoveStatusMessageHandler {
     void handle_message(std::monostate&) {}
 
     void handle_message(const can::messages::ErrorMessage& msg) {
+        // An error ends any stream that is running, and the host stops
+        // counting on credits for it.
+        stream_credits = 0;
         can_client.send_can_message(can::ids::NodeId::host, msg);
     }
 
@@ -70,6 +75,9 @@ class MoveStatusMessageHandler {
             .position_flags = message.position_flags,
             .ack_id = static_cast<uint8_t>(message.ack_id)};
         can_client.send_can_message(can::ids::NodeId::host, msg);
+        if (message.group_id == motor_messages::STREAM_GROUP) {
+            return_stream_credit(message);
+        }
 
         int32_t distance_traveled_um =
             end_position - fixed_point_multiply(um_per_encoder_pulse,
@@ -102,11 +110,34 @@ class MoveStatusMessageHandler {
     }
 
   private:
+    /**
+     * Each completed stream segment frees a slot for the host to send
+     * another one. The credits are returned in batches to keep the bus
+     * traffic down.
+     */
+    void return_stream_credit(const motor_messages::Ack& message) {
+        if (message.seq_id == motor_messages::STREAM_END_SEQ) {
+            stream_credits = 0;
+            return;
+        }
+        stream_credits++;
+        if (stream_credits >= motor_messages::STREAM_CREDIT_BATCH) {
+            can_client.send_can_message(
+                can::ids::NodeId::host,
+                can::messages::MoveStreamCreditResponse{
+                    .message_index = message.message_index,
+                    .credits = stream_credits});
+            stream_credits = 0;
+        }
+    }
+
     CanClient& can_client;
     const lms::LinearMotionSystemConfig<LmsConfig>& lms_config;
     sq31_31 um_per_step;
     sq31_31 um_per_encoder_pulse;
     UsageClient& usage_client;
+    // Completed stream segments not yet returned to the host
+    uint8_t stream_credits = 0;
 };
 
 /**
@@ -145,9 +176,66 @@ class MoveStatusReporterTask {
         }
     }
 
+    /**
+     * Task entry point for a reporter that also drains the event log its
+     * step interrupt handler reports into. The task sleeps on its queue and
+     * the interrupt wakes it with an empty message when it appends to the
+     * log.
+     */
+    template <can::message_writer_task::TaskClient CanClient,
+              lms::MotorMechanicalConfig LmsConfig,
+              usage_storage_task::TaskClient UsageClient, std::size_t LogSize>
+    [[noreturn]] void operator()(
+        CanClient* can_client,
+        const lms::LinearMotionSystemConfig<LmsConfig>* config,
+        UsageClient* usage_client, MoveStatusEventLog<LogSize>* event_log) {
+        auto handler =
+            MoveStatusMessageHandler{*can_client, *config, *usage_client};
+        event_log->set_waker(wake, &queue);
+        TaskMessage message{};
+        uint32_t reported_drops = 0;
+        for (;;) {
+            if (event_log->start_waiting() &&
+                queue.try_read(&message, queue.max_delay)) {
+                handler.handle_message(message);
+            }
+            while (event_log->try_read(&message)) {
+                handler.handle_message(message);
+            }
+            if (event_log->get_dropped_count() != reported_drops) {
+                reported_drops = event_log->get_dropped_count();
+                report_dropped(*can_client, reported_drops,
+                               event_log->get_last_dropped_index());
+            }
+        }
+    }
+
     [[nodiscard]] auto get_queue() const -> QueueType& { return queue; }
 
   private:
+    static void wake(void* context) {
+        static_cast<void>(
+            static_cast<QueueType*>(context)->try_write_isr(TaskMessage{}));
+    }
+
+    /**
+     * An event that did not fit in the log may have been the ack the host
+     * is waiting on to finish a move group, so the host is told with an
+     * error against the last move that went unreported.
+     */
+    template <can::message_writer_task::TaskClient CanClient>
+    static void report_dropped(CanClient& can_client, uint32_t dropped,
+                               uint32_t message_index) {
+        LOG("Move status event log full, %lu events dropped",
+            static_cast<unsigned long>(dropped));
+        can_client.send_can_message(
+            can::ids::NodeId::host,
+            can::messages::ErrorMessage{
+                .message_index = message_index,
+                .severity = can::ids::ErrorSeverity::recoverable,
+                .error_code = can::ids::ErrorCode::hardware});
+    }
+
     QueueType& queue;
 };
 
@@ -1,4 +1,6 @@
 #pragma once
+#include <array>
+#include <atomic>
 #include <limits>
 #include <type_traits>
 #include <variant>
@@ -11,6 +13,7 @@
 #include "common/core/logging.h"
 #include "eeprom/core/dev_data.hpp"
 #include "motor-control/core/tasks/messages.hpp"
+#include "motor-control/core/usage_accumulator.hpp"
 
 namespace usage_storage_task {
 
@@ -18,6 +21,10 @@ using namespace usage_messages;
 
 using TaskMessage = motor_control_task_messages::UsageStorageTaskMessage;
 
+static_assert(motor_hardware::max_requests_per_can_message <=
+                  eeprom::dev_data::max_batch_keys,
+              "A usage request must fit in one batch read");
+
 static constexpr uint16_t distance_data_usage_len = 8;
 static constexpr uint16_t force_time_data_usage_len = 4;
 static constexpr uint16_t error_count_usage_len = 4;
@@ -38,7 +45,9 @@ requires std::is_integral_v<NUM_T> && std::is_unsigned_v<NUM_T>
     return val;
 }
 /**
- * The message queue message handler.
+ * The message queue message handler. Increments are absorbed by a
+ * UsageAccumulator and written to the eeprom in batches; the direct
+ * read-modify-write is only used when the accumulator has no room.
  */
 template <can::message_writer_task::TaskClient CanClient,
           eeprom::task::TaskClient EEPromClient>
@@ -49,7 +58,8 @@ class UsageStorageTaskHandler : eeprom::accessor::ReadListener {
         eeprom::dev_data::DevDataTailAccessor<EEPromClient>& tail_accessor)
         : can_client{can_client},
           usage_data_accessor{eeprom_client, *this, accessor_backing,
-                              tail_accessor} {}
+                              tail_accessor},
+          accumulator{usage_accumulator::claim_journal()} {}
     UsageStorageTaskHandler(const UsageStorageTaskHandler& c) = delete;
     UsageStorageTaskHandler(const UsageStorageTaskHandler&& c) = delete;
     auto operator=(const UsageStorageTaskHandler& c) = delete;
@@ -62,11 +72,50 @@ class UsageStorageTaskHandler : eeprom::accessor::ReadListener {
 
     void read_complete(uint32_t message_index) final {
         std::ignore = message_index;
+        if (flush_state == FlushState::READING) {
+            finish_flush();
+            return;
+        }
         std::visit([this](auto m) { this->finish_handle(m); }, buffered_task);
     }
 
     auto ready() -> bool {
-        return ready_for_new_message && usage_data_accessor.read_write_ready();
+        return ready_for_new_message && flush_state == FlushState::IDLE &&
+               usage_data_accessor.read_write_ready();
+    }
+
+    [[nodiscard]] auto is_dirty() const -> bool {
+        return accumulator.is_dirty();
+    }
+
+    /**
+     * Keep the time, and start a flush if enough has built up.
+     */
+    void tick(uint32_t now_ms) {
+        now = now_ms;
+        if (ready() && accumulator.flush_due(now)) {
+            start_flush();
+        }
+    }
+
+    /**
+     * Called when no message came in for idle_flush_ms.
+     */
+    void idle() {
+        if (ready() && accumulator.is_dirty()) {
+            start_flush();
+        }
+    }
+
+    /**
+     * Once the eeprom has finished writing the last key, take its count out
+     * of the journal and move on to the next one.
+     */
+    void continue_flush() {
+        if (flush_state == FlushState::WRITING && write_done.exchange(false)) {
+            accumulator.flushed(flush_index, flush_amount);
+            flush_next();
+        }
     }
 
   private:
@@ -77,49 +126,128 @@ class UsageStorageTaskHandler : eeprom::accessor::ReadListener {
         ready_for_new_message = true;
     }
 
-    void start_next_read(const GetUsageRequest& m) {
-        if (m.usage_conf.num_keys != response.num_keys) {
-            std::fill(accessor_backing.begin(), accessor_backing.end(), 0x00);
-            usage_data_accessor.get_data(
-                m.usage_conf.usage_requests[response.num_keys].eeprom_key,
-                m.message_index);
+    void start_flush() {
+        accumulator.flush_started(now);
+        flush_next();
+    }
+
+    void flush_next() {
+        flush_index = accumulator.next_dirty();
+        if (flush_index == usage_accumulator::journal_entries ||
+            !usage_data_accessor.read_write_ready()) {
+            flush_state = FlushState::IDLE;
+            return;
+        }
+        const auto& entry = accumulator.entry(flush_index);
+        if (!usage_data_accessor.data_part_exists(entry.key)) {
+            // the accessor would never call back for this key
+            LOG("dropping usage for key %d, it is not in the eeprom",
+                entry.key);
+            accumulator.flushed(flush_index, entry.pending);
+            flush_next();
+            return;
+        }
+        flush_amount = entry.pending;
+        flush_state = FlushState::READING;
+        std::fill(accessor_backing.begin(), accessor_backing.end(), 0x00);
+        usage_data_accessor.get_data(entry.key, 0);
+    }
+
+    template <typename NUM_T>
+    void write_flushed(uint16_t key, uint16_t len) {
+        NUM_T value = 0;
+        std::ignore = bit_utils::bytes_to_int(
+            accessor_backing.begin(), accessor_backing.begin() + len, value);
+        value = check_for_default_val(value);
+        value += static_cast<NUM_T>(flush_amount);
+        std::ignore = bit_utils::int_to_bytes(value, accessor_backing.begin(),
+                                              accessor_backing.end());
+        write_done = false;
+        if (usage_data_accessor.write_data(key, len, accessor_backing,
+                                           write_complete, this)) {
+            flush_state = FlushState::WRITING;
         } else {
-            can_client.send_can_message(can::ids::NodeId::host, response);
-            ready_for_new_message = true;
-            buffered_task = TaskMessage{};
+            // the entry stays in the journal for the next flush
+            flush_state = FlushState::IDLE;
+        }
+    }
+
+    void finish_flush() {
+        const auto& entry = accumulator.entry(flush_index);
+        if (entry.len == distance_data_usage_len) {
+            write_flushed<uint64_t>(entry.key, entry.len);
+        } else {
+            write_flushed<uint32_t>(entry.key, entry.len);
+        }
+    }
+
+    /*
+     * Called from the eeprom task once the write is done. The journal entry
+     * is only cleared after this, so a reset before then loses no counts;
+     * at worst they are added to the eeprom twice.
+     */
+    static void write_complete(void* param) {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        auto* self = reinterpret_cast<UsageStorageTaskHandler*>(param);
+        self->write_done = true;
+    }
+
+    /*
+     * A value read from the eeprom sits in the top bytes of the response
+     * field, so a pending count has to be shifted up to match.
+     */
+    [[nodiscard]] auto pending_in_field(uint16_t key, uint16_t len) const
+        -> uint64_t {
+        if (len == 0 || len > sizeof(uint64_t)) {
+            return 0;
         }
+        return accumulator.pending(key) << ((sizeof(uint64_t) - len) * 8);
     }
 
     void start_handle(const GetUsageRequest& m) {
         ready_for_new_message = false;
         buffered_task = TaskMessage{m};
-        response.message_index = m.message_index;
-        response.num_keys = 0;
-        start_next_read(m);
+        auto requests = std::array<eeprom::dev_data::DataRequest,
+                                   eeprom::dev_data::max_batch_keys>{};
+        for (std::size_t i = 0; i < m.usage_conf.num_keys; ++i) {
+            requests[i] = eeprom::dev_data::DataRequest{
+                .key = m.usage_conf.usage_requests[i].eeprom_key, .len = 0};
+        }
+        usage_data_accessor.get_data_batch(requests, m.usage_conf.num_keys,
+                                           batch_backing, m.message_index);
     }
 
     void finish_handle(const GetUsageRequest& m) {
-        // parse the next usage value and construct response field
-        uint64_t read_value = 0;
-        std::ignore = bit_utils::bytes_to_int(
-            accessor_backing.begin(), accessor_backing.end(), read_value);
-        auto next_klv = can::messages::GetMotorUsageResponse::UsageValueField{
-            .key = m.usage_conf.usage_requests[response.num_keys].type_key,
-            .len = m.usage_conf.usage_requests[response.num_keys].length,
-            .value = check_for_default_val(
-                read_value,
-                m.usage_conf.usage_requests[response.num_keys].length)};
-        // add the next value to the response, and increment num_keys
-        response.values[response.num_keys] = next_klv;
-        response.num_keys += 1;
-        // remove this request from the struct, save it to buffered task and
-        // continue
-        start_next_read(m);
-        // the start_next_read task will handle sending the response if there is
-        // no more requests
+        auto response = can::messages::GetMotorUsageResponse{
+            .message_index = m.message_index, .num_keys = 0};
+        for (std::size_t i = 0; i < m.usage_conf.num_keys; ++i) {
+            // each value sits at the start of its slot, so it ends up in the
+            // top bytes of the field
+            uint64_t read_value = 0;
+            auto* slot =
+                batch_backing.begin() + i * eeprom::types::max_data_length;
+            std::ignore = bit_utils::bytes_to_int(
+                slot, slot + eeprom::types::max_data_length, read_value);
+            const auto& request = m.usage_conf.usage_requests[i];
+            response.values[response.num_keys] =
+                can::messages::GetMotorUsageResponse::UsageValueField{
+                    .key = request.type_key,
+                    .len = request.length,
+                    .value =
+                        check_for_default_val(read_value, request.length) +
+                        pending_in_field(request.eeprom_key, request.length)};
+            response.num_keys += 1;
+        }
+        can_client.send_can_message(can::ids::NodeId::host, response);
+        ready_for_new_message = true;
+        buffered_task = TaskMessage{};
     }
 
     void start_handle(const IncreaseForceTimeUsage& m) {
+        if (accumulator.add(m.key, force_time_data_usage_len, m.seconds, now)) {
+            return;
+        }
+        LOG("usage journal full, writing key %d straight through", m.key);
         ready_for_new_message = false;
         buffered_task = TaskMessage{m};
         usage_data_accessor.get_data(m.key, 0);
@@ -141,6 +269,11 @@ class UsageStorageTaskHandler : eeprom::accessor::ReadListener {
     }
 
     void start_handle(const IncreaseDistanceUsage& m) {
+        if (accumulator.add(m.key, distance_data_usage_len,
+                            m.distance_traveled_um, now)) {
+            return;
+        }
+        LOG("usage journal full, writing key %d straight through", m.key);
         ready_for_new_message = false;
         buffered_task = TaskMessage{m};
         usage_data_accessor.get_data(m.key, 0);
@@ -162,6 +295,10 @@ class UsageStorageTaskHandler : eeprom::accessor::ReadListener {
     }
 
     void start_handle(const IncreaseErrorCount& m) {
+        if (accumulator.add(m.key, error_count_usage_len, 1, now)) {
+            return;
+        }
+        LOG("usage journal full, writing key %d straight through", m.key);
         ready_for_new_message = false;
         buffered_task = TaskMessage{m};
         usage_data_accessor.get_data(m.key, 0);
@@ -183,12 +320,21 @@ class UsageStorageTaskHandler : eeprom::accessor::ReadListener {
     }
 
     TaskMessage buffered_task = {};
-    can::messages::GetMotorUsageResponse response = {};
     bool ready_for_new_message = true;
     CanClient& can_client;
     eeprom::dev_data::DataBufferType<8> accessor_backing =
         eeprom::dev_data::DataBufferType<8>{};
+    // a usage request's values are read in one batch
+    eeprom::dev_data::BatchBufferType batch_backing =
+        eeprom::dev_data::BatchBufferType{};
     eeprom::dev_data::DevDataAccessor<EEPromClient> usage_data_accessor;
+    usage_accumulator::UsageAccumulator accumulator;
+    enum class FlushState { IDLE, READING, WRITING };
+    FlushState flush_state = FlushState::IDLE;
+    std::atomic_bool write_done = false;
+    std::size_t flush_index = 0;
+    uint64_t flush_amount = 0;
+    uint32_t now = 0;
 };
 
 /**
@@ -220,13 +366,22 @@ class UsageStorageTask {
         TaskMessage message{};
         for (;;) {
             if (handler.ready()) {
-                if (queue.try_read(&message, queue.max_delay)) {
+                // while counts are waiting, a quiet spell is the time to
+                // write them out
+                auto timeout = handler.is_dirty()
+                                   ? usage_accumulator::idle_flush_ms
+                                   : queue.max_delay;
+                if (queue.try_read(&message, timeout)) {
                     handler.handle_message(message);
+                } else {
+                    handler.idle();
                 }
+                handler.tick(hardware_tick_count());
             } else {
                 // wait for the handler to be ready before sending the next
                 // message
                 vtask_hardware_delay(10);
+                handler.continue_flush();
             }
         }
     }
@@ -17,6 +17,8 @@ using stepper_timer_ticks = uint64_t;
 using brushed_timer_ticks = uint64_t;
 using steps_per_tick = sq0_31;
 using steps_per_tick_sq = sq0_31;
+// carries can::messages::JERK_RADIX fractional bits rather than 31
+using steps_per_tick_cu = int32_t;
 
 class MotorPositionStatus {
   public:
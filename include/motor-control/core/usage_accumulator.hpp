@@ -0,0 +1,243 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace usage_accumulator {
+
+// Increments absorbed between flushes before one is forced.
+static constexpr uint32_t flush_threshold = 32;
+// How long counts may sit unflushed while the task is kept busy.
+static constexpr uint32_t flush_period_ms = 60000;
+// How long the task waits for another message before flushing.
+static constexpr uint32_t idle_flush_ms = 1000;
+
+// A usage task tracks at most three keys, so this leaves room for one key
+// recovered from another task's journal.
+static constexpr std::size_t journal_entries = 4;
+// Every board runs at most three usage tasks.
+static constexpr std::size_t max_journals = 4;
+
+static constexpr uint16_t journal_magic = 0x55a1;
+
+/**
+ * An unflushed count. Entries are self-describing so that after a reset
+ * any usage task can write them out to the eeprom.
+ */
+struct JournalEntry {
+    uint16_t magic;
+    uint16_t key;
+    uint16_t len;
+    uint16_t crc;
+    uint64_t pending;
+};
+
+struct UsageJournal {
+    std::array<JournalEntry, journal_entries> entries;
+};
+
+/**
+ * CRC-16/CCITT-FALSE of an entry's fields other than the crc itself.
+ */
+constexpr auto entry_crc(const JournalEntry& entry) -> uint16_t {
+    std::array<uint8_t, 14> bytes{};
+    auto put = [&bytes, i = std::size_t(0)](uint64_t value,
+                                           std::size_t size) mutable {
+        for (std::size_t b = 0; b < size; ++b, ++i) {
+            bytes[i] = uint8_t(value >> (b * 8));
+        }
+    };
+    put(entry.magic, 2);
+    put(entry.key, 2);
+    put(entry.len, 2);
+    put(entry.pending, 8);
+    uint16_t crc = 0xFFFF;
+    for (auto byte : bytes) {
+        crc ^= uint16_t(byte) << 8;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 0x8000) ? uint16_t((crc << 1) ^ 0x1021)
+                                 : uint16_t(crc << 1);
+        }
+    }
+    return crc;
+}
+
+/*
+ * The journals live in RAM that neither the startup code nor the bootloader
+ * clears, so counts that were not yet flushed are still there after a
+ * watchdog reset, a firmware update or a brownout that kept SRAM. After a
+ * power cycle the contents are noise, which the magic and crc reject.
+ */
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+inline std::array<UsageJournal, max_journals> journals
+    __attribute__((section(".usage_journal_section")));
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+inline std::atomic<std::size_t> journals_claimed{0};
+
+/**
+ * Take a journal from the pool for one usage task.
+ * @return nullptr if every journal is taken
+ */
+inline auto claim_journal() -> UsageJournal* {
+    auto index = journals_claimed.fetch_add(1);
+    return (index < max_journals) ? &journals[index] : nullptr;
+}
+
+/**
+ * Usage counts kept in RAM until they are worth an eeprom write. Each
+ * increment only touches the journal; the owner writes dirty entries out,
+ * one read-modify-write per key, when flush_due says so or when it is idle.
+ */
+class UsageAccumulator {
+  public:
+    /**
+     * Start from a journal, keeping whatever valid counts it holds. Without
+     * one, counts are only kept in this object.
+     */
+    explicit UsageAccumulator(UsageJournal* storage)
+        : journal{(storage == nullptr) ? local : *storage} {
+        for (std::size_t i = 0; i < journal_entries; ++i) {
+            auto& entry = journal.entries[i];
+            if (valid(entry) && entry.pending != 0) {
+                dirty |= (1U << i);
+            } else {
+                entry = JournalEntry{};
+            }
+        }
+    }
+    UsageAccumulator(const UsageAccumulator&) = delete;
+    auto operator=(const UsageAccumulator&) -> UsageAccumulator& = delete;
+    UsageAccumulator(UsageAccumulator&&) = delete;
+    auto operator=(UsageAccumulator&&) -> UsageAccumulator& = delete;
+    ~UsageAccumulator() = default;
+
+    /**
+     * @param len The size of the key's value in the eeprom
+     * @return False if every entry holds another key's unflushed count
+     */
+    auto add(uint16_t key, uint16_t len, uint64_t amount, uint32_t now_ms)
+        -> bool {
+        auto index = find(key);
+        if (index == journal_entries) {
+            index = find_free();
+            if (index == journal_entries) {
+                return false;
+            }
+        }
+        if (dirty == 0) {
+            dirty_since_ms = now_ms;
+        }
+        auto& entry = journal.entries[index];
+        update(entry, key, len, entry.pending + amount);
+        dirty |= (1U << index);
+        increments++;
+        return true;
+    }
+
+    /**
+     * The count for a key that has not reached the eeprom yet.
+     */
+    [[nodiscard]] auto pending(uint16_t key) const -> uint64_t {
+        auto index = find(key);
+        return (index == journal_entries) ? 0
+                                          : journal.entries[index].pending;
+    }
+
+    [[nodiscard]] auto is_dirty() const -> bool { return dirty != 0; }
+
+    /**
+     * True once enough increments have built up, or the oldest has waited
+     * flush_period_ms.
+     */
+    [[nodiscard]] auto flush_due(uint32_t now_ms) const -> bool {
+        return is_dirty() && (increments >= flush_threshold ||
+                              now_ms - dirty_since_ms >= flush_period_ms);
+    }
+
+    /**
+     * The first entry that needs writing out, or journal_entries.
+     */
+    [[nodiscard]] auto next_dirty() const -> std::size_t {
+        for (std::size_t i = 0; i < journal_entries; ++i) {
+            if ((dirty & (1U << i)) != 0) {
+                return i;
+            }
+        }
+        return journal_entries;
+    }
+
+    [[nodiscard]] auto entry(std::size_t index) const -> const JournalEntry& {
+        return journal.entries[index];
+    }
+
+    /**
+     * Start counting towards the next flush from a flush that is starting
+     * now.
+     */
+    auto flush_started(uint32_t now_ms) -> void {
+        increments = 0;
+        dirty_since_ms = now_ms;
+    }
+
+    /**
+     * Take an amount that has been written to the eeprom off an entry.
+     * Increments that came in while it was being written stay pending.
+     */
+    auto flushed(std::size_t index, uint64_t amount) -> void {
+        auto& entry = journal.entries[index];
+        auto left = entry.pending - std::min(amount, entry.pending);
+        if (left == 0) {
+            entry = JournalEntry{};
+            dirty &= ~(1U << index);
+        } else {
+            update(entry, entry.key, entry.len, left);
+        }
+    }
+
+  private:
+    static auto valid(const JournalEntry& entry) -> bool {
+        return entry.magic == journal_magic && entry.len != 0 &&
+               entry.len <= sizeof(entry.pending) &&
+               entry.crc == entry_crc(entry);
+    }
+
+    static auto update(JournalEntry& entry, uint16_t key, uint16_t len,
+                       uint64_t pending) -> void {
+        auto updated = JournalEntry{.magic = journal_magic,
+                                    .key = key,
+                                    .len = len,
+                                    .crc = 0,
+                                    .pending = pending};
+        updated.crc = entry_crc(updated);
+        entry = updated;
+    }
+
+    [[nodiscard]] auto find(uint16_t key) const -> std::size_t {
+        for (std::size_t i = 0; i < journal_entries; ++i) {
+            if ((dirty & (1U << i)) != 0 && journal.entries[i].key == key) {
+                return i;
+            }
+        }
+        return journal_entries;
+    }
+
+    [[nodiscard]] auto find_free() const -> std::size_t {
+        for (std::size_t i = 0; i < journal_entries; ++i) {
+            if ((dirty & (1U << i)) == 0) {
+                return i;
+            }
+        }
+        return journal_entries;
+    }
+
+    UsageJournal local{};
+    UsageJournal& journal;
+    uint32_t dirty = 0;
+    uint32_t increments = 0;
+    uint32_t dirty_since_ms = 0;
+};
+
+}  // namespace usage_accumulator
@@ -9,16 +9,15 @@
 
 namespace motor_interrupt_driver {
 
-template <class StatusClient, typename MotorMoveMessage, class MotorHardware>
+template <template <class> class QueueImpl, class StatusClient,
+          typename MotorMoveMessage, class MotorHardware>
 class MotorInterruptDriver {
-    using InterruptQueue =
-        freertos_message_queue::FreeRTOSMessageQueue<MotorMoveMessage>;
+    using InterruptQueue = QueueImpl<MotorMoveMessage>;
     using MotorPositionUpdateQueue =
-        freertos_message_queue::FreeRTOSMessageQueue<
-            can::messages::UpdateMotorPositionEstimationRequest>;
-    using InterruptHandler = motor_handler::MotorInterruptHandler<
-        freertos_message_queue::FreeRTOSMessageQueue, StatusClient,
-        MotorMoveMessage, MotorHardware>;
+        QueueImpl<can::messages::UpdateMotorPositionEstimationRequest>;
+    using InterruptHandler =
+        motor_handler::MotorInterruptHandler<QueueImpl, StatusClient,
+                                             MotorMoveMessage, MotorHardware>;
 
   public:
     MotorInterruptDriver(InterruptQueue& q, InterruptHandler& h,
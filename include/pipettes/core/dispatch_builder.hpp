@@ -50,7 +50,9 @@ using MoveGroupDispatchTarget = can::dispatch::DispatchParseTarget<
     can::messages::ClearAllMoveGroupsRequest,
     can::messages::ExecuteMoveGroupRequest, can::messages::GetMoveGroupRequest,
     can::messages::HomeRequest, can::messages::StopRequest,
-    can::messages::AddSensorMoveRequest>;
+    can::messages::AddSensorMoveRequest, can::messages::AddJerkMoveRequest,
+    can::messages::ExecuteMoveStreamRequest,
+    can::messages::EndMoveStreamRequest>;
 #else
 using MoveGroupDispatchTarget = can::dispatch::DispatchParseTarget<
     can::message_handlers::move_group::MoveGroupHandler<
@@ -58,7 +60,9 @@ using MoveGroupDispatchTarget = can::dispatch::DispatchParseTarget<
     can::messages::AddLinearMoveRequest,
     can::messages::ClearAllMoveGroupsRequest,
     can::messages::ExecuteMoveGroupRequest, can::messages::GetMoveGroupRequest,
-    can::messages::HomeRequest, can::messages::StopRequest>;
+    can::messages::HomeRequest, can::messages::StopRequest,
+    can::messages::AddJerkMoveRequest, can::messages::ExecuteMoveStreamRequest,
+    can::messages::EndMoveStreamRequest>;
 #endif
 
 using GearMoveGroupDispatchTarget = can::dispatch::DispatchParseTarget<
@@ -91,7 +95,8 @@ using SystemDispatchTarget = can::dispatch::DispatchParseTarget<
     can::message_handlers::system::SystemMessageHandler<
         central_tasks::QueueClient>,
     can::messages::DeviceInfoRequest, can::messages::InitiateFirmwareUpdate,
-    can::messages::FirmwareUpdateStatusRequest, can::messages::TaskInfoRequest>;
+    can::messages::FirmwareUpdateStatusRequest, can::messages::TaskInfoRequest,
+    can::messages::TransmitLaneStatusRequest>;
 
 using SensorDispatchTarget = can::dispatch::DispatchParseTarget<
     sensors::handlers::SensorHandler<sensor_tasks::QueueClient>,
@@ -101,7 +106,7 @@ using SensorDispatchTarget = can::dispatch::DispatchParseTarget<
     can::messages::SetSensorThresholdRequest,
     can::messages::BindSensorOutputRequest,
     can::messages::PeripheralStatusRequest,
-    can::messages::MaxSensorValueRequest>;
+    can::messages::MaxSensorValueRequest, can::messages::SensorStreamRequest>;
 
 using PipetteInfoDispatchTarget = can::dispatch::DispatchParseTarget<
     pipette_info::PipetteInfoMessageHandler<central_tasks::QueueClient,
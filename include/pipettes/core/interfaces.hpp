@@ -1,25 +1,25 @@
 #pragma once
 
 #include "common/core/freertos_message_queue.hpp"
+#include "common/core/spsc_message_queue.hpp"
 #include "motor-control/core/motor_messages.hpp"
 #include "motor-control/core/stepper_motor/motion_controller.hpp"
 #include "motor-control/core/tasks/motor_hardware_task.hpp"
 
 namespace interfaces {
 #ifdef USE_SENSOR_MOVE
-using MoveQueue = freertos_message_queue::FreeRTOSMessageQueue<
-    motor_messages::SensorSyncMove>;
-#else
 using MoveQueue =
-    freertos_message_queue::FreeRTOSMessageQueue<motor_messages::Move>;
+    spsc_message_queue::SPSCMessageQueue<motor_messages::SensorSyncMove>;
+#else
+using MoveQueue = spsc_message_queue::SPSCMessageQueue<motor_messages::Move>;
 #endif
 using GearMoveQueue =
-    freertos_message_queue::FreeRTOSMessageQueue<motor_messages::GearMotorMove>;
+    spsc_message_queue::SPSCMessageQueue<motor_messages::GearMotorMove>;
 using MotionControlType =
     motion_controller::MotionController<lms::LeadScrewConfig>;
 using PipetteMotionControlType =
     pipette_motion_controller::PipetteMotionController<lms::LeadScrewConfig>;
-using UpdatePositionQueue = freertos_message_queue::FreeRTOSMessageQueue<
+using UpdatePositionQueue = spsc_message_queue::SPSCMessageQueue<
     can::messages::UpdateMotorPositionEstimationRequest>;
 
 struct LowThroughputInterruptQueues {
@@ -52,6 +52,11 @@ void start_tasks(
     eeprom::dev_data::DevDataTailAccessor<sensor_tasks::QueueClient>&
         tail_accessor);
 
+/**
+ * The channel the plunger step interrupt reports move status through.
+ */
+using MoveStatusEventLog = move_status_reporter_task::MoveStatusEventLog<>;
+
 /**
  * Access to all the linear motion task queues on the pipette.
  */
@@ -78,6 +83,9 @@ struct QueueClient : can::message_writer::MessageWriter {
         nullptr};
     freertos_message_queue::FreeRTOSMessageQueue<
         usage_storage_task::TaskMessage>* usage_storage_queue{nullptr};
+    // The step interrupt handler reports move status here instead of into
+    // move_status_report_queue.
+    MoveStatusEventLog move_status_events{};
 };
 
 /**
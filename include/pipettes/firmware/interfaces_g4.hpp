@@ -31,18 +31,18 @@ namespace interfaces {
 #ifdef USE_SENSOR_MOVE
 template <typename Client>
 using MotorInterruptHandlerType = motor_handler::MotorInterruptHandler<
-    freertos_message_queue::FreeRTOSMessageQueue, Client,
+    spsc_message_queue::SPSCMessageQueue, Client,
     motor_messages::SensorSyncMove, motor_hardware::MotorHardware>;
 #else
 template <typename Client>
 using MotorInterruptHandlerType = motor_handler::MotorInterruptHandler<
-    freertos_message_queue::FreeRTOSMessageQueue, Client, motor_messages::Move,
+    spsc_message_queue::SPSCMessageQueue, Client, motor_messages::Move,
     motor_hardware::MotorHardware>;
 #endif
 template <typename Client>
 using GearMotorInterruptHandlerType = motor_handler::MotorInterruptHandler<
-    freertos_message_queue::FreeRTOSMessageQueue, Client,
-    motor_messages::GearMotorMove, motor_hardware::MotorHardware>;
+    spsc_message_queue::SPSCMessageQueue, Client, motor_messages::GearMotorMove,
+    motor_hardware::MotorHardware>;
 
 template <PipetteType P>
 auto get_interrupt_queues()
@@ -84,11 +84,11 @@ namespace linear_motor {
 auto get_interrupt(motor_hardware::MotorHardware& hw,
                    LowThroughputInterruptQueues& queues,
                    stall_check::StallCheck& stall)
-    -> MotorInterruptHandlerType<linear_motor_tasks::QueueClient>;
+    -> MotorInterruptHandlerType<linear_motor_tasks::MoveStatusEventLog>;
 auto get_interrupt(motor_hardware::MotorHardware& hw,
                    HighThroughputInterruptQueues& queues,
                    stall_check::StallCheck& stall)
-    -> MotorInterruptHandlerType<linear_motor_tasks::QueueClient>;
+    -> MotorInterruptHandlerType<linear_motor_tasks::MoveStatusEventLog>;
 auto get_motor_hardware(motor_hardware::HardwareConfig pins)
     -> motor_hardware::MotorHardware;
 auto get_motion_control(motor_hardware::MotorHardware& hw,
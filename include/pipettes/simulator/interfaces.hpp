@@ -16,19 +16,18 @@ template <typename Client>
 using MotorInterruptHandlerType =
 #ifdef USE_SENSOR_MOVE
     motor_handler::MotorInterruptHandler<
-        freertos_message_queue::FreeRTOSMessageQueue, Client,
+        spsc_message_queue::SPSCMessageQueue, Client,
         motor_messages::SensorSyncMove,
         sim_motor_hardware_iface::SimMotorHardwareIface>;
 #else
     motor_handler::MotorInterruptHandler<
-        freertos_message_queue::FreeRTOSMessageQueue, Client,
+        spsc_message_queue::SPSCMessageQueue, Client,
         motor_messages::Move, sim_motor_hardware_iface::SimMotorHardwareIface>;
 #endif
 
 template <typename Client>
 using GearMotorInterruptHandlerType = motor_handler::MotorInterruptHandler<
-    freertos_message_queue::FreeRTOSMessageQueue, Client,
-    motor_messages::GearMotorMove,
+    spsc_message_queue::SPSCMessageQueue, Client, motor_messages::GearMotorMove,
     sim_motor_hardware_iface::SimGearMotorHardwareIface>;
 
 template <PipetteType P>
@@ -71,38 +70,44 @@ namespace linear_motor {
 auto get_interrupt(sim_motor_hardware_iface::SimMotorHardwareIface& hw,
                    LowThroughputInterruptQueues& queues,
                    stall_check::StallCheck& stall)
-    -> MotorInterruptHandlerType<linear_motor_tasks::QueueClient>;
+    -> MotorInterruptHandlerType<linear_motor_tasks::MoveStatusEventLog>;
 
 auto get_interrupt(sim_motor_hardware_iface::SimMotorHardwareIface& hw,
                    HighThroughputInterruptQueues& queues,
                    stall_check::StallCheck& stall)
-    -> MotorInterruptHandlerType<linear_motor_tasks::QueueClient>;
+    -> MotorInterruptHandlerType<linear_motor_tasks::MoveStatusEventLog>;
 
 auto get_interrupt_driver(
     sim_motor_hardware_iface::SimMotorHardwareIface& hw,
     LowThroughputInterruptQueues& queues,
-    MotorInterruptHandlerType<linear_motor_tasks::QueueClient>& handler) ->
+    MotorInterruptHandlerType<linear_motor_tasks::MoveStatusEventLog>&
+        handler) ->
 #ifdef USE_SENSOR_MOVE
     motor_interrupt_driver::MotorInterruptDriver<
-        linear_motor_tasks::QueueClient, motor_messages::SensorSyncMove,
+        spsc_message_queue::SPSCMessageQueue,
+        linear_motor_tasks::MoveStatusEventLog, motor_messages::SensorSyncMove,
         sim_motor_hardware_iface::SimMotorHardwareIface>;
 #else
     motor_interrupt_driver::MotorInterruptDriver<
-        linear_motor_tasks::QueueClient, motor_messages::Move,
+        spsc_message_queue::SPSCMessageQueue,
+        linear_motor_tasks::MoveStatusEventLog, motor_messages::Move,
         sim_motor_hardware_iface::SimMotorHardwareIface>;
 #endif
 
 auto get_interrupt_driver(
     sim_motor_hardware_iface::SimMotorHardwareIface& hw,
     HighThroughputInterruptQueues& queues,
-    MotorInterruptHandlerType<linear_motor_tasks::QueueClient>& handler) ->
+    MotorInterruptHandlerType<linear_motor_tasks::MoveStatusEventLog>&
+        handler) ->
 #ifdef USE_SENSOR_MOVE
     motor_interrupt_driver::MotorInterruptDriver<
-        linear_motor_tasks::QueueClient, motor_messages::SensorSyncMove,
+        spsc_message_queue::SPSCMessageQueue,
+        linear_motor_tasks::MoveStatusEventLog, motor_messages::SensorSyncMove,
         sim_motor_hardware_iface::SimMotorHardwareIface>;
 #else
     motor_interrupt_driver::MotorInterruptDriver<
-        linear_motor_tasks::QueueClient, motor_messages::Move,
+        spsc_message_queue::SPSCMessageQueue,
+        linear_motor_tasks::MoveStatusEventLog, motor_messages::Move,
         sim_motor_hardware_iface::SimMotorHardwareIface>;
 #endif
 
@@ -126,11 +131,13 @@ struct GearInterruptHandlers {
 
 struct GearInterruptDrivers {
     motor_interrupt_driver::MotorInterruptDriver<
-        gear_motor_tasks::QueueClient, motor_messages::GearMotorMove,
+        spsc_message_queue::SPSCMessageQueue, gear_motor_tasks::QueueClient,
+        motor_messages::GearMotorMove,
         sim_motor_hardware_iface::SimGearMotorHardwareIface>
         left;
     motor_interrupt_driver::MotorInterruptDriver<
-        gear_motor_tasks::QueueClient, motor_messages::GearMotorMove,
+        spsc_message_queue::SPSCMessageQueue, gear_motor_tasks::QueueClient,
+        motor_messages::GearMotorMove,
         sim_motor_hardware_iface::SimGearMotorHardwareIface>
         right;
 };
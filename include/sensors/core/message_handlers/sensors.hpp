@@ -63,6 +63,11 @@ class SensorHandler {
         }
     }
 
+    void visit(const can::messages::SensorStreamRequest &m) {
+        send_to_queue(can::ids::SensorType(m.sensor),
+                      can::ids::SensorId(m.sensor_id), m);
+    }
+
     void visit(const can::messages::BindSensorOutputRequest &m) {
         send_to_queue(can::ids::SensorType(m.sensor),
                       can::ids::SensorId(m.sensor_id), m);
@@ -2,6 +2,9 @@
 // TODO (lc 02-16-2022) We should refactor the fixed point
 // helper functions such that they live in a shared location.
 
+#include <cmath>
+#include <cstdint>
+
 #include "motor-control/core/utils.hpp"
 /*
  * MMR920 Pressure Sensor
@@ -289,19 +292,87 @@ struct PressureResult {
         return 1e-5 * CMH20_TO_PASCALS;  // 1.0e-5cmH2O/count * 98.0665Pa/cmH2O
     }
 
-    [[nodiscard]] static auto to_pressure(uint32_t reg, SensorVersion version)
-        -> float {
-        // Pressure is converted to pascals
+    // The range of a sign extended 24 bit reading
+    static constexpr int32_t MIN_COUNTS = -(1 << 23);
+    static constexpr int32_t MAX_COUNTS = (1 << 23) - 1;
+
+    [[nodiscard]] static auto to_counts(uint32_t reg) -> int32_t {
         // Sign extend pressure result
         if ((reg & 0x00800000) != 0) {
             reg |= 0xFF000000;
         } else {
             reg &= 0x007FFFFF;
         }
+        return static_cast<int32_t>(reg);
+    }
+
+    [[nodiscard]] static auto counts_to_pressure(int32_t counts,
+                                                 SensorVersion version)
+        -> float {
+        return static_cast<float>(counts) * get_pa_per_count(version);
+    }
+
+    [[nodiscard]] static auto to_pressure(uint32_t reg, SensorVersion version)
+        -> float {
+        // Pressure is converted to pascals
+        return counts_to_pressure(to_counts(reg), version);
+    }
+};
+
+/**
+ * The band of raw pressure counts a reading stays inside while a float
+ * threshold check on it does not trip. The band is worked out once from
+ * the float check when the threshold or baseline changes, so a reading is
+ * checked with two integer compares and gets the same answer the float
+ * check would have given.
+ */
+struct ThresholdWindow {
+    int32_t lower = PressureResult::MIN_COUNTS;
+    int32_t upper = PressureResult::MAX_COUNTS;
 
-        float pressure = static_cast<float>(static_cast<int32_t>(reg)) *
-                         get_pa_per_count(version);
-        return pressure;
+    [[nodiscard]] auto outside(int32_t counts) const -> bool {
+        return counts < lower || counts > upper;
+    }
+
+    /**
+     * Build the window for a float check.
+     *
+     * @param offset Maps counts to the value the check is made on, e.g.
+     * the pressure less the baseline. It must never decrease as the counts
+     * go up.
+     * @param tripped The check, which must trip for every value at or
+     * beyond some point on each side of zero and for no other value, e.g.
+     * std::fabs(value) > threshold.
+     */
+    template <typename Offset, typename Tripped>
+    static auto from(Offset&& offset, Tripped&& tripped) -> ThresholdWindow {
+        constexpr auto end = PressureResult::MAX_COUNTS + 1;
+        auto zero = first_of(PressureResult::MIN_COUNTS, end, [&](int32_t c) {
+            return offset(c) >= 0;
+        });
+        auto high =
+            first_of(zero, end, [&](int32_t c) { return tripped(offset(c)); });
+        auto low = first_of(PressureResult::MIN_COUNTS, zero, [&](int32_t c) {
+            return !tripped(offset(c));
+        });
+        return ThresholdWindow{.lower = low, .upper = high - 1};
+    }
+
+  private:
+    // The first count in [first, last) that pred holds for, or last if there
+    // is none. pred must not go from true back to false.
+    template <typename Pred>
+    static auto first_of(int32_t first, int32_t last, Pred&& pred)
+        -> int32_t {
+        while (first < last) {
+            auto middle = first + (last - first) / 2;
+            if (pred(middle)) {
+                last = middle;
+            } else {
+                first = middle + 1;
+            }
+        }
+        return first;
     }
 };
 
@@ -4,6 +4,7 @@
 #include <optional>
 
 #include "can/core/ids.hpp"
+#include "common/core/sample_stamps.hpp"
 #include "common/firmware/gpio.hpp"
 #include "sensors/core/utils.hpp"
 
@@ -124,6 +125,15 @@ class SensorHardwareVersionSingleton {
     utils::SensorBoardRev b_revision = utils::SensorBoardRev::VERSION_0;
 };
 
+/**
+ * Where a board gets the stamps of logged samples from: a monotonic tick
+ * and the step tracker of the motor the sensor moves with.
+ */
+struct SampleStampSource {
+    uint32_t (*tick)() = nullptr;
+    uint32_t (*step_position)() = nullptr;
+};
+
 /** abstract sensor hardware device for a sync line */
 class SensorHardwareBase {
   public:
@@ -183,9 +193,29 @@ class SensorHardwareBase {
         return version_wrapper.get_board_rev();
     }
 
+    void set_sample_stamp_source(SampleStampSource source) {
+        stamp_source = source;
+    }
+
+    /**
+     * The stamp for a sample taken now, or nothing if this board has no
+     * stamp source.
+     */
+    [[nodiscard]] auto get_sample_stamp() const
+        -> std::optional<sample_stamps::SampleStamp> {
+        if (stamp_source.tick == nullptr ||
+            stamp_source.step_position == nullptr) {
+            return std::nullopt;
+        }
+        return sample_stamps::SampleStamp{
+            .tick = stamp_source.tick(),
+            .step_position = stamp_source.step_position()};
+    }
+
   private:
     SensorHardwareVersionSingleton& version_wrapper;
     SensorHardwareSyncControlSingleton& sync_control;
+    SampleStampSource stamp_source{};
 };
 
 struct SensorHardwareContainer {
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include "can/core/ids.hpp"
+#include "can/core/messages.hpp"
+#include "common/core/delta_encoding.hpp"
+
+namespace sensors {
+
+namespace stream {
+
+/**
+ * Bookkeeping for a sensor that sends its samples as SensorStreamData
+ * frames. The owner keeps the samples; this numbers the frames and the
+ * samples in them and packs the samples into a frame.
+ *
+ * Samples go out as whole counts of the stream's scale rather than in
+ * S15Q16, so a reading that moves by one count of the sensor moves the
+ * encoded sample by one and its delta stays a single byte.
+ */
+class SensorStream {
+  public:
+    // The most samples one frame can say it holds.
+    static constexpr std::size_t max_samples = UINT8_MAX;
+
+    // Any this many samples fit in a frame, however far apart they are.
+    static constexpr std::size_t min_samples =
+        can::messages::SENSOR_STREAM_MAX_BYTES /
+        delta_encoding::max_varint_size;
+
+    /**
+     * The scale of a sensor whose readings change by units_per_count.
+     */
+    static auto scale_of(float units_per_count) -> uint32_t {
+        return static_cast<uint32_t>(std::lround(std::ldexp(
+            units_per_count, can::messages::SENSOR_STREAM_SCALE_RADIX)));
+    }
+
+    /**
+     * @param new_scale The size of a count in sensor units, with
+     * SENSOR_STREAM_SCALE_RADIX fractional bits
+     */
+    void set_mode(can::ids::SensorStreamMode new_mode, uint32_t new_scale) {
+        mode = new_mode;
+        scale = (new_scale == 0) ? s15q16_scale : new_scale;
+        restart();
+    }
+
+    [[nodiscard]] auto get_mode() const -> can::ids::SensorStreamMode {
+        return mode;
+    }
+
+    [[nodiscard]] auto get_scale() const -> uint32_t { return scale; }
+
+    /** The nearest whole number of counts to an S15Q16 sample. */
+    [[nodiscard]] auto to_counts(int32_t sample) const -> int32_t {
+        auto scaled = static_cast<int64_t>(sample) * (int64_t{1} << shift);
+        auto half = static_cast<int64_t>(scale / 2);
+        return static_cast<int32_t>(
+            (scaled + ((scaled < 0) ? -half : half)) /
+            static_cast<int64_t>(scale));
+    }
+
+    [[nodiscard]] auto streaming() const -> bool {
+        return mode == can::ids::SensorStreamMode::delta;
+    }
+
+    /** Start counting frames and samples from zero again. */
+    void restart() {
+        sequence = 0;
+        next_sample = 0;
+    }
+
+    /** Count samples that were thrown away before they were sent. */
+    void dropped(std::size_t count) { next_sample += count; }
+
+    /**
+     * Pack as many of the waiting samples as fit into a frame.
+     *
+     * @param frame The frame to fill
+     * @param available The number of samples waiting
+     * @param sample Called with i to get the i-th waiting sample in S15Q16;
+     * it goes into the frame as counts of the scale
+     * @return True if the frame has no room for another sample.
+     */
+    template <typename Sample>
+    auto fill(can::messages::SensorStreamData& frame, std::size_t available,
+              Sample&& sample) const -> bool {
+        auto encoder = delta_encoding::DeltaEncoder(frame.data.begin(),
+                                                    frame.data.end());
+        auto full = false;
+        for (std::size_t i = 0; i < available; ++i) {
+            if (encoder.count() == max_samples ||
+                !encoder.add(to_counts(static_cast<int32_t>(sample(i))))) {
+                full = true;
+                break;
+            }
+        }
+        frame.sequence = sequence;
+        frame.first_sample = next_sample;
+        frame.sample_count = static_cast<uint8_t>(encoder.count());
+        frame.data_length = static_cast<uint8_t>(encoder.size());
+        return full || encoder.count() == max_samples;
+    }
+
+    /** Note that a frame made by fill was queued. */
+    void sent(const can::messages::SensorStreamData& frame) {
+        ++sequence;
+        next_sample += frame.sample_count;
+    }
+
+  private:
+    // S15Q16 samples have 16 fractional bits
+    static constexpr int shift = can::messages::SENSOR_STREAM_SCALE_RADIX - 16;
+    // the scale that leaves an S15Q16 sample as it is
+    static constexpr uint32_t s15q16_scale = uint32_t{1} << shift;
+
+    can::ids::SensorStreamMode mode = can::ids::SensorStreamMode::batch;
+    uint32_t scale = s15q16_scale;
+    uint16_t sequence = 0;
+    uint32_t next_sample = 0;
+};
+
+}  // namespace stream
+
+}  // namespace sensors
@@ -13,6 +13,7 @@
 #include "i2c/core/messages.hpp"
 #include "sensors/core/fdc1004.hpp"
 #include "sensors/core/sensor_hardware_interface.hpp"
+#include "sensors/core/sensor_stream.hpp"
 #include "sensors/core/utils.hpp"
 
 namespace sensors {
@@ -29,7 +30,7 @@ class FDC1004 {
             CanClient &can_client, OwnQueue &own_queue,
             sensors::hardware::SensorHardwareBase &hardware,
             bool using_both_sensors,
-            std::array<float, SENSOR_BUFFER_SIZE> *sensor_buffer)
+            SensorBuffer *sensor_buffer)
         : writer(writer),
           poller(poller),
           can_client(can_client),
@@ -90,11 +91,48 @@ class FDC1004 {
     void set_echoing(bool should_echo) {
         echoing = should_echo;
         if (should_echo) {
-            sensor_buffer_index_start = 0;  // reset buffer index
-            sensor_buffer_index_end = 0;    // reset buffer index
+            sensor_buffer->clear();
+            stream.restart();
         }
     }
 
+    /**
+     * Streamed samples are stamped with their tick and the others are not,
+     * so waiting samples are dropped when the mode changes.
+     */
+    void set_stream_mode(can::ids::SensorStreamMode mode,
+                         uint32_t message_index) {
+        if (mode != stream.get_mode()) {
+            sensor_buffer->clear();
+        }
+        stream.set_mode(mode, stream::SensorStream::scale_of(
+                                  fdc1004_utils::MAX_MEASUREMENT_PF /
+                                  fdc1004_utils::MAX_RAW_MEASUREMENT));
+        can_client.send_can_message(
+            can::ids::NodeId::host,
+            can::messages::SensorStreamResponse{
+                .message_index = message_index,
+                .sensor = can::ids::SensorType::capacitive,
+                .sensor_id = sensor_id,
+                .mode = stream.get_mode(),
+                .sample_period_us = static_cast<uint16_t>(DELAY * 1000),
+                .scale = stream.get_scale()});
+    }
+
+    /**
+     * Stamp each logged sample with the tick and the motor position it was
+     * taken at, if this board has a stamp source. Waiting samples are
+     * dropped when this changes so that every sample or none has a stamp.
+     */
+    void set_stamping(bool should_stamp) {
+        should_stamp = should_stamp && hardware.get_sample_stamp().has_value();
+        if (should_stamp != stamping) {
+            sensor_buffer->clear();
+            stream.restart();
+        }
+        stamping = should_stamp;
+    }
+
     void set_bind_sync(bool should_bind) {
         bind_sync = should_bind;
         hardware.set_sync_enabled(sensor_id, should_bind);
@@ -211,7 +249,12 @@ class FDC1004 {
 
     void send_accumulated_sensor_data(uint32_t message_index) {
         while (get_buffer_count() > 0) {
-            try_send_next_chunk(message_index);
+            if (!stream.streaming()) {
+                try_send_next_chunk(message_index);
+            } else if (!try_send_stream_frame(message_index, false)) {
+                // if the queue is full release the task for bit
+                vtask_hardware_delay(20);
+            }
         }
         can_client.send_can_message(
             can::ids::NodeId::host,
@@ -219,60 +262,108 @@ class FDC1004 {
     }
 
     auto sensor_buffer_log(float data) -> void {
-        sensor_buffer->at(sensor_buffer_index_end) = data;
-        sensor_buffer_index_end++;
-        if (sensor_buffer_index_end == SENSOR_BUFFER_SIZE) {
-            sensor_buffer_index_end = 0;
-            crossed_buffer_index = true;
+        if (sensor_buffer->full()) {
+            // this task is both ends of the ring, so it makes room for the
+            // newest sample by dropping the oldest itself
+            sensor_buffer->consume(1);
+            stream.dropped(1);
         }
-        if (sensor_buffer_index_end == sensor_buffer_index_start) {
-            sensor_buffer_index_start =
-                (sensor_buffer_index_end + 1) % SENSOR_BUFFER_SIZE;
+        static_cast<void>(
+            sensor_buffer->push(convert_to_fixed_point(data, S15Q16_RADIX)));
+        if (stamping || stream.streaming()) {
+            // stream frames need the tick of their first sample even on a
+            // board with no stamp source
+            auto stamp = hardware.get_sample_stamp().value_or(
+                sample_stamps::SampleStamp{.tick = hardware_tick_count()});
+            static_cast<void>(sensor_buffer->stamps.push(stamp));
         }
     }
 
     auto get_buffer_count() -> uint16_t {
-        auto count = sensor_buffer_index_end;
-        if (sensor_buffer_index_end < sensor_buffer_index_start) {
-            count += (SENSOR_BUFFER_SIZE - sensor_buffer_index_start);
-        } else {
-            count -= sensor_buffer_index_start;
-        }
-        return count;
+        return static_cast<uint16_t>(sensor_buffer->size());
     }
 
     auto try_send_next_chunk(uint32_t message_index) -> void {
-        std::array<int32_t, can::messages::BATCH_SENSOR_MAX_LEN> data{};
-        auto count = get_buffer_count();
-        auto data_len = std::min(uint8_t(count),
-                                 uint8_t(can::messages::BATCH_SENSOR_MAX_LEN));
-        if (data_len == 0) {
-            return;
-        }
-        for (uint8_t i = 0; i < data_len; i++) {
-            data.at(i) = convert_to_fixed_point(
-                (*sensor_buffer)
-                    .at((sensor_buffer_index_start + i) % SENSOR_BUFFER_SIZE),
-                S15Q16_RADIX);
-        }
         auto response = can::messages::BatchReadFromSensorResponse{
             .message_index = message_index,
             .sensor = can::ids::SensorType::capacitive,
             .sensor_id = sensor_id,
-            .data_length = data_len,
-            .sensor_data = data,
         };
+        auto count = sensor_buffer->copy(response.sensor_data);
+        if (stamping) {
+            // end the batch before a gap too long for its stamps to hold
+            count = sensor_buffer->stamps.run(count, UINT8_MAX);
+        }
+        response.data_length = static_cast<uint8_t>(count);
+        if (response.data_length == 0) {
+            return;
+        }
         if (can_client.send_can_message(can::ids::NodeId::host, response)) {
+            if (stamping) {
+                send_sample_stamps(message_index, response.data_length);
+            }
             // if we succesfully queue the can message, mark that data as sent
-            // by incrementing the buffer start pointer
-            sensor_buffer_index_start =
-                (sensor_buffer_index_start + data_len) % SENSOR_BUFFER_SIZE;
+            // by dropping it from the buffer
+            sensor_buffer->consume(response.data_length);
         } else {
             // if the queue is full release the task for bit
             vtask_hardware_delay(20);
         }
     }
 
+    /**
+     * Send the stamps of the oldest samples, which have just been sent in a
+     * BatchReadFromSensorResponse.
+     */
+    auto send_sample_stamps(uint32_t message_index, uint8_t count) -> void {
+        const auto &stamps = sensor_buffer->stamps;
+        auto response = can::messages::BatchSensorStampsResponse{
+            .message_index = message_index,
+            .sensor = can::ids::SensorType::capacitive,
+            .sensor_id = sensor_id,
+            .data_length = count,
+            .first_tick = stamps.oldest().tick,
+            .first_step_position = stamps.oldest().step_position};
+        for (std::size_t i = 1; i < count; i++) {
+            response.tick_deltas.at(i - 1) =
+                static_cast<uint8_t>(stamps[i].ticks);
+            response.step_deltas.at(i - 1) = stamps[i].steps;
+        }
+        static_cast<void>(
+            can_client.send_can_message(can::ids::NodeId::host, response));
+    }
+
+    /**
+     * Queue a SensorStreamData frame of the oldest samples in the buffer.
+     *
+     * @param only_if_full Don't send a frame that has room for more samples
+     * @return True if there was nothing to send or the frame was queued.
+     */
+    auto try_send_stream_frame(uint32_t message_index, bool only_if_full)
+        -> bool {
+        auto count = get_buffer_count();
+        if (count == 0) {
+            return true;
+        }
+        auto frame = can::messages::SensorStreamData{
+            .message_index = message_index,
+            .sensor = can::ids::SensorType::capacitive,
+            .sensor_id = sensor_id,
+            .first_tick = sensor_buffer->stamps.oldest().tick};
+        auto full = stream.fill(frame, count, [this](std::size_t i) {
+            return (*sensor_buffer)[i];
+        });
+        if (only_if_full && !full) {
+            return true;
+        }
+        if (!can_client.send_can_message(can::ids::NodeId::host, frame)) {
+            return false;
+        }
+        sensor_buffer->consume(frame.sample_count);
+        stream.sent(frame);
+        return true;
+    }
+
     void handle_fdc_response(i2c::messages::TransactionResponse &m) {
         uint16_t reg_int = 0;
         static_cast<void>(bit_utils::bytes_to_int(
@@ -341,7 +432,14 @@ class FDC1004 {
 
         if (echoing) {
             sensor_buffer_log(capacitance);
-            if (get_buffer_count() >= can::messages::BATCH_SENSOR_MAX_LEN) {
+            if (stream.streaming()) {
+                // never wait on the can queue here; samples that can't be
+                // sent yet stay in the buffer until the next reading
+                if (get_buffer_count() > stream::SensorStream::min_samples) {
+                    static_cast<void>(try_send_stream_frame(0, true));
+                }
+            } else if (get_buffer_count() >=
+                       can::messages::BATCH_SENSOR_MAX_LEN) {
                 try_send_next_chunk(0);
             }
         }
@@ -562,10 +660,9 @@ class FDC1004 {
         // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
         return RG(*reinterpret_cast<Reg *>(&ret.value()));
     }
-    std::array<float, SENSOR_BUFFER_SIZE> *sensor_buffer;
-    uint16_t sensor_buffer_index_start = 0;
-    uint16_t sensor_buffer_index_end = 0;
-    bool crossed_buffer_index = false;
+    SensorBuffer *sensor_buffer;
+    stream::SensorStream stream{};
+    bool stamping = false;
 
 };  // end of FDC1004 class
 
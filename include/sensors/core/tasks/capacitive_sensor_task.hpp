@@ -23,7 +23,7 @@ class CapacitiveMessageHandler {
         I2CQueueWriter &i2c_writer, I2CQueuePoller &i2c_poller,
         sensors::hardware::SensorHardwareBase &hardware, CanClient &can_client,
         OwnQueue &own_queue, bool shared_task,
-        std::array<float, SENSOR_BUFFER_SIZE> *sensor_buffer)
+        SensorBuffer *sensor_buffer)
         : driver{i2c_writer, i2c_poller,  can_client,   own_queue,
                  hardware,   shared_task, sensor_buffer} {}
     CapacitiveMessageHandler(const CapacitiveMessageHandler &) = delete;
@@ -44,6 +44,10 @@ class CapacitiveMessageHandler {
     void visit(std::monostate &) {}
 
     void visit(i2c::messages::TransactionResponse &m) {
+        if (m.poll_rejected) {
+            LOG("capacitive sensor poll rejected: the i2c poller is full");
+            return;
+        }
         auto reg_id = utils::reg_from_id<uint8_t>(m.id.token);
         if (reg_id == static_cast<uint8_t>(fdc1004::Registers::FDC_CONF)) {
             driver.handle_fdc_response(m);
@@ -72,6 +76,11 @@ class CapacitiveMessageHandler {
         driver.send_accumulated_sensor_data(m.message_index);
     }
 
+    void visit(const can::messages::SensorStreamRequest &m) {
+        LOG("Received request to set capacitive stream mode %d", m.mode);
+        driver.set_stream_mode(m.mode, m.message_index);
+    }
+
     void visit(can::messages::ReadFromSensorRequest &m) {
         /**
          * The FDC1004 sensor has an offset register and
@@ -158,6 +167,9 @@ class CapacitiveMessageHandler {
         driver.set_echoing(
             m.binding &
             static_cast<uint8_t>(can::ids::SensorOutputBinding::report));
+        driver.set_stamping(
+            m.binding &
+            static_cast<uint8_t>(can::ids::SensorOutputBinding::stamp_samples));
         driver.set_bind_sync(
             m.binding &
             static_cast<uint8_t>(can::ids::SensorOutputBinding::sync));
@@ -217,7 +229,7 @@ class CapacitiveSensorTask {
         i2c::writer::Writer<QueueImpl> *writer,
         i2c::poller::Poller<QueueImpl> *poller,
         sensors::hardware::SensorHardwareBase *hardware, CanClient *can_client,
-        std::array<float, SENSOR_BUFFER_SIZE> *sensor_buffer,
+        SensorBuffer *sensor_buffer,
         bool shared_task = false) {
         // On the 8 channel, there is a singular cap sensor but we're using
         // multiple channels. We will thus rely on the sensor id in this case
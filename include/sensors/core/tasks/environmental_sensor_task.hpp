@@ -51,6 +51,10 @@ class EnvironmentSensorMessageHandler {
     void visit(const std::monostate &) {}
 
     void visit(const i2c::messages::TransactionResponse &m) {
+        if (m.poll_rejected) {
+            LOG("environment sensor poll rejected: the i2c poller is full");
+            return;
+        }
         driver.handle_response(m);
     }
 
@@ -85,6 +89,10 @@ class EnvironmentSensorMessageHandler {
         std::ignore = m;
     }
 
+    void visit(const can::messages::SensorStreamRequest &m) {
+        std::ignore = m;
+    }
+
     void visit(const can::messages::BindSensorOutputRequest &m) {
         LOG("Received bind sensor output request from %d sensor", m.sensor);
         // sync doesn't quite mean the same thing here for us. We should
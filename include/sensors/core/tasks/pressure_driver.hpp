@@ -1,7 +1,6 @@
 #pragma once
 
 #include <cmath>
-#include <numeric>
 
 #include "can/core/can_writer_task.hpp"
 #include "can/core/ids.hpp"
@@ -15,6 +14,7 @@
 #include "motor-control/core/tasks/usage_storage_task.hpp"
 #include "sensors/core/mmr920.hpp"
 #include "sensors/core/sensor_hardware_interface.hpp"
+#include "sensors/core/sensor_stream.hpp"
 #include "sensors/core/sensors.hpp"
 #include "sensors/core/utils.hpp"
 
@@ -44,7 +44,7 @@ class MMR920 {
            CanClient &can_client, OwnQueue &own_queue,
            sensors::hardware::SensorHardwareBase &hardware,
            const can::ids::SensorId &id,
-           std::array<float, SENSOR_BUFFER_SIZE> *sensor_buffer,
+           SensorBuffer *sensor_buffer,
            UsageClient &usage_client, uint16_t pres_err_key)
         : writer(writer),
           poller(poller),
@@ -76,18 +76,61 @@ class MMR920 {
     void set_echoing(bool should_echo) {
         echoing = should_echo;
         if (should_echo) {
-            sensor_buffer_index_start = 0;  // reset buffer index
-            sensor_buffer_index_end = 0;    // reset buffer index
-            crossed_buffer_index = false;
-            sensor_buffer->fill(0.0);
+            sensor_buffer->clear();
+            samples_logged = 0;
+            auto_baseline_total = 0;
+            stream.restart();
         }
     }
 
+    /**
+     * Streamed samples are stamped with their tick and the others are not,
+     * so waiting samples are dropped when the mode changes.
+     */
+    void set_stream_mode(can::ids::SensorStreamMode mode,
+                         uint32_t message_index) {
+        if (mode != stream.get_mode()) {
+            sensor_buffer->clear();
+        }
+        stream.set_mode(mode,
+                        stream::SensorStream::scale_of(
+                            mmr920::PressureResult::get_pa_per_count(
+                                sensor_version())));
+        auto period_ms =
+            MeasurementTimings[static_cast<int>(measurement_mode_rate)] +
+            DEFAULT_DELAY_BUFFER;
+        can_client.send_can_message(
+            can::ids::NodeId::host,
+            can::messages::SensorStreamResponse{
+                .message_index = message_index,
+                .sensor = SensorType::pressure,
+                .sensor_id = sensor_id,
+                .mode = stream.get_mode(),
+                .sample_period_us =
+                    static_cast<uint16_t>(std::lround(period_ms * 1000)),
+                .scale = stream.get_scale()});
+    }
+
     void set_auto_baseline_report(bool should_auto) {
         enable_auto_baseline = should_auto;
         // Always set this to 0, we want to clear it if disabled and
         // reset if if we haven't baselined yet
         current_moving_pressure_baseline_pa = 0.0;
+        threshold_windows_current = false;
+    }
+
+    /**
+     * Stamp each logged sample with the tick and the motor position it was
+     * taken at, if this board has a stamp source. Waiting samples are
+     * dropped when this changes so that every sample or none has a stamp.
+     */
+    void set_stamping(bool should_stamp) {
+        should_stamp = should_stamp && hardware.get_sample_stamp().has_value();
+        if (should_stamp != stamping) {
+            sensor_buffer->clear();
+            stream.restart();
+        }
+        stamping = should_stamp;
     }
 
     void set_bind_sync(bool should_bind) {
@@ -111,6 +154,7 @@ class MMR920 {
                        uint32_t message_index, bool send_threshold = true)
         -> void {
         threshold_pascals = threshold_pa;
+        threshold_windows_current = false;
         if (send_threshold) {
             auto message = can::messages::SensorThresholdResponse{
                 .message_index = message_index,
@@ -251,26 +295,26 @@ class MMR920 {
     }
 
     auto get_buffer_count() -> uint16_t {
-        auto count = sensor_buffer_index_end;
-        if (sensor_buffer_index_end < sensor_buffer_index_start) {
-            count += (SENSOR_BUFFER_SIZE - sensor_buffer_index_start);
-        } else {
-            count -= sensor_buffer_index_start;
-        }
-        return count;
+        return static_cast<uint16_t>(sensor_buffer->size());
     }
 
     auto sensor_buffer_log(float data) -> void {
-        sensor_buffer->at(sensor_buffer_index_end) = data;
-        sensor_buffer_index_end++;
-        if (sensor_buffer_index_end == SENSOR_BUFFER_SIZE) {
-            sensor_buffer_index_end = 0;
-            crossed_buffer_index = true;
+        if (sensor_buffer->full()) {
+            // this task is both ends of the ring, so it makes room for the
+            // newest sample by dropping the oldest itself
+            sensor_buffer->consume(1);
+            stream.dropped(1);
         }
-        if (sensor_buffer_index_end == sensor_buffer_index_start) {
-            sensor_buffer_index_start =
-                (sensor_buffer_index_end + 1) % SENSOR_BUFFER_SIZE;
+        static_cast<void>(
+            sensor_buffer->push(mmr920::reading_to_fixed_point(data)));
+        if (stamping || stream.streaming()) {
+            // stream frames need the tick of their first sample even on a
+            // board with no stamp source
+            auto stamp = hardware.get_sample_stamp().value_or(
+                sample_stamps::SampleStamp{.tick = hardware_tick_count()});
+            static_cast<void>(sensor_buffer->stamps.push(stamp));
         }
+        samples_logged++;
     }
 
     auto save_temperature(int32_t data) -> bool {
@@ -325,39 +369,94 @@ class MMR920 {
     }
 
     auto try_send_next_chunk(uint32_t message_index) -> void {
-        std::array<int32_t, can::messages::BATCH_SENSOR_MAX_LEN> data{};
-        auto count = get_buffer_count();
-        auto data_len = std::min(uint8_t(count),
-                                 uint8_t(can::messages::BATCH_SENSOR_MAX_LEN));
-        if (data_len == 0) {
-            return;
-        }
-        for (uint8_t i = 0; i < data_len; i++) {
-            data.at(i) = mmr920::reading_to_fixed_point(
-                (*sensor_buffer)
-                    .at((sensor_buffer_index_start + i) % SENSOR_BUFFER_SIZE));
-        }
         auto response = can::messages::BatchReadFromSensorResponse{
             .message_index = message_index,
             .sensor = can::ids::SensorType::pressure,
             .sensor_id = sensor_id,
-            .data_length = data_len,
-            .sensor_data = data,
         };
+        auto count = sensor_buffer->copy(response.sensor_data);
+        if (stamping) {
+            // end the batch before a gap too long for its stamps to hold
+            count = sensor_buffer->stamps.run(count, UINT8_MAX);
+        }
+        response.data_length = static_cast<uint8_t>(count);
+        if (response.data_length == 0) {
+            return;
+        }
         if (can_client.send_can_message(can::ids::NodeId::host, response)) {
+            if (stamping) {
+                send_sample_stamps(message_index, response.data_length);
+            }
             // if we succesfully queue the can message, mark that data as sent
-            // by incrementing the buffer start pointer
-            sensor_buffer_index_start =
-                (sensor_buffer_index_start + data_len) % SENSOR_BUFFER_SIZE;
+            // by dropping it from the buffer
+            sensor_buffer->consume(response.data_length);
         } else {
             // if the queue is full release the task for bit
             vtask_hardware_delay(20);
         }
     }
 
+    /**
+     * Send the stamps of the oldest samples, which have just been sent in a
+     * BatchReadFromSensorResponse.
+     */
+    auto send_sample_stamps(uint32_t message_index, uint8_t count) -> void {
+        const auto &stamps = sensor_buffer->stamps;
+        auto response = can::messages::BatchSensorStampsResponse{
+            .message_index = message_index,
+            .sensor = can::ids::SensorType::pressure,
+            .sensor_id = sensor_id,
+            .data_length = count,
+            .first_tick = stamps.oldest().tick,
+            .first_step_position = stamps.oldest().step_position};
+        for (std::size_t i = 1; i < count; i++) {
+            response.tick_deltas.at(i - 1) =
+                static_cast<uint8_t>(stamps[i].ticks);
+            response.step_deltas.at(i - 1) = stamps[i].steps;
+        }
+        static_cast<void>(
+            can_client.send_can_message(can::ids::NodeId::host, response));
+    }
+
+    /**
+     * Queue a SensorStreamData frame of the oldest samples in the buffer.
+     *
+     * @param only_if_full Don't send a frame that has room for more samples
+     * @return True if there was nothing to send or the frame was queued.
+     */
+    auto try_send_stream_frame(uint32_t message_index, bool only_if_full)
+        -> bool {
+        auto count = get_buffer_count();
+        if (count == 0) {
+            return true;
+        }
+        auto frame = can::messages::SensorStreamData{
+            .message_index = message_index,
+            .sensor = can::ids::SensorType::pressure,
+            .sensor_id = sensor_id,
+            .first_tick = sensor_buffer->stamps.oldest().tick};
+        auto full = stream.fill(frame, count, [this](std::size_t i) {
+            return (*sensor_buffer)[i];
+        });
+        if (only_if_full && !full) {
+            return true;
+        }
+        if (!can_client.send_can_message(can::ids::NodeId::host, frame)) {
+            return false;
+        }
+        sensor_buffer->consume(frame.sample_count);
+        stream.sent(frame);
+        return true;
+    }
+
     void send_accumulated_sensor_data(uint32_t message_index) {
         while (get_buffer_count() > 0) {
-            try_send_next_chunk(message_index);
+            if (!stream.streaming()) {
+                try_send_next_chunk(message_index);
+            } else if (!try_send_stream_frame(message_index, false)) {
+                // if the queue is full release the task for bit
+                vtask_hardware_delay(20);
+            }
         }
         can_client.send_can_message(
             can::ids::NodeId::host,
@@ -369,42 +468,62 @@ class MMR920 {
         // a BaselineSensorRequest is sent prior to a move using the
         // auto baseline. it works by taking several samples
         // at the beginning of the move but after noise has stopped.
-        // and we haven't crossed the circular buffer barrier yet) it
-        // then takes the average of those samples to create a new
+        // it then takes the average of those samples to create a new
         // baseline factor
         current_moving_pressure_baseline_pa =
-            std::accumulate(sensor_buffer->begin() + AUTO_BASELINE_START,
-                            sensor_buffer->begin() + AUTO_BASELINE_END, 0.0) /
+            auto_baseline_total /
             float(AUTO_BASELINE_END - AUTO_BASELINE_START);
-        for (auto i = sensor_buffer_index_end - AUTO_BASELINE_END;
-             i < sensor_buffer_index_end; i++) {
-            // apply the moving baseline to older samples to so that
-            // data is in the same format as later samples, don't apply
-            // the current_pressure_baseline_pa since it has already
-            // been applied
-            sensor_buffer->at(i) =
-                sensor_buffer->at(i) - current_moving_pressure_baseline_pa;
-        }
-    }
-
-    auto handle_sync_threshold(float pressure) -> void {
-        if (enable_auto_baseline) {
-            if ((sensor_buffer_index_end > AUTO_BASELINE_END ||
-                 crossed_buffer_index) &&
-                (std::fabs(pressure - current_pressure_baseline_pa -
-                           current_moving_pressure_baseline_pa) >
-                 threshold_pascals)) {
-                hardware.set_sync(sensor_id);
-            } else {
-                hardware.reset_sync(sensor_id);
-            }
+        // apply the moving baseline to the older samples that haven't been
+        // sent yet so that data is in the same format as later samples,
+        // don't apply the current_pressure_baseline_pa since it has already
+        // been applied
+        auto baseline_fixed_point =
+            mmr920::reading_to_fixed_point(current_moving_pressure_baseline_pa);
+        for (std::size_t i = 0; i < sensor_buffer->size(); i++) {
+            (*sensor_buffer)[i] -= baseline_fixed_point;
+        }
+        threshold_windows_current = false;
+    }
+
+    /**
+     * Work out the raw count windows for the sync and max pressure checks
+     * if the threshold, the baselines or the sensor version have changed
+     * since they were last worked out.
+     */
+    auto update_threshold_windows(mmr920::SensorVersion version) -> void {
+        if (threshold_windows_current && version == threshold_window_version) {
+            return;
+        }
+        auto baseline = current_pressure_baseline_pa;
+        auto moving_baseline =
+            enable_auto_baseline ? current_moving_pressure_baseline_pa : 0.0F;
+        auto threshold = threshold_pascals;
+        auto max_pressure = mmr920::get_max_pressure_reading(version);
+        sync_threshold_window = mmr920::ThresholdWindow::from(
+            [=](int32_t counts) {
+                return mmr920::PressureResult::counts_to_pressure(counts,
+                                                                  version) -
+                       baseline - moving_baseline;
+            },
+            [=](float offset) { return std::fabs(offset) > threshold; });
+        max_pressure_window = mmr920::ThresholdWindow::from(
+            [=](int32_t counts) {
+                return mmr920::PressureResult::counts_to_pressure(counts,
+                                                                  version) -
+                       baseline;
+            },
+            [=](float offset) { return std::fabs(offset) >= max_pressure; });
+        threshold_window_version = version;
+        threshold_windows_current = true;
+    }
+
+    auto handle_sync_threshold(int32_t pressure_counts) -> void {
+        if (enable_auto_baseline && samples_logged <= AUTO_BASELINE_END) {
+            hardware.reset_sync(sensor_id);
+        } else if (sync_threshold_window.outside(pressure_counts)) {
+            hardware.set_sync(sensor_id);
         } else {
-            if (std::fabs(pressure - current_pressure_baseline_pa) >
-                threshold_pascals) {
-                hardware.set_sync(sensor_id);
-            } else {
-                hardware.reset_sync(sensor_id);
-            }
+            hardware.reset_sync(sensor_id);
         }
     }
 
@@ -425,13 +544,14 @@ class MMR920 {
         uint32_t shifted_data_store = temporary_data_store >> 8;
 
         save_pressure(shifted_data_store);
-        auto pressure = mmr920::PressureResult::to_pressure(
-            _registers.pressure_result.reading, sensor_version());
+        auto version = sensor_version();
+        auto pressure_counts = mmr920::PressureResult::to_counts(
+            _registers.pressure_result.reading);
+        update_threshold_windows(version);
 
         if (max_pressure_sync) {
             bool this_tick_over_threshold =
-                std::fabs(pressure - current_pressure_baseline_pa) >=
-                mmr920::get_max_pressure_reading(sensor_version());
+                max_pressure_window.outside(pressure_counts);
             bool over_threshold = false;
             if (this_tick_over_threshold) {
                 max_pressure_consecutive_readings =
@@ -463,23 +583,35 @@ class MMR920 {
             }
         }
         if (bind_sync) {
-            handle_sync_threshold(pressure);
+            handle_sync_threshold(pressure_counts);
         }
 
         if (echo_this_time) {
+            auto pressure =
+                mmr920::PressureResult::counts_to_pressure(pressure_counts,
+                                                           version);
             auto response_pressure = pressure - current_pressure_baseline_pa;
             if (enable_auto_baseline) {
                 // apply moving baseline if using
                 response_pressure -= current_moving_pressure_baseline_pa;
             }
             sensor_buffer_log(response_pressure);
-            if (get_buffer_count() >= can::messages::BATCH_SENSOR_MAX_LEN) {
+            if (samples_logged > AUTO_BASELINE_START &&
+                samples_logged <= AUTO_BASELINE_END) {
+                auto_baseline_total += response_pressure;
+            }
+            if (stream.streaming()) {
+                // never wait on the can queue here; samples that can't be
+                // sent yet stay in the buffer until the next reading
+                if (get_buffer_count() > stream::SensorStream::min_samples) {
+                    static_cast<void>(try_send_stream_frame(0, true));
+                }
+            } else if (get_buffer_count() >=
+                       can::messages::BATCH_SENSOR_MAX_LEN) {
                 try_send_next_chunk(0);
             }
 
-            if (enable_auto_baseline &&
-                sensor_buffer_index_end == AUTO_BASELINE_END &&
-                !crossed_buffer_index) {
+            if (enable_auto_baseline && samples_logged == AUTO_BASELINE_END) {
                 compute_auto_baseline();
             }
         }
@@ -659,6 +791,14 @@ class MMR920 {
     float threshold_pascals = 100.0F;
     float offset_average = 0;
 
+    // the sync and max pressure checks in raw counts, see
+    // update_threshold_windows
+    mmr920::ThresholdWindow sync_threshold_window{};
+    mmr920::ThresholdWindow max_pressure_window{};
+    mmr920::SensorVersion threshold_window_version =
+        mmr920::SensorVersion::mmr920c04;
+    bool threshold_windows_current = false;
+
     uint32_t temporary_data_store = 0x0;
 
     template <mmr920::MMR920CommandRegister Reg>
@@ -678,10 +818,12 @@ class MMR920 {
         value &= Reg::value_mask;
         return write(Reg::address, value);
     }
-    std::array<float, SENSOR_BUFFER_SIZE> *sensor_buffer;
-    uint16_t sensor_buffer_index_start = 0;
-    uint16_t sensor_buffer_index_end = 0;
-    bool crossed_buffer_index = false;
+    SensorBuffer *sensor_buffer;
+    // samples logged since echoing was last turned on
+    uint32_t samples_logged = 0;
+    float auto_baseline_total = 0;
+    stream::SensorStream stream{};
+    bool stamping = false;
     UsageClient &usage_client;
     uint16_t pressure_error_key;
 };
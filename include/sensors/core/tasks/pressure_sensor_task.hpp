@@ -25,7 +25,7 @@ class PressureMessageHandler {
         CanClient &can_client, OwnQueue &own_queue,
         sensors::hardware::SensorHardwareBase &hardware,
         const can::ids::SensorId &id,
-        std::array<float, SENSOR_BUFFER_SIZE> *sensor_buffer,
+        SensorBuffer *sensor_buffer,
         UsageClient &usage_client, uint16_t pres_err_key)
         : driver{i2c_writer, i2c_poller,    can_client,   own_queue,   hardware,
                  id,         sensor_buffer, usage_client, pres_err_key},
@@ -55,6 +55,10 @@ class PressureMessageHandler {
     void visit(const std::monostate &) {}
 
     void visit(i2c::messages::TransactionResponse &m) {
+        if (m.poll_rejected) {
+            LOG("pressure sensor poll rejected: the i2c poller is full");
+            return;
+        }
         auto reg_id = utils::reg_from_id<mmr920::Registers>(m.id.token);
         if ((reg_id != mmr920::Registers::LOW_PASS_PRESSURE_READ) &&
             (reg_id != mmr920::Registers::PRESSURE_READ) &&
@@ -87,6 +91,11 @@ class PressureMessageHandler {
         driver.send_accumulated_sensor_data(m.message_index);
     }
 
+    void visit(const can::messages::SensorStreamRequest &m) {
+        LOG("Received request to set pressure stream mode %d", m.mode);
+        driver.set_stream_mode(m.mode, m.message_index);
+    }
+
     void visit(const can::messages::ReadFromSensorRequest &m) {
         LOG("Received request to read from %d sensor\n", m.sensor);
         driver.set_echoing(true);
@@ -144,6 +153,9 @@ class PressureMessageHandler {
         driver.set_echoing(
             m.binding &
             static_cast<uint8_t>(can::ids::SensorOutputBinding::report));
+        driver.set_stamping(
+            m.binding &
+            static_cast<uint8_t>(can::ids::SensorOutputBinding::stamp_samples));
         driver.set_multi_sensor_sync(
             m.binding & static_cast<uint8_t>(
                             can::ids::SensorOutputBinding::multi_sensor_sync));
@@ -226,7 +238,7 @@ class PressureSensorTask {
         i2c::writer::Writer<QueueImpl> *writer,
         i2c::poller::Poller<QueueImpl> *poller, CanClient *can_client,
         sensors::hardware::SensorHardwareBase *hardware,
-        std::array<float, SENSOR_BUFFER_SIZE> *sensor_buffer,
+        SensorBuffer *sensor_buffer,
         UsageClient *usage_client) {
         auto handler = PressureMessageHandler{
             *writer,   *poller,       *can_client,   get_queue(), *hardware,
@@ -26,7 +26,8 @@ using CanMessageTuple =
                can::messages::SetSensorThresholdRequest,
                can::messages::BindSensorOutputRequest,
                can::messages::PeripheralStatusRequest,
-               can::messages::MaxSensorValueRequest>;
+               can::messages::MaxSensorValueRequest,
+               can::messages::SensorStreamRequest>;
 using OtherTaskMessagesTuple = std::tuple<i2c::messages::TransactionResponse>;
 using CanMessageHandler = typename ::utils::TuplesToVariants<
     std::tuple<std::monostate, can::messages::TipStatusQueryRequest>,
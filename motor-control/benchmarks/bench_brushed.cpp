@@ -0,0 +1,112 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+
+#include "bench_rigs.hpp"
+#include "benchmarks.hpp"
+#include "common/core/freertos_message_queue.hpp"
+
+namespace {
+
+using namespace motor_messages;
+using Rig =
+    benchmarks::BrushedRig<freertos_message_queue::FreeRTOSMessageQueue>;
+
+constexpr uint32_t move_timeout_ticks = 5 * Rig::brushed_timer_frequency;
+
+template <typename Setup>
+auto run_profile(const char* name, const benchmarks::Options& options,
+                 Rig& rig, Setup&& setup) -> benchmarks::Summary {
+    auto sampler = benchmarks::Sampler{options.ticks};
+    for (uint32_t tick = 0; tick < options.ticks; ++tick) {
+        setup(tick);
+        sampler.time([&rig]() { rig.handler.run_interrupt(); });
+    }
+    return sampler.summarize(name);
+}
+
+// Jaw moves between two encoder positions under PID control, then holds
+// position between moves.
+auto position(const benchmarks::Options& options) -> benchmarks::Summary {
+    constexpr int32_t open_position = 61054;
+    constexpr int32_t pulses_per_tick = 8;
+    auto rig = Rig{};
+    uint32_t index = 0;
+    int32_t encoder = 0;
+    int32_t target = 0;
+    return run_profile("brushed/position", options, rig, [&](uint32_t) {
+        if (!rig.handler.has_active_move() && !rig.handler.has_messages()) {
+            target = (target == 0) ? open_position : 0;
+            std::ignore = rig.queue.try_write(BrushedMove{
+                .message_index = ++index,
+                .duration = move_timeout_ticks,
+                .duty_cycle = 0,
+                .group_id = 0,
+                .seq_id = 0,
+                .encoder_position = target,
+                .stop_condition = MoveStopCondition::encoder_position});
+        }
+        if (std::abs(target - encoder) < pulses_per_tick) {
+            encoder = target;
+        } else {
+            encoder += (target > encoder) ? pulses_per_tick : -pulses_per_tick;
+        }
+        rig.hw.set_encoder_value(encoder);
+    });
+}
+
+// The jaw closes on labware and the encoder goes idle, finishing the grip
+// and leaving the handler checking for a dropped labware.
+auto grip(const benchmarks::Options& options) -> benchmarks::Summary {
+    constexpr uint32_t ticks_to_contact = 4096;
+    constexpr uint32_t ticks_holding = 4096;
+    auto rig = Rig{};
+    uint32_t index = 0;
+    return run_profile("brushed/grip", options, rig, [&](uint32_t tick) {
+        auto phase = tick % (ticks_to_contact + ticks_holding);
+        if (phase == 0) {
+            std::ignore = rig.queue.try_write(
+                BrushedMove{.message_index = ++index,
+                            .duration = move_timeout_ticks,
+                            .duty_cycle = 50,
+                            .group_id = 0,
+                            .seq_id = 0,
+                            .stay_engaged = 1,
+                            .stop_condition = MoveStopCondition::none});
+        }
+        rig.handler.set_enc_idle_state(phase >= ticks_to_contact);
+        rig.hw.set_encoder_value(
+            static_cast<int32_t>(std::min(phase, ticks_to_contact)));
+    });
+}
+
+// Estop asserts during a move, holds, then releases.
+auto estop(const benchmarks::Options& options) -> benchmarks::Summary {
+    constexpr uint32_t ticks_running = 2048;
+    constexpr uint32_t ticks_in_estop = 512;
+    auto rig = Rig{};
+    uint32_t index = 0;
+    return run_profile("brushed/estop", options, rig, [&](uint32_t tick) {
+        auto phase = tick % (ticks_running + ticks_in_estop);
+        rig.hw.set_estop_in(phase >= ticks_running);
+        if (phase == 0) {
+            std::ignore = rig.queue.try_write(
+                BrushedMove{.message_index = ++index,
+                            .duration = move_timeout_ticks,
+                            .duty_cycle = 50,
+                            .group_id = 0,
+                            .seq_id = 0,
+                            .stay_engaged = 1,
+                            .stop_condition = MoveStopCondition::none});
+        }
+    });
+}
+
+}  // namespace
+
+void benchmarks::run_brushed_benchmarks(const Options& options,
+                                        Results& results) {
+    results.push_back(position(options));
+    results.push_back(grip(options));
+    results.push_back(estop(options));
+}
@@ -0,0 +1,45 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "benchmarks.hpp"
+
+/*
+ * Host benchmarks for motor-control. These run before the FreeRTOS scheduler
+ * is started, so the kernel queue calls made by the code under test take the
+ * same paths they would from an interrupt but without contending with other
+ * tasks.
+ *
+ * Usage: motor-control-benchmarks [--ticks N] [--json PATH]
+ */
+auto main(int argc, char** argv) -> int {
+    auto options = benchmarks::Options{};
+    const char* json_path = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--ticks") == 0 && i + 1 < argc) {
+            options.ticks = strtoul(argv[++i], nullptr, 0);
+        } else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            json_path = argv[++i];
+        } else {
+            fprintf(stderr, "usage: %s [--ticks N] [--json PATH]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (options.ticks == 0) {
+        fprintf(stderr, "--ticks must be greater than zero\n");
+        return 1;
+    }
+
+    auto results = benchmarks::Results{};
+    benchmarks::run_move_queue_benchmark(options, results);
+    benchmarks::run_stepper_profile_benchmarks(options, results);
+    benchmarks::run_stall_check_benchmarks(options, results);
+    benchmarks::run_brushed_benchmarks(options, results);
+
+    benchmarks::print_results(results);
+    if (json_path != nullptr && !benchmarks::write_json(results, json_path)) {
+        fprintf(stderr, "could not write %s\n", json_path);
+        return 1;
+    }
+    return 0;
+}
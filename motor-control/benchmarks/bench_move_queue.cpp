@@ -0,0 +1,54 @@
+#include <cstdint>
+
+#include "bench_rigs.hpp"
+#include "benchmarks.hpp"
+#include "common/core/freertos_message_queue.hpp"
+#include "common/core/spsc_message_queue.hpp"
+
+namespace {
+
+using namespace motor_messages;
+
+// Short moves mean the handler goes back to the queue often, which is the
+// behavior the queue choice matters for.
+constexpr uint32_t ticks_per_move = 8;
+
+template <template <class> class QueueImpl>
+auto run(const char* name, const benchmarks::Options& options)
+    -> benchmarks::Summary {
+    auto rig = benchmarks::StepperRig<QueueImpl>{};
+    auto sampler = benchmarks::Sampler{options.ticks};
+    uint32_t index = 0;
+    auto next_move = [&index]() {
+        ++index;
+        return Move{.message_index = index,
+                    .duration = ticks_per_move,
+                    .velocity = 1 << 30,
+                    .acceleration = 0,
+                    .group_id = 0,
+                    .seq_id = static_cast<uint8_t>(index),
+                    .start_encoder_position = 0,
+                    .usage_key = 0};
+    };
+    rig.top_up(next_move);
+    for (uint32_t tick = 0; tick < options.ticks; ++tick) {
+        sampler.time([&rig]() { rig.handler.run_interrupt(); });
+        // The motion controller refills far less often than the interrupt
+        // fires; refilling once per move keeps the queue from running dry
+        // without timing the producer side.
+        if (tick % ticks_per_move == 0) {
+            rig.top_up(next_move);
+        }
+    }
+    return sampler.summarize(name);
+}
+
+}  // namespace
+
+void benchmarks::run_move_queue_benchmark(const Options& options,
+                                          Results& results) {
+    results.push_back(run<freertos_message_queue::FreeRTOSMessageQueue>(
+        "move_queue/freertos", options));
+    results.push_back(
+        run<spsc_message_queue::SPSCMessageQueue>("move_queue/spsc", options));
+}
@@ -0,0 +1,35 @@
+#include <cstdio>
+
+#include "benchmarks.hpp"
+
+void benchmarks::print_results(const Results& results) {
+    printf("%-32s %10s %10s %10s %10s %10s\n", "benchmark", "samples",
+           "mean ns", "p50 ns", "p99 ns", "max ns");
+    for (const auto& result : results) {
+        printf("%-32s %10llu %10.1f %10.1f %10.1f %10.1f\n",
+               result.name.c_str(),
+               static_cast<unsigned long long>(result.samples),
+               result.mean_ns, result.p50_ns, result.p99_ns, result.max_ns);
+    }
+}
+
+auto benchmarks::write_json(const Results& results, const char* path) -> bool {
+    auto* file = fopen(path, "w");
+    if (file == nullptr) {
+        return false;
+    }
+    fprintf(file, "{\n  \"unit\": \"ns\",\n  \"benchmarks\": [");
+    const char* separator = "\n";
+    for (const auto& result : results) {
+        // Benchmark names are fixed identifiers, so they need no escaping.
+        fprintf(file,
+                "%s    {\"name\": \"%s\", \"samples\": %llu, \"mean\": %.1f, "
+                "\"p50\": %.1f, \"p99\": %.1f, \"max\": %.1f}",
+                separator, result.name.c_str(),
+                static_cast<unsigned long long>(result.samples),
+                result.mean_ns, result.p50_ns, result.p99_ns, result.max_ns);
+        separator = ",\n";
+    }
+    fprintf(file, "\n  ]\n}\n");
+    return fclose(file) == 0;
+}
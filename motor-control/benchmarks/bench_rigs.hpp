@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+
+#include "motor-control/core/brushed_motor/brushed_motor_interrupt_handler.hpp"
+#include "motor-control/core/brushed_motor/error_tolerance_config.hpp"
+#include "motor-control/core/stepper_motor/motor_interrupt_handler.hpp"
+#include "motor-control/core/tasks/move_status_reporter_task.hpp"
+#include "motor-control/tests/mock_brushed_motor_components.hpp"
+#include "motor-control/tests/mock_motor_hardware.hpp"
+
+namespace benchmarks {
+
+// Counts reports instead of storing them so the status path does not
+// allocate while it is being timed.
+struct CountingStatusClient {
+    void send_move_status_reporter_queue(
+        const move_status_reporter_task::TaskMessage&) {
+        ++messages;
+    }
+    void send_brushed_move_status_reporter_queue(
+        const move_status_reporter_task::TaskMessage&) {
+        ++messages;
+    }
+    uint32_t messages = 0;
+};
+
+/*
+ * A stepper interrupt handler wired to mock hardware, with the queue type
+ * left open so the same profile can be run over different queues.
+ */
+template <template <class> class QueueImpl>
+struct StepperRig {
+    explicit StepperRig(float encoder_tick_per_um = 0)
+        : stall{encoder_tick_per_um, 1, 10} {}
+
+    // Write moves until the queue is full.
+    template <typename MakeMove>
+    void top_up(MakeMove&& make_move) {
+        while (queue.try_write_isr(make_move())) {
+        }
+    }
+
+    test_mocks::MockMotorHardware hw{};
+    QueueImpl<motor_messages::Move> queue{""};
+    QueueImpl<can::messages::UpdateMotorPositionEstimationRequest>
+        update_position_queue{""};
+    CountingStatusClient reporter{};
+    stall_check::StallCheck stall;
+    motor_handler::MotorInterruptHandler<QueueImpl, CountingStatusClient,
+                                         motor_messages::Move,
+                                         test_mocks::MockMotorHardware>
+        handler{queue, reporter, hw, stall, update_position_queue};
+};
+
+/*
+ * A brushed interrupt handler wired to mock hardware, configured like the
+ * gripper jaw.
+ */
+template <template <class> class QueueImpl>
+struct BrushedRig {
+    static constexpr uint32_t brushed_timer_frequency = 32000;
+
+    lms::LinearMotionSystemConfig<lms::GearBoxConfig> gear_config{
+        .mech_config = lms::GearBoxConfig{.gear_diameter = 9,
+                                          .gear_reduction_ratio = 84.29},
+        .steps_per_rev = 0,
+        .microstep = 0,
+        .encoder_pulses_per_rev = 512};
+    error_tolerance_config::BrushedMotorErrorTolerance error_config{
+        gear_config, brushed_timer_frequency};
+    test_mocks::MockBrushedMotorHardware hw{};
+    test_mocks::MockBrushedMotorDriverIface driver{};
+    QueueImpl<motor_messages::BrushedMove> queue{""};
+    CountingStatusClient reporter{};
+    brushed_motor_handler::BrushedMotorInterruptHandler<QueueImpl,
+                                                        CountingStatusClient>
+        handler{queue, reporter, hw, driver, error_config};
+};
+
+}  // namespace benchmarks
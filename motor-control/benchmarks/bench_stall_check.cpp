@@ -0,0 +1,50 @@
+#include <cstdint>
+
+#include "benchmarks.hpp"
+#include "motor-control/core/stall_check.hpp"
+
+namespace {
+
+// Steps and encoder ticks are deliberately not 1:1 so that the fixed point
+// ratios do not reduce to trivial arithmetic.
+constexpr float encoder_tick_per_um = 0.2;
+constexpr float stepper_tick_per_um = 0.08;
+constexpr uint32_t stall_threshold_um = 500;
+
+auto step_itr(const benchmarks::Options& options) -> benchmarks::Summary {
+    auto stall = stall_check::StallCheck{encoder_tick_per_um,
+                                         stepper_tick_per_um,
+                                         stall_threshold_um};
+    auto sampler = benchmarks::Sampler{options.ticks};
+    uint32_t crossings = 0;
+    for (uint32_t tick = 0; tick < options.ticks; ++tick) {
+        // Reverse every so often so both thresholds are exercised.
+        auto direction = (tick / 4096) % 2 == 0;
+        sampler.time([&]() { crossings += stall.step_itr(direction) ? 1 : 0; });
+    }
+    return sampler.summarize("stall_check/step_itr");
+}
+
+auto check_stall_itr(const benchmarks::Options& options)
+    -> benchmarks::Summary {
+    auto stall = stall_check::StallCheck{encoder_tick_per_um,
+                                         stepper_tick_per_um,
+                                         stall_threshold_um};
+    auto sampler = benchmarks::Sampler{options.ticks};
+    uint32_t stalls = 0;
+    for (uint32_t tick = 0; tick < options.ticks; ++tick) {
+        auto encoder = static_cast<int32_t>(tick % 256) - 128;
+        sampler.time([&]() {
+            stalls += stall.check_stall_itr(encoder) ? 0 : 1;
+        });
+    }
+    return sampler.summarize("stall_check/check_stall_itr");
+}
+
+}  // namespace
+
+void benchmarks::run_stall_check_benchmarks(const Options& options,
+                                            Results& results) {
+    results.push_back(step_itr(options));
+    results.push_back(check_stall_itr(options));
+}
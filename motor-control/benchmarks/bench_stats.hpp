@@ -0,0 +1,118 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace benchmarks {
+
+struct Summary {
+    std::string name;
+    uint64_t samples;
+    double mean_ns;
+    double p50_ns;
+    double p99_ns;
+    double max_ns;
+};
+
+/*
+ * Records how long each call of a hot path takes so that the tail, and not
+ * just the average, can be reported.
+ */
+class Sampler {
+  public:
+    explicit Sampler(std::size_t expected_samples) {
+        samples.reserve(expected_samples);
+    }
+
+    template <typename Callable>
+    void time(Callable&& callable) {
+        auto start = clock::now();
+        callable();
+        auto end = clock::now();
+        auto elapsed = static_cast<uint32_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+                .count());
+        samples.push_back(elapsed > overhead_ns() ? elapsed - overhead_ns()
+                                                  : 0);
+    }
+
+    auto summarize(std::string name) -> Summary {
+        auto summary = Summary{.name = std::move(name),
+                               .samples = samples.size(),
+                               .mean_ns = 0,
+                               .p50_ns = 0,
+                               .p99_ns = 0,
+                               .max_ns = 0};
+        if (samples.empty()) {
+            return summary;
+        }
+        std::sort(samples.begin(), samples.end());
+        uint64_t total = 0;
+        for (auto sample : samples) {
+            total += sample;
+        }
+        summary.mean_ns =
+            static_cast<double>(total) / static_cast<double>(samples.size());
+        summary.p50_ns = percentile(50);
+        summary.p99_ns = percentile(99);
+        summary.max_ns = samples.back();
+        return summary;
+    }
+
+  private:
+    using clock = std::chrono::steady_clock;
+
+    /*
+     * Reading the clock costs about as much as a pass through the interrupt
+     * handler, so the median cost of timing nothing is taken off every
+     * sample.
+     */
+    static auto overhead_ns() -> uint32_t {
+        static const uint32_t overhead = []() {
+            constexpr std::size_t calibration_samples = 10001;
+            auto empty = std::vector<uint32_t>{};
+            empty.reserve(calibration_samples);
+            for (std::size_t i = 0; i < calibration_samples; ++i) {
+                auto start = clock::now();
+                auto end = clock::now();
+                empty.push_back(static_cast<uint32_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        end - start)
+                        .count()));
+            }
+            std::sort(empty.begin(), empty.end());
+            return empty[empty.size() / 2];
+        }();
+        return overhead;
+    }
+
+    // samples must be sorted
+    [[nodiscard]] auto percentile(std::size_t pct) const -> double {
+        auto index = (samples.size() - 1) * pct / 100;
+        return samples[index];
+    }
+
+    std::vector<uint32_t> samples{};
+};
+
+/*
+ * The figures for one call from samples that each timed calls_per_sample
+ * calls. Paths that take less time than reading the clock are timed in
+ * batches and reported like this.
+ */
+inline auto per_call(Summary summary, std::size_t calls_per_sample)
+    -> Summary {
+    auto calls = static_cast<double>(calls_per_sample);
+    summary.samples *= calls_per_sample;
+    summary.mean_ns /= calls;
+    summary.p50_ns /= calls;
+    summary.p99_ns /= calls;
+    summary.max_ns /= calls;
+    return summary;
+}
+
+}  // namespace benchmarks
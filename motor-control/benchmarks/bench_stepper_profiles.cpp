@@ -0,0 +1,149 @@
+#include <cstdint>
+
+#include "bench_rigs.hpp"
+#include "benchmarks.hpp"
+#include "common/core/spsc_message_queue.hpp"
+
+namespace {
+
+using namespace motor_messages;
+using Rig = benchmarks::StepperRig<spsc_message_queue::SPSCMessageQueue>;
+
+constexpr steps_per_tick cruise_velocity = 1 << 30;
+constexpr uint32_t ramp_ticks = 1024;
+constexpr uint32_t cruise_ticks = 4096;
+
+auto make_move(uint32_t index, uint32_t duration, steps_per_tick velocity,
+               steps_per_tick_sq acceleration,
+               MoveStopCondition stop_condition = MoveStopCondition::none)
+    -> Move {
+    return Move{.message_index = index,
+                .duration = duration,
+                .velocity = velocity,
+                .acceleration = acceleration,
+                .group_id = 0,
+                .seq_id = static_cast<uint8_t>(index),
+                .stop_condition = static_cast<uint8_t>(stop_condition),
+                .start_encoder_position = 0,
+                .usage_key = 0};
+}
+
+// The encoder follows the step position exactly, so the stall check runs
+// its full comparison on every threshold crossing without ever firing.
+void follow_steps_with_encoder(Rig& rig) {
+    rig.hw.sim_set_encoder_pulses(
+        static_cast<int32_t>(rig.hw.get_step_tracker()));
+}
+
+auto idle(Rig& rig) -> bool {
+    return !rig.handler.has_active_move() && !rig.handler.has_move_messages();
+}
+
+/*
+ * Run the handler for the configured number of ticks, calling setup before
+ * each one outside of the timed section.
+ */
+template <typename Setup>
+auto run_profile(const char* name, const benchmarks::Options& options,
+                 Rig& rig, Setup&& setup) -> benchmarks::Summary {
+    auto sampler = benchmarks::Sampler{options.ticks};
+    for (uint32_t tick = 0; tick < options.ticks; ++tick) {
+        setup(tick);
+        sampler.time([&rig]() { rig.handler.run_interrupt(); });
+    }
+    return sampler.summarize(name);
+}
+
+// Back to back accelerate, cruise, decelerate segments, the common case for
+// a gantry move.
+auto trapezoid(const benchmarks::Options& options) -> benchmarks::Summary {
+    auto rig = Rig{1};
+    uint32_t index = 0;
+    auto enqueue_trapezoid = [&rig, &index]() {
+        constexpr steps_per_tick_sq ramp_acceleration =
+            cruise_velocity / ramp_ticks;
+        std::ignore = rig.queue.try_write(
+            make_move(++index, ramp_ticks, 0, ramp_acceleration));
+        std::ignore = rig.queue.try_write(
+            make_move(++index, cruise_ticks, cruise_velocity, 0));
+        std::ignore = rig.queue.try_write(make_move(
+            ++index, ramp_ticks, cruise_velocity, -ramp_acceleration));
+    };
+    return run_profile("stepper/trapezoid", options, rig, [&](uint32_t) {
+        if (rig.queue.get_size() < 3) {
+            enqueue_trapezoid();
+        }
+        follow_steps_with_encoder(rig);
+    });
+}
+
+// Drive toward the limit switch until it triggers, then back off until it
+// releases.
+auto homing(const benchmarks::Options& options) -> benchmarks::Summary {
+    constexpr uint32_t ticks_to_switch = 2048;
+    constexpr uint32_t ticks_to_release = 256;
+    auto rig = Rig{1};
+    uint32_t index = 0;
+    uint32_t phase_ticks = 0;
+    return run_profile("stepper/homing", options, rig, [&](uint32_t) {
+        if (idle(rig)) {
+            std::ignore = rig.queue.try_write(
+                make_move(++index, ticks_to_switch * 2, -cruise_velocity, 0,
+                          MoveStopCondition::limit_switch));
+            std::ignore = rig.queue.try_write(
+                make_move(++index, ticks_to_release * 2, cruise_velocity, 0,
+                          MoveStopCondition::limit_switch_backoff));
+            phase_ticks = 0;
+        }
+        ++phase_ticks;
+        rig.hw.set_mock_lim_sw(phase_ticks > ticks_to_switch &&
+                               phase_ticks <
+                                   ticks_to_switch + ticks_to_release);
+        follow_steps_with_encoder(rig);
+    });
+}
+
+// The encoder never moves, so every move ends in a collision and the rest of
+// the queue is discarded; the motion controller's stop handling resets the
+// handler once it has drained.
+auto stall(const benchmarks::Options& options) -> benchmarks::Summary {
+    auto rig = Rig{1};
+    uint32_t index = 0;
+    return run_profile("stepper/stall", options, rig, [&](uint32_t) {
+        if (idle(rig)) {
+            rig.handler.reset();
+            rig.top_up([&index]() {
+                return make_move(++index, cruise_ticks, cruise_velocity, 0);
+            });
+        }
+    });
+}
+
+// Estop asserts partway through a move, holds while new moves arrive, then
+// releases.
+auto estop(const benchmarks::Options& options) -> benchmarks::Summary {
+    constexpr uint32_t ticks_running = 2048;
+    constexpr uint32_t ticks_in_estop = 512;
+    auto rig = Rig{1};
+    uint32_t index = 0;
+    return run_profile("stepper/estop", options, rig, [&](uint32_t tick) {
+        auto phase = tick % (ticks_running + ticks_in_estop);
+        rig.hw.set_mock_estop_in(phase >= ticks_running);
+        if (phase == 0 || phase == ticks_running + ticks_in_estop / 2) {
+            rig.top_up([&index]() {
+                return make_move(++index, ramp_ticks, cruise_velocity, 0);
+            });
+        }
+        follow_steps_with_encoder(rig);
+    });
+}
+
+}  // namespace
+
+void benchmarks::run_stepper_profile_benchmarks(const Options& options,
+                                                Results& results) {
+    results.push_back(trapezoid(options));
+    results.push_back(homing(options));
+    results.push_back(stall(options));
+    results.push_back(estop(options));
+}
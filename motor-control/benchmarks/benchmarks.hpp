@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "bench_stats.hpp"
+
+namespace benchmarks {
+
+struct Options {
+    // Number of interrupt ticks (or calls, for the non-interrupt paths)
+    // timed per benchmark
+    uint32_t ticks = 200000;
+};
+
+using Results = std::vector<Summary>;
+
+/*
+ * Time the step timer interrupt handler consuming a stream of short moves,
+ * once with the moves handed over on a FreeRTOS queue and once on the
+ * lock-free SPSC ring.
+ */
+void run_move_queue_benchmark(const Options& options, Results& results);
+
+/*
+ * Time MotorInterruptHandler::run_interrupt() through trapezoid, homing,
+ * stall and estop move profiles.
+ */
+void run_stepper_profile_benchmarks(const Options& options, Results& results);
+
+/*
+ * Time StallCheck::step_itr() and StallCheck::check_stall_itr().
+ */
+void run_stall_check_benchmarks(const Options& options, Results& results);
+
+/*
+ * Time BrushedMotorInterruptHandler::run_interrupt() through grip, encoder
+ * position and estop profiles.
+ */
+void run_brushed_benchmarks(const Options& options, Results& results);
+
+void print_results(const Results& results);
+
+/*
+ * Write the results as JSON so that a run can be diffed against a stored
+ * baseline. Returns false if the file could not be written.
+ */
+auto write_json(const Results& results, const char* path) -> bool;
+
+}  // namespace benchmarks
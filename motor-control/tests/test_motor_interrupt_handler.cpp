@@ -197,3 +197,84 @@ SCENARIO("negative position reset") {
         }
     }
 }
+
+SCENARIO("the next move is staged before the segment boundary") {
+    MotorContainer test_objs{};
+    constexpr uint64_t duration = 4;
+
+    GIVEN("two moves in the same group") {
+        test_objs.queue.try_write_isr(Move{.message_index = 1,
+                                           .duration = duration,
+                                           .velocity = 0x7fffffff,
+                                           .group_id = 0,
+                                           .seq_id = 0});
+        test_objs.queue.try_write_isr(Move{.message_index = 2,
+                                           .duration = duration,
+                                           .velocity = 0x7fffffff,
+                                           .group_id = 0,
+                                           .seq_id = 1});
+        WHEN("the first move has started") {
+            test_objs.handler.run_interrupt();
+            test_objs.handler.run_interrupt();
+            THEN("the second move is read out of the queue mid-move") {
+                REQUIRE(test_objs.handler.has_staged_move());
+                REQUIRE(test_objs.queue.get_size() == 0);
+                REQUIRE(test_objs.handler.get_buffered_move().message_index ==
+                        1);
+            }
+        }
+        WHEN("the interrupt runs up to the segment boundary") {
+            for (uint64_t i = 0; i <= duration; ++i) {
+                test_objs.handler.run_interrupt();
+            }
+            REQUIRE(test_objs.reporter.messages.empty());
+            auto steps_before = test_objs.hw.steps_taken();
+            test_objs.handler.run_interrupt();
+            THEN("the boundary tick swaps in the staged move and steps") {
+                REQUIRE(test_objs.handler.has_active_move());
+                REQUIRE(!test_objs.handler.has_staged_move());
+                REQUIRE(test_objs.handler.get_buffered_move().message_index ==
+                        2);
+                REQUIRE(test_objs.hw.steps_taken() == steps_before + 1);
+            }
+            THEN("the boundary tick sends nothing to the reporter") {
+                REQUIRE(test_objs.reporter.messages.empty());
+            }
+            THEN("the ack for the first move is sent on the next tick") {
+                test_objs.handler.run_interrupt();
+                REQUIRE(test_objs.reporter.messages.size() == 1);
+                auto ack = std::get<Ack>(test_objs.reporter.messages.front());
+                REQUIRE(ack.message_index == 1);
+                REQUIRE(ack.ack_id == AckMessageId::complete_without_condition);
+            }
+            AND_WHEN("the last move finishes") {
+                for (uint64_t i = 0; i < duration; ++i) {
+                    test_objs.handler.run_interrupt();
+                }
+                THEN("its ack is sent on the boundary tick") {
+                    REQUIRE(test_objs.reporter.messages.size() == 2);
+                    auto ack =
+                        std::get<Ack>(test_objs.reporter.messages.back());
+                    REQUIRE(ack.message_index == 2);
+                    REQUIRE(!test_objs.handler.has_active_move());
+                }
+            }
+        }
+        WHEN("the moves are cancelled with the second one staged") {
+            test_objs.handler.run_interrupt();
+            test_objs.handler.run_interrupt();
+            REQUIRE(test_objs.handler.has_staged_move());
+            test_objs.hw.request_cancel();
+            test_objs.handler.run_interrupt();
+            test_objs.handler.run_interrupt();
+            THEN("the staged move is discarded and never runs") {
+                REQUIRE(!test_objs.handler.has_staged_move());
+                REQUIRE(!test_objs.handler.has_move_messages());
+                for (uint64_t i = 0; i <= duration; ++i) {
+                    test_objs.handler.run_interrupt();
+                }
+                REQUIRE(!test_objs.handler.has_active_move());
+            }
+        }
+    }
+}
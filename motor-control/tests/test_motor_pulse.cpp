@@ -184,6 +184,81 @@ TEST_CASE("Non-zero acceleration") {
     }
 }
 
+TEST_CASE("Non-zero jerk") {
+    // jerk has 16 more fractional bits than acceleration
+    constexpr steps_per_tick_cu one_acceleration_lsb = 1 << 16;
+
+    GIVEN("a motor handler") {
+        HandlerContainer test_objs{};
+        WHEN("move starts at 0 velocity and acceleration with positive jerk") {
+            auto msg = Move{.duration = 4,
+                            .velocity = 0,
+                            .acceleration = 0,
+                            .jerk = one_acceleration_lsb};
+            test_objs.handler.set_buffered_move(msg);
+            THEN("acceleration grows each tick and velocity follows it") {
+                for (int i = 0; i < 4; i++) {
+                    static_cast<void>(test_objs.handler.tick());
+                }
+                auto move = test_objs.handler.get_buffered_move();
+                REQUIRE(move.acceleration == 4);
+                REQUIRE(move.velocity == 1 + 2 + 3 + 4);
+                REQUIRE(test_objs.handler.get_current_position() ==
+                        q31_31(1 + 3 + 6 + 10));
+            }
+        }
+        WHEN("jerk is below the resolution of acceleration") {
+            auto msg = Move{.duration = 4,
+                            .velocity = 0,
+                            .acceleration = 0,
+                            .jerk = one_acceleration_lsb / 2};
+            test_objs.handler.set_buffered_move(msg);
+            THEN("it accumulates until it changes acceleration") {
+                static_cast<void>(test_objs.handler.tick());
+                REQUIRE(test_objs.handler.get_buffered_move().acceleration ==
+                        0);
+                static_cast<void>(test_objs.handler.tick());
+                REQUIRE(test_objs.handler.get_buffered_move().acceleration ==
+                        1);
+            }
+        }
+        WHEN("negative jerk takes acceleration below zero") {
+            auto msg = Move{.duration = 3,
+                            .velocity = convert_velocity(0.5),
+                            .acceleration = 1,
+                            .jerk = -one_acceleration_lsb};
+            test_objs.handler.set_buffered_move(msg);
+            THEN("acceleration and velocity decrease") {
+                for (int i = 0; i < 3; i++) {
+                    static_cast<void>(test_objs.handler.tick());
+                }
+                auto move = test_objs.handler.get_buffered_move();
+                REQUIRE(move.acceleration == -2);
+                REQUIRE(move.velocity == convert_velocity(0.5) + 0 - 1 - 2);
+            }
+        }
+        WHEN("jerk would overflow acceleration") {
+            auto max = std::numeric_limits<sq0_31>::max();
+            auto msg = Move{.duration = 2,
+                            .velocity = 0,
+                            .acceleration = max,
+                            .jerk = one_acceleration_lsb};
+            test_objs.handler.set_buffered_move(msg);
+            THEN("acceleration is held") {
+                static_cast<void>(test_objs.handler.tick());
+                REQUIRE(test_objs.handler.get_buffered_move().acceleration ==
+                        max);
+                REQUIRE(test_objs.handler.get_buffered_move().velocity == max);
+                AND_THEN("velocity is held when it would overflow") {
+                    static_cast<void>(test_objs.handler.tick());
+                    REQUIRE(test_objs.handler.get_buffered_move().velocity ==
+                            max);
+                }
+            }
+        }
+    }
+}
+
 TEST_CASE("Compute move sequence") {
     GIVEN("a motor handler") {
         HandlerContainer test_objs{};
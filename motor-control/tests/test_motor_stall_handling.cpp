@@ -129,6 +129,9 @@ SCENARIO("motor handler stall detection") {
                     for (int i = 22; i < (int)msg1.duration; i++) {
                         test_objs.handler.run_interrupt();
                     }
+                    // msg2 was staged, so the ack for msg1 goes out on the
+                    // tick after the boundary
+                    test_objs.handler.run_interrupt();
                     REQUIRE(test_objs.reporter.messages.size() == 3);
                     Ack ack_msg =
                         std::get<Ack>(test_objs.reporter.messages.back());
@@ -340,6 +343,9 @@ SCENARIO("motor handler stall detection") {
             for (int i = 0; i < (int)msg1.duration; ++i) {
                 test_objs.handler.run_interrupt();
             }
+            // msg2 was staged, so the ack for msg1 goes out on the tick
+            // after the boundary
+            test_objs.handler.run_interrupt();
             THEN("the stall is detected") {
                 REQUIRE(!test_objs.hw.position_flags.check_flag(
                     Flags::stepper_position_ok));
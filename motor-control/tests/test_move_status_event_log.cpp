@@ -0,0 +1,165 @@
+#include "catch2/catch.hpp"
+#include "common/tests/mock_message_queue.hpp"
+#include "motor-control/core/stepper_motor/motor_interrupt_handler.hpp"
+#include "motor-control/core/tasks/move_status_event_log.hpp"
+#include "motor-control/tests/mock_motor_hardware.hpp"
+
+using namespace move_status_reporter_task;
+
+SCENARIO("move status event log round trips reports") {
+    GIVEN("an empty event log") {
+        auto subject = MoveStatusEventLog<4>{};
+        auto out = TaskMessage{};
+        REQUIRE(!subject.has_event());
+        REQUIRE(!subject.try_read(&out));
+
+        WHEN("an ack is reported") {
+            subject.send_move_status_reporter_queue(motor_messages::Ack{
+                .message_index = 12,
+                .group_id = 1,
+                .seq_id = 2,
+                .current_position_steps = 3000,
+                .encoder_position = -40,
+                .position_flags = 3,
+                .ack_id = motor_messages::AckMessageId::stopped_by_condition,
+                .start_encoder_position = 55,
+                .usage_key = 0x1234});
+            THEN("it reads back as the same ack") {
+                REQUIRE(subject.try_read(&out));
+                auto ack = std::get<motor_messages::Ack>(out);
+                REQUIRE(ack.message_index == 12);
+                REQUIRE(ack.group_id == 1);
+                REQUIRE(ack.seq_id == 2);
+                REQUIRE(ack.current_position_steps == 3000);
+                REQUIRE(ack.encoder_position == -40);
+                REQUIRE(ack.position_flags == 3);
+                REQUIRE(ack.ack_id ==
+                        motor_messages::AckMessageId::stopped_by_condition);
+                REQUIRE(ack.start_encoder_position == 55);
+                REQUIRE(ack.usage_key == 0x1234);
+                REQUIRE(!subject.has_event());
+            }
+        }
+        WHEN("a position response is reported") {
+            subject.send_move_status_reporter_queue(
+                motor_messages::UpdatePositionResponse{
+                    .message_index = 7,
+                    .stepper_position_counts = 100,
+                    .encoder_pulses = 200,
+                    .position_flags = 1});
+            THEN("it reads back as the same response") {
+                REQUIRE(subject.try_read(&out));
+                auto response =
+                    std::get<motor_messages::UpdatePositionResponse>(out);
+                REQUIRE(response.message_index == 7);
+                REQUIRE(response.stepper_position_counts == 100);
+                REQUIRE(response.encoder_pulses == 200);
+                REQUIRE(response.position_flags == 1);
+            }
+        }
+        WHEN("an error and an error count are reported") {
+            subject.send_move_status_reporter_queue(
+                can::messages::ErrorMessage{
+                    .message_index = 9,
+                    .severity = can::ids::ErrorSeverity::unrecoverable,
+                    .error_code = can::ids::ErrorCode::collision_detected});
+            subject.send_move_status_reporter_queue(
+                usage_messages::IncreaseErrorCount{.key = 42});
+            THEN("they read back in order") {
+                REQUIRE(subject.try_read(&out));
+                auto error = std::get<can::messages::ErrorMessage>(out);
+                REQUIRE(error.message_index == 9);
+                REQUIRE(error.severity ==
+                        can::ids::ErrorSeverity::unrecoverable);
+                REQUIRE(error.error_code ==
+                        can::ids::ErrorCode::collision_detected);
+                REQUIRE(subject.try_read(&out));
+                REQUIRE(std::get<usage_messages::IncreaseErrorCount>(out).key ==
+                        42);
+            }
+        }
+        WHEN("more events are reported than the log holds") {
+            for (uint32_t i = 0; i < 6; ++i) {
+                subject.send_move_status_reporter_queue(
+                    motor_messages::UpdatePositionResponse{.message_index = i});
+            }
+            THEN("the overflow is counted and the oldest events are kept") {
+                REQUIRE(subject.get_dropped_count() == 2);
+                REQUIRE(subject.get_last_dropped_index() == 5);
+                for (uint32_t i = 0; i < 4; ++i) {
+                    REQUIRE(subject.try_read(&out));
+                    REQUIRE(std::get<motor_messages::UpdatePositionResponse>(
+                                out)
+                                .message_index == i);
+                }
+                REQUIRE(!subject.try_read(&out));
+            }
+        }
+    }
+}
+
+SCENARIO("move status event log wakes its reader") {
+    GIVEN("an event log with a waker") {
+        auto subject = MoveStatusEventLog<4>{};
+        int wakes = 0;
+        subject.set_waker(
+            [](void* context) { (*static_cast<int*>(context))++; }, &wakes);
+        auto report = [&subject]() {
+            subject.send_move_status_reporter_queue(
+                usage_messages::IncreaseErrorCount{.key = 1});
+        };
+        WHEN("an event is appended while the reader is not waiting") {
+            report();
+            THEN("the reader is not woken") { REQUIRE(wakes == 0); }
+        }
+        WHEN("the reader waits on an empty log") {
+            REQUIRE(subject.start_waiting());
+            AND_WHEN("events are appended") {
+                report();
+                report();
+                THEN("the reader is woken once") { REQUIRE(wakes == 1); }
+            }
+        }
+        WHEN("the reader goes to wait with an event in the log") {
+            report();
+            THEN("it is told not to sleep") {
+                REQUIRE(!subject.start_waiting());
+                report();
+                REQUIRE(wakes == 0);
+            }
+        }
+    }
+}
+
+SCENARIO("a motor interrupt handler reports into an event log") {
+    GIVEN("a handler using an event log as its status client") {
+        test_mocks::MockMotorHardware hw{};
+        test_mocks::MockMessageQueue<motor_messages::Move> queue{};
+        test_mocks::MockMessageQueue<
+            can::messages::UpdateMotorPositionEstimationRequest>
+            update_position_queue{};
+        MoveStatusEventLog<> log{};
+        stall_check::StallCheck stall{1, 1, 10};
+        auto handler = motor_handler::MotorInterruptHandler(
+            queue, log, hw, stall, update_position_queue);
+        queue.try_write(motor_messages::Move{.message_index = 5,
+                                             .duration = 2,
+                                             .velocity = 0x7fffffff,
+                                             .group_id = 0,
+                                             .seq_id = 0});
+        WHEN("the move runs to completion") {
+            for (int i = 0; i < 4; ++i) {
+                handler.run_interrupt();
+            }
+            THEN("its ack is in the log") {
+                auto out = TaskMessage{};
+                REQUIRE(log.try_read(&out));
+                auto ack = std::get<motor_messages::Ack>(out);
+                REQUIRE(ack.message_index == 5);
+                REQUIRE(ack.ack_id == motor_messages::AckMessageId::
+                                          complete_without_condition);
+                REQUIRE(!log.has_event());
+            }
+        }
+    }
+}
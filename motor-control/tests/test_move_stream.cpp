@@ -0,0 +1,290 @@
+#include <cstdint>
+#include <deque>
+#include <utility>
+#include <variant>
+
+#include "can/core/ids.hpp"
+#include "can/core/messages.hpp"
+#include "catch2/catch.hpp"
+#include "common/tests/mock_message_queue.hpp"
+#include "motor-control/core/linear_motion_system.hpp"
+#include "motor-control/core/motor_messages.hpp"
+#include "motor-control/core/stepper_motor/motor_interrupt_handler.hpp"
+#include "motor-control/core/tasks/move_status_reporter_task.hpp"
+#include "motor-control/tests/mock_motor_hardware.hpp"
+#include "motor-control/tests/mock_move_status_reporter_client.hpp"
+
+using namespace motor_handler;
+using namespace motor_messages;
+
+namespace {
+
+struct StreamMotorContainer {
+    test_mocks::MockMotorHardware hw{};
+    test_mocks::MockMessageQueue<Move> queue{};
+    test_mocks::MockMessageQueue<
+        can::messages::UpdateMotorPositionEstimationRequest>
+        update_position_queue{};
+    test_mocks::MockMoveStatusReporterClient reporter{};
+    stall_check::StallCheck st{1, 1, 10};
+    MotorInterruptHandler<test_mocks::MockMessageQueue,
+                          test_mocks::MockMoveStatusReporterClient, Move,
+                          test_mocks::MockMotorHardware>
+        handler{queue, reporter, hw, st, update_position_queue};
+
+    void run(int ticks) {
+        for (int i = 0; i < ticks; ++i) {
+            handler.run_interrupt();
+        }
+    }
+
+    [[nodiscard]] auto acks() const -> std::vector<Ack> {
+        auto out = std::vector<Ack>{};
+        for (const auto& m : reporter.messages) {
+            if (std::holds_alternative<Ack>(m)) {
+                out.push_back(std::get<Ack>(m));
+            }
+        }
+        return out;
+    }
+
+    [[nodiscard]] auto errors() const
+        -> std::vector<can::messages::ErrorMessage> {
+        auto out = std::vector<can::messages::ErrorMessage>{};
+        for (const auto& m : reporter.messages) {
+            if (std::holds_alternative<can::messages::ErrorMessage>(m)) {
+                out.push_back(std::get<can::messages::ErrorMessage>(m));
+            }
+        }
+        return out;
+    }
+};
+
+auto segment(uint32_t message_index, uint8_t seq_id) -> Move {
+    return Move{.message_index = message_index,
+                .duration = 10,
+                .velocity = 0x40000000,
+                .acceleration = 0,
+                .group_id = STREAM_GROUP,
+                .seq_id = seq_id,
+                .stop_condition = 0};
+}
+
+auto end_marker(uint32_t message_index) -> Move {
+    return Move{.message_index = message_index,
+                .duration = 0,
+                .velocity = 0,
+                .acceleration = 0,
+                .group_id = STREAM_GROUP,
+                .seq_id = STREAM_END_SEQ,
+                .stop_condition = 0};
+}
+
+struct StreamCanClient {
+    std::deque<std::pair<can::ids::NodeId, can::messages::ResponseMessageType>>
+        queue{};
+    auto send_can_message(can::ids::NodeId node_id,
+                          const can::messages::ResponseMessageType& m) -> void {
+        queue.push_back(std::make_pair(node_id, m));
+    }
+
+    [[nodiscard]] auto credits() const
+        -> std::vector<can::messages::MoveStreamCreditResponse> {
+        auto out = std::vector<can::messages::MoveStreamCreditResponse>{};
+        for (const auto& m : queue) {
+            if (std::holds_alternative<can::messages::MoveStreamCreditResponse>(
+                    m.second)) {
+                out.push_back(
+                    std::get<can::messages::MoveStreamCreditResponse>(
+                        m.second));
+            }
+        }
+        return out;
+    }
+};
+
+struct StreamUsageClient {
+    std::deque<usage_storage_task::TaskMessage> queue{};
+    auto send_usage_storage_queue(const usage_storage_task::TaskMessage& m)
+        -> void {
+        queue.push_back(m);
+    }
+};
+
+auto stream_ack(uint32_t message_index, uint8_t seq_id) -> Ack {
+    return Ack{.message_index = message_index,
+               .group_id = STREAM_GROUP,
+               .seq_id = seq_id,
+               .current_position_steps = 0,
+               .encoder_position = 0,
+               .position_flags = 0,
+               .ack_id = AckMessageId::complete_without_condition,
+               .start_encoder_position = 0,
+               .usage_key = 0};
+}
+
+}  // namespace
+
+SCENARIO("the step interrupt runs a move stream") {
+    StreamMotorContainer test_objs{};
+
+    GIVEN("stream segments that are queued ahead of time") {
+        test_objs.queue.try_write_isr(segment(1, 0));
+        test_objs.queue.try_write_isr(segment(2, 1));
+        test_objs.queue.try_write_isr(segment(3, 2));
+        test_objs.queue.try_write_isr(end_marker(4));
+        WHEN("the stream runs out") {
+            test_objs.run(50);
+            THEN("every segment and the end marker are acked") {
+                auto acks = test_objs.acks();
+                REQUIRE(acks.size() == 4);
+                REQUIRE(acks[0].message_index == 1);
+                REQUIRE(acks[2].message_index == 3);
+                REQUIRE(acks[3].message_index == 4);
+                REQUIRE(acks[3].seq_id == STREAM_END_SEQ);
+            }
+            THEN("no underrun is reported") {
+                REQUIRE(test_objs.errors().empty());
+                REQUIRE(test_objs.hw.steps_taken() == 15);
+            }
+        }
+    }
+
+    GIVEN("a stream segment with nothing queued after it") {
+        test_objs.queue.try_write_isr(segment(1, 0));
+        WHEN("the segment finishes") {
+            test_objs.run(20);
+            THEN("the segment is acked and then an underrun is reported") {
+                REQUIRE(test_objs.reporter.messages.size() == 2);
+                auto ack = std::get<Ack>(test_objs.reporter.messages[0]);
+                REQUIRE(ack.message_index == 1);
+                auto err = std::get<can::messages::ErrorMessage>(
+                    test_objs.reporter.messages[1]);
+                REQUIRE(err.message_index == 1);
+                REQUIRE(err.error_code ==
+                        can::ids::ErrorCode::move_stream_underrun);
+                REQUIRE(err.severity == can::ids::ErrorSeverity::recoverable);
+            }
+            AND_WHEN("a late segment arrives") {
+                auto steps = test_objs.hw.steps_taken();
+                test_objs.reporter.messages.clear();
+                test_objs.queue.try_write_isr(segment(2, 1));
+                test_objs.run(20);
+                THEN("it is discarded without moving") {
+                    REQUIRE(test_objs.hw.steps_taken() == steps);
+                    REQUIRE(test_objs.reporter.messages.empty());
+                    REQUIRE(!test_objs.handler.has_active_move());
+                }
+            }
+            AND_WHEN("the stream is ended and a new one is started") {
+                test_objs.reporter.messages.clear();
+                test_objs.queue.try_write_isr(segment(2, 1));
+                test_objs.queue.try_write_isr(end_marker(3));
+                test_objs.queue.try_write_isr(segment(4, 0));
+                test_objs.queue.try_write_isr(end_marker(5));
+                test_objs.run(50);
+                THEN("the segments after the end marker run") {
+                    auto acks = test_objs.acks();
+                    REQUIRE(acks.size() == 3);
+                    REQUIRE(acks[0].message_index == 3);
+                    REQUIRE(acks[1].message_index == 4);
+                    REQUIRE(acks[2].message_index == 5);
+                    REQUIRE(test_objs.errors().empty());
+                }
+            }
+            AND_WHEN("the handler is reset") {
+                test_objs.handler.reset();
+                test_objs.reporter.messages.clear();
+                test_objs.queue.try_write_isr(segment(2, 1));
+                test_objs.queue.try_write_isr(end_marker(3));
+                test_objs.run(30);
+                THEN("a new stream runs") {
+                    auto acks = test_objs.acks();
+                    REQUIRE(acks.size() == 2);
+                    REQUIRE(acks[0].message_index == 2);
+                }
+            }
+        }
+    }
+
+    GIVEN("a move outside of a stream with nothing queued after it") {
+        auto move = segment(1, 0);
+        move.group_id = 0;
+        test_objs.queue.try_write_isr(move);
+        WHEN("the move finishes") {
+            test_objs.run(20);
+            THEN("no underrun is reported") {
+                REQUIRE(test_objs.acks().size() == 1);
+                REQUIRE(test_objs.errors().empty());
+            }
+        }
+    }
+}
+
+SCENARIO("the move status reporter returns stream credits") {
+    struct lms::LinearMotionSystemConfig<lms::LeadScrewConfig> linear_config {
+        .mech_config = lms::LeadScrewConfig{.lead_screw_pitch = 2,
+                                            .gear_reduction_ratio = 1.0},
+        .steps_per_rev = 200, .microstep = 32, .encoder_pulses_per_rev = 1000,
+    };
+    auto can_client = StreamCanClient{};
+    auto usage_client = StreamUsageClient{};
+    auto handler = move_status_reporter_task::MoveStatusMessageHandler(
+        can_client, linear_config, usage_client);
+
+    GIVEN("stream segments completing one at a time") {
+        WHEN("fewer segments than a batch complete") {
+            for (uint8_t i = 0; i < STREAM_CREDIT_BATCH - 1; ++i) {
+                handler.handle_message(stream_ack(i, i));
+            }
+            THEN("no credit is returned yet") {
+                REQUIRE(can_client.credits().empty());
+            }
+        }
+        WHEN("a batch of segments completes") {
+            for (uint8_t i = 0; i < STREAM_CREDIT_BATCH; ++i) {
+                handler.handle_message(stream_ack(i, i));
+            }
+            THEN("the batch is returned as credits") {
+                auto credits = can_client.credits();
+                REQUIRE(credits.size() == 1);
+                REQUIRE(credits[0].credits == STREAM_CREDIT_BATCH);
+                REQUIRE(credits[0].message_index == STREAM_CREDIT_BATCH - 1);
+            }
+        }
+        WHEN("the stream ends part way through a batch") {
+            handler.handle_message(stream_ack(1, 0));
+            handler.handle_message(stream_ack(2, STREAM_END_SEQ));
+            for (uint8_t i = 0; i < STREAM_CREDIT_BATCH - 1; ++i) {
+                handler.handle_message(stream_ack(i + 3, i));
+            }
+            THEN("the next stream starts counting from zero") {
+                REQUIRE(can_client.credits().empty());
+            }
+        }
+        WHEN("an error interrupts the stream") {
+            handler.handle_message(stream_ack(1, 0));
+            handler.handle_message(can::messages::ErrorMessage{
+                .message_index = 1,
+                .severity = can::ids::ErrorSeverity::recoverable,
+                .error_code = can::ids::ErrorCode::move_stream_underrun});
+            for (uint8_t i = 0; i < STREAM_CREDIT_BATCH - 1; ++i) {
+                handler.handle_message(stream_ack(i + 2, i));
+            }
+            THEN("the held back credits are dropped") {
+                REQUIRE(can_client.credits().empty());
+            }
+        }
+    }
+
+    GIVEN("moves outside of a stream") {
+        for (uint8_t i = 0; i < STREAM_WINDOW; ++i) {
+            auto ack = stream_ack(i, i);
+            ack.group_id = 0;
+            handler.handle_message(ack);
+        }
+        THEN("no credits are returned") {
+            REQUIRE(can_client.credits().empty());
+        }
+    }
+}
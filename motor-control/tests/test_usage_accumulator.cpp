@@ -0,0 +1,118 @@
+#include "catch2/catch.hpp"
+#include "motor-control/core/usage_accumulator.hpp"
+
+using namespace usage_accumulator;
+
+SCENARIO("accumulating usage in RAM") {
+    UsageJournal journal{};
+    GIVEN("an accumulator on an empty journal") {
+        auto subject = UsageAccumulator{&journal};
+        THEN("it has nothing to flush") {
+            REQUIRE(!subject.is_dirty());
+            REQUIRE(subject.next_dirty() == journal_entries);
+            REQUIRE(subject.pending(3) == 0);
+        }
+        WHEN("increments come in") {
+            REQUIRE(subject.add(3, 8, 100, 0));
+            REQUIRE(subject.add(3, 8, 250, 0));
+            REQUIRE(subject.add(4, 4, 1, 0));
+            THEN("they are summed per key") {
+                REQUIRE(subject.is_dirty());
+                REQUIRE(subject.pending(3) == 350);
+                REQUIRE(subject.pending(4) == 1);
+                REQUIRE(subject.entry(subject.next_dirty()).key == 3);
+            }
+            THEN("a flush is not due yet") { REQUIRE(!subject.flush_due(10)); }
+            THEN("a flush is due once the period has passed") {
+                REQUIRE(subject.flush_due(flush_period_ms));
+            }
+        }
+        WHEN("enough increments come in") {
+            for (uint32_t i = 0; i < flush_threshold; ++i) {
+                REQUIRE(subject.add(3, 8, 1, 0));
+            }
+            THEN("a flush is due") { REQUIRE(subject.flush_due(0)); }
+            AND_WHEN("a flush starts") {
+                subject.flush_started(5);
+                THEN("the count starts over") {
+                    REQUIRE(!subject.flush_due(5));
+                }
+            }
+        }
+        WHEN("an entry is flushed while more comes in") {
+            REQUIRE(subject.add(3, 8, 100, 0));
+            auto index = subject.next_dirty();
+            auto amount = subject.entry(index).pending;
+            REQUIRE(subject.add(3, 8, 20, 0));
+            subject.flushed(index, amount);
+            THEN("only what was written is taken off") {
+                REQUIRE(subject.pending(3) == 20);
+                REQUIRE(subject.is_dirty());
+            }
+            AND_WHEN("the rest is flushed") {
+                subject.flushed(index, 20);
+                THEN("it is clean") {
+                    REQUIRE(!subject.is_dirty());
+                    REQUIRE(subject.pending(3) == 0);
+                }
+            }
+        }
+        WHEN("every entry holds a count") {
+            for (uint16_t key = 0; key < journal_entries; ++key) {
+                REQUIRE(subject.add(key, 4, 1, 0));
+            }
+            THEN("a new key is refused") { REQUIRE(!subject.add(10, 4, 1, 0)); }
+            THEN("existing keys still accumulate") {
+                REQUIRE(subject.add(0, 4, 1, 0));
+                REQUIRE(subject.pending(0) == 2);
+            }
+        }
+    }
+
+    GIVEN("a journal left behind by a reset") {
+        {
+            auto before = UsageAccumulator{&journal};
+            REQUIRE(before.add(3, 8, 1234, 0));
+            REQUIRE(before.add(4, 4, 2, 0));
+        }
+        WHEN("an accumulator starts on it") {
+            auto subject = UsageAccumulator{&journal};
+            THEN("the counts are recovered") {
+                REQUIRE(subject.is_dirty());
+                REQUIRE(subject.pending(3) == 1234);
+                REQUIRE(subject.pending(4) == 2);
+            }
+        }
+        WHEN("an entry was corrupted") {
+            journal.entries[0].pending ^= 0x10;
+            auto subject = UsageAccumulator{&journal};
+            THEN("only that entry is dropped") {
+                REQUIRE(subject.pending(3) == 0);
+                REQUIRE(subject.pending(4) == 2);
+            }
+        }
+    }
+
+    GIVEN("a journal full of noise") {
+        for (auto& entry : journal.entries) {
+            entry = JournalEntry{.magic = journal_magic,
+                                 .key = 7,
+                                 .len = 4,
+                                 .crc = 0x1234,
+                                 .pending = 99};
+        }
+        auto subject = UsageAccumulator{&journal};
+        THEN("nothing is recovered") {
+            REQUIRE(!subject.is_dirty());
+            REQUIRE(subject.pending(7) == 0);
+        }
+    }
+
+    GIVEN("no journal") {
+        auto subject = UsageAccumulator{nullptr};
+        THEN("counts are still kept") {
+            REQUIRE(subject.add(3, 8, 5, 0));
+            REQUIRE(subject.pending(3) == 5);
+        }
+    }
+}
@@ -1,11 +1,15 @@
+#include "can/core/acceptance_filter.hpp"
 #include "can/core/freertos_can_dispatch.hpp"
 #include "can/core/ids.hpp"
+#include "can/core/message_writer.hpp"
 #include "can/core/messages.hpp"
 #include "common/core/freertos_message_queue.hpp"
 #include "common/core/freertos_task.hpp"
 #include "common/core/version.h"
+#include "motor-control/core/tasks/move_group_task.hpp"
 #include "pipettes/core/can_task.hpp"
 #include "pipettes/core/dispatch_builder.hpp"
+#include "pipettes/core/tasks/move_group_task.hpp"
 
 static auto& peripheral_queue_client = peripheral_tasks::get_queues();
 static auto& sensor_queue_client = sensor_tasks::get_queues();
@@ -102,7 +106,7 @@ static auto pipette_info_target =
     dispatch_builder::PipetteInfoDispatchTarget{pipette_info_handler};
 
 /** Dispatcher to the various handlers */
-static auto dispatcher = can::dispatch::Dispatcher(
+static auto dispatcher = can::dispatch::ParsingDispatcher(
     [](auto) -> bool { return true; }, motor_dispatch_target,
     motion_group_dispatch_target, motion_controller_dispatch_target,
     sensor_dispatch_target, eeprom_dispatch_target, pipette_info_target,
@@ -116,12 +120,19 @@ auto can_sender_queue = freertos_message_queue::FreeRTOSMessageQueue<
     can::message_writer_task::TaskMessage>{};
 
 /**
- * The type of the message buffer populated by HAL ISR.
+ * The pool of frame slots populated by HAL ISR, with room for a full move
+ * group to the plunger and both gear motors.
  */
-static auto read_can_message_buffer =
-    freertos_message_buffer::FreeRTOSMessageBuffer<1024>{};
-static auto read_can_message_buffer_writer =
-    can::message_buffer::CanMessageBufferWriter(read_can_message_buffer);
+static constexpr auto read_can_frame_pool_size =
+    can::frame_pool::pool_size_for_burst(
+        move_group_task::max_moves_per_group +
+        2 * pipettes::tasks::move_group_task::max_moves_per_group);
+static auto read_can_frame_pool =
+    can::freertos_dispatch::FreeRTOSCanFramePool<read_can_frame_pool_size>{};
+
+/** Tells the host when received frames are dropped. */
+static auto drop_reporter =
+    can::message_writer::MessageWriter{can::ids::NodeId::pipette_left};
 
 /**
  * New CAN message callback.
@@ -131,17 +142,19 @@ static auto read_can_message_buffer_writer =
  * @param length Message data length
  */
 void callback(void*, uint32_t identifier, uint8_t* data, uint8_t length) {
-    read_can_message_buffer_writer.send_from_isr(identifier, data,
-                                                 data + length);  // NOLINT
+    read_can_frame_pool.send_from_isr(identifier, data,
+                                      data + length);  // NOLINT
 }
 
 [[noreturn]] void can_task::CanMessageReaderTask::operator()(
     can::bus::CanBus* can_bus) {
     can_bus->set_incoming_message_callback(nullptr, callback);
-    can_bus->setup_node_id_filter(listen_id);
+    can::acceptance_filter::add_filters(
+        *can_bus,
+        can::acceptance_filter::compile_for<decltype(dispatcher)>(listen_id));
 
-    auto poller = can::freertos_dispatch::FreeRTOSCanBufferPoller(
-        read_can_message_buffer, dispatcher);
+    auto poller = can::freertos_dispatch::FreeRTOSCanFramePoller(
+        read_can_frame_pool, dispatcher);
     poller();
 }
 
@@ -159,11 +172,14 @@ auto static writer_task_control =
 auto can_task::start_reader(can::bus::CanBus& canbus, can::ids::NodeId id)
     -> can_task::CanMessageReaderTask& {
     reader_task.listen_id = id;
+    drop_reporter.set_node_id(id);
+    read_can_frame_pool.set_drop_reporter(drop_reporter);
     reader_task_control.start(5, "can reader task", &canbus);
     return reader_task;
 }
 
 auto can_task::start_writer(can::bus::CanBus& canbus) -> CanMessageWriterTask& {
+    drop_reporter.set_writer(writer_task);
     writer_task_control.start(5, "can writer task", &canbus);
     return writer_task;
 }
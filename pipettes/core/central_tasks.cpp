@@ -24,7 +24,7 @@ void central_tasks::start_tasks(can::bus::CanBus& can_bus,
 
     tasks.can_writer = &can_writer;
 
-    queues.set_queue(&can_writer.get_queue());
+    queues.set_writer(can_writer);
     queues.can_writer = &can_writer.get_queue();
 }
 
@@ -76,7 +76,7 @@ void gear_motor_tasks::start_tasks(
     left_tasks.move_status_reporter = &move_status_reporter_left;
     left_tasks.usage_storage_task = &left_usage_storage_task;
 
-    left_queues.set_queue(&can_writer.get_queue());
+    left_queues.set_writer(can_writer);
     left_queues.driver_queue = &tmc2160_driver_left.get_queue();
     left_queues.motion_queue = &motion_left.get_queue();
     left_queues.move_group_queue = &move_group_left.get_queue();
@@ -106,7 +106,7 @@ void gear_motor_tasks::start_tasks(
     right_tasks.move_status_reporter = &move_status_reporter_right;
     right_tasks.usage_storage_task = &right_usage_storage_task;
 
-    right_queues.set_queue(&can_writer.get_queue());
+    right_queues.set_writer(can_writer);
     right_queues.driver_queue = &tmc2160_driver_right.get_queue();
     right_queues.motion_queue = &motion_right.get_queue();
     right_queues.move_group_queue = &move_group_right.get_queue();
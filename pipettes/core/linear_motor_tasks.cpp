@@ -59,7 +59,7 @@ void linear_motor_tasks::start_tasks(
         move_group_task_builder.start(5, "move group", queues, queues);
     auto& move_status_reporter = move_status_task_builder.start(
         5, "move status", queues, motion_controller.get_mechanical_config(),
-        queues);
+        queues, queues.move_status_events);
     auto& usage_storage_task = linear_usage_storage_task_builder.start(
         5, "usage storage", queues, sensor_tasks::get_queues(), tail_accessor);
 
@@ -73,8 +73,8 @@ void linear_motor_tasks::start_tasks(
     motion_tasks.usage_storage_task = &usage_storage_task;
     motion_tasks.update_data_rev_task = &eeprom_data_rev_update_task;
 
-    queues.set_queue(&can_writer.get_queue());
-    tmc2130_queues.set_queue(&can_writer.get_queue());
+    queues.set_writer(can_writer);
+    tmc2130_queues.set_writer(can_writer);
     tmc2130_queues.driver_queue = &tmc2130_driver.get_queue();
 
     queues.motion_queue = &motion.get_queue();
@@ -110,7 +110,7 @@ void linear_motor_tasks::start_tasks(
         move_group_task_builder.start(5, "move group", queues, queues);
     auto& move_status_reporter = move_status_task_builder.start(
         5, "move status", queues, motion_controller.get_mechanical_config(),
-        queues);
+        queues, queues.move_status_events);
     auto& usage_storage_task = linear_usage_storage_task_builder.start(
         5, "linear usage storage", queues, sensor_tasks::get_queues(),
         tail_accessor);
@@ -125,8 +125,8 @@ void linear_motor_tasks::start_tasks(
     motion_tasks.usage_storage_task = &usage_storage_task;
     motion_tasks.update_data_rev_task = &eeprom_data_rev_update_task;
 
-    queues.set_queue(&can_writer.get_queue());
-    tmc2160_queues.set_queue(&can_writer.get_queue());
+    queues.set_writer(can_writer);
+    tmc2160_queues.set_writer(can_writer);
     tmc2160_queues.driver_queue = &tmc2160_driver.get_queue();
 
     queues.motion_queue = &motion.get_queue();
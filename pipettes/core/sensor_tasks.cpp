@@ -7,9 +7,9 @@
 
 static auto tasks = sensor_tasks::Tasks{};
 static auto queue_client = sensor_tasks::QueueClient{};
-static std::array<float, SENSOR_BUFFER_SIZE> sensor_buffer;
+static SensorBuffer sensor_buffer;
 #ifdef USE_TWO_BUFFERS
-static std::array<float, SENSOR_BUFFER_SIZE> sensor_buffer_front;
+static SensorBuffer sensor_buffer_front;
 #endif
 static auto eeprom_task_builder =
     freertos_task::TaskStarter<512, eeprom::task::EEPromTask>{};
@@ -110,7 +110,7 @@ void sensor_tasks::start_tasks(
     tasks.read_sensor_board_task = &read_sensor_board_task;
     tasks.usage_storage_task = &usage_storage_task;
 
-    queues.set_queue(&can_writer.get_queue());
+    queues.set_writer(can_writer);
     queues.eeprom_queue = &eeprom_task.get_queue();
     queues.environment_sensor_queue = &environment_sensor_task.get_queue();
     queues.capacitive_sensor_queue_rear =
@@ -200,7 +200,7 @@ void sensor_tasks::start_tasks(
     tasks.read_sensor_board_task = &read_sensor_board_task;
     tasks.usage_storage_task = &usage_storage_task;
 
-    queues.set_queue(&can_writer.get_queue());
+    queues.set_writer(can_writer);
     queues.eeprom_queue = &eeprom_task.get_queue();
     queues.environment_sensor_queue = &environment_sensor_task.get_queue();
     queues.capacitive_sensor_queue_rear =
@@ -58,18 +58,20 @@ void linear_motor::encoder_interrupt(motor_hardware::MotorHardware& hw,
 auto linear_motor::get_interrupt(motor_hardware::MotorHardware& hw,
                                  LowThroughputInterruptQueues& queues,
                                  stall_check::StallCheck& stall)
-    -> MotorInterruptHandlerType<linear_motor_tasks::QueueClient> {
+    -> MotorInterruptHandlerType<linear_motor_tasks::MoveStatusEventLog> {
     return motor_handler::MotorInterruptHandler(
-        queues.plunger_queue, linear_motor_tasks::get_queues(), hw, stall,
+        queues.plunger_queue,
+        linear_motor_tasks::get_queues().move_status_events, hw, stall,
         queues.plunger_update_queue);
 }
 
 auto linear_motor::get_interrupt(motor_hardware::MotorHardware& hw,
                                  HighThroughputInterruptQueues& queues,
                                  stall_check::StallCheck& stall)
-    -> MotorInterruptHandlerType<linear_motor_tasks::QueueClient> {
+    -> MotorInterruptHandlerType<linear_motor_tasks::MoveStatusEventLog> {
     return motor_handler::MotorInterruptHandler(
-        queues.plunger_queue, linear_motor_tasks::get_queues(), hw, stall,
+        queues.plunger_queue,
+        linear_motor_tasks::get_queues().move_status_events, hw, stall,
         queues.plunger_update_queue);
 }
 
@@ -142,6 +142,14 @@ static auto sensor_hardware_container =
 
 static auto tip_sense_gpio_primary = pins_for_sensor.primary.tip_sense.value();
 
+// Samples are stamped with the scheduler tick and the plunger position.
+static constexpr auto sample_stamp_source =
+    sensors::hardware::SampleStampSource{
+        .tick = []() -> uint32_t { return xTaskGetTickCount(); },
+        .step_position = []() -> uint32_t {
+            return linear_motor_hardware.get_step_tracker();
+        }};
+
 static auto tail_accessor =
     eeprom::dev_data::DevDataTailAccessor{sensor_queue_client};
 
@@ -274,6 +282,13 @@ auto main() -> int {
 
     app_update_clear_flags();
 
+    sensor_hardware_container.primary.set_sample_stamp_source(
+        sample_stamp_source);
+    if (sensor_hardware_container.secondary.has_value()) {
+        sensor_hardware_container.secondary->set_sample_stamp_source(
+            sample_stamp_source);
+    }
+
     can_bus_1.start(can_bit_timings);
 
     central_tasks::start_tasks(can_bus_1, id);
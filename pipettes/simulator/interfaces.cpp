@@ -47,32 +47,36 @@ auto interfaces::get_interrupt_queues<PipetteType::THREE_EIGHTY_FOUR_CHANNEL>()
 auto linear_motor::get_interrupt(
     sim_motor_hardware_iface::SimMotorHardwareIface& hw,
     LowThroughputInterruptQueues& queues, stall_check::StallCheck& stall)
-    -> MotorInterruptHandlerType<linear_motor_tasks::QueueClient> {
+    -> MotorInterruptHandlerType<linear_motor_tasks::MoveStatusEventLog> {
     return motor_handler::MotorInterruptHandler(
-        queues.plunger_queue, linear_motor_tasks::get_queues(), hw, stall,
+        queues.plunger_queue,
+        linear_motor_tasks::get_queues().move_status_events, hw, stall,
         queues.plunger_update_queue);
 }
 
 auto linear_motor::get_interrupt(
     sim_motor_hardware_iface::SimMotorHardwareIface& hw,
     HighThroughputInterruptQueues& queues, stall_check::StallCheck& stall)
-    -> MotorInterruptHandlerType<linear_motor_tasks::QueueClient> {
+    -> MotorInterruptHandlerType<linear_motor_tasks::MoveStatusEventLog> {
     return motor_handler::MotorInterruptHandler(
-        queues.plunger_queue, linear_motor_tasks::get_queues(), hw, stall,
+        queues.plunger_queue,
+        linear_motor_tasks::get_queues().move_status_events, hw, stall,
         queues.plunger_update_queue);
 }
 
 auto linear_motor::get_interrupt_driver(
     sim_motor_hardware_iface::SimMotorHardwareIface& hw,
     LowThroughputInterruptQueues& queues,
-    MotorInterruptHandlerType<linear_motor_tasks::QueueClient>& handler)
+    MotorInterruptHandlerType<linear_motor_tasks::MoveStatusEventLog>& handler)
 #ifdef USE_SENSOR_MOVE
     -> motor_interrupt_driver::MotorInterruptDriver<
-        linear_motor_tasks::QueueClient, motor_messages::SensorSyncMove,
+        spsc_message_queue::SPSCMessageQueue,
+        linear_motor_tasks::MoveStatusEventLog, motor_messages::SensorSyncMove,
         sim_motor_hardware_iface::SimMotorHardwareIface> {
 #else
     -> motor_interrupt_driver::MotorInterruptDriver<
-        linear_motor_tasks::QueueClient, motor_messages::Move,
+        spsc_message_queue::SPSCMessageQueue,
+        linear_motor_tasks::MoveStatusEventLog, motor_messages::Move,
         sim_motor_hardware_iface::SimMotorHardwareIface> {
 #endif
     return motor_interrupt_driver::MotorInterruptDriver(
@@ -82,14 +86,16 @@ auto linear_motor::get_interrupt_driver(
 auto linear_motor::get_interrupt_driver(
     sim_motor_hardware_iface::SimMotorHardwareIface& hw,
     HighThroughputInterruptQueues& queues,
-    MotorInterruptHandlerType<linear_motor_tasks::QueueClient>& handler)
+    MotorInterruptHandlerType<linear_motor_tasks::MoveStatusEventLog>& handler)
 #ifdef USE_SENSOR_MOVE
     -> motor_interrupt_driver::MotorInterruptDriver<
-        linear_motor_tasks::QueueClient, motor_messages::SensorSyncMove,
+        spsc_message_queue::SPSCMessageQueue,
+        linear_motor_tasks::MoveStatusEventLog, motor_messages::SensorSyncMove,
         sim_motor_hardware_iface::SimMotorHardwareIface> {
 #else
     -> motor_interrupt_driver::MotorInterruptDriver<
-        linear_motor_tasks::QueueClient, motor_messages::Move,
+        spsc_message_queue::SPSCMessageQueue,
+        linear_motor_tasks::MoveStatusEventLog, motor_messages::Move,
         sim_motor_hardware_iface::SimMotorHardwareIface> {
 #endif
     return motor_interrupt_driver::MotorInterruptDriver(
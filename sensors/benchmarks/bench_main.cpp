@@ -0,0 +1,170 @@
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "bench_stats.hpp"
+#include "sensors/core/mmr920.hpp"
+
+/*
+ * Host benchmark for the per reading threshold checks the pressure driver
+ * makes before it sets or clears the sync line: the float checks on the
+ * reading converted to pascals, kept here as the reference, against the
+ * raw count windows that replaced them.
+ *
+ * Usage: sensors-benchmarks [--readings N]
+ */
+
+using namespace sensors::mmr920;
+
+namespace {
+
+constexpr auto version = SensorVersion::mmr920c04;
+constexpr float baseline_pa = 12.5F;
+constexpr float moving_baseline_pa = -3.25F;
+constexpr float threshold_pa = 150.0F;
+
+/*
+ * Readings around the baseline, with an occasional one past the threshold,
+ * as 24 bit register values.
+ */
+auto readings(std::size_t count) -> std::vector<uint32_t> {
+    auto generator = std::mt19937{1234};
+    auto noise = std::normal_distribution<float>{0.0F, threshold_pa / 2};
+    auto result = std::vector<uint32_t>{};
+    result.reserve(count);
+    auto pa_per_count = PressureResult::get_pa_per_count(version);
+    for (std::size_t i = 0; i < count; ++i) {
+        auto counts = static_cast<int32_t>(
+            std::lround((baseline_pa + noise(generator)) / pa_per_count));
+        result.push_back(static_cast<uint32_t>(counts) & 0xFFFFFF);
+    }
+    return result;
+}
+
+// Keeps the results of the code under test alive
+volatile std::size_t sink = 0;
+
+// A reading takes less time than reading the clock, so they are timed in
+// batches
+constexpr std::size_t readings_per_sample = 64;
+
+template <typename Callable>
+auto time_readings(const std::vector<uint32_t>& regs, Callable&& callable)
+    -> benchmarks::Summary {
+    std::size_t total = 0;
+    // One untimed pass so both sides start with warm caches
+    for (auto reg : regs) {
+        total += callable(reg) ? 1 : 0;
+    }
+    auto sampler = benchmarks::Sampler{regs.size() / readings_per_sample};
+    for (std::size_t first = 0; first + readings_per_sample <= regs.size();
+         first += readings_per_sample) {
+        sampler.time([&]() {
+            for (std::size_t i = first; i < first + readings_per_sample;
+                 ++i) {
+                total += callable(regs[i]) ? 1 : 0;
+            }
+        });
+    }
+    sink = total;
+    return benchmarks::per_call(sampler.summarize("sync and max pressure"),
+                                readings_per_sample);
+}
+
+auto time_float_check(const std::vector<uint32_t>& regs)
+    -> benchmarks::Summary {
+    return time_readings(regs, [](uint32_t reg) {
+        auto pressure = PressureResult::to_pressure(reg, version);
+        auto sync = std::fabs(pressure - baseline_pa - moving_baseline_pa) >
+                    threshold_pa;
+        auto max_pressure = std::fabs(pressure - baseline_pa) >=
+                            get_max_pressure_reading(version);
+        return sync || max_pressure;
+    });
+}
+
+auto time_window_check(const std::vector<uint32_t>& regs)
+    -> benchmarks::Summary {
+    auto sync_window = ThresholdWindow::from(
+        [](int32_t counts) {
+            return PressureResult::counts_to_pressure(counts, version) -
+                   baseline_pa - moving_baseline_pa;
+        },
+        [](float offset) { return std::fabs(offset) > threshold_pa; });
+    auto max_window = ThresholdWindow::from(
+        [](int32_t counts) {
+            return PressureResult::counts_to_pressure(counts, version) -
+                   baseline_pa;
+        },
+        [](float offset) {
+            return std::fabs(offset) >= get_max_pressure_reading(version);
+        });
+    return time_readings(regs, [&](uint32_t reg) {
+        auto counts = PressureResult::to_counts(reg);
+        return sync_window.outside(counts) || max_window.outside(counts);
+    });
+}
+
+auto time_window_build() -> benchmarks::Summary {
+    constexpr std::size_t builds = 1000;
+    std::size_t total = 0;
+    auto sampler = benchmarks::Sampler{builds};
+    for (std::size_t i = 0; i < builds; ++i) {
+        auto threshold = threshold_pa + static_cast<float>(i);
+        sampler.time([&]() {
+            auto window = ThresholdWindow::from(
+                [](int32_t counts) {
+                    return PressureResult::counts_to_pressure(counts,
+                                                              version) -
+                           baseline_pa;
+                },
+                [threshold](float offset) {
+                    return std::fabs(offset) > threshold;
+                });
+            total += static_cast<std::size_t>(window.upper - window.lower);
+        });
+    }
+    sink = total;
+    return sampler.summarize("build a window");
+}
+
+}  // namespace
+
+auto main(int argc, char** argv) -> int {
+    std::size_t count = 1000000;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--readings") == 0 && i + 1 < argc) {
+            count = strtoul(argv[++i], nullptr, 0);
+        } else {
+            fprintf(stderr, "usage: %s [--readings N]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (count < readings_per_sample) {
+        fprintf(stderr, "--readings must be at least %zu\n",
+                readings_per_sample);
+        return 1;
+    }
+
+    auto regs = readings(count);
+    auto float_check = time_float_check(regs);
+    auto window_check = time_window_check(regs);
+    auto build = time_window_build();
+    printf("%zu readings\n", count);
+    printf("%-28s %10s %10s %10s %10s %10s\n", "ns per reading", "float p50",
+           "p50", "float p99", "p99", "speedup");
+    printf("%-28s %10.2f %10.2f %10.2f %10.2f %9.2fx\n",
+           window_check.name.c_str(), float_check.p50_ns, window_check.p50_ns,
+           float_check.p99_ns, window_check.p99_ns,
+           window_check.p50_ns > 0 ? float_check.p50_ns / window_check.p50_ns
+                                   : 0.0);
+    printf("%-28s %10s %10s %10s\n", "ns to build a window", "p50", "p99",
+           "max");
+    printf("%-28s %10.2f %10.2f %10.2f\n", "", build.p50_ns, build.p99_ns,
+           build.max_ns);
+    return 0;
+}
@@ -30,7 +30,7 @@ auto get_message_i2c(Queue& q) -> Message {
 auto sensor_id = can::ids::SensorId::S0;
 constexpr uint8_t sensor_id_int = 0x0;
 
-static std::array<float, SENSOR_BUFFER_SIZE> sensor_buffer;
+static SensorBuffer sensor_buffer;
 
 SCENARIO("read capacitance sensor values without shared CINs") {
     auto version_wrapper = sensors::hardware::SensorHardwareVersionSingleton();
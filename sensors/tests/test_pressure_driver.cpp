@@ -1,7 +1,10 @@
+#include <algorithm>
 #include <concepts>
+#include <vector>
 
 #include "can/core/messages.hpp"
 #include "catch2/catch.hpp"
+#include "common/core/delta_encoding.hpp"
 #include "common/tests/mock_message_queue.hpp"
 #include "common/tests/mock_queue_client.hpp"
 #include "i2c/core/poller.hpp"
@@ -44,7 +47,7 @@ struct MockUsageClient {
 };
 constexpr auto sensor_id = can::ids::SensorId::S0;
 constexpr uint8_t sensor_id_int = 0x0;
-static std::array<float, SENSOR_BUFFER_SIZE> sensor_buffer;
+static SensorBuffer sensor_buffer;
 constexpr uint16_t overpressure_eeprom_key = 123;
 
 SCENARIO("Testing the pressure sensor driver") {
@@ -407,3 +410,312 @@ SCENARIO("Testing the pressure sensor driver") {
         }
     }
 }
+
+static uint32_t stamp_tick = 0;
+static uint32_t stamp_steps = 0;
+
+SCENARIO("Streaming pressure samples") {
+    test_mocks::MockMessageQueue<i2c::writer::TaskMessage> i2c_queue{};
+    test_mocks::MockMessageQueue<i2c::poller::TaskMessage> i2c_poll_queue{};
+    test_mocks::MockMessageQueue<can::message_writer_task::TaskMessage>
+        can_queue{};
+    test_mocks::MockMessageQueue<sensors::utils::TaskMessage> pressure_queue{};
+
+    auto version_wrapper = sensors::hardware::SensorHardwareVersionSingleton();
+    auto sync_control = sensors::hardware::SensorHardwareSyncControlSingleton();
+
+    auto writer = i2c::writer::Writer<test_mocks::MockMessageQueue>{};
+    auto poller = i2c::poller::Poller<test_mocks::MockMessageQueue>{};
+    test_mocks::MockSensorHardware hardware{version_wrapper, sync_control};
+    auto queue_client =
+        mock_client::QueueClient{.pressure_sensor_queue = &pressure_queue};
+    queue_client.set_queue(&can_queue);
+    writer.set_queue(&i2c_queue);
+    poller.set_queue(&i2c_poll_queue);
+    auto muc = MockUsageClient();
+    sensors::tasks::MMR920 driver(writer, poller, queue_client, pressure_queue,
+                                  hardware, sensor_id, &sensor_buffer, muc,
+                                  overpressure_eeprom_key);
+
+    std::array tags{sensors::utils::ResponseTag::IS_PART_OF_POLL,
+                    sensors::utils::ResponseTag::POLL_IS_CONTINUOUS};
+    auto sensor_response = i2c::messages::TransactionResponse{
+        .id =
+            i2c::messages::TransactionIdentifier{
+                .token = sensors::utils::build_id(
+                    sensors::mmr920::ADDRESS,
+                    static_cast<uint8_t>(
+                        sensors::mmr920::Registers::LOW_PASS_PRESSURE_READ),
+                    sensors::utils::byte_from_tags(tags)),
+                .is_completed_poll = false,
+                .transaction_index = 0},
+        .bytes_read = 3,
+        .read_buffer = {0x00, 0xC0, 0xDE}};
+
+    auto read_frame = [&can_queue]() {
+        can::message_writer_task::TaskMessage can_msg{};
+        REQUIRE(can_queue.try_read(&can_msg));
+        REQUIRE(std::holds_alternative<can::messages::SensorStreamData>(
+            can_msg.message));
+        return std::get<can::messages::SensorStreamData>(can_msg.message);
+    };
+    auto samples_of = [](const can::messages::SensorStreamData& frame) {
+        std::vector<int32_t> samples{};
+        delta_encoding::decode(
+            frame.data.cbegin(), frame.data.cbegin() + frame.data_length,
+            frame.sample_count,
+            [&samples](int32_t sample) { samples.push_back(sample); });
+        return samples;
+    };
+
+    GIVEN("a request for delta streaming") {
+        driver.set_stream_mode(can::ids::SensorStreamMode::delta, 7);
+        can::message_writer_task::TaskMessage can_msg{};
+        can_queue.try_read(&can_msg);
+        auto response =
+            std::get<can::messages::SensorStreamResponse>(can_msg.message);
+        THEN("the mode, sample period and scale are sent back") {
+            REQUIRE(response.message_index == 7);
+            REQUIRE(response.mode == can::ids::SensorStreamMode::delta);
+            REQUIRE(response.sample_period_us == 4240);
+            // a count of the mmr920c04 is 1e-5 cmH2O
+            REQUIRE(std::ldexp(static_cast<double>(response.scale),
+                               -can::messages::SENSOR_STREAM_SCALE_RADIX) ==
+                    Approx(1e-5 * 98.0665));
+        }
+        driver.set_echoing(true);
+
+        WHEN("fewer samples than fill a frame arrive") {
+            for (int i = 0; i < 20; i++) {
+                driver.handle_ongoing_pressure_response(sensor_response);
+            }
+            THEN("nothing is sent yet") { REQUIRE(can_queue.get_size() == 0); }
+            AND_WHEN("the accumulated data is requested") {
+                driver.send_accumulated_sensor_data(3);
+                THEN("the samples are flushed ahead of the ack") {
+                    auto frame = read_frame();
+                    REQUIRE(frame.sample_count == 20);
+                    REQUIRE(samples_of(frame).size() == 20);
+                    can::message_writer_task::TaskMessage ack{};
+                    can_queue.try_read(&ack);
+                    REQUIRE(std::holds_alternative<
+                            can::messages::Acknowledgment>(ack.message));
+                }
+            }
+        }
+
+        WHEN("enough samples arrive to fill frames") {
+            for (int i = 0; i < 100; i++) {
+                driver.handle_ongoing_pressure_response(sensor_response);
+            }
+            THEN("full frames carry more samples than a batch response") {
+                auto first = read_frame();
+                auto second = read_frame();
+                REQUIRE(first.sample_count >
+                        can::messages::BATCH_SENSOR_MAX_LEN);
+                REQUIRE(first.sequence == 0);
+                REQUIRE(first.first_sample == 0);
+                REQUIRE(second.sequence == 1);
+                REQUIRE(second.first_sample == first.sample_count);
+                auto samples = samples_of(first);
+                REQUIRE(samples.size() == first.sample_count);
+                REQUIRE(std::all_of(
+                    samples.begin(), samples.end(),
+                    [&samples](int32_t s) { return s == samples.front(); }));
+            }
+            THEN("the samples are the sensor's counts") {
+                REQUIRE(samples_of(read_frame()).front() == 0xC0DE);
+            }
+        }
+
+        WHEN("readings move by one count at a time") {
+            auto counts = 0xC0DE;
+            for (int i = 0; i < 100; i++) {
+                counts += (i % 2 == 0) ? 1 : -1;
+                sensor_response.read_buffer[1] =
+                    static_cast<uint8_t>(counts >> 8);
+                sensor_response.read_buffer[2] = static_cast<uint8_t>(counts);
+                driver.handle_ongoing_pressure_response(sensor_response);
+            }
+            THEN("every sample after the first takes one byte") {
+                auto frame = read_frame();
+                REQUIRE(frame.data_length ==
+                        delta_encoding::varint_size(
+                            delta_encoding::zigzag(0xC0DE + 1)) +
+                            frame.sample_count - 1);
+                auto samples = samples_of(frame);
+                REQUIRE(samples.at(0) == 0xC0DE + 1);
+                REQUIRE(samples.at(1) == 0xC0DE);
+            }
+        }
+
+        WHEN("the board stamps its samples") {
+            hardware.set_sample_stamp_source(
+                sensors::hardware::SampleStampSource{
+                    .tick = []() { return stamp_tick; },
+                    .step_position = []() { return stamp_steps; }});
+            stamp_tick = 2000;
+            for (int i = 0; i < 100; i++) {
+                stamp_tick += 4;
+                driver.handle_ongoing_pressure_response(sensor_response);
+            }
+            THEN("each frame carries the tick of its first sample") {
+                auto first = read_frame();
+                auto second = read_frame();
+                REQUIRE(first.first_tick == 2004);
+                REQUIRE(second.first_tick == 2004U + 4U * first.sample_count);
+            }
+        }
+
+        WHEN("the can queue stays full until the buffer wraps") {
+            while (can_queue.try_write(
+                can::message_writer_task::TaskMessage{})) {
+            }
+            for (size_t i = 0; i < SENSOR_BUFFER_SIZE + 10; i++) {
+                driver.handle_ongoing_pressure_response(sensor_response);
+            }
+            can_queue.reset();
+            driver.handle_ongoing_pressure_response(sensor_response);
+            THEN("the next frame starts after the dropped samples") {
+                auto frame = read_frame();
+                REQUIRE(frame.sequence == 0);
+                REQUIRE(frame.first_sample == 11);
+            }
+        }
+    }
+}
+
+SCENARIO("Stamping pressure samples") {
+    test_mocks::MockMessageQueue<i2c::writer::TaskMessage> i2c_queue{};
+    test_mocks::MockMessageQueue<i2c::poller::TaskMessage> i2c_poll_queue{};
+    test_mocks::MockMessageQueue<can::message_writer_task::TaskMessage>
+        can_queue{};
+    test_mocks::MockMessageQueue<sensors::utils::TaskMessage> pressure_queue{};
+
+    auto version_wrapper = sensors::hardware::SensorHardwareVersionSingleton();
+    auto sync_control = sensors::hardware::SensorHardwareSyncControlSingleton();
+
+    auto writer = i2c::writer::Writer<test_mocks::MockMessageQueue>{};
+    auto poller = i2c::poller::Poller<test_mocks::MockMessageQueue>{};
+    test_mocks::MockSensorHardware hardware{version_wrapper, sync_control};
+    auto queue_client =
+        mock_client::QueueClient{.pressure_sensor_queue = &pressure_queue};
+    queue_client.set_queue(&can_queue);
+    writer.set_queue(&i2c_queue);
+    poller.set_queue(&i2c_poll_queue);
+    auto muc = MockUsageClient();
+    sensors::tasks::MMR920 driver(writer, poller, queue_client, pressure_queue,
+                                  hardware, sensor_id, &sensor_buffer, muc,
+                                  overpressure_eeprom_key);
+
+    std::array tags{sensors::utils::ResponseTag::IS_PART_OF_POLL,
+                    sensors::utils::ResponseTag::POLL_IS_CONTINUOUS};
+    auto sensor_response = i2c::messages::TransactionResponse{
+        .id =
+            i2c::messages::TransactionIdentifier{
+                .token = sensors::utils::build_id(
+                    sensors::mmr920::ADDRESS,
+                    static_cast<uint8_t>(
+                        sensors::mmr920::Registers::LOW_PASS_PRESSURE_READ),
+                    sensors::utils::byte_from_tags(tags)),
+                .is_completed_poll = false,
+                .transaction_index = 0},
+        .bytes_read = 3,
+        .read_buffer = {0x00, 0xC0, 0xDE}};
+
+    auto read_message = [&can_queue]() {
+        can::message_writer_task::TaskMessage can_msg{};
+        REQUIRE(can_queue.try_read(&can_msg));
+        return can_msg.message;
+    };
+
+    stamp_tick = 1000;
+    stamp_steps = 500;
+    driver.set_echoing(true);
+
+    GIVEN("a board without a stamp source") {
+        driver.set_stamping(true);
+        WHEN("a batch of samples arrives") {
+            for (size_t i = 0; i < can::messages::BATCH_SENSOR_MAX_LEN; i++) {
+                driver.handle_ongoing_pressure_response(sensor_response);
+            }
+            THEN("the batch is sent without stamps") {
+                REQUIRE(can_queue.get_size() == 1);
+                REQUIRE(std::holds_alternative<
+                        can::messages::BatchReadFromSensorResponse>(
+                    read_message()));
+            }
+        }
+    }
+
+    GIVEN("a board that stamps samples with a tick and the motor position") {
+        hardware.set_sample_stamp_source(sensors::hardware::SampleStampSource{
+            .tick = []() { return stamp_tick; },
+            .step_position = []() { return stamp_steps; }});
+        driver.set_stamping(true);
+        auto log_sample = [&](uint32_t ticks, int32_t steps) {
+            stamp_tick += ticks;
+            stamp_steps += static_cast<uint32_t>(steps);
+            driver.handle_ongoing_pressure_response(sensor_response);
+        };
+
+        WHEN("a batch of samples arrives while the motor moves") {
+            for (size_t i = 0; i < can::messages::BATCH_SENSOR_MAX_LEN; i++) {
+                log_sample(4, -30);
+            }
+            THEN("the batch is followed by the stamps of its samples") {
+                auto batch = std::get<
+                    can::messages::BatchReadFromSensorResponse>(
+                    read_message());
+                auto stamps =
+                    std::get<can::messages::BatchSensorStampsResponse>(
+                        read_message());
+                REQUIRE(stamps.data_length == batch.data_length);
+                REQUIRE(stamps.sensor == can::ids::SensorType::pressure);
+                REQUIRE(stamps.first_tick == 1004);
+                REQUIRE(stamps.first_step_position == 470);
+                for (size_t i = 0; i < stamps.data_length - 1U; i++) {
+                    REQUIRE(stamps.tick_deltas.at(i) == 4);
+                    REQUIRE(stamps.step_deltas.at(i) == -30);
+                }
+                REQUIRE(sensor_buffer.stamps.empty());
+            }
+        }
+
+        WHEN("samples are further apart than a batch's stamps can hold") {
+            log_sample(4, 10);
+            log_sample(300, 10);
+            log_sample(4, 10);
+            driver.send_accumulated_sensor_data(3);
+            THEN("the batch is split at the gap") {
+                auto first = std::get<
+                    can::messages::BatchReadFromSensorResponse>(
+                    read_message());
+                auto first_stamps =
+                    std::get<can::messages::BatchSensorStampsResponse>(
+                        read_message());
+                auto second = std::get<
+                    can::messages::BatchReadFromSensorResponse>(
+                    read_message());
+                auto second_stamps =
+                    std::get<can::messages::BatchSensorStampsResponse>(
+                        read_message());
+                REQUIRE(first.data_length == 1);
+                REQUIRE(first_stamps.first_tick == 1004);
+                REQUIRE(second.data_length == 2);
+                REQUIRE(second_stamps.first_tick == 1304);
+                REQUIRE(second_stamps.first_step_position == 520);
+                REQUIRE(second_stamps.tick_deltas.at(0) == 4);
+            }
+        }
+
+        WHEN("stamping is turned off") {
+            log_sample(4, 10);
+            driver.set_stamping(false);
+            THEN("the waiting samples and their stamps are dropped") {
+                REQUIRE(sensor_buffer.empty());
+                REQUIRE(sensor_buffer.stamps.empty());
+            }
+        }
+    }
+}
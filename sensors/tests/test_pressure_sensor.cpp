@@ -44,7 +44,7 @@ constexpr uint8_t pressure_temperature_id =
 constexpr uint8_t sensor_id_int = 0x0;
 constexpr uint16_t overpressure_eeprom_key = 123;
 
-static std::array<float, SENSOR_BUFFER_SIZE> sensor_buffer;
+static SensorBuffer sensor_buffer;
 
 SCENARIO("Receiving messages through the pressure sensor message handler") {
     test_mocks::MockMessageQueue<i2c::writer::TaskMessage> i2c_queue{};
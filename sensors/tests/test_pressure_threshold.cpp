@@ -0,0 +1,118 @@
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "catch2/catch.hpp"
+#include "sensors/core/mmr920.hpp"
+
+using namespace sensors::mmr920;
+
+namespace {
+
+struct Check {
+    SensorVersion version;
+    float baseline;
+    float threshold;
+    bool inclusive;
+
+    [[nodiscard]] auto offset(int32_t counts) const -> float {
+        return PressureResult::counts_to_pressure(counts, version) - baseline;
+    }
+
+    [[nodiscard]] auto tripped(float value) const -> bool {
+        return inclusive ? std::fabs(value) >= threshold
+                         : std::fabs(value) > threshold;
+    }
+
+    [[nodiscard]] auto window() const -> ThresholdWindow {
+        return ThresholdWindow::from(
+            [this](int32_t counts) { return offset(counts); },
+            [this](float value) { return tripped(value); });
+    }
+};
+
+// Every count near the edges of the window and a spread across the range
+auto counts_to_check(const ThresholdWindow& window) -> std::vector<int32_t> {
+    auto counts = std::vector<int32_t>{};
+    for (auto edge : {window.lower, window.upper}) {
+        for (int32_t i = -256; i <= 256; ++i) {
+            auto count = static_cast<int64_t>(edge) + i;
+            if (count >= PressureResult::MIN_COUNTS &&
+                count <= PressureResult::MAX_COUNTS) {
+                counts.push_back(static_cast<int32_t>(count));
+            }
+        }
+    }
+    for (int32_t count = PressureResult::MIN_COUNTS;
+         count < PressureResult::MAX_COUNTS; count += 9973) {
+        counts.push_back(count);
+    }
+    counts.push_back(PressureResult::MAX_COUNTS);
+    return counts;
+}
+
+}  // namespace
+
+SCENARIO("pressure threshold windows match the float checks") {
+    auto checks = std::vector<Check>{
+        {SensorVersion::mmr920c04, 0.0F, 100.0F, false},
+        {SensorVersion::mmr920c10, 0.0F, 100.0F, false},
+        {SensorVersion::mmr920c04, 37.25F, 12.5F, false},
+        {SensorVersion::mmr920c10, -412.7F, 3.3F, false},
+        {SensorVersion::mmr920c04, 0.0F, 0.0F, false},
+        {SensorVersion::mmr920c04, 0.0F,
+         get_max_pressure_reading(SensorVersion::mmr920c04), true},
+        {SensorVersion::mmr920c10, 250.0F,
+         get_max_pressure_reading(SensorVersion::mmr920c10), true},
+        {SensorVersion::mmr920c04, 5000.0F, 4000.0F, false},
+    };
+    for (const auto& check : checks) {
+        GIVEN("a baseline of " << check.baseline << " and threshold of "
+                               << check.threshold) {
+            auto window = check.window();
+            THEN("the window trips for exactly the readings the float check "
+                 "trips for") {
+                for (auto counts : counts_to_check(window)) {
+                    INFO("counts " << counts);
+                    REQUIRE(window.outside(counts) ==
+                            check.tripped(check.offset(counts)));
+                }
+            }
+        }
+    }
+
+    GIVEN("a threshold below zero") {
+        auto check = Check{SensorVersion::mmr920c04, 0.0F, -1.0F, false};
+        auto window = check.window();
+        THEN("every reading trips it") {
+            REQUIRE(window.outside(0));
+            REQUIRE(window.outside(PressureResult::MIN_COUNTS));
+            REQUIRE(window.outside(PressureResult::MAX_COUNTS));
+        }
+    }
+
+    GIVEN("a threshold beyond the range of the sensor") {
+        auto check = Check{SensorVersion::mmr920c04, 0.0F, 1e6F, false};
+        auto window = check.window();
+        THEN("no reading trips it") {
+            REQUIRE(!window.outside(PressureResult::MIN_COUNTS));
+            REQUIRE(!window.outside(PressureResult::MAX_COUNTS));
+        }
+    }
+}
+
+SCENARIO("pressure readings as counts") {
+    GIVEN("a negative 24 bit reading") {
+        THEN("it is sign extended") {
+            REQUIRE(PressureResult::to_counts(0xFFFFFF) == -1);
+            REQUIRE(PressureResult::to_counts(0x800000) ==
+                    PressureResult::MIN_COUNTS);
+        }
+        THEN("converting it to pascals is unchanged") {
+            REQUIRE(PressureResult::to_pressure(0xFFFFFF,
+                                                SensorVersion::mmr920c04) ==
+                    -PressureResult::get_pa_per_count(
+                        SensorVersion::mmr920c04));
+        }
+    }
+}